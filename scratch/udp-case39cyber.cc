@@ -99,7 +99,18 @@ time_t seconds;
 int main (int argc, char *argv[])
 {
 
+  // Queue of the PointToPoint devices, such as ns3::PrioQueue to give
+  // the WAC and PDC traffic priority over the background traffic
+  std::string queueType = "ns3::DropTailQueue";
+
+  // Route the PMU to PDC and WAC flows of BEG_005 and BEG_006 on paths
+  // precomputed before the simulation, with failover paths for the links
+  // of BEG_100, instead of global routing
+  bool useFlowPaths = false;
+
   CommandLine cmd;
+  cmd.AddValue ("queue", "Queue of the PointToPoint devices", queueType);
+  cmd.AddValue ("flowPaths", "Route the PMU flows on precomputed paths", useFlowPaths);
   cmd.Parse (argc, argv);
 
   // Open the configuration file for reading
@@ -107,7 +118,7 @@ int main (int argc, char *argv[])
 
   std::string strLine;
   bool gettingNodeCount = false, buildingNetworkTopo = false, attachingWACs = false, attachingPMUs = false, attachingPDCs = false, flowPMUtoPDC = false, flowPMUtoWAC = false;
-  bool failLinks = false, injectData = false;
+  bool settingQueue = false, failLinks = false, injectData = false;
   std::vector<std::string> netParams;
 
   NodeContainer nodes;
@@ -117,11 +128,14 @@ int main (int argc, char *argv[])
   Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("10"));
 
   PointToPointHelper p2p;
+  p2p.SetQueue (queueType);
   NetDeviceContainer devices;
   Ipv4AddressHelper addresses;
 
   std::pair<int,std::string> node_ip_pair;
 
+  Ipv4FlowPathRoutingHelper flowPaths;
+
   ProducerHelper proHelper;
   ApplicationContainer proApps;
   SubscriberHelper consumerHelper;
@@ -147,6 +161,13 @@ int main (int argc, char *argv[])
 			nodes.Create(nodeCount);
 			//Install internet protocol stack on nodes
 			InternetStackHelper stack1;
+			if (useFlowPaths) {
+				Ipv4ListRoutingHelper list;
+				list.Add (Ipv4StaticRoutingHelper (), 0);
+				list.Add (flowPaths, 10);
+				list.Add (Ipv4GlobalRoutingHelper (), -10);
+				stack1.SetRoutingHelper (list);
+			}
   			stack1.Install (nodes);
 
 			continue; 
@@ -163,6 +184,8 @@ int main (int argc, char *argv[])
                 if(strLine.substr(0,7) == "END_005") { flowPMUtoPDC = false; continue; }
 		if(strLine.substr(0,7) == "BEG_006") { flowPMUtoWAC = true; continue; }
                 if(strLine.substr(0,7) == "END_006") { flowPMUtoWAC = false; continue; }
+		if(strLine.substr(0,7) == "BEG_007") { settingQueue = true; continue; }
+                if(strLine.substr(0,7) == "END_007") { settingQueue = false; continue; }
 		if(strLine.substr(0,7) == "BEG_100") { failLinks = true; continue; }
                 if(strLine.substr(0,7) == "END_100") { failLinks = false; continue; }
 		if(strLine.substr(0,7) == "BEG_101") { injectData = true; continue; }
@@ -244,6 +267,7 @@ int main (int argc, char *argv[])
                 	//int offset = (rand() % 91) + 1;
                 	consumerHelper.SetAttribute ("Offset", UintegerValue (0));
                 	conApps = consumerHelper.Install (nodes.Get (std::stoi(netParams[1])));
+			flowPaths.AddFlow (nodes.Get (std::stoi(netParams[1])), Ipv4Address(GetPDCIP(std::stoi(netParams[0])).c_str()));
 
 			//Write flow to file
 			flowfile << netParams[0] << " " << netParams[1] << " PDC" << std::endl;
@@ -267,11 +291,22 @@ int main (int argc, char *argv[])
                         //int offset = (rand() % 91) + 1;
                         consumerHelper.SetAttribute ("Offset", UintegerValue (0));
                         conApps = consumerHelper.Install (nodes.Get (std::stoi(netParams[1])));
+                        flowPaths.AddFlow (nodes.Get (std::stoi(netParams[1])), Ipv4Address(GetWACIP(std::stoi(netParams[0])).c_str()));
 
 			//Write flow to file
 			flowfile << netParams[0] << " " << netParams[1] << " WAC" << std::endl;
 
                 }
+		else if(settingQueue == true) {
+                        //Setting the queue of the links created afterwards, as "QueueType ns3::PrioQueue"
+                        //followed by the queue attributes, as "Classifier IcensPort" or "BandLimits 10 50 100"
+                        netParams = SplitString(strLine);
+                        if (netParams.size () < 2) continue;
+                        std::string value = netParams[1];
+                        for (int i=2; i<(int)netParams.size(); i++) value += " " + netParams[i];
+                        if (netParams[0] == "QueueType") p2p.SetQueue(value);
+                        else p2p.SetQueueAttribute(netParams[0], StringValue(value));
+		}
 		else if(failLinks == true) {
                         //Fail links specified in the config file
                         netParams = SplitString(strLine);
@@ -279,6 +314,7 @@ int main (int argc, char *argv[])
 			ipv4node = nodes.Get(stoi(netParams[1]))->GetObject<Ipv4> ();
                         Simulator::Schedule (Seconds ( ((double)stod(netParams[2])) ),&Ipv4::SetDown,ipv4node, stoi(netParams[4]));
                         Simulator::Schedule (Seconds ( ((double)stod(netParams[3])) ),&Ipv4::SetUp,ipv4node, stoi(netParams[4]));
+                        flowPaths.AddLinkFailure (nodes.Get(stoi(netParams[1])), stoi(netParams[4]));
 
 		}
 		else if(injectData == true) {
@@ -320,6 +356,9 @@ int main (int argc, char *argv[])
 
   //Populate the routing table
   Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+  if (useFlowPaths) {
+	flowPaths.PopulateFlowPaths ();
+  }
 
 
   //Open trace file for writing
@@ -134,8 +134,10 @@ iCenSAggregator::StartApplication (void)
         m_socket6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), m_local_port));
   }
 
-  m_socket->SetRecvCallback (MakeCallback (&iCenSAggregator::HandleRead, this));
-  m_socket6->SetRecvCallback (MakeCallback (&iCenSAggregator::HandleRead, this));
+  SetRecvCallbacks (m_socket, MakeCallback (&iCenSAggregator::HandleRead, this),
+                    MakeCallback (&iCenSAggregator::HandlePacket, this));
+  SetRecvCallbacks (m_socket6, MakeCallback (&iCenSAggregator::HandleRead, this),
+                    MakeCallback (&iCenSAggregator::HandlePacket, this));
 
   // Create socket (only once) to compute node that this aggregator sends packets to
   if (m_comp_socket == 0) {
@@ -158,12 +160,29 @@ iCenSAggregator::StartApplication (void)
   }
 
   //Handle acknowledgement responses back from compute nodes on the new socket
-  m_comp_socket->SetRecvCallback (MakeCallback (&iCenSAggregator::HandleACK, this));
+  SetRecvCallbacks (m_comp_socket, MakeCallback (&iCenSAggregator::HandleACK, this),
+                    MakeCallback (&iCenSAggregator::HandleACKPacket, this));
 
   //Send aggregated packets at scheduled rate
   ScheduleAggPackets();
 }
 
+void
+iCenSAggregator::SetRecvCallbacks (Ptr<Socket> socket, Callback<void, Ptr<Socket> > handleRead,
+                                   Callback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> handlePacket)
+{
+  //UDP sockets deliver the packets directly, without queueing them
+  Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (socket);
+  if (udpSocket)
+  {
+    udpSocket->SetRecvPktCallback (handlePacket);
+  }
+  else
+  {
+    socket->SetRecvCallback (handleRead);
+  }
+}
+
 void
 iCenSAggregator::StopApplication (void)
 {
@@ -253,36 +272,45 @@ iCenSAggregator::HandleRead (Ptr<Socket> socket)
 {
 
   Ptr<Packet> packet;
+  Address from;
 
-  while ((packet = socket->RecvFrom (m_src_address)))
+  while ((packet = socket->RecvFrom (from)))
   {
+    HandlePacket (socket, packet, from, Address ());
+  }
 
-    if (InetSocketAddress::IsMatchingType (m_src_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
-         InetSocketAddress::ConvertFrom (m_src_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_src_address).GetPort ());
-    }
-    else if (Inet6SocketAddress::IsMatchingType (m_src_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
-         Inet6SocketAddress::ConvertFrom (m_src_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_src_address).GetPort ());
-    }
+}
 
-    //Aggregate the payload size
-    m_totalpayload += (packet->GetSize () - 4);
+void
+iCenSAggregator::HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to)
+{
 
-    //Subscription values >=100 are sequence numbers
-    iCenSHeader packetHeader;
-    packet->RemoveHeader(packetHeader);
-    if (packetHeader.GetSubscription() >= 100) {
-    	m_recv_seq = packetHeader.GetSubscription();
-    }
+  m_src_address = from;
 
-    // Callback for received packet
-    m_receivedPacket (GetNode()->GetId(), packet, m_src_address, m_local_port, m_recv_seq);
+  if (InetSocketAddress::IsMatchingType (m_src_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
+       InetSocketAddress::ConvertFrom (m_src_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_src_address).GetPort ());
+  }
+  else if (Inet6SocketAddress::IsMatchingType (m_src_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
+       Inet6SocketAddress::ConvertFrom (m_src_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_src_address).GetPort ());
+  }
+
+  //Aggregate the payload size
+  m_totalpayload += (packet->GetSize () - 4);
 
+  //Subscription values >=100 are sequence numbers
+  iCenSHeader packetHeader;
+  packet->RemoveHeader(packetHeader);
+  if (packetHeader.GetSubscription() >= 100) {
+  	m_recv_seq = packetHeader.GetSubscription();
   }
 
+  // Callback for received packet
+  m_receivedPacket (GetNode()->GetId(), packet, m_src_address, m_local_port, m_recv_seq);
+
 }
 
 void
@@ -290,20 +318,30 @@ iCenSAggregator::HandleACK (Ptr<Socket> socket)
 {
 
   Ptr<Packet> packet;
+  Address from;
 
-  while ((packet = socket->RecvFrom (m_remote_address)))
+  while ((packet = socket->RecvFrom (from)))
   {
+    HandleACKPacket (socket, packet, from, Address ());
+  }
 
-    if (InetSocketAddress::IsMatchingType (m_remote_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED ACK of size " << packet->GetSize () << " bytes from " <<
-         InetSocketAddress::ConvertFrom (m_remote_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_remote_address).GetPort ());
-    }
-    else if (Inet6SocketAddress::IsMatchingType (m_remote_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED ACK of size " << packet->GetSize () << " bytes from " <<
-         Inet6SocketAddress::ConvertFrom (m_remote_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_remote_address).GetPort ());
-    }
+}
+
+void
+iCenSAggregator::HandleACKPacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to)
+{
+
+  m_remote_address = from;
+
+  if (InetSocketAddress::IsMatchingType (m_remote_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED ACK of size " << packet->GetSize () << " bytes from " <<
+       InetSocketAddress::ConvertFrom (m_remote_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_remote_address).GetPort ());
+  }
+  else if (Inet6SocketAddress::IsMatchingType (m_remote_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED ACK of size " << packet->GetSize () << " bytes from " <<
+       Inet6SocketAddress::ConvertFrom (m_remote_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_remote_address).GetPort ());
   }
 
 }
@@ -68,11 +68,27 @@ public:
   */
   void HandleACK (Ptr<Socket> socket);
 
+  /**
+  * \brief Handle a received packet from a physical layer node
+  */
+  void HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
+
+  /**
+  * \brief Handle a received acknowledgement from a compute node
+  */
+  void HandleACKPacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
+
 
 private:
   virtual void StartApplication (void);
   virtual void StopApplication (void);
 
+  /**
+  * \brief Set the callbacks receiving the packets of a socket: direct delivery for UDP sockets, read otherwise
+  */
+  void SetRecvCallbacks (Ptr<Socket> socket, Callback<void, Ptr<Socket> > handleRead,
+                         Callback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> handlePacket);
+
   void ScheduleAggPackets ();
   void SendAggPacket ();
 
@@ -122,8 +122,23 @@ iCenSProducer::StartApplication (void)
         m_socket6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), m_local_port));
   }
 
-  m_socket->SetRecvCallback (MakeCallback (&iCenSProducer::HandleRead, this));
-  m_socket6->SetRecvCallback (MakeCallback (&iCenSProducer::HandleRead, this));
+  SetRecvCallbacks (m_socket);
+  SetRecvCallbacks (m_socket6);
+}
+
+void
+iCenSProducer::SetRecvCallbacks (Ptr<Socket> socket)
+{
+  //UDP sockets deliver the packets directly, without queueing them
+  Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (socket);
+  if (udpSocket)
+  {
+    udpSocket->SetRecvPktCallback (MakeCallback (&iCenSProducer::HandlePacket, this));
+  }
+  else
+  {
+    socket->SetRecvCallback (MakeCallback (&iCenSProducer::HandleRead, this));
+  }
 }
 
 void
@@ -213,56 +228,66 @@ iCenSProducer::HandleRead (Ptr<Socket> socket)
 {
 
   Ptr<Packet> packet;
+  Address from;
 
-  while ((packet = socket->RecvFrom (m_remote_address)))
+  while ((packet = socket->RecvFrom (from)))
   {
+    HandlePacket (socket, packet, from, Address ());
+  }
 
-    //Get the first interface IP attached to this node (this is where socket is bound, true nodes that have only 1 IP)
-    //Ptr<NetDevice> PtrNetDevice = PtrNode->GetDevice(0);
-    Ptr <Node> PtrNode = this->GetNode();
-    Ptr<Ipv4> ipv4 = PtrNode->GetObject<Ipv4> (); 
-    Ipv4InterfaceAddress iaddr = ipv4->GetAddress (1,0);  
-    m_local_ip = iaddr.GetLocal (); 
+}
 
-    if (InetSocketAddress::IsMatchingType (m_remote_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
-         InetSocketAddress::ConvertFrom (m_remote_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_remote_address).GetPort ());
-    }
-    else if (Inet6SocketAddress::IsMatchingType (m_remote_address))
-    {
-      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
-         Inet6SocketAddress::ConvertFrom (m_remote_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_remote_address).GetPort ());
-    }
+void
+iCenSProducer::HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to)
+{
+
+  m_remote_address = from;
+
+  //Get the first interface IP attached to this node (this is where socket is bound, true nodes that have only 1 IP)
+  //Ptr<NetDevice> PtrNetDevice = PtrNode->GetDevice(0);
+  Ptr <Node> PtrNode = this->GetNode();
+  Ptr<Ipv4> ipv4 = PtrNode->GetObject<Ipv4> (); 
+  Ipv4InterfaceAddress iaddr = ipv4->GetAddress (1,0);  
+  m_local_ip = iaddr.GetLocal (); 
+
+  if (InetSocketAddress::IsMatchingType (m_remote_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
+       InetSocketAddress::ConvertFrom (m_remote_address).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (m_remote_address).GetPort ());
+  }
+  else if (Inet6SocketAddress::IsMatchingType (m_remote_address))
+  {
+    NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED packet of size " << packet->GetSize () - 4 << " bytes from " <<
+       Inet6SocketAddress::ConvertFrom (m_remote_address).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (m_remote_address).GetPort ());
+  }
 
-    //packet->RemoveAllPacketTags ();
-    //packet->RemoveAllByteTags ();
-
-    //Get subscription value set in packet's payload
-    iCenSHeader packetHeader;
-    packet->RemoveHeader(packetHeader);
-    m_subscription = packetHeader.GetSubscription();
-    NS_LOG_INFO("SUBSCRIPTION value = " << m_subscription);
-    
-    //Send packet through the socket
-    if (m_subscription >= 100 ) {
+  //packet->RemoveAllPacketTags ();
+  //packet->RemoveAllByteTags ();
+
+  //Get subscription value set in packet's payload
+  iCenSHeader packetHeader;
+  packet->RemoveHeader(packetHeader);
+  m_subscription = packetHeader.GetSubscription();
+  NS_LOG_INFO("SUBSCRIPTION value = " << m_subscription);
+  
+  //Send packet through the socket
+  if (m_subscription >= 100 ) {
 	//1-byte acknowledgement, for packets with sequence numbers (m_subscription >=100)
 	m_packet_size = 1;
-    	SendPacket(socket,m_remote_address);
-    }
-    else if (m_subscription == 1 || m_subscription == 2) {
+  	SendPacket(socket,m_remote_address);
+  }
+  else if (m_subscription == 1 || m_subscription == 2) {
 
-        //Soft or Hard subsription set
+      //Soft or Hard subsription set
 	if (m_frequency != 0) {
 		//Application instance is set for demand-response flow, send separate packet to each client that subscribes
 		ScheduleTransmit(socket, m_remote_address);
 	}
-    }
-
-    // Callback for received packet
-    m_receivedPacket (GetNode()->GetId(), packet, m_remote_address, m_local_port, m_packet_size, m_subscription, m_local_ip);
   }
 
+  // Callback for received packet
+  m_receivedPacket (GetNode()->GetId(), packet, m_remote_address, m_local_port, m_packet_size, m_subscription, m_local_ip);
+
 }
 
 }//namespace
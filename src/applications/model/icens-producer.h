@@ -66,10 +66,20 @@ public:
   */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+  * \brief Handle a received packet
+  */
+  void HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
+
 private:
   virtual void StartApplication (void);
   virtual void StopApplication (void);
 
+  /**
+  * \brief Set the callbacks receiving the packets of a socket
+  */
+  void SetRecvCallbacks (Ptr<Socket> socket);
+
   void ScheduleTransmit (Ptr<Socket> socket, Address client_address);
   void SendPacket (Ptr<Socket> socket, Address client_address);
 
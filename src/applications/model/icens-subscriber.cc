@@ -149,7 +149,16 @@ iCenSSubscriber::StartApplication (void)
         }
   }
 
-  m_socket->SetRecvCallback (MakeCallback (&iCenSSubscriber::HandleRead, this));
+  //UDP sockets deliver the replies directly, without queueing them
+  Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (m_socket);
+  if (udpSocket)
+  {
+      udpSocket->SetRecvPktCallback (MakeCallback (&iCenSSubscriber::HandlePacket, this));
+  }
+  else
+  {
+      m_socket->SetRecvCallback (MakeCallback (&iCenSSubscriber::HandleRead, this));
+  }
 
   ScheduleNextPacket();
 
@@ -253,20 +262,27 @@ iCenSSubscriber::HandleRead (Ptr<Socket> socket)
 
    while ((packet = socket->RecvFrom (from)))
    {
-       if (InetSocketAddress::IsMatchingType (from))
-       {
-          NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED REPLY packet of size " << packet->GetSize () << " bytes from - " <<
-             InetSocketAddress::ConvertFrom (from).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (from).GetPort ());
-       }
-       else if (Inet6SocketAddress::IsMatchingType (from))
-       {
-          NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED REPLY packet of size " << packet->GetSize () << " bytes from - " <<
-             Inet6SocketAddress::ConvertFrom (from).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (from).GetPort ());
-       }
-
-       // Callback for received packet
-       m_receivedPacket (GetNode()->GetId(), packet, from);
+       HandlePacket (socket, packet, from, Address ());
+   }
+}
+
+void
+iCenSSubscriber::HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to)
+{
+
+   if (InetSocketAddress::IsMatchingType (from))
+   {
+      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED REPLY packet of size " << packet->GetSize () << " bytes from - " <<
+         InetSocketAddress::ConvertFrom (from).GetIpv4 () << ":" << InetSocketAddress::ConvertFrom (from).GetPort ());
    }
+   else if (Inet6SocketAddress::IsMatchingType (from))
+   {
+      NS_LOG_INFO ("Node(" << GetNode()->GetId() << ") RECEIVED REPLY packet of size " << packet->GetSize () << " bytes from - " <<
+         Inet6SocketAddress::ConvertFrom (from).GetIpv6 () << ":" << Inet6SocketAddress::ConvertFrom (from).GetPort ());
+   }
+
+   // Callback for received packet
+   m_receivedPacket (GetNode()->GetId(), packet, from);
 }
 
 }//namespace
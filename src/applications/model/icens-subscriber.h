@@ -67,6 +67,11 @@ public:
   */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+  * \brief Handle a received packet
+  */
+  void HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
+
 private:
   virtual void StartApplication (void);
   virtual void StopApplication (void);
@@ -132,7 +132,16 @@ void PacketSink::StartApplication ()    // Called at time specified by Start
         }
     }
 
-  m_socket->SetRecvCallback (MakeCallback (&PacketSink::HandleRead, this));
+  Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (m_socket);
+  if (udpSocket)
+    {
+      // UDP datagrams are delivered directly, without the receive buffer
+      udpSocket->SetRecvPktCallback (MakeCallback (&PacketSink::HandlePacket, this));
+    }
+  else
+    {
+      m_socket->SetRecvCallback (MakeCallback (&PacketSink::HandleRead, this));
+    }
   m_socket->SetAcceptCallback (
     MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
     MakeCallback (&PacketSink::HandleAccept, this));
@@ -154,6 +163,11 @@ void PacketSink::StopApplication ()     // Called at time specified by Stop
     {
       m_socket->Close ();
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (m_socket);
+      if (udpSocket)
+        {
+          udpSocket->SetRecvPktCallback (MakeNullCallback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> ());
+        }
     }
 }
 
@@ -168,29 +182,35 @@ void PacketSink::HandleRead (Ptr<Socket> socket)
         { //EOF
           break;
         }
-      m_totalRx += packet->GetSize ();
-      if (InetSocketAddress::IsMatchingType (from))
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
-                       << "s packet sink received "
-                       <<  packet->GetSize () << " bytes from "
-                       << InetSocketAddress::ConvertFrom(from).GetIpv4 ()
-                       << " port " << InetSocketAddress::ConvertFrom (from).GetPort ()
-                       << " total Rx " << m_totalRx << " bytes");
-        }
-      else if (Inet6SocketAddress::IsMatchingType (from))
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
-                       << "s packet sink received "
-                       <<  packet->GetSize () << " bytes from "
-                       << Inet6SocketAddress::ConvertFrom(from).GetIpv6 ()
-                       << " port " << Inet6SocketAddress::ConvertFrom (from).GetPort ()
-                       << " total Rx " << m_totalRx << " bytes");
-        }
-      m_rxTrace (packet, from);
+      HandlePacket (socket, packet, from, Address ());
     }
 }
 
+void PacketSink::HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet,
+                               const Address &from, const Address &to)
+{
+  NS_LOG_FUNCTION (this << socket << packet << from << to);
+  m_totalRx += packet->GetSize ();
+  if (InetSocketAddress::IsMatchingType (from))
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                   << "s packet sink received "
+                   <<  packet->GetSize () << " bytes from "
+                   << InetSocketAddress::ConvertFrom(from).GetIpv4 ()
+                   << " port " << InetSocketAddress::ConvertFrom (from).GetPort ()
+                   << " total Rx " << m_totalRx << " bytes");
+    }
+  else if (Inet6SocketAddress::IsMatchingType (from))
+    {
+      NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                   << "s packet sink received "
+                   <<  packet->GetSize () << " bytes from "
+                   << Inet6SocketAddress::ConvertFrom(from).GetIpv6 ()
+                   << " port " << Inet6SocketAddress::ConvertFrom (from).GetPort ()
+                   << " total Rx " << m_totalRx << " bytes");
+    }
+  m_rxTrace (packet, from);
+}
 
 void PacketSink::HandlePeerClose (Ptr<Socket> socket)
 {
@@ -104,6 +104,14 @@ private:
    * \param socket the receiving socket
    */
   void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Handle a single packet, read from a socket or delivered directly by a UDP socket
+   * \param socket the receiving socket
+   * \param packet the received packet
+   * \param from the address the packet is from
+   * \param to the address the packet is destined to (empty when read from the socket)
+   */
+  void HandlePacket (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
   /**
    * \brief Handle an incoming connection
    * \param socket the incoming connection socket
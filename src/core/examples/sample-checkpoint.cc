@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/command-line.h"
+#include "ns3/checkpoint.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Example program branching a simulation into several scenarios
+ * after a common warm-up phase.
+ */
+
+using namespace ns3;
+
+/** Number of ticks seen by this process. */
+static uint32_t g_ticks = 0;
+
+/**
+ * Periodic event standing for the traffic of the warm-up phase.
+ */
+static void
+Tick (void)
+{
+  g_ticks++;
+  Simulator::Schedule (Seconds (1.0), &Tick);
+}
+
+/**
+ * Event standing for the failure injected in a branch.
+ *
+ * \param [in] branch The branch index.
+ */
+static void
+Fail (uint32_t branch)
+{
+  std::cout << "branch " << branch << ": failure at "
+            << Simulator::Now ().GetSeconds () << "s after "
+            << g_ticks << " ticks" << std::endl;
+}
+
+/**
+ * Set up the scenario of one branch.
+ *
+ * \param [in] branch The branch index.
+ */
+static void
+SetupBranch (uint32_t branch)
+{
+  Simulator::Schedule (Seconds (1.0 + branch), &Fail, branch);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t branches = 3;
+
+  CommandLine cmd;
+  cmd.AddValue ("branches", "Number of scenarios to branch", branches);
+  cmd.Parse (argc, argv);
+
+  Simulator::Schedule (Seconds (0.0), &Tick);
+  Checkpoint::Branch (Seconds (5.0), branches, MakeCallback (&SetupBranch));
+  Simulator::Stop (Seconds (10.0));
+
+  Simulator::Run ();
+
+  if (Checkpoint::GetBranch () == Checkpoint::NO_BRANCH)
+    {
+      std::vector<int> status = Checkpoint::GetBranchStatus ();
+      std::cout << "warm-up ran " << g_ticks << " ticks once for "
+                << status.size () << " branches" << std::endl;
+    }
+
+  Simulator::Destroy ();
+}
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+
+#include <iostream>
+#include <map>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::Checkpoint.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace {
+
+/** The branch executed by this process. */
+uint32_t g_branch = Checkpoint::NO_BRANCH;
+/** The exit status of the branches, collected by the parent. */
+std::vector<int> g_branchStatus;
+
+/**
+ * Wait for one branch to exit and record its status.
+ *
+ * \param [in,out] running The process ids of the running branches,
+ *                 mapped to their branch index.
+ */
+void
+WaitBranch (std::map<pid_t, uint32_t> &running)
+{
+  int status;
+  pid_t pid = waitpid (-1, &status, 0);
+  if (pid == -1)
+    {
+      NS_FATAL_ERROR ("Checkpoint: waitpid failed: " << std::strerror (errno));
+    }
+  std::map<pid_t, uint32_t>::iterator i = running.find (pid);
+  if (i == running.end ())
+    {
+      // not one of our branches
+      return;
+    }
+  if (WIFEXITED (status))
+    {
+      g_branchStatus[i->second] = WEXITSTATUS (status);
+    }
+  else
+    {
+      g_branchStatus[i->second] = -1;
+    }
+  NS_LOG_LOGIC ("branch " << i->second << " (pid " << pid << ") exited with status "
+                          << g_branchStatus[i->second]);
+  running.erase (i);
+}
+
+} // unnamed namespace
+
+void
+Checkpoint::Branch (Time const &at, uint32_t branches,
+                    Callback<void, uint32_t> setup, uint32_t maxParallel)
+{
+  NS_LOG_FUNCTION (at << branches << maxParallel);
+  NS_ASSERT (at >= Simulator::Now ());
+  NS_ASSERT (maxParallel > 0);
+  Simulator::Schedule (at - Simulator::Now (), &Checkpoint::DoBranch,
+                       branches, setup, maxParallel);
+}
+
+uint32_t
+Checkpoint::GetBranch (void)
+{
+  return g_branch;
+}
+
+std::vector<int>
+Checkpoint::GetBranchStatus (void)
+{
+  return g_branchStatus;
+}
+
+void
+Checkpoint::DoBranch (uint32_t branches, Callback<void, uint32_t> setup,
+                      uint32_t maxParallel)
+{
+  NS_LOG_FUNCTION (branches << maxParallel);
+  NS_ASSERT_MSG (g_branch == NO_BRANCH, "Checkpoint: nested branches are not supported");
+
+  // Do not let the children flush again what the parent buffered.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  g_branchStatus.assign (branches, -1);
+  std::map<pid_t, uint32_t> running;
+  for (uint32_t i = 0; i < branches; ++i)
+    {
+      while (running.size () >= maxParallel)
+        {
+          WaitBranch (running);
+        }
+      pid_t pid = fork ();
+      if (pid == -1)
+        {
+          NS_FATAL_ERROR ("Checkpoint: fork failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_branch = i;
+          g_branchStatus.clear ();
+          if (!setup.IsNull ())
+            {
+              setup (i);
+            }
+          return;
+        }
+      NS_LOG_LOGIC ("started branch " << i << " (pid " << pid << ")");
+      running[pid] = i;
+    }
+  while (!running.empty ())
+    {
+      WaitBranch (running);
+    }
+  Simulator::Stop ();
+}
+
+} // namespace ns3
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "nstime.h"
+#include "callback.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::Checkpoint.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Branch a running simulation into several scenarios which
+ * share a common warm-up phase.
+ *
+ * Checkpoint::Branch schedules a checkpoint at a given simulation
+ * time.  When the checkpoint is reached, the whole simulation state
+ * (pending events, nodes, queues, sockets, applications, random
+ * number generator streams) is captured by forking the simulation
+ * process once per branch.  Each child process invokes the setup
+ * callback with its branch index, which can schedule the link
+ * failures or injections specific to that scenario, and then resumes
+ * the simulation from the checkpoint.  The parent process waits for
+ * all the branches to complete and then stops its own simulation.
+ *
+ * Because the snapshot is the process image itself, every model is
+ * captured without any per-class serialization support, but the
+ * snapshot only lives as long as the branches are being created: it
+ * cannot be written to disk and reloaded by a later run.
+ *
+ * Output files should be opened, or their names chosen, after the
+ * checkpoint, using GetBranch () to tell the branches apart.  The
+ * standard output streams are flushed before forking so that output
+ * produced during the warm-up is not duplicated.
+ *
+ * This facility is only available on POSIX systems and must not be
+ * used with the distributed (MPI) simulator implementations.
+ *
+ * \code
+ *   static void
+ *   FailLink (uint32_t branch)
+ *   {
+ *     Simulator::Schedule (Seconds (1), &FailLinkN, branch);
+ *   }
+ *
+ *   Checkpoint::Branch (Seconds (5), 10, MakeCallback (&FailLink));
+ *   Simulator::Run ();
+ *   if (Checkpoint::GetBranch () == Checkpoint::NO_BRANCH)
+ *     {
+ *       // parent process: the branches have completed
+ *     }
+ * \endcode
+ */
+class Checkpoint
+{
+public:
+  /** Branch index reported outside of any branch. */
+  static const uint32_t NO_BRANCH = 0xffffffff;
+
+  /**
+   * Schedule a checkpoint from which the simulation branches.
+   *
+   * \param [in] at The simulation time of the checkpoint.
+   * \param [in] branches The number of branches to create.
+   * \param [in] setup The callback invoked in each branch, with the
+   *             branch index, before the simulation resumes.
+   * \param [in] maxParallel The maximum number of branches which run
+   *             concurrently.
+   */
+  static void Branch (Time const &at, uint32_t branches,
+                      Callback<void, uint32_t> setup,
+                      uint32_t maxParallel = 1);
+
+  /**
+   * \returns the index of the branch executed by this process, or
+   * NO_BRANCH before the checkpoint and in the parent process.
+   */
+  static uint32_t GetBranch (void);
+
+  /**
+   * \returns the exit status of each branch, indexed by branch, as
+   * collected by the parent process once the branches have completed.
+   */
+  static std::vector<int> GetBranchStatus (void);
+
+private:
+  /**
+   * Fork the branches; invoked at the checkpoint time.
+   *
+   * \param [in] branches The number of branches to create.
+   * \param [in] setup The callback invoked in each branch.
+   * \param [in] maxParallel The maximum number of concurrent branches.
+   */
+  static void DoBranch (uint32_t branches, Callback<void, uint32_t> setup,
+                        uint32_t maxParallel);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
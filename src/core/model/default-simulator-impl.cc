@@ -22,13 +22,17 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,6 +57,18 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EnableProfiling",
+                   "Measure the wall clock time spent in each event and "
+                   "attribute it to the event type and context.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfileFile",
+                   "Prefix of the files the event profile is written to "
+                   "when the simulator is destroyed, no files if empty.",
+                   StringValue ("simulator-profile"),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -73,11 +89,14 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profile = false;
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -108,6 +127,26 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  WriteProfile ();
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_profiler == 0)
+    {
+      return;
+    }
+  if (!m_profileFile.empty ())
+    {
+      std::ofstream flat ((m_profileFile + ".txt").c_str ());
+      m_profiler->PrintFlat (flat);
+      std::ofstream folded ((m_profileFile + ".folded").c_str ());
+      m_profiler->PrintFolded (folded);
+    }
+  delete m_profiler;
+  m_profiler = 0;
 }
 
 void
@@ -146,7 +185,16 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->StartEvent ();
+      next.impl->Invoke ();
+      m_profiler->EndEvent (m_currentContext, next.impl);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -197,16 +245,36 @@ DefaultSimulatorImpl::Run (void)
   ProcessEventsWithContext ();
   m_stop = false;
 
+  if (GetProfiler () != 0)
+    {
+      m_profiler->Start ();
+    }
+
   while (!m_events->IsEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
+  if (m_profiler != 0)
+    {
+      m_profiler->Stop ();
+    }
+
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
   NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
 }
 
+EventProfiler *
+DefaultSimulatorImpl::GetProfiler (void)
+{
+  if (m_profile && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
+  return m_profiler;
+}
+
 void 
 DefaultSimulatorImpl::Stop (void)
 {
@@ -30,6 +30,7 @@
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -39,10 +40,19 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the EnableProfiling attribute is set, the time spent in each
+ * event is measured and attributed to the event type and context
+ * (see EventProfiler).  The profile is written by Destroy() to
+ * ProfileFile.txt (flat profile) and ProfileFile.folded (folded stacks
+ * for flamegraph.pl), unless ProfileFile is empty; it can also be read
+ * from GetProfiler() until then.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -78,6 +88,12 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \returns the event profiler, or 0 if the EnableProfiling attribute
+   * is not set.  The profiler lives until Destroy().
+   */
+  EventProfiler *GetProfiler (void);
+
 private:
   virtual void DoDispose (void);
 
@@ -85,6 +101,8 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /** Write the event profile collected during the simulation, if any. */
+  void WriteProfile (void);
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -132,6 +150,13 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Flag \c true if event execution times should be profiled. */
+  bool m_profile;
+  /** Prefix of the files the event profile is written to. */
+  std::string m_profileFile;
+  /** The event profiler, allocated by GetProfiler() when profiling is enabled. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
@@ -0,0 +1,397 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "log.h"
+#include "assert.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cxxabi.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * Implementation of class ns3::EventProfiler.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/** One line of the flat profile. */
+struct ProfileLine
+{
+  ProfileLine () : count (0), ticks (0) {}
+  std::string name;  //!< Event type or context name.
+  uint64_t count;    //!< Number of events.
+  uint64_t ticks;    //!< Total ticks.
+};
+
+/**
+ * Order profile lines by decreasing time.
+ * \param [in] a The first line.
+ * \param [in] b The second line.
+ * \returns \c true if \p a should be printed before \p b.
+ */
+bool
+CompareByTicks (const ProfileLine &a, const ProfileLine &b)
+{
+  return a.ticks > b.ticks;
+}
+
+} // unnamed namespace
+
+EventProfiler::Counter::Counter ()
+  : count (0),
+    ticks (0)
+{
+}
+
+EventProfiler::EventProfiler ()
+  : m_lastType (0),
+    m_lastIndex (0),
+    m_inEvent (false),
+    m_eventStart (0),
+    m_scope (0),
+    m_inScope (false),
+    m_scopeStart (0),
+    m_scopeTicks (0),
+    m_startTicks (0),
+    m_elapsedTicks (0),
+    m_elapsedMs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventProfiler::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_clock.Start ();
+  m_startTicks = ReadCounter ();
+}
+
+void
+EventProfiler::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_elapsedTicks += ReadCounter () - m_startTicks;
+  m_elapsedMs += m_clock.End ();
+}
+
+uint32_t
+EventProfiler::GetTypeIndex (const std::type_info *type)
+{
+  std::map<const std::type_info *, uint32_t>::const_iterator i = m_typeIndex.find (type);
+  if (i != m_typeIndex.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = m_types.size ();
+  m_typeIndex[type] = index;
+  m_types.push_back (type);
+  return index;
+}
+
+void
+EventProfiler::Record (uint32_t context, const EventImpl *event, uint64_t ticks)
+{
+  const std::type_info *type = &typeid (*event);
+  if (type != m_lastType)
+    {
+      m_lastIndex = GetTypeIndex (type);
+      m_lastType = type;
+    }
+  // 0xffffffff (no context) wraps around to index 0.
+  uint32_t slot = context + 1;
+  if (slot >= m_contexts.size ())
+    {
+      m_contexts.resize (slot + 1);
+    }
+  TypeCounters &counters = m_contexts[slot];
+  if (m_lastIndex >= counters.size ())
+    {
+      counters.resize (m_types.size ());
+    }
+  Counter &counter = counters[m_lastIndex];
+  counter.count++;
+  counter.ticks += ticks;
+}
+
+void
+EventProfiler::StartEvent (void)
+{
+  m_inEvent = true;
+  m_inScope = false;
+  m_scopeTicks = 0;
+  m_eventStart = ReadCounter ();
+}
+
+void
+EventProfiler::EndEvent (uint32_t context, const EventImpl *event)
+{
+  uint64_t now = ReadCounter ();
+  if (m_inScope)
+    {
+      m_scopes[m_scope].ticks += now - m_scopeStart;
+      m_scopeTicks += now - m_scopeStart;
+    }
+  m_inEvent = false;
+  Record (context, event, now - m_eventStart - m_scopeTicks);
+}
+
+uint32_t
+EventProfiler::GetScope (const std::string &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  std::map<std::string, uint32_t>::const_iterator i = m_scopeIndex.find (name);
+  if (i != m_scopeIndex.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = m_scopeNames.size ();
+  m_scopeIndex[name] = index;
+  m_scopeNames.push_back (name);
+  m_scopes.push_back (Counter ());
+  return index;
+}
+
+void
+EventProfiler::EnterScope (uint32_t scope)
+{
+  NS_ASSERT (scope < m_scopes.size ());
+  if (!m_inEvent)
+    {
+      return;
+    }
+  uint64_t now = ReadCounter ();
+  if (m_inScope)
+    {
+      m_scopes[m_scope].ticks += now - m_scopeStart;
+      m_scopeTicks += now - m_scopeStart;
+    }
+  m_scope = scope;
+  m_inScope = true;
+  m_scopeStart = now;
+  m_scopes[scope].count++;
+}
+
+double
+EventProfiler::TicksToNs (uint64_t ticks) const
+{
+#ifdef NS3_EVENT_PROFILER_TSC
+  if (m_elapsedTicks == 0 || m_elapsedMs <= 0)
+    {
+      return static_cast<double> (ticks);
+    }
+  return static_cast<double> (ticks) * m_elapsedMs * 1e6 / m_elapsedTicks;
+#else
+  return static_cast<double> (ticks);
+#endif
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t index) const
+{
+  if (index == 0)
+    {
+      return "no-context";
+    }
+  std::ostringstream oss;
+  oss << "context-" << index - 1;
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetEventTypeName (const std::type_info &type)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (type.name (), NULL, NULL, &status);
+  std::string name = (status == 0) ? demangled : type.name ();
+  std::free (demangled);
+
+  // The events created by MakeEvent are local classes of one of the
+  // MakeEvent functions: report the type of its first parameter, which
+  // is the type of the scheduled function or method.
+  const std::string prefix = "ns3::MakeEvent";
+  if (name.compare (0, prefix.size (), prefix) != 0)
+    {
+      return name;
+    }
+  std::string::size_type i = prefix.size ();
+  std::string::size_type first = std::string::npos;
+  int depth = 0;
+  for (; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (depth == 0 && c == '(')
+        {
+          first = i + 1;
+          depth++;
+        }
+      else if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')' || c == ',')
+        {
+          if (depth == 1 && first != std::string::npos)
+            {
+              return name.substr (first, i - first);
+            }
+          if (c != ',')
+            {
+              depth--;
+            }
+        }
+    }
+  return name;
+}
+
+void
+EventProfiler::PrintFlat (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  // Several event implementation types may share the same name, for
+  // example when the same method is scheduled on different object
+  // pointer types: merge them.
+  std::map<std::string, ProfileLine> byName;
+  std::vector<ProfileLine> contexts;
+  uint64_t totalTicks = 0;
+  uint64_t totalCount = 0;
+  for (uint32_t c = 0; c < m_contexts.size (); ++c)
+    {
+      ProfileLine line;
+      line.name = GetContextName (c);
+      for (uint32_t t = 0; t < m_contexts[c].size (); ++t)
+        {
+          const Counter &counter = m_contexts[c][t];
+          if (counter.count == 0)
+            {
+              continue;
+            }
+          std::string name = GetEventTypeName (*m_types[t]);
+          ProfileLine &type = byName[name];
+          type.name = name;
+          type.count += counter.count;
+          type.ticks += counter.ticks;
+          line.count += counter.count;
+          line.ticks += counter.ticks;
+        }
+      if (line.count != 0)
+        {
+          contexts.push_back (line);
+        }
+      totalCount += line.count;
+      totalTicks += line.ticks;
+    }
+  std::vector<ProfileLine> types;
+  for (std::map<std::string, ProfileLine>::const_iterator i = byName.begin (); i != byName.end (); ++i)
+    {
+      types.push_back (i->second);
+    }
+  std::vector<ProfileLine> scopes;
+  for (uint32_t i = 0; i < m_scopes.size (); ++i)
+    {
+      if (m_scopes[i].count == 0)
+        {
+          continue;
+        }
+      ProfileLine line;
+      line.name = m_scopeNames[i];
+      line.count = m_scopes[i].count;
+      line.ticks = m_scopes[i].ticks;
+      scopes.push_back (line);
+      totalTicks += line.ticks;
+    }
+  std::sort (types.begin (), types.end (), CompareByTicks);
+  std::sort (contexts.begin (), contexts.end (), CompareByTicks);
+  std::sort (scopes.begin (), scopes.end (), CompareByTicks);
+
+  os << "# events: " << totalCount
+     << " event time (ms): " << TicksToNs (totalTicks) / 1e6
+     << " wall time (ms): " << m_elapsedMs << std::endl;
+#ifdef NS3_EVENT_PROFILER_TSC
+  if (m_elapsedTicks == 0 || m_elapsedMs <= 0)
+    {
+      os << "# run too short to calibrate the counter: times are in ticks, not ns" << std::endl;
+    }
+#endif
+  const std::vector<ProfileLine> *sections[3] = { &types, &contexts, &scopes };
+  const char *titles[3] = { "event type", "context", "scope" };
+  for (uint32_t s = 0; s < 3; ++s)
+    {
+      if (s == 2 && scopes.empty ())
+        {
+          continue;
+        }
+      os << std::endl
+         << std::setw (8) << "%time" << " "
+         << std::setw (14) << "total(ms)" << " "
+         << std::setw (12) << "calls" << " "
+         << std::setw (12) << "ns/call" << "  "
+         << titles[s] << std::endl;
+      for (std::vector<ProfileLine>::const_iterator i = sections[s]->begin (); i != sections[s]->end (); ++i)
+        {
+          double ns = TicksToNs (i->ticks);
+          os << std::fixed
+             << std::setw (8) << std::setprecision (2)
+             << (totalTicks ? 100.0 * i->ticks / totalTicks : 0.0) << " "
+             << std::setw (14) << std::setprecision (3) << ns / 1e6 << " "
+             << std::setw (12) << i->count << " "
+             << std::setw (12) << std::setprecision (1) << (i->count ? ns / i->count : 0.0) << "  "
+             << i->name << std::endl;
+        }
+    }
+}
+
+void
+EventProfiler::PrintFolded (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t c = 0; c < m_contexts.size (); ++c)
+    {
+      std::map<std::string, uint64_t> byName;
+      for (uint32_t t = 0; t < m_contexts[c].size (); ++t)
+        {
+          const Counter &counter = m_contexts[c][t];
+          if (counter.count != 0)
+            {
+              byName[GetEventTypeName (*m_types[t])] += counter.ticks;
+            }
+        }
+      for (std::map<std::string, uint64_t>::const_iterator i = byName.begin (); i != byName.end (); ++i)
+        {
+          os << GetContextName (c) << ";" << i->first << " "
+             << static_cast<uint64_t> (TicksToNs (i->second)) << std::endl;
+        }
+    }
+  for (uint32_t i = 0; i < m_scopes.size (); ++i)
+    {
+      if (m_scopes[i].count != 0)
+        {
+          os << "scope;" << m_scopeNames[i] << " "
+             << static_cast<uint64_t> (TicksToNs (m_scopes[i].ticks)) << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+#include "system-wall-clock-ms.h"
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <typeinfo>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#define NS3_EVENT_PROFILER_TSC 1
+#else
+#include <time.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * Declaration of class ns3::EventProfiler.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Attribute the time spent in EventImpl::Invoke to event
+ * types and execution contexts.
+ *
+ * The simulator implementation samples ReadCounter() around every
+ * event it invokes and hands the difference to Record().  Events are
+ * classified by the dynamic type of their EventImpl, which for events
+ * created by MakeEvent() identifies the scheduled function or method,
+ * and by their context, which is the node id for events scheduled
+ * with Simulator::ScheduleWithContext().
+ *
+ * The counters are plain integers: they are only updated from the
+ * thread which runs the simulation events, so no locking is needed.
+ *
+ * The code run by an event can charge the rest of the event to a
+ * named scope with EnterScope(), for example when a packet crosses
+ * from one protocol layer to the next: the time of the event is then
+ * split between its type, up to the first scope, and the scopes it
+ * went through.
+ *
+ * The profile can be written either as a flat, human-readable table
+ * or as folded stacks ("context;event-type ticks") suitable for
+ * flamegraph.pl.
+ */
+class EventProfiler
+{
+public:
+  EventProfiler ();
+
+  /**
+   * \returns the current value of the cycle counter.
+   *
+   * This is the time stamp counter on x86 processors and a monotonic
+   * nanosecond clock elsewhere.
+   */
+  static inline uint64_t ReadCounter (void);
+
+  /** Start measuring the wall clock time used to calibrate the counter. */
+  void Start (void);
+  /** Stop measuring the wall clock time used to calibrate the counter. */
+  void Stop (void);
+
+  /**
+   * Account for one invoked event.
+   *
+   * \param [in] context The context the event was executed in.
+   * \param [in] event The event which was invoked.
+   * \param [in] ticks The number of counter ticks spent in EventImpl::Invoke.
+   */
+  void Record (uint32_t context, const EventImpl *event, uint64_t ticks);
+
+  /** Mark the start of the event about to be invoked. */
+  void StartEvent (void);
+  /**
+   * Account for the event started by StartEvent(): the ticks which
+   * were not charged to a scope go to the event type.
+   *
+   * \param [in] context The context the event was executed in.
+   * \param [in] event The event which was invoked.
+   */
+  void EndEvent (uint32_t context, const EventImpl *event);
+
+  /**
+   * \returns the index of a scope, to be passed to EnterScope().
+   * \param [in] name The name of the scope.
+   */
+  uint32_t GetScope (const std::string &name);
+  /**
+   * Charge the rest of the running event to a scope.
+   *
+   * The ticks elapsed since the previous call go to the previous
+   * scope, those elapsed since the start of the event to the event
+   * type for the first call.  Outside of an event, this does nothing.
+   *
+   * \param [in] scope The index of the scope, from GetScope().
+   */
+  void EnterScope (uint32_t scope);
+
+  /**
+   * Write the flat profile: one line per event type name, then one
+   * line per context and one line per scope, sorted by decreasing
+   * time.
+   *
+   * \param [in] os The output stream.
+   */
+  void PrintFlat (std::ostream &os) const;
+  /**
+   * Write the profile in the folded-stack format used by flamegraph.pl.
+   * The scopes are written under a "scope" root.  Sample counts are expressed in nanoseconds when the counter could
+   * be calibrated and in raw ticks otherwise.
+   *
+   * \param [in] os The output stream.
+   */
+  void PrintFolded (std::ostream &os) const;
+
+  /**
+   * \returns the short name reported for an event implementation type.
+   *
+   * The local classes created by MakeEvent() are reported as the
+   * type of the function or method they invoke.
+   *
+   * \param [in] type The dynamic type of an EventImpl.
+   */
+  static std::string GetEventTypeName (const std::type_info &type);
+
+private:
+  /** Accumulated cost of a set of events. */
+  struct Counter
+  {
+    Counter ();
+    uint64_t count;  /**< Number of invoked events. */
+    uint64_t ticks;  /**< Total counter ticks spent in these events. */
+  };
+  /** Counters of one context, indexed by event type index. */
+  typedef std::vector<Counter> TypeCounters;
+
+  /**
+   * \returns the index of an event type, allocating a new one if needed.
+   * \param [in] type The dynamic type of an EventImpl.
+   */
+  uint32_t GetTypeIndex (const std::type_info *type);
+  /**
+   * \returns the duration in nanoseconds of a number of ticks, or the
+   * number of ticks itself if the counter could not be calibrated.
+   * \param [in] ticks The number of ticks.
+   */
+  double TicksToNs (uint64_t ticks) const;
+  /**
+   * \returns the printable name of a context.
+   * \param [in] index The index of the context in m_contexts.
+   */
+  std::string GetContextName (uint32_t index) const;
+
+  /** Map from event type to index in a TypeCounters vector. */
+  std::map<const std::type_info *, uint32_t> m_typeIndex;
+  /** The event types, by index. */
+  std::vector<const std::type_info *> m_types;
+  /** The most recently seen event type. */
+  const std::type_info *m_lastType;
+  /** The index of m_lastType. */
+  uint32_t m_lastIndex;
+  /**
+   * The counters, indexed by context plus one so that the "no context"
+   * value 0xffffffff is stored at index 0.
+   */
+  std::vector<TypeCounters> m_contexts;
+
+  /** Map from scope name to index in m_scopes. */
+  std::map<std::string, uint32_t> m_scopeIndex;
+  /** The scope names, by index. */
+  std::vector<std::string> m_scopeNames;
+  /** The counters of the scopes, by index. */
+  std::vector<Counter> m_scopes;
+  /** Whether an event is running. */
+  bool m_inEvent;
+  /** Counter value at the start of the running event. */
+  uint64_t m_eventStart;
+  /** Index of the current scope of the running event, if m_inScope. */
+  uint32_t m_scope;
+  /** Whether the running event entered a scope. */
+  bool m_inScope;
+  /** Counter value when the running event entered the current scope. */
+  uint64_t m_scopeStart;
+  /** Ticks of the running event charged to its scopes. */
+  uint64_t m_scopeTicks;
+
+  /** Wall clock used to calibrate the counter. */
+  SystemWallClockMs m_clock;
+  /** Counter value at Start(). */
+  uint64_t m_startTicks;
+  /** Counter ticks elapsed between Start() and Stop(). */
+  uint64_t m_elapsedTicks;
+  /** Milliseconds elapsed between Start() and Stop(). */
+  int64_t m_elapsedMs;
+};
+
+uint64_t
+EventProfiler::ReadCounter (void)
+{
+#ifdef NS3_EVENT_PROFILER_TSC
+  return __rdtsc ();
+#else
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t> (ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
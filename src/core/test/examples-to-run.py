@@ -11,6 +11,7 @@ cpp_examples = [
     ("main-attribute-value", "True", "True"),
     ("main-callback", "True", "True"),
     ("sample-simulator", "True", "True"),
+    ("sample-checkpoint", "True", "False"),
     ("main-ptr", "True", "True"),
     ("main-random-variable", "True", "False"),
     ("sample-random-variable", "True", "True"),
@@ -23,6 +23,10 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
+
+#include <sstream>
 
 using namespace ns3;
 
@@ -459,6 +463,81 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+static void profileFoo (int) {}
+
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+private:
+  virtual void DoRun (void);
+  void Bar (void) {}
+};
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check that the event profiler attributes time to event types and contexts")
+{
+}
+
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  EventImpl *foo = MakeEvent (&profileFoo, 0);
+  EventImpl *bar = MakeEvent (&SimulatorProfileTestCase::Bar, this);
+
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetEventTypeName (typeid (*foo)), "void (*)(int)",
+                         "Function events are named after the function type");
+  NS_TEST_EXPECT_MSG_EQ (EventProfiler::GetEventTypeName (typeid (*bar)), "void (SimulatorProfileTestCase::*)()",
+                         "Method events are named after the method type");
+
+  EventProfiler profiler;
+  profiler.Record (3, foo, 10);
+  profiler.Record (3, foo, 20);
+  profiler.Record (3, bar, 5);
+  profiler.Record (0xffffffff, bar, 7);
+
+  std::ostringstream folded;
+  profiler.PrintFolded (folded);
+  NS_TEST_EXPECT_MSG_EQ (folded.str (),
+                         "no-context;void (SimulatorProfileTestCase::*)() 7\n"
+                         "context-3;void (*)(int) 30\n"
+                         "context-3;void (SimulatorProfileTestCase::*)() 5\n",
+                         "Unexpected folded stacks");
+
+  std::ostringstream flat;
+  profiler.PrintFlat (flat);
+  NS_TEST_EXPECT_MSG_EQ (flat.str ().find ("# events: 4"), 0, "Unexpected flat profile header");
+  NS_TEST_EXPECT_MSG_EQ (flat.str ().find ("scope"), std::string::npos, "No scope was entered");
+
+  uint32_t scope = profiler.GetScope ("layer");
+  NS_TEST_EXPECT_MSG_EQ (profiler.GetScope ("layer"), scope, "Scopes are looked up by name");
+  // Outside of an event, entering a scope does nothing.
+  profiler.EnterScope (scope);
+  profiler.StartEvent ();
+  profiler.EnterScope (scope);
+  profiler.EndEvent (3, foo);
+
+  std::ostringstream scoped;
+  profiler.PrintFlat (scoped);
+  NS_TEST_EXPECT_MSG_EQ (scoped.str ().find ("# events: 5"), 0, "The scoped event is counted once");
+  std::istringstream lines (scoped.str ());
+  std::string line;
+  uint64_t calls = 0;
+  while (std::getline (lines, line))
+    {
+      if (line.size () > 7 && line.compare (line.size () - 7, 7, "  layer") == 0)
+        {
+          double percent, ms;
+          std::istringstream fields (line);
+          fields >> percent >> ms >> calls;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (calls, 1, "The scope was entered once during an event");
+
+  foo->Unref ();
+  bar->Unref ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +554,6 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -0,0 +1,354 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/boolean.h"
+#include "ipv4-flow-path-routing-helper.h"
+
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4FlowPathRoutingHelper");
+
+Ipv4FlowPathRoutingHelper::Ipv4FlowPathRoutingHelper ()
+{
+}
+
+Ipv4FlowPathRoutingHelper::Ipv4FlowPathRoutingHelper (const Ipv4FlowPathRoutingHelper &o)
+  : m_flows (o.m_flows),
+    m_failures (o.m_failures)
+{
+}
+
+Ipv4FlowPathRoutingHelper*
+Ipv4FlowPathRoutingHelper::Copy (void) const
+{
+  return new Ipv4FlowPathRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+Ipv4FlowPathRoutingHelper::Create (Ptr<Node> node) const
+{
+  return CreateObject<Ipv4FlowPathRouting> ();
+}
+
+void
+Ipv4FlowPathRoutingHelper::AddFlow (Ptr<Node> source, Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << source << destination);
+  Flow flow;
+  flow.m_source = source;
+  flow.m_destination = destination;
+  m_flows.push_back (flow);
+}
+
+void
+Ipv4FlowPathRoutingHelper::AddFlow (Ptr<Node> source, Ipv4Address destination, const NodeContainer &path)
+{
+  NS_LOG_FUNCTION (this << source << destination);
+  NS_ABORT_MSG_IF (path.GetN () < 2 || path.Get (0) != source,
+                   "The path must start at the source node, and have at least two nodes");
+  Flow flow;
+  flow.m_source = source;
+  flow.m_destination = destination;
+  for (NodeContainer::Iterator i = path.Begin (); i != path.End (); ++i)
+    {
+      flow.m_path.push_back ((*i)->GetId ());
+    }
+  m_flows.push_back (flow);
+}
+
+void
+Ipv4FlowPathRoutingHelper::AddLinkFailure (Ptr<Node> node, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << node << interface);
+  m_failures.insert (std::make_pair (node->GetId (), interface));
+}
+
+Ptr<Ipv4FlowPathRouting>
+Ipv4FlowPathRoutingHelper::GetFlowPathRouting (Ptr<Node> node)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetRoutingProtocol () == 0)
+    {
+      return 0;
+    }
+  return GetRouting<Ipv4FlowPathRouting> (ipv4->GetRoutingProtocol ());
+}
+
+void
+Ipv4FlowPathRoutingHelper::BuildTopology (Topology &topology)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  topology.assign (NodeList::GetNNodes (), std::vector<Link> ());
+  for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (n)->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          continue;
+        }
+      for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+        {
+          Ptr<NetDevice> device = ipv4->GetNetDevice (i);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0 || !ipv4->IsUp (i))
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              Ptr<NetDevice> neighborDevice = channel->GetDevice (j);
+              if (neighborDevice == device)
+                {
+                  continue;
+                }
+              Ptr<Ipv4> neighborIpv4 = neighborDevice->GetNode ()->GetObject<Ipv4> ();
+              if (neighborIpv4 == 0)
+                {
+                  continue;
+                }
+              int32_t neighborInterface = neighborIpv4->GetInterfaceForDevice (neighborDevice);
+              if (neighborInterface == -1 || !neighborIpv4->IsUp (neighborInterface)
+                  || neighborIpv4->GetNAddresses (neighborInterface) == 0)
+                {
+                  continue;
+                }
+              Link link;
+              link.m_interface = i;
+              link.m_neighbor = neighborDevice->GetNode ()->GetId ();
+              link.m_neighborInterface = neighborInterface;
+              link.m_gateway = neighborIpv4->GetAddress (neighborInterface, 0).GetLocal ();
+              link.m_metric = ipv4->GetMetric (i);
+              topology[n].push_back (link);
+            }
+        }
+    }
+}
+
+bool
+Ipv4FlowPathRoutingHelper::UsesInterface (uint32_t node, const Link &link, const InterfaceSet &interfaces)
+{
+  return interfaces.find (std::make_pair (node, link.m_interface)) != interfaces.end ()
+         || interfaces.find (std::make_pair (link.m_neighbor, link.m_neighborInterface)) != interfaces.end ();
+}
+
+std::vector<Ipv4FlowPathRouting::Hop>
+Ipv4FlowPathRoutingHelper::ComputeShortestPath (const Topology &topology,
+                                                uint32_t source, uint32_t destination,
+                                                const InterfaceSet &excluded)
+{
+  NS_LOG_FUNCTION (source << destination);
+  // Dijkstra on the interface metrics
+  const uint64_t infinity = std::numeric_limits<uint64_t>::max ();
+  std::vector<uint64_t> distance (topology.size (), infinity);
+  // the node and the link the node is reached from
+  std::vector<std::pair<uint32_t, const Link *> > parent (topology.size (), std::make_pair (0, (const Link *) 0));
+  typedef std::pair<uint64_t, uint32_t> Candidate;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > candidates;
+  distance[source] = 0;
+  candidates.push (Candidate (0, source));
+  while (!candidates.empty ())
+    {
+      Candidate candidate = candidates.top ();
+      candidates.pop ();
+      uint32_t node = candidate.second;
+      if (candidate.first > distance[node])
+        {
+          continue;
+        }
+      if (node == destination)
+        {
+          break;
+        }
+      for (std::vector<Link>::const_iterator link = topology[node].begin (); link != topology[node].end (); ++link)
+        {
+          if (UsesInterface (node, *link, excluded))
+            {
+              continue;
+            }
+          uint64_t d = distance[node] + link->m_metric;
+          if (d < distance[link->m_neighbor])
+            {
+              distance[link->m_neighbor] = d;
+              parent[link->m_neighbor] = std::make_pair (node, &(*link));
+              candidates.push (Candidate (d, link->m_neighbor));
+            }
+        }
+    }
+
+  std::vector<Ipv4FlowPathRouting::Hop> hops;
+  if (distance[destination] == infinity)
+    {
+      return hops;
+    }
+  for (uint32_t node = destination; node != source; node = parent[node].first)
+    {
+      const Link *link = parent[node].second;
+      Ipv4FlowPathRouting::Hop hop;
+      hop.m_node = parent[node].first;
+      hop.m_interface = link->m_interface;
+      hop.m_nextNode = node;
+      hop.m_nextInterface = link->m_neighborInterface;
+      hop.m_gateway = link->m_gateway;
+      hops.insert (hops.begin (), hop);
+    }
+  return hops;
+}
+
+std::vector<Ipv4FlowPathRouting::Hop>
+Ipv4FlowPathRoutingHelper::ComputeNodePath (const Topology &topology,
+                                            const std::vector<uint32_t> &nodes)
+{
+  std::vector<Ipv4FlowPathRouting::Hop> hops;
+  for (uint32_t i = 0; i + 1 < nodes.size (); i++)
+    {
+      const Link *link = 0;
+      for (std::vector<Link>::const_iterator it = topology[nodes[i]].begin (); it != topology[nodes[i]].end (); ++it)
+        {
+          if (it->m_neighbor == nodes[i + 1])
+            {
+              link = &(*it);
+              break;
+            }
+        }
+      NS_ABORT_MSG_IF (link == 0, "Nodes " << nodes[i] << " and " << nodes[i + 1] << " are not neighbors");
+      Ipv4FlowPathRouting::Hop hop;
+      hop.m_node = nodes[i];
+      hop.m_interface = link->m_interface;
+      hop.m_nextNode = nodes[i + 1];
+      hop.m_nextInterface = link->m_neighborInterface;
+      hop.m_gateway = link->m_gateway;
+      hops.push_back (hop);
+    }
+  return hops;
+}
+
+void
+Ipv4FlowPathRoutingHelper::PopulateFlowPaths (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // A route cache is flushed by the changes of its own node only, a flow
+  // picks its path again on the changes of any node
+  for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+    {
+      Ptr<Node> node = NodeList::GetNode (n);
+      Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+      BooleanValue routeCache;
+      if (ipv4 != 0 && GetFlowPathRouting (node) != 0
+          && ipv4->GetAttributeFailSafe ("RouteCache", routeCache) && routeCache.Get ())
+        {
+          NS_LOG_WARN ("Disabling the route cache of node " << n << ", which runs Ipv4FlowPathRouting");
+          ipv4->SetAttribute ("RouteCache", BooleanValue (false));
+        }
+    }
+
+  Topology topology;
+  BuildTopology (topology);
+
+  // the first node owning an address wins
+  std::unordered_map<uint32_t, uint32_t> nodeByAddress;
+  for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (n)->GetObject<Ipv4> ();
+      for (uint32_t i = 0; ipv4 != 0 && i < ipv4->GetNInterfaces (); i++)
+        {
+          for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+            {
+              nodeByAddress.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal ().Get (), n));
+            }
+        }
+    }
+
+  for (std::vector<Flow>::const_iterator flow = m_flows.begin (); flow != m_flows.end (); ++flow)
+    {
+      Ptr<Ipv4FlowPathRouting> routing = GetFlowPathRouting (flow->m_source);
+      NS_ABORT_MSG_IF (routing == 0, "No Ipv4FlowPathRouting on node " << flow->m_source->GetId ());
+      std::unordered_map<uint32_t, uint32_t>::const_iterator destination = nodeByAddress.find (flow->m_destination.Get ());
+      NS_ABORT_MSG_IF (destination == nodeByAddress.end (), "No node owns " << flow->m_destination);
+      uint32_t source = flow->m_source->GetId ();
+      if (source == destination->second)
+        {
+          NS_LOG_WARN ("Flow from node " << source << " to itself");
+          continue;
+        }
+
+      std::vector<std::vector<Ipv4FlowPathRouting::Hop> > paths;
+      if (flow->m_path.empty ())
+        {
+          paths.push_back (ComputeShortestPath (topology, source, destination->second, InterfaceSet ()));
+        }
+      else
+        {
+          NS_ABORT_MSG_IF (flow->m_path.back () != destination->second,
+                           "The path must end at the node owning " << flow->m_destination);
+          paths.push_back (ComputeNodePath (topology, flow->m_path));
+        }
+      if (paths[0].empty ())
+        {
+          NS_LOG_WARN ("No path from node " << source << " to " << flow->m_destination);
+          continue;
+        }
+
+      // a failover path for each failing link of the path
+      std::set<std::vector<std::pair<uint32_t, uint32_t> > > keys;
+      for (std::vector<Ipv4FlowPathRouting::Hop>::const_iterator hop = paths[0].begin (); hop != paths[0].end (); ++hop)
+        {
+          std::pair<uint32_t, uint32_t> interfaces[2] = { std::make_pair (hop->m_node, hop->m_interface),
+                                                          std::make_pair (hop->m_nextNode, hop->m_nextInterface) };
+          for (uint32_t i = 0; i < 2; i++)
+            {
+              if (m_failures.find (interfaces[i]) == m_failures.end ())
+                {
+                  continue;
+                }
+              InterfaceSet excluded;
+              excluded.insert (interfaces[i]);
+              std::vector<Ipv4FlowPathRouting::Hop> failover = ComputeShortestPath (topology, source, destination->second, excluded);
+              std::vector<std::pair<uint32_t, uint32_t> > key;
+              for (std::vector<Ipv4FlowPathRouting::Hop>::const_iterator it = failover.begin (); it != failover.end (); ++it)
+                {
+                  key.push_back (std::make_pair (it->m_node, it->m_interface));
+                }
+              if (!failover.empty () && keys.insert (key).second)
+                {
+                  paths.push_back (failover);
+                }
+            }
+        }
+
+      std::vector<uint32_t> pathIndexes;
+      for (std::vector<std::vector<Ipv4FlowPathRouting::Hop> >::const_iterator path = paths.begin (); path != paths.end (); ++path)
+        {
+          pathIndexes.push_back (Ipv4FlowPathRouting::AddPath (flow->m_destination, *path));
+        }
+      NS_LOG_LOGIC ("Flow from node " << source << " to " << flow->m_destination << ": " << pathIndexes.size () << " paths");
+      routing->AddFlow (flow->m_destination, pathIndexes);
+    }
+}
+
+} // namespace ns3
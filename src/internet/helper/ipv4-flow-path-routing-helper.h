@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_FLOW_PATH_ROUTING_HELPER_H
+#define IPV4_FLOW_PATH_ROUTING_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-flow-path-routing.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that adds ns3::Ipv4FlowPathRouting objects, and
+ * computes the paths of the declared flows
+ *
+ * The flows are declared before the simulation starts, e.g., from the
+ * PMU to PDC and PMU to WAC flow sections of a scenario, and so are the
+ * links which may fail, e.g., from its link failure schedule.  Then
+ * PopulateFlowPaths computes the path of each flow, on the shortest
+ * path by interface metric or on the nodes given with the flow.  For
+ * each link of this path declared as failing, it also computes the
+ * shortest path avoiding that link.  This failover path is used while
+ * the link is down.
+ *
+ * The protocol is meant to be added to an Ipv4ListRouting with a higher
+ * priority than the static and global routing, which route the other
+ * packets:
+ *
+ * \code
+ *   Ipv4FlowPathRoutingHelper flowPaths;
+ *   Ipv4ListRoutingHelper list;
+ *   list.Add (Ipv4StaticRoutingHelper (), 0);
+ *   list.Add (flowPaths, 10);
+ *   list.Add (Ipv4GlobalRoutingHelper (), -10);
+ *   InternetStackHelper stack;
+ *   stack.SetRoutingHelper (list);
+ *   ...
+ *   flowPaths.AddFlow (pmu, pdcAddress);
+ *   flowPaths.AddLinkFailure (router, 2);
+ *   flowPaths.PopulateFlowPaths ();
+ * \endcode
+ */
+class Ipv4FlowPathRoutingHelper : public Ipv4RoutingHelper
+{
+public:
+  Ipv4FlowPathRoutingHelper ();
+
+  /**
+   * \brief Construct an Ipv4FlowPathRoutingHelper from another previously
+   * initialized instance (Copy Constructor).
+   * \param o object to copy
+   */
+  Ipv4FlowPathRoutingHelper (const Ipv4FlowPathRoutingHelper &o);
+
+  /**
+   * \returns pointer to clone of this Ipv4FlowPathRoutingHelper
+   *
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv4FlowPathRoutingHelper* Copy (void) const;
+
+  /**
+   * \param node the node on which the routing protocol will run
+   * \returns a newly-created routing protocol
+   *
+   * This method will be called by ns3::InternetStackHelper::Install
+   */
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \brief Declare a flow routed on the shortest path
+   * \param source the source node of the flow
+   * \param destination the destination address of the flow
+   */
+  void AddFlow (Ptr<Node> source, Ipv4Address destination);
+
+  /**
+   * \brief Declare a flow routed on given nodes
+   * \param source the source node of the flow
+   * \param destination the destination address of the flow
+   * \param path the nodes of the path, from the source node to the node
+   * owning the destination address
+   */
+  void AddFlow (Ptr<Node> source, Ipv4Address destination, const NodeContainer &path);
+
+  /**
+   * \brief Declare a link which may fail during the simulation
+   *
+   * The flows whose path goes through the interface get a failover path
+   * avoiding the link of the interface.
+   *
+   * \param node the node
+   * \param interface the interface of the node which may go down
+   */
+  void AddLinkFailure (Ptr<Node> node, uint32_t interface);
+
+  /**
+   * \brief Compute the paths of the declared flows, and install them
+   *
+   * Must be called once the addresses are assigned, and the protocol
+   * installed on the nodes.  The "RouteCache" attribute of
+   * Ipv4L3Protocol is turned off, with a warning, on the nodes running
+   * the protocol: the paths of the flows are chosen again when an
+   * interface of any node goes up or down, while the route cache of a
+   * node is only flushed by the changes of its own interfaces.
+   */
+  void PopulateFlowPaths (void) const;
+
+  /**
+   * \brief Get the Ipv4FlowPathRouting of a node
+   * \param node the node
+   * \returns the Ipv4FlowPathRouting of the node, or 0 if not found
+   */
+  static Ptr<Ipv4FlowPathRouting> GetFlowPathRouting (Ptr<Node> node);
+
+private:
+  /**
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return
+   */
+  Ipv4FlowPathRoutingHelper &operator = (const Ipv4FlowPathRoutingHelper &);
+
+  /// A link of the topology, from a node
+  struct Link
+  {
+    uint32_t m_interface;         //!< Interface of the node
+    uint32_t m_neighbor;          //!< Id of the neighbor
+    uint32_t m_neighborInterface; //!< Interface of the neighbor
+    Ipv4Address m_gateway;        //!< Address of the interface of the neighbor
+    uint16_t m_metric;            //!< Metric of the interface of the node
+  };
+
+  /// The links of each node, indexed by node id
+  typedef std::vector<std::vector<Link> > Topology;
+
+  /// A declared flow
+  struct Flow
+  {
+    Ptr<Node> m_source;             //!< Source node
+    Ipv4Address m_destination;      //!< Destination address
+    std::vector<uint32_t> m_path;   //!< Ids of the nodes of the path, empty for the shortest path
+  };
+
+  /// (node id, interface) pairs
+  typedef std::set<std::pair<uint32_t, uint32_t> > InterfaceSet;
+
+  /**
+   * \brief Build the topology of the nodes, from the interfaces which are up
+   * \param topology the topology to fill
+   */
+  static void BuildTopology (Topology &topology);
+
+  /**
+   * \brief Check whether a link uses one of some interfaces
+   * \param node the id of the node of the link
+   * \param link the link
+   * \param interfaces the interfaces
+   * \returns true if either end of the link is in interfaces
+   */
+  static bool UsesInterface (uint32_t node, const Link &link, const InterfaceSet &interfaces);
+
+  /**
+   * \brief Compute the shortest path between two nodes
+   * \param topology the topology
+   * \param source the id of the source node
+   * \param destination the id of the destination node
+   * \param excluded the interfaces whose links are not used
+   * \returns the hops of the path, empty if there is none
+   */
+  static std::vector<Ipv4FlowPathRouting::Hop> ComputeShortestPath (const Topology &topology,
+                                                                    uint32_t source, uint32_t destination,
+                                                                    const InterfaceSet &excluded);
+
+  /**
+   * \brief Compute the hops of a path given by its nodes
+   * \param topology the topology
+   * \param nodes the ids of the nodes of the path
+   * \returns the hops of the path
+   */
+  static std::vector<Ipv4FlowPathRouting::Hop> ComputeNodePath (const Topology &topology,
+                                                                const std::vector<uint32_t> &nodes);
+
+  std::vector<Flow> m_flows;  //!< Declared flows
+  InterfaceSet m_failures;    //!< Interfaces which may go down
+};
+
+} // namespace ns3
+
+#endif /* IPV4_FLOW_PATH_ROUTING_HELPER_H */
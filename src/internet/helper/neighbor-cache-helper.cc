@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "neighbor-cache-helper.h"
+
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+NeighborCacheHelper::NeighborCacheHelper ()
+{
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<uint32_t> channels;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<Channel> channel = node->GetDevice (j)->GetChannel ();
+          if (channel != 0 && channels.insert (channel->GetId ()).second)
+            {
+              PopulateNeighborCache (channel);
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  for (uint32_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          if (i != j)
+            {
+              PopulateNeighborEntries (channel->GetDevice (i), channel->GetDevice (j));
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const NetDeviceContainer &c) const
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<NetDevice> device = *i;
+      Ptr<Channel> channel = device->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> neighbor = channel->GetDevice (j);
+          if (neighbor != device)
+            {
+              PopulateNeighborEntries (device, neighbor);
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborEntries (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const
+{
+  NS_LOG_FUNCTION (this << device << neighbor);
+  if (!device->NeedsArp ())
+    {
+      return;
+    }
+  PopulateArpCache (device, neighbor);
+  PopulateNdiscCache (device, neighbor);
+}
+
+void
+NeighborCacheHelper::PopulateArpCache (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const
+{
+  NS_LOG_FUNCTION (this << device << neighbor);
+  Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  Ptr<Ipv4L3Protocol> neighborIpv4 = neighbor->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  if (ipv4 == 0 || neighborIpv4 == 0)
+    {
+      return;
+    }
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  int32_t neighborInterface = neighborIpv4->GetInterfaceForDevice (neighbor);
+  if (interface == -1 || neighborInterface == -1)
+    {
+      return;
+    }
+  Ptr<Ipv4Interface> ipv4Interface = ipv4->GetInterface (interface);
+  Ptr<Ipv4Interface> neighborIpv4Interface = neighborIpv4->GetInterface (neighborInterface);
+  Ptr<ArpCache> cache = ipv4Interface->GetArpCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+
+  for (uint32_t i = 0; i < neighborIpv4Interface->GetNAddresses (); ++i)
+    {
+      Ipv4Address address = neighborIpv4Interface->GetAddress (i).GetLocal ();
+      bool onLink = false;
+      for (uint32_t j = 0; j < ipv4Interface->GetNAddresses (); ++j)
+        {
+          Ipv4InterfaceAddress local = ipv4Interface->GetAddress (j);
+          if (local.GetLocal ().CombineMask (local.GetMask ()) == address.CombineMask (local.GetMask ()))
+            {
+              onLink = true;
+              break;
+            }
+        }
+      if (!onLink)
+        {
+          continue;
+        }
+
+      ArpCache::Entry *entry = cache->Lookup (address);
+      if (entry == 0)
+        {
+          entry = cache->Add (address);
+        }
+      else if (entry->IsWaitReply ())
+        {
+          // let the ongoing resolution send the packets waiting for it
+          continue;
+        }
+      NS_LOG_LOGIC ("Node " << device->GetNode ()->GetId () << ": permanent ARP entry " <<
+                    address << " -> " << neighbor->GetAddress ());
+      entry->MarkPermanent (neighbor->GetAddress ());
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNdiscCache (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const
+{
+  NS_LOG_FUNCTION (this << device << neighbor);
+  Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  Ptr<Ipv6L3Protocol> neighborIpv6 = neighbor->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  if (ipv6 == 0 || neighborIpv6 == 0)
+    {
+      return;
+    }
+  int32_t interface = ipv6->GetInterfaceForDevice (device);
+  int32_t neighborInterface = neighborIpv6->GetInterfaceForDevice (neighbor);
+  if (interface == -1 || neighborInterface == -1)
+    {
+      return;
+    }
+  Ptr<Ipv6Interface> ipv6Interface = ipv6->GetInterface (interface);
+  Ptr<Ipv6Interface> neighborIpv6Interface = neighborIpv6->GetInterface (neighborInterface);
+  Ptr<NdiscCache> cache = ipv6Interface->GetNdiscCache ();
+  if (cache == 0)
+    {
+      return;
+    }
+
+  for (uint32_t i = 0; i < neighborIpv6Interface->GetNAddresses (); ++i)
+    {
+      Ipv6Address address = neighborIpv6Interface->GetAddress (i).GetAddress ();
+      bool onLink = address.IsLinkLocal ();
+      for (uint32_t j = 0; !onLink && j < ipv6Interface->GetNAddresses (); ++j)
+        {
+          Ipv6InterfaceAddress local = ipv6Interface->GetAddress (j);
+          if (local.GetScope () != Ipv6InterfaceAddress::LINKLOCAL
+              && local.GetAddress ().CombinePrefix (local.GetPrefix ()) == address.CombinePrefix (local.GetPrefix ()))
+            {
+              onLink = true;
+            }
+        }
+      if (!onLink)
+        {
+          continue;
+        }
+
+      NdiscCache::Entry *entry = cache->Lookup (address);
+      if (entry == 0)
+        {
+          entry = cache->Add (address);
+          entry->SetRouter (false);
+        }
+      else if (entry->IsIncomplete ())
+        {
+          // let the ongoing resolution send the packets waiting for it
+          continue;
+        }
+      NS_LOG_LOGIC ("Node " << device->GetNode ()->GetId () << ": permanent NDISC entry " <<
+                    address << " -> " << neighbor->GetAddress ());
+      entry->MarkPermanent (neighbor->GetAddress ());
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include "ns3/ptr.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+class Channel;
+class NetDevice;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Helper class that fills the ARP and NDISC caches of static
+ * topologies with permanent entries
+ *
+ * On a link whose neighbors never change, the ARP requests and the
+ * Neighbor Solicitations sent for the first packets to each neighbor
+ * only delay these packets and add events to the simulation.  This
+ * helper walks the channels and, for every pair of devices attached to
+ * the same channel, adds to the cache of each device a permanent entry
+ * for the on-link IPv4 and IPv6 addresses of the other one.  Permanent
+ * entries never expire, are resolved without any state machine, and
+ * are not changed by the ARP and Neighbor Discovery messages received.
+ *
+ * The caches must be populated once the addresses are assigned to the
+ * interfaces.  Addresses assigned later need a new call to the helper.
+ * The permanent entries are kept when the caches are flushed, on a link
+ * change of the device or when an IPv6 interface goes down.  Devices
+ * which do not need address resolution (e.g., point-to-point devices
+ * over IPv4) have no cache and are skipped.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Populate the caches of all the devices of all the nodes
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the caches of the devices attached to a channel
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the caches of some devices with their neighbors
+   *
+   * Only the caches of the devices in the container are modified,
+   * the neighbors are all the other devices attached to their channel.
+   *
+   * \param c the devices
+   */
+  void PopulateNeighborCache (const NetDeviceContainer &c) const;
+
+private:
+  /**
+   * \brief Populate the caches of a device with the addresses of a neighbor
+   * \param device the device whose caches are populated
+   * \param neighbor the neighbor device on the same channel
+   */
+  void PopulateNeighborEntries (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const;
+
+  /**
+   * \brief Populate the ARP cache of a device with the IPv4 addresses of a neighbor
+   * \param device the device whose cache is populated
+   * \param neighbor the neighbor device on the same channel
+   */
+  void PopulateArpCache (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const;
+
+  /**
+   * \brief Populate the NDISC cache of a device with the IPv6 addresses of a neighbor
+   * \param device the device whose cache is populated
+   * \param neighbor the neighbor device on the same channel
+   */
+  void PopulateNdiscCache (Ptr<NetDevice> device, Ptr<NetDevice> neighbor) const;
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
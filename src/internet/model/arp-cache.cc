@@ -99,7 +99,7 @@ void
 ArpCache::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
-  Flush ();
+  RemoveAll ();
   m_device = 0;
   m_interface = 0;
   if (!m_waitReplyTimer.IsRunning ())
@@ -241,11 +241,16 @@ void
 ArpCache::Flush (void)
 {
   NS_LOG_FUNCTION (this);
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++) 
+  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); )
     {
+      if ((*i).second->IsPermanent ())
+        {
+          i++;
+          continue;
+        }
       delete (*i).second;
+      m_arpCache.erase (i++);
     }
-  m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -253,6 +258,18 @@ ArpCache::Flush (void)
     }
 }
 
+void
+ArpCache::RemoveAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+    {
+      delete (*i).second;
+    }
+  m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+}
+
 void
 ArpCache::PrintArpCache (Ptr<OutputStreamWrapper> stream)
 {
@@ -278,6 +295,10 @@ ArpCache::PrintArpCache (Ptr<OutputStreamWrapper> stream)
         {
           *os << " REACHABLE\n";
         }
+      else if (i->second->IsPermanent ())
+        {
+          *os << " PERMANENT\n";
+        }
       else if (i->second->IsWaitReply ())
         {
           *os << " DELAY\n";
@@ -293,10 +314,10 @@ ArpCache::Entry *
 ArpCache::Lookup (Ipv4Address to)
 {
   NS_LOG_FUNCTION (this << to);
-  if (m_arpCache.find (to) != m_arpCache.end ()) 
+  CacheI it = m_arpCache.find (to);
+  if (it != m_arpCache.end ())
     {
-      ArpCache::Entry *entry = m_arpCache[to];
-      return entry;
+      return it->second;
     }
   return 0;
 }
@@ -340,6 +361,12 @@ ArpCache::Entry::IsWaitReply (void)
   NS_LOG_FUNCTION (this);
   return (m_state == WAIT_REPLY) ? true : false;
 }
+bool
+ArpCache::Entry::IsPermanent (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return (m_state == PERMANENT) ? true : false;
+}
 
 
 void 
@@ -388,6 +415,16 @@ ArpCache::Entry::MarkWaitReply (Ptr<Packet> waiting)
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
 }
+void
+ArpCache::Entry::MarkPermanent (Address macAddress)
+{
+  NS_LOG_FUNCTION (this << macAddress);
+  NS_ASSERT (m_pending.empty ());
+  m_macAddress = macAddress;
+  m_state = PERMANENT;
+  ClearRetries ();
+  UpdateSeen ();
+}
 
 Address
 ArpCache::Entry::GetMacAddress (void) const
@@ -428,6 +465,10 @@ bool
 ArpCache::Entry::IsExpired (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_state == PERMANENT)
+    {
+      return false;
+    }
   Time timeout = GetTimeout ();
   Time delta = Simulator::Now () - m_lastSeen;
   NS_LOG_DEBUG ("delta=" << delta.GetSeconds () << "s");
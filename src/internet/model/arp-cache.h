@@ -151,7 +151,10 @@ public:
    */
   ArpCache::Entry *Add (Ipv4Address to);
   /**
-   * \brief Clear the ArpCache of all entries
+   * \brief Clear the ArpCache of all entries but the PERMANENT ones
+   *
+   * The static neighbors (e.g., those of NeighborCacheHelper) survive
+   * the link changes of the device.
    */
   void Flush (void);
 
@@ -185,6 +188,16 @@ public:
      * \param waiting
      */
     void MarkWaitReply (Ptr<Packet> waiting);
+    /**
+     * \brief Changes the state of this entry to permanent
+     *
+     * A permanent entry never expires and is not changed by the ARP
+     * messages received.  Flush keeps it, it is only removed when the
+     * cache is disposed.
+     *
+     * \param macAddress the MAC address of the neighbor
+     */
+    void MarkPermanent (Address macAddress);
     /**
      * \param waiting
      * \return 
@@ -202,6 +215,10 @@ public:
      * \return True if the state of this entry is wait_reply; false otherwise.
      */
     bool IsWaitReply (void);
+    /**
+     * \return True if the state of this entry is permanent; false otherwise.
+     */
+    bool IsPermanent (void) const;
 
     /**
      * \return The MacAddress of this entry
@@ -248,7 +265,8 @@ private:
     enum ArpCacheEntryState_e {
       ALIVE,
       WAIT_REPLY,
-      DEAD
+      DEAD,
+      PERMANENT
     };
 
     /**
@@ -283,6 +301,11 @@ private:
 
   virtual void DoDispose (void);
 
+  /**
+   * \brief Remove all the entries, the PERMANENT ones included
+   */
+  void RemoveAll (void);
+
   Ptr<NetDevice> m_device; //!< NetDevice associated with the cache
   Ptr<Ipv4Interface> m_interface; //!< Ipv4Interface associated with the cache
   Time m_aliveTimeout; //!< cache alive state timeout
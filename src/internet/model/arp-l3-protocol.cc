@@ -273,6 +273,12 @@ ArpL3Protocol::Lookup (Ptr<Packet> packet, Ipv4Address destination,
   ArpCache::Entry *entry = cache->Lookup (destination);
   if (entry != 0)
     {
+      if (entry->IsPermanent ())
+        {
+          // static neighbor: no timeout and no state to update
+          *hardwareDestination = entry->GetMacAddress ();
+          return true;
+        }
       if (entry->IsExpired ()) 
         {
           if (entry->IsDead ()) 
@@ -504,6 +504,31 @@ CoDelQueue::DoDequeue (void)
   return p;
 }
 
+Ptr<Packet>
+CoDelQueue::DropHead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_packets.empty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+  Ptr<Packet> p = m_packets.front ();
+  m_packets.pop ();
+  m_bytesInQueue -= p->GetSize ();
+
+  NS_LOG_LOGIC ("Dropping head " << p);
+  Drop (p);
+
+  // p was in queue, trace the dequeue and update stats manually
+  m_traceDequeue (p);
+  m_nBytes -= p->GetSize ();
+  m_nPackets--;
+
+  return p;
+}
+
 uint32_t
 CoDelQueue::GetQueueSize (void)
 {
@@ -139,6 +139,7 @@ public:
 private:
   friend class::CoDelQueueNewtonStepTest;  // Test code
   friend class::CoDelQueueControlLawTest;  // Test code
+  friend class FqCoDelQueue;               // Uses DropHead
   /**
    * \brief Add a packet to the queue
    *
@@ -160,6 +161,16 @@ private:
 
   virtual Ptr<const Packet> DoPeek (void) const;
 
+  /**
+   * \brief Drop the packet at the head of the queue, bypassing the CoDel
+   * algorithm
+   *
+   * Used by FqCoDelQueue to enforce its overall limit.
+   *
+   * \returns The packet dropped, or 0 if the queue is empty
+   */
+  Ptr<Packet> DropHead (void);
+
   /**
    * \brief Calculate the reciprocal square root of m_count by using Newton's method
    *  http://en.wikipedia.org/wiki/Methods_of_computing_square_roots#Iterative_methods_for_reciprocal_square_roots
@@ -0,0 +1,408 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * FQ-CoDel, the Flow Queue CoDel queueing discipline (RFC 8290),
+ * following the structure of the linux kernel sch_fq_codel.
+ */
+
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/unused.h"
+#include "fq-codel-queue.h"
+#include "ip-header-bytes.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FqCoDelQueue");
+
+/**
+ * Mixes a word into a hash value, as the body of MurmurHash3.
+ * \param h the hash value
+ * \param k the word
+ * \returns the new hash value
+ */
+static inline uint32_t
+HashMix (uint32_t h, uint32_t k)
+{
+  k *= 0xcc9e2d51;
+  k = (k << 15) | (k >> 17);
+  k *= 0x1b873593;
+  h ^= k;
+  h = (h << 13) | (h >> 19);
+  return h * 5 + 0xe6546b64;
+}
+
+/**
+ * Final avalanche of a hash value, as the finalizer of MurmurHash3.
+ * \param h the hash value
+ * \returns the final hash value
+ */
+static inline uint32_t
+HashFinal (uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (FqCoDelQueue);
+
+TypeId FqCoDelQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqCoDelQueue")
+    .SetParent<Queue> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<FqCoDelQueue> ()
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of packets accepted by this FqCoDelQueue, all flows together.",
+                   UintegerValue (10240),
+                   MakeUintegerAccessor (&FqCoDelQueue::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Flows",
+                   "The number of flow queues.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FqCoDelQueue::m_nFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Quantum",
+                   "The number of bytes each flow may send per round of the deficit round robin.",
+                   UintegerValue (1514),
+                   MakeUintegerAccessor (&FqCoDelQueue::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Perturbation",
+                   "The seed of the flow hash.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqCoDelQueue::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Interval",
+                   "The CoDel algorithm interval of each flow queue",
+                   StringValue ("100ms"),
+                   MakeTimeAccessor (&FqCoDelQueue::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Target",
+                   "The CoDel algorithm target queue delay of each flow queue",
+                   StringValue ("5ms"),
+                   MakeTimeAccessor (&FqCoDelQueue::m_target),
+                   MakeTimeChecker ())
+  ;
+
+  return tid;
+}
+
+FqCoDelQueue::FqCoDelQueue ()
+  : Queue (),
+    m_dropOverLimit (0),
+    m_newFlowCount (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FqCoDelQueue::~FqCoDelQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqCoDelQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flows.clear ();
+  m_newFlows.clear ();
+  m_oldFlows.clear ();
+  Queue::DoDispose ();
+}
+
+void
+FqCoDelQueue::InitializeFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // The overall limit is enforced here: the flow queues never overflow.
+  m_flowFactory.SetTypeId ("ns3::CoDelQueue");
+  m_flowFactory.Set ("Mode", EnumValue (QUEUE_MODE_PACKETS));
+  m_flowFactory.Set ("MaxPackets", UintegerValue (m_maxPackets + 1));
+  m_flowFactory.Set ("Interval", TimeValue (m_interval));
+  m_flowFactory.Set ("Target", TimeValue (m_target));
+
+  Flow flow;
+  flow.deficit = 0;
+  flow.status = INACTIVE;
+  m_flows.resize (m_nFlows, flow);
+}
+
+uint32_t
+FqCoDelQueue::Classify (Ptr<const Packet> p) const
+{
+  NS_LOG_FUNCTION (this << p);
+
+  IpHeaderBytes bytes (p);
+  const uint8_t *ip = bytes.GetIpHeader ();
+  uint32_t left = bytes.GetIpSize ();
+
+  uint32_t hash = m_perturbation;
+  if (left >= 20 && (ip[0] >> 4) == 4)
+    {
+      uint32_t headerLength = (ip[0] & 0x0f) * 4;
+      uint8_t protocol = ip[9];
+      hash = HashMix (hash, IpHeaderBytes::ReadU32 (ip + 12));
+      hash = HashMix (hash, IpHeaderBytes::ReadU32 (ip + 16));
+      hash = HashMix (hash, protocol);
+      // The fragments of a datagram must stay in the same flow: only
+      // whole datagrams are hashed with their ports.
+      bool fragment = (IpHeaderBytes::ReadU16 (ip + 6) & 0x3fff) != 0;
+      if ((protocol == 6 || protocol == 17) && !fragment && left >= headerLength + 4)
+        {
+          hash = HashMix (hash, IpHeaderBytes::ReadU32 (ip + headerLength));
+        }
+    }
+  else if (left >= 40 && (ip[0] >> 4) == 6)
+    {
+      uint8_t nextHeader = ip[6];
+      for (uint32_t i = 8; i < 40; i += 4)
+        {
+          hash = HashMix (hash, IpHeaderBytes::ReadU32 (ip + i));
+        }
+      hash = HashMix (hash, nextHeader);
+      if ((nextHeader == 6 || nextHeader == 17) && left >= 44)
+        {
+          hash = HashMix (hash, IpHeaderBytes::ReadU32 (ip + 40));
+        }
+    }
+  hash = HashFinal (hash);
+
+  uint32_t flow = ((uint64_t) hash * m_nFlows) >> 32;
+  NS_LOG_LOGIC ("Hash " << hash << " flow " << flow);
+  return flow;
+}
+
+bool
+FqCoDelQueue::DoEnqueue (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (m_flows.empty ())
+    {
+      InitializeFlows ();
+    }
+
+  uint32_t i = Classify (p);
+  Flow &flow = m_flows[i];
+  if (flow.queue == 0)
+    {
+      flow.queue = m_flowFactory.Create<CoDelQueue> ();
+      flow.queue->TraceConnectWithoutContext ("Drop", MakeCallback (&FqCoDelQueue::FlowDrop, this));
+    }
+
+  // p is not yet counted in the number of packets of the queue.
+  if (GetNPackets () >= m_maxPackets)
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping from the largest flow");
+      uint32_t fattest = FindFattestFlow (i, p->GetSize ());
+      m_dropOverLimit++;
+      if (fattest == i && flow.queue->GetNPackets () == 0)
+        {
+          // p would be the head of the largest flow: it is the one dropped.
+          NS_LOG_LOGIC ("Dropping the packet enqueued");
+          Drop (p);
+          return false;
+        }
+      // The drop is accounted for by FlowDrop.
+      m_flows[fattest].queue->DropHead ();
+    }
+
+  bool enqueued = flow.queue->Enqueue (p);
+  NS_ASSERT_MSG (enqueued, "Flow queues never overflow");
+  NS_UNUSED (enqueued);
+
+  if (flow.status == INACTIVE)
+    {
+      NS_LOG_LOGIC ("Flow " << i << " becomes active");
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      m_newFlows.push_back (i);
+      m_newFlowCount++;
+    }
+
+  NS_LOG_LOGIC ("Number packets in flow " << i << ": " << flow.queue->GetNPackets ());
+  return true;
+}
+
+uint32_t
+FqCoDelQueue::FindFattestFlow (uint32_t flow, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << flow << size);
+
+  // The flow of the packet may not be active yet.
+  uint32_t fattest = flow;
+  uint32_t maxBytes = m_flows[flow].queue->GetNBytes () + size;
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      const std::deque<uint32_t> &flows = k == 0 ? m_newFlows : m_oldFlows;
+      for (std::deque<uint32_t>::const_iterator i = flows.begin (); i != flows.end (); ++i)
+        {
+          uint32_t bytes = m_flows[*i].queue->GetNBytes ();
+          if (*i != flow && bytes > maxBytes)
+            {
+              maxBytes = bytes;
+              fattest = *i;
+            }
+        }
+    }
+  return fattest;
+}
+
+void
+FqCoDelQueue::FlowDrop (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  Ptr<Packet> packet = ConstCast<Packet> (p);
+  Drop (packet);
+
+  // p was in queue, trace the dequeue and update stats manually
+  m_traceDequeue (packet);
+  m_nBytes -= p->GetSize ();
+  m_nPackets--;
+}
+
+Ptr<Packet>
+FqCoDelQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  while (true)
+    {
+      std::deque<uint32_t> *flows;
+      if (!m_newFlows.empty ())
+        {
+          flows = &m_newFlows;
+        }
+      else if (!m_oldFlows.empty ())
+        {
+          flows = &m_oldFlows;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Queue empty");
+          return 0;
+        }
+
+      uint32_t i = flows->front ();
+      Flow &flow = m_flows[i];
+      if (flow.deficit <= 0)
+        {
+          // The flow used up its quantum: move it to the end of the
+          // old flows, with a new quantum.
+          flow.deficit += m_quantum;
+          flow.status = OLD_FLOW;
+          flows->pop_front ();
+          m_oldFlows.push_back (i);
+          continue;
+        }
+
+      Ptr<Packet> p = flow.queue->Dequeue ();
+      if (p == 0)
+        {
+          // An empty new flow goes through the old flows once, so that a
+          // flow sending one packet at a time is not always served first.
+          flows->pop_front ();
+          if (flows == &m_newFlows && !m_oldFlows.empty ())
+            {
+              flow.status = OLD_FLOW;
+              m_oldFlows.push_back (i);
+            }
+          else
+            {
+              NS_LOG_LOGIC ("Flow " << i << " becomes inactive");
+              flow.status = INACTIVE;
+            }
+          continue;
+        }
+
+      flow.deficit -= p->GetSize ();
+      NS_LOG_LOGIC ("Popped " << p << " from flow " << i);
+      return p;
+    }
+}
+
+Ptr<const Packet>
+FqCoDelQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      const std::deque<uint32_t> &flows = k == 0 ? m_newFlows : m_oldFlows;
+      for (std::deque<uint32_t>::const_iterator i = flows.begin (); i != flows.end (); ++i)
+        {
+          Ptr<const Packet> p = m_flows[*i].queue->Peek ();
+          if (p != 0)
+            {
+              return p;
+            }
+        }
+    }
+  NS_LOG_LOGIC ("Queue empty");
+  return 0;
+}
+
+uint32_t
+FqCoDelQueue::GetNFlows (void) const
+{
+  return m_nFlows;
+}
+
+Ptr<CoDelQueue>
+FqCoDelQueue::GetFlowQueue (uint32_t i) const
+{
+  NS_ASSERT (i < m_nFlows);
+  if (m_flows.empty ())
+    {
+      return 0;
+    }
+  return m_flows[i].queue;
+}
+
+uint32_t
+FqCoDelQueue::GetDropOverLimit (void) const
+{
+  return m_dropOverLimit;
+}
+
+uint32_t
+FqCoDelQueue::GetDropCount (void) const
+{
+  uint32_t count = 0;
+  for (std::vector<Flow>::const_iterator i = m_flows.begin (); i != m_flows.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          count += i->queue->GetDropCount ();
+        }
+    }
+  return count;
+}
+
+uint32_t
+FqCoDelQueue::GetNewFlowCount (void) const
+{
+  return m_newFlowCount;
+}
+
+} // namespace ns3
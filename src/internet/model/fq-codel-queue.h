@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * FQ-CoDel, the Flow Queue CoDel queueing discipline (RFC 8290),
+ * following the structure of the linux kernel sch_fq_codel.
+ */
+
+#ifndef FQ_CODEL_QUEUE_H
+#define FQ_CODEL_QUEUE_H
+
+#include <vector>
+#include <deque>
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "codel-queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A Flow Queue CoDel packet queue
+ *
+ * Packets are classified into a fixed number of flow queues by a hash
+ * of their IPv4 or IPv6 5-tuple (addresses, protocol and, for TCP and
+ * UDP, ports), so that a flow cannot starve the others.  Each flow
+ * queue is a CoDelQueue, created the first time a packet is hashed to
+ * it.  The flow queues are served by deficit round robin with a
+ * quantum of Quantum bytes; flows which have just become active are
+ * served first, as in RFC 8290.  Dequeue, and enqueue below the
+ * overall limit, take constant time.  When the overall limit is
+ * reached, a packet is dropped from the head of the flow queue with
+ * the largest backlog, found by a scan of the active flows as in the
+ * Linux implementation: such an enqueue takes a time linear in the
+ * number of active flows, at most Flows.
+ *
+ * The queues of network devices see the link layer frames: the IP
+ * header is searched for after a PPP header, an Ethernet II header or
+ * an Ethernet header followed by an LLC/SNAP header, or at the start of
+ * the packet.  Packets whose IP header is not found, such as ARP
+ * packets, are all classified into the same flow queue.
+ */
+class FqCoDelQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief FqCoDelQueue Constructor
+   */
+  FqCoDelQueue ();
+
+  virtual ~FqCoDelQueue ();
+
+  /**
+   * \brief Get the number of flow queues.
+   *
+   * \returns The number of flow queues
+   */
+  uint32_t GetNFlows (void) const;
+
+  /**
+   * \brief Get a flow queue, to read its statistics.
+   *
+   * \param i The index of the flow queue, smaller than GetNFlows ()
+   * \returns The flow queue, or 0 if no packet was ever classified into it
+   */
+  Ptr<CoDelQueue> GetFlowQueue (uint32_t i) const;
+
+  /**
+   * \brief Get the index of the flow queue of a packet.
+   *
+   * \param p The packet, as enqueued
+   * \returns The index of its flow queue
+   */
+  uint32_t Classify (Ptr<const Packet> p) const;
+
+  /**
+   * \brief Get the number of packets dropped because the overall limit
+   * was reached.
+   *
+   * \returns The number of dropped packets
+   */
+  uint32_t GetDropOverLimit (void) const;
+
+  /**
+   * \brief Get the number of packets dropped by the CoDel algorithm of
+   * the flow queues.
+   *
+   * \returns The number of dropped packets
+   */
+  uint32_t GetDropCount (void) const;
+
+  /**
+   * \brief Get the number of times a flow became active.
+   *
+   * \returns The number of new flows
+   */
+  uint32_t GetNewFlowCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<Packet> p);
+  virtual Ptr<Packet> DoDequeue (void);
+  virtual Ptr<const Packet> DoPeek (void) const;
+
+  /**
+   * \brief Create the flow queues, on the first enqueue.
+   */
+  void InitializeFlows (void);
+
+  /**
+   * \brief Account for a packet dropped by a flow queue.
+   *
+   * \param p The packet dropped
+   */
+  void FlowDrop (Ptr<const Packet> p);
+
+  /**
+   * \brief Find the flow queue with the largest backlog, once a packet
+   * is enqueued.
+   *
+   * The flow queue is found by a scan of the new and old flows, in a time
+   * linear in the number of active flows.
+   *
+   * \param flow The flow of the packet enqueued
+   * \param size The size of the packet enqueued
+   * \returns the index of the flow
+   */
+  uint32_t FindFattestFlow (uint32_t flow, uint32_t size) const;
+
+  /**
+   * \brief State of a flow queue in the round robin.
+   */
+  enum FlowStatus
+  {
+    INACTIVE,    //!< No packet in the flow queue
+    NEW_FLOW,    //!< In the list of new flows
+    OLD_FLOW     //!< In the list of old flows
+  };
+
+  /**
+   * \brief A flow queue and its round robin state.
+   */
+  struct Flow
+  {
+    Ptr<CoDelQueue> queue;  //!< The packets of the flow, or 0 if never used
+    int32_t deficit;        //!< Deficit of the flow, in bytes
+    FlowStatus status;      //!< Round robin state of the flow
+  };
+
+  std::vector<Flow> m_flows;           //!< The flow queues
+  std::deque<uint32_t> m_newFlows;     //!< The flows which just became active
+  std::deque<uint32_t> m_oldFlows;     //!< The other active flows
+  ObjectFactory m_flowFactory;         //!< Factory of the flow queues
+  uint32_t m_nFlows;                   //!< Number of flow queues
+  uint32_t m_maxPackets;               //!< Max # of packets accepted by the queue
+  uint32_t m_quantum;                  //!< Round robin quantum, in bytes
+  uint32_t m_perturbation;             //!< Seed of the flow hash
+  Time m_interval;                     //!< CoDel interval of the flow queues
+  Time m_target;                       //!< CoDel target of the flow queues
+  uint32_t m_dropOverLimit;            //!< Packets dropped due to full queue
+  uint32_t m_newFlowCount;             //!< Number of times a flow became active
+};
+
+} // namespace ns3
+
+#endif /* FQ_CODEL_QUEUE_H */
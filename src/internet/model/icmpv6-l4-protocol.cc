@@ -375,7 +375,7 @@ void Icmpv6L4Protocol::ReceiveLLA (Icmpv6OptionLinkLayerAddress lla, Ipv6Address
       entry->MarkReachable ();
       entry->StartReachableTimer ();
     }
-  else
+  else if (!entry->IsPermanent ())
     {
       std::list<Ptr<Packet> > waiting;
       if (entry->IsIncomplete ())
@@ -451,7 +451,7 @@ void Icmpv6L4Protocol::HandleRS (Ptr<Packet> packet, Ipv6Address const &src, Ipv
           entry->SetRouter (false);
           entry->MarkStale (lla.GetAddress ());
         }
-      else if (entry->GetMacAddress () != lla.GetAddress ())
+      else if (!entry->IsPermanent () && entry->GetMacAddress () != lla.GetAddress ())
         {
           entry->MarkStale (lla.GetAddress ());
         }
@@ -523,7 +523,7 @@ void Icmpv6L4Protocol::HandleNS (Ptr<Packet> packet, Ipv6Address const &src, Ipv
           entry->SetRouter (false);
           entry->MarkStale (lla.GetAddress ());
         }
-      else if (entry->GetMacAddress () != lla.GetAddress ())
+      else if (!entry->IsPermanent () && entry->GetMacAddress () != lla.GetAddress ())
         {
           entry->MarkStale (lla.GetAddress ());
         }
@@ -659,6 +659,12 @@ void Icmpv6L4Protocol::HandleNA (Ptr<Packet> packet, Ipv6Address const &src, Ipv
     }
   packet->RemoveHeader (lla);
 
+  if (entry->IsPermanent ())
+    {
+      /* static entries are not updated by the NA */
+      return;
+    }
+
   if (entry->IsIncomplete ())
     {
       /* we receive a NA so stop the retransmission timer */
@@ -776,7 +782,7 @@ void Icmpv6L4Protocol::HandleRedirection (Ptr<Packet> packet, Ipv6Address const
           entry->SetMacAddress (llOptionHeader.GetAddress ());
           entry->MarkStale ();
         }
-      else
+      else if (!entry->IsPermanent ())
         {
           if (entry->IsIncomplete () || entry->GetMacAddress () != llOptionHeader.GetAddress ())
             {
@@ -1295,7 +1301,7 @@ bool Icmpv6L4Protocol::Lookup (Ipv6Address dst, Ptr<NetDevice> device, Ptr<Ndisc
       NdiscCache::Entry* entry = cache->Lookup (dst);
       if (entry)
         {
-          if (entry->IsReachable () || entry->IsDelay ())
+          if (entry->IsPermanent () || entry->IsReachable () || entry->IsDelay ())
             {
               *hardwareDestination = entry->GetMacAddress ();
               return true;
@@ -1329,7 +1335,13 @@ bool Icmpv6L4Protocol::Lookup (Ptr<Packet> p, Ipv6Address dst, Ptr<NetDevice> de
   NdiscCache::Entry* entry = cache->Lookup (dst);
   if (entry)
     {
-      if (entry->IsReachable () || entry->IsDelay ())
+      if (entry->IsPermanent ())
+        {
+          /* static neighbor: no NUD state to update */
+          *hardwareDestination = entry->GetMacAddress ();
+          return true;
+        }
+      else if (entry->IsReachable () || entry->IsDelay ())
         {
           /* XXX check reachability time */
           /* send packet */
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ip-header-bytes.h"
+
+namespace ns3 {
+
+IpHeaderBytes::IpHeaderBytes (Ptr<const Packet> p)
+{
+  m_len = p->CopyData (m_buf, SIZE);
+  m_offset = FindIpHeader (m_buf, m_len);
+}
+
+uint32_t
+IpHeaderBytes::FindIpHeader (const uint8_t *buf, uint32_t len)
+{
+  uint32_t offset = len;
+  if (len >= 2 && (ReadU16 (buf) == 0x0021 || ReadU16 (buf) == 0x0057))
+    {
+      // PPP
+      offset = 2;
+    }
+  else if (len >= 14 && (ReadU16 (buf + 12) == 0x0800 || ReadU16 (buf + 12) == 0x86dd))
+    {
+      // Ethernet II
+      offset = 14;
+    }
+  else if (len >= 22 && ReadU16 (buf + 12) <= 1500
+           && buf[14] == 0xaa && buf[15] == 0xaa && buf[16] == 0x03
+           && (ReadU16 (buf + 20) == 0x0800 || ReadU16 (buf + 20) == 0x86dd))
+    {
+      // Ethernet, LLC/SNAP
+      offset = 22;
+    }
+  else if (len >= 1 && ((buf[0] >> 4) == 4 || (buf[0] >> 4) == 6))
+    {
+      // No link layer header
+      offset = 0;
+    }
+  return offset;
+}
+
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IP_HEADER_BYTES_H
+#define IP_HEADER_BYTES_H
+
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief The first bytes of a packet, from which the queues classify it
+ *
+ * The bytes are copied from the packet once, and the IPv4 or IPv6
+ * header is searched for after a PPP, Ethernet II or Ethernet LLC/SNAP
+ * header, or at the start of the packet.  Enough bytes are copied for
+ * the largest of these headers, an IPv6 header and the ports.
+ */
+class IpHeaderBytes
+{
+public:
+  /**
+   * \brief Copy the first bytes of a packet and find its IP header
+   * \param p the packet
+   */
+  explicit IpHeaderBytes (Ptr<const Packet> p);
+
+  /**
+   * \returns the IP header, valid for GetIpSize bytes
+   */
+  const uint8_t *GetIpHeader (void) const;
+
+  /**
+   * \returns the number of bytes copied from the IP header on, 0 if no IP
+   * header was found
+   */
+  uint32_t GetIpSize (void) const;
+
+  /**
+   * \param buf the bytes
+   * \returns the 16 bits in network order at \p buf
+   */
+  static uint16_t ReadU16 (const uint8_t *buf);
+
+  /**
+   * \param buf the bytes
+   * \returns the 32 bits in network order at \p buf
+   */
+  static uint32_t ReadU32 (const uint8_t *buf);
+
+  /**
+   * \brief Find the IP header in a link layer frame
+   * \param buf the first bytes of the frame
+   * \param len the number of bytes in \p buf
+   * \returns the offset of the IPv4 or IPv6 header, or \p len if none is found
+   */
+  static uint32_t FindIpHeader (const uint8_t *buf, uint32_t len);
+
+  /// Number of bytes copied: an Ethernet and LLC/SNAP header, an IPv6 header and the ports
+  static const uint32_t SIZE = 22 + 40 + 4;
+
+private:
+  uint8_t m_buf[SIZE]; //!< The first bytes of the packet
+  uint32_t m_len;      //!< The number of bytes copied
+  uint32_t m_offset;   //!< The offset of the IP header
+};
+
+inline const uint8_t *
+IpHeaderBytes::GetIpHeader (void) const
+{
+  return m_buf + m_offset;
+}
+
+inline uint32_t
+IpHeaderBytes::GetIpSize (void) const
+{
+  return m_len - m_offset;
+}
+
+inline uint16_t
+IpHeaderBytes::ReadU16 (const uint8_t *buf)
+{
+  return (buf[0] << 8) | buf[1];
+}
+
+inline uint32_t
+IpHeaderBytes::ReadU32 (const uint8_t *buf)
+{
+  return ((uint32_t) buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+}
+
+} // namespace ns3
+
+#endif /* IP_HEADER_BYTES_H */
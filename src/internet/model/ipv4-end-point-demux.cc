@@ -26,6 +26,45 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+/**
+ * \param endPoint an end point
+ * \returns true if the end point is connected to a peer address and port
+ */
+static bool
+IsConnected (Ipv4EndPoint *endPoint)
+{
+  return endPoint->GetPeerAddress () != Ipv4Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+/**
+ * \brief Find the end point with the fewest wildcard addresses.
+ * \param endPoints the end points to look at
+ * \param genericity the number of wildcard addresses of generic, updated
+ * \param generic the end point found so far, updated
+ */
+static void
+FindGeneric (const std::list<Ipv4EndPoint *> &endPoints, uint32_t &genericity, Ipv4EndPoint *&generic)
+{
+  for (std::list<Ipv4EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      uint32_t tmp = 0;
+      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ())
+        {
+          tmp++;
+        }
+      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ())
+        {
+          tmp++;
+        }
+      if (tmp < genericity)
+        {
+          generic = (*i);
+          genericity = tmp;
+        }
+    }
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -35,41 +74,104 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints endPoints = GetAllEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv4EndPoint *endPoint = *i;
       delete endPoint;
     }
-  m_endPoints.clear ();
+  m_ports.clear ();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+void
+Ipv4EndPointDemux::AddToIndex (Ipv4EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  port.n++;
+  port.local[endPoint->GetLocalAddress ()]++;
+  if (IsConnected (endPoint))
+    {
+      Peer peer (endPoint->GetPeerAddress ().Get (), endPoint->GetPeerPort ());
+      port.connected[peer].push_back (endPoint);
+    }
+  else
+    {
+      port.unconnected.push_back (endPoint);
+    }
+}
+
+Ipv4EndPointDemux::EndPoints *
+Ipv4EndPointDemux::GetIndexedEndPoints (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort)
+{
+  NS_LOG_FUNCTION (this << localPort << peerAddress << peerPort);
+  static EndPoints empty;
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (localPort);
+  if (port == m_ports.end ())
+    {
+      return &empty;
+    }
+  if (peerAddress == Ipv4Address::GetAny () || peerPort == 0)
+    {
+      return &port->second.unconnected;
+    }
+  std::unordered_map<Peer, EndPoints, PeerHash>::iterator peer =
+    port->second.connected.find (Peer (peerAddress.Get (), peerPort));
+  if (peer == port->second.connected.end ())
     {
-      if ((*i)->GetLocalPort  () == port) 
+      return &empty;
+    }
+  return &peer->second;
+}
+
+void
+Ipv4EndPointDemux::RemoveFromIndex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (IsConnected (endPoint))
+    {
+      Peer peer (endPoint->GetPeerAddress ().Get (), endPoint->GetPeerPort ());
+      std::unordered_map<Peer, EndPoints, PeerHash>::iterator i = port->second.connected.find (peer);
+      NS_ASSERT (i != port->second.connected.end ());
+      i->second.remove (endPoint);
+      if (i->second.empty ())
         {
-          return true;
+          port->second.connected.erase (i);
         }
     }
-  return false;
+  else
+    {
+      port->second.unconnected.remove (endPoint);
+    }
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::iterator local =
+    port->second.local.find (endPoint->GetLocalAddress ());
+  NS_ASSERT (local != port->second.local.end ());
+  if (--local->second == 0)
+    {
+      port->second.local.erase (local);
+    }
+  if (--port->second.n == 0)
+    {
+      m_ports.erase (port);
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
-        {
-          return true;
-        }
-    }
-  return false;
+  std::unordered_map<uint16_t, PortEndPoints>::iterator entry = m_ports.find (port);
+  return entry != m_ports.end ()
+         && entry->second.local.find (addr) != entry->second.local.end ();
 }
 
 Ipv4EndPoint *
@@ -83,8 +185,9 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetAllEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -99,8 +202,9 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetAllEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -122,8 +226,9 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetAllEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -132,12 +237,12 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPoints *endPoints = GetIndexedEndPoints (localPort, peerAddress, peerPort);
+  for (EndPointsI i = endPoints->begin (); i != endPoints->end (); i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
+      if ((*i)->GetLocalAddress () == localAddress &&
           (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
+          (*i)->GetPeerAddress () == peerAddress)
         {
           NS_LOG_WARN ("No way we can allocate this end-point.");
           /* no way we can allocate this end-point. */
@@ -146,9 +251,10 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
 
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  NS_LOG_DEBUG ("Now have >>" << GetAllEndPoints ().size () << "<< endpoints.");
 
   return endPoint;
 }
@@ -157,15 +263,8 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
-    }
+  RemoveFromIndex (endPoint);
+  delete endPoint;
 }
 
 /*
@@ -177,10 +276,15 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.begin ();
+       port != m_ports.end (); port++)
     {
-      Ipv4EndPoint* endP = *i;
-      ret.push_back (endP);
+      ret.insert (ret.end (), port->second.unconnected.begin (), port->second.unconnected.end ());
+      for (std::unordered_map<Peer, EndPoints, PeerHash>::iterator j = port->second.connected.begin ();
+           j != port->second.connected.end (); j++)
+        {
+          ret.insert (ret.end (), j->second.begin (), j->second.end ());
+        }
     }
   return ret;
 }
@@ -204,108 +308,114 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
     {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
-      if (!endP->IsRxEnabled ())
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
         }
-
-      if (endP->GetLocalPort () != dport) 
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  // Only the end points of the port which are not connected, and those
+  // connected to the sender of the packet, can match.
+  EndPoints *candidates[2];
+  candidates[0] = GetIndexedEndPoints (dport, Ipv4Address::GetAny (), 0);
+  candidates[1] = GetIndexedEndPoints (dport, saddr, sport);
+  for (uint32_t list = 0; list < 2; list++)
+    {
+      if (list == 1 && candidates[1] == candidates[0])
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
+          // The sender has no address or port: no connected end point.
+          break;
         }
-      if (endP->GetBoundNetDevice ())
+      for (EndPointsI i = candidates[list]->begin (); i != candidates[list]->end (); i++)
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          Ipv4EndPoint* endP = *i;
+
+          NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                                     << " daddr=" << endP->GetLocalAddress ()
+                                                     << " sport=" << endP->GetPeerPort ()
+                                                     << " saddr=" << endP->GetPeerAddress ());
+
+          if (!endP->IsRxEnabled ())
             {
               NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
+                            << " because endpoint can not receive packets");
               continue;
             }
-        }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+
+          if (endP->GetBoundNetDevice ())
             {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
+              if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+                {
+                  NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                                     << " because endpoint is bound to specific device and"
+                                                     << endP->GetBoundNetDevice ()
+                                                     << " does not match packet device " << incomingInterface->GetDevice ());
+                  continue;
+                }
             }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
-      bool localAddressMatchesWildCard = 
-        endP->GetLocalAddress () == Ipv4Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+          bool localAddressMatchesWildCard = 
+            endP->GetLocalAddress () == Ipv4Address::GetAny ();
+          bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
 
-      if (isBroadcast)
-        {
-          NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
-        }
+          if (isBroadcast)
+            {
+              NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
+            }
 
-      if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
-        {
-          localAddressMatchesExact = (endP->GetLocalAddress () ==
-                                      incomingInterfaceAddr);
-        }
-      // if no match here, keep looking
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        continue; 
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
-        Ipv4Address::GetAny ();
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      // Now figure out which return list to add this one to
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port matches exactly
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port and local address matches exactly
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All but local address
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All 4 match
-          retval4.push_back (endP);
+          if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+            {
+              localAddressMatchesExact = (endP->GetLocalAddress () ==
+                                          incomingInterfaceAddr);
+            }
+          // if no match here, keep looking
+          if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+            continue; 
+          bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+          bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+          bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+          bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
+            Ipv4Address::GetAny ();
+          // If remote does not match either with exact or wildcard,
+          // skip this one
+          if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+            continue;
+          if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+            continue;
+
+          // Now figure out which return list to add this one to
+          if (localAddressMatchesWildCard &&
+              remotePeerMatchesWildCard &&
+              remoteAddressMatchesWildCard)
+            { // Only local port matches exactly
+              retval1.push_back (endP);
+            }
+          if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
+              remotePeerMatchesWildCard &&
+              remoteAddressMatchesWildCard)
+            { // Only local port and local address matches exactly
+              retval2.push_back (endP);
+            }
+          if (localAddressMatchesWildCard &&
+              remotePeerMatchesExact &&
+              remoteAddressMatchesExact)
+            { // All but local address
+              retval3.push_back (endP);
+            }
+          if (localAddressMatchesExact &&
+              remotePeerMatchesExact &&
+              remoteAddressMatchesExact)
+            { // All 4 match
+              retval4.push_back (endP);
+            }
         }
     }
 
@@ -326,14 +436,14 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
-  uint32_t genericity = 3;
-  Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+  EndPoints *peerEndPoints = GetIndexedEndPoints (dport, saddr, sport);
+  for (EndPointsI i = peerEndPoints->begin (); i != peerEndPoints->end (); i++)
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -341,23 +451,18 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
           /* this is an exact match. */
           return *i;
         }
-      uint32_t tmp = 0;
-      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
-        {
-          tmp++;
-        }
-      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ()) 
-        {
-          tmp++;
-        }
-      if (tmp < genericity) 
-        {
-          generic = (*i);
-          genericity = tmp;
-        }
+    }
+  uint32_t genericity = 3;
+  Ipv4EndPoint *generic = 0;
+  FindGeneric (port->second.unconnected, genericity, generic);
+  for (std::unordered_map<Peer, EndPoints, PeerHash>::iterator j = port->second.connected.begin ();
+       j != port->second.connected.end (); j++)
+    {
+      FindGeneric (j->second, genericity, generic);
     }
   return generic;
 }
+
 uint16_t
 Ipv4EndPointDemux::AllocateEphemeralPort (void)
 {
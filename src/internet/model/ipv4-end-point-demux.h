@@ -23,8 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <utility>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
-#include "ipv4-interface.h"
+#include "ns3/ipv4-interface.h"
 
 namespace ns3 {
 
@@ -38,6 +40,14 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port and, within a port, the
+ * endpoints connected to a peer address and port are hashed by peer.
+ * A lookup thus only looks at the endpoints connected to the sender
+ * of the packet and at the endpoints not connected to a peer, such as
+ * the listening sockets, whatever the number of connections accepted
+ * by a server.  The local addresses in use on a port are counted, so
+ * that LookupLocal and LookupPortLocal are hash lookups.
  */
 
 class Ipv4EndPointDemux {
@@ -102,6 +112,10 @@ public:
 
   /**
    * \brief simple lookup for a match with all the parameters.
+   *
+   * Only the end points of the port which are not connected, and those
+   * connected to the source address and port, are looked at.
+   *
    * \param daddr destination address to test
    * \param dport destination port to test
    * \param saddr source address to test
@@ -161,6 +175,29 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Add an end point to the index of its local port.
+   * \param endPoint the end point
+   */
+  void AddToIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the index of its local port.
+   * \param endPoint the end point
+   */
+  void RemoveFromIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Get the end points of a local port connected to a peer.
+   * \param localPort the local port
+   * \param peerAddress the peer address, or the wildcard address
+   * \param peerPort the peer port, or 0
+   * \return the end points connected to the peer, or the end points
+   * which are not connected if the peer address or port is a wildcard
+   */
+  EndPoints *GetIndexedEndPoints (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -184,9 +221,40 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief A peer address and port.
+   */
+  typedef std::pair<uint32_t, uint16_t> Peer;
+
+  /**
+   * \brief Hash function of a peer address and port.
+   */
+  struct PeerHash
+  {
+    /**
+     * \param peer the peer address and port
+     * \returns the hash
+     */
+    size_t operator() (const Peer &peer) const
+    {
+      return peer.first * 2654435761U + peer.second;
+    }
+  };
+
+  /**
+   * \brief The end points of a local port.
+   */
+  struct PortEndPoints
+  {
+    EndPoints unconnected;  //!< End points with a wildcard peer address or port
+    std::unordered_map<Peer, EndPoints, PeerHash> connected;  //!< Connected end points, by peer
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> local;  //!< Number of end points, by local address
+    uint32_t n;             //!< Number of end points
+  };
+
+  /**
+   * \brief The end points, by local port.
    */
-  EndPoints m_endPoints;
+  std::unordered_map<uint16_t, PortEndPoints> m_ports;
 };
 
 } // namespace ns3
@@ -0,0 +1,374 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/names.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ipv4-flow-path-routing.h"
+#include "ipv4-flow-path-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4FlowPathRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4FlowPathRouting);
+
+const uint32_t Ipv4FlowPathRouting::NO_PATH;
+std::vector<Ipv4FlowPathRouting::Path> Ipv4FlowPathRouting::g_paths;
+uint32_t Ipv4FlowPathRouting::g_generation = 0;
+
+TypeId
+Ipv4FlowPathRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4FlowPathRouting")
+    .SetParent<Ipv4RoutingProtocol> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4FlowPathRouting> ()
+  ;
+  return tid;
+}
+
+Ipv4FlowPathRouting::Ipv4FlowPathRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4FlowPathRouting::~Ipv4FlowPathRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4FlowPathRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv4 = 0;
+  m_forwarding.clear ();
+  m_flows.clear ();
+  // the paths are shared by the nodes, which are disposed together
+  g_paths.clear ();
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
+uint32_t
+Ipv4FlowPathRouting::AddPath (Ipv4Address destination, const std::vector<Hop> &hops)
+{
+  NS_LOG_FUNCTION (destination << hops.size ());
+  NS_ABORT_MSG_IF (hops.empty (), "A path needs at least one hop");
+  for (uint32_t i = 0; i < hops.size (); i++)
+    {
+      for (uint32_t j = 0; j < i; j++)
+        {
+          NS_ABORT_MSG_IF (hops[i].m_node == hops[j].m_node,
+                           "Node " << hops[i].m_node << " appears twice in the path to " << destination);
+        }
+    }
+  Path path;
+  path.m_destination = destination;
+  path.m_hops = hops;
+  g_paths.push_back (path);
+  return g_paths.size () - 1;
+}
+
+uint32_t
+Ipv4FlowPathRouting::GetNPaths (void)
+{
+  return g_paths.size ();
+}
+
+const std::vector<Ipv4FlowPathRouting::Hop> &
+Ipv4FlowPathRouting::GetPath (uint32_t pathIndex)
+{
+  NS_ASSERT (pathIndex < g_paths.size ());
+  return g_paths[pathIndex].m_hops;
+}
+
+void
+Ipv4FlowPathRouting::AddFlow (Ipv4Address destination, const std::vector<uint32_t> &paths)
+{
+  NS_LOG_FUNCTION (this << destination << paths.size ());
+  Flow flow;
+  flow.m_paths = paths;
+  flow.m_path = NO_PATH;
+  // selected on the first packet
+  flow.m_generation = g_generation - 1;
+  for (std::vector<uint32_t>::const_iterator it = paths.begin (); it != paths.end (); ++it)
+    {
+      NS_ABORT_MSG_IF (*it >= g_paths.size (), "Unknown path " << *it);
+      NS_ABORT_MSG_IF (g_paths[*it].m_destination != destination,
+                       "Path " << *it << " does not lead to " << destination);
+    }
+  m_flows[destination.Get ()] = flow;
+}
+
+int32_t
+Ipv4FlowPathRouting::GetFlowPath (Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << destination);
+  std::unordered_map<uint32_t, Flow>::iterator it = m_flows.find (destination.Get ());
+  if (it == m_flows.end ())
+    {
+      return -1;
+    }
+  if (it->second.m_generation != g_generation)
+    {
+      SelectFlowPath (it->second);
+    }
+  return it->second.m_path == NO_PATH ? -1 : it->second.m_path;
+}
+
+bool
+Ipv4FlowPathRouting::IsPathUp (const Path &path)
+{
+  for (std::vector<Hop>::const_iterator hop = path.m_hops.begin (); hop != path.m_hops.end (); ++hop)
+    {
+      Ptr<Ipv4> ipv4 = NodeList::GetNode (hop->m_node)->GetObject<Ipv4> ();
+      Ptr<Ipv4> nextIpv4 = NodeList::GetNode (hop->m_nextNode)->GetObject<Ipv4> ();
+      if (!ipv4->IsUp (hop->m_interface) || !nextIpv4->IsUp (hop->m_nextInterface))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+Ipv4FlowPathRouting::SelectFlowPath (Flow &flow)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  flow.m_path = NO_PATH;
+  for (std::vector<uint32_t>::const_iterator it = flow.m_paths.begin (); it != flow.m_paths.end (); ++it)
+    {
+      if (IsPathUp (g_paths[*it]))
+        {
+          flow.m_path = *it;
+          break;
+        }
+    }
+  flow.m_generation = g_generation;
+  NS_LOG_LOGIC ("Selected path " << flow.m_path);
+}
+
+void
+Ipv4FlowPathRouting::UpdateForwardingEntries (void)
+{
+  uint32_t first = m_forwarding.size ();
+  if (first == g_paths.size ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  uint32_t nodeId = m_ipv4->GetObject<Node> ()->GetId ();
+  ForwardingEntry none;
+  none.m_interface = 0;
+  m_forwarding.resize (g_paths.size (), none);
+  for (uint32_t i = first; i < g_paths.size (); i++)
+    {
+      for (std::vector<Hop>::const_iterator hop = g_paths[i].m_hops.begin (); hop != g_paths[i].m_hops.end (); ++hop)
+        {
+          if (hop->m_node == nodeId && m_ipv4->GetNAddresses (hop->m_interface) > 0)
+            {
+              Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+              route->SetDestination (g_paths[i].m_destination);
+              route->SetGateway (hop->m_gateway);
+              route->SetSource (m_ipv4->GetAddress (hop->m_interface, 0).GetLocal ());
+              route->SetOutputDevice (m_ipv4->GetNetDevice (hop->m_interface));
+              m_forwarding[i].m_route = route;
+              m_forwarding[i].m_interface = hop->m_interface;
+              break;
+            }
+        }
+    }
+}
+
+Ptr<Ipv4Route>
+Ipv4FlowPathRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << p << header << oif);
+  std::unordered_map<uint32_t, Flow>::iterator it = m_flows.find (header.GetDestination ().Get ());
+  if (it == m_flows.end ())
+    {
+      NS_LOG_LOGIC ("No flow to " << header.GetDestination ());
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+  Flow &flow = it->second;
+  if (flow.m_generation != g_generation)
+    {
+      SelectFlowPath (flow);
+    }
+  if (flow.m_path == NO_PATH)
+    {
+      NS_LOG_LOGIC ("All the paths to " << header.GetDestination () << " are down");
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+  UpdateForwardingEntries ();
+  const ForwardingEntry &entry = m_forwarding[flow.m_path];
+  if (entry.m_route == 0 || (oif != 0 && oif != entry.m_route->GetOutputDevice ()))
+    {
+      NS_LOG_LOGIC ("Path " << flow.m_path << " does not start on the requested interface");
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+
+  if (p)
+    {
+      Ipv4FlowPathTag tag;
+      tag.SetPathIndex (flow.m_path);
+      // added if the packet has none yet
+      p->ReplacePacketTag (tag);
+    }
+  sockerr = Socket::ERROR_NOTERROR;
+  return entry.m_route;
+}
+
+bool
+Ipv4FlowPathRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p << header << idev);
+  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+
+  Ipv4FlowPathTag tag;
+  if (header.GetDestination ().IsMulticast () || !p->PeekPacketTag (tag))
+    {
+      return false; // Let other routing protocols try to handle this
+    }
+
+  if (m_ipv4->IsDestinationAddress (header.GetDestination (), iif))
+    {
+      NS_LOG_LOGIC ("For me (destination " << header.GetDestination () << " match)");
+      lcb (p, header, iif);
+      return true;
+    }
+  if (m_ipv4->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+
+  UpdateForwardingEntries ();
+  uint32_t pathIndex = tag.GetPathIndex ();
+  if (pathIndex >= m_forwarding.size () || m_forwarding[pathIndex].m_route == 0
+      || m_forwarding[pathIndex].m_route->GetDestination () != header.GetDestination ()
+      || !m_ipv4->IsUp (m_forwarding[pathIndex].m_interface))
+    {
+      NS_LOG_LOGIC ("No usable route of path " << pathIndex << " on this node");
+      return false;
+    }
+  NS_LOG_LOGIC ("Forwarding on path " << pathIndex);
+  ucb (m_forwarding[pathIndex].m_route, p, header);
+  return true;
+}
+
+void
+Ipv4FlowPathRouting::NotifyInterfaceUp (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  g_generation++;
+}
+
+void
+Ipv4FlowPathRouting::NotifyInterfaceDown (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  g_generation++;
+}
+
+void
+Ipv4FlowPathRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  // the source addresses of the routes may change
+  m_forwarding.clear ();
+}
+
+void
+Ipv4FlowPathRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  m_forwarding.clear ();
+}
+
+void
+Ipv4FlowPathRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+  NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
+  m_ipv4 = ipv4;
+}
+
+void
+Ipv4FlowPathRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
+{
+  NS_LOG_FUNCTION (this << stream);
+  std::ostream* os = stream->GetStream ();
+  uint32_t nodeId = m_ipv4->GetObject<Node> ()->GetId ();
+  *os << "Path    Destination     Gateway         Iface" << std::endl;
+  for (uint32_t i = 0; i < g_paths.size (); i++)
+    {
+      for (std::vector<Hop>::const_iterator hop = g_paths[i].m_hops.begin (); hop != g_paths[i].m_hops.end (); ++hop)
+        {
+          if (hop->m_node == nodeId)
+            {
+              std::ostringstream dest, gw;
+              dest << g_paths[i].m_destination;
+              gw << hop->m_gateway;
+              *os << std::setiosflags (std::ios::left) << std::setw (8) << i;
+              *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
+              *os << std::setiosflags (std::ios::left) << std::setw (16) << gw.str ();
+              if (Names::FindName (m_ipv4->GetNetDevice (hop->m_interface)) != "")
+                {
+                  *os << Names::FindName (m_ipv4->GetNetDevice (hop->m_interface));
+                }
+              else
+                {
+                  *os << hop->m_interface;
+                }
+              *os << std::endl;
+              break;
+            }
+        }
+    }
+
+  if (!m_flows.empty ())
+    {
+      *os << "Flow to         Paths" << std::endl;
+      for (std::unordered_map<uint32_t, Flow>::const_iterator it = m_flows.begin (); it != m_flows.end (); ++it)
+        {
+          std::ostringstream dest;
+          dest << Ipv4Address (it->first);
+          *os << std::setiosflags (std::ios::left) << std::setw (16) << dest.str ();
+          for (std::vector<uint32_t>::const_iterator path = it->second.m_paths.begin (); path != it->second.m_paths.end (); ++path)
+            {
+              *os << *path << " ";
+            }
+          *os << std::endl;
+        }
+    }
+  *os << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_FLOW_PATH_ROUTING_H
+#define IPV4_FLOW_PATH_ROUTING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Source routing of the flows declared before the simulation
+ *
+ * When all the flows of a scenario are known in advance, such as the
+ * PMU to PDC and WAC flows of the iCenS scenarios, their paths can be
+ * computed once instead of being looked up at each hop.  The paths are
+ * kept in a table shared by all the nodes, and are identified by their
+ * index in this table.  The source of a flow stamps the index of the
+ * path of the flow in an Ipv4FlowPathTag, and each node of the path
+ * forwards the packet with the route it holds at this index, without
+ * any routing table lookup.
+ *
+ * A flow has a set of paths in preference order.  The first path whose
+ * interfaces are all up is used, so that precomputed failover paths take
+ * over when links of the first path go down, and the first path is used
+ * again when they come back up.  The path is selected again only after
+ * an interface of a node goes up or down.
+ *
+ * Packets without the tag, to destinations which are not declared flows,
+ * or whose paths are all down, are left to the next routing protocols of
+ * an Ipv4ListRouting, in which this protocol should have a higher
+ * priority than the static and global routing.  The paths and the flows
+ * are usually set with the Ipv4FlowPathRoutingHelper.
+ */
+class Ipv4FlowPathRouting : public Ipv4RoutingProtocol
+{
+public:
+  /**
+   * \brief A hop of a path
+   */
+  struct Hop
+  {
+    uint32_t m_node;          //!< Id of the node sending on the hop
+    uint32_t m_interface;     //!< Output interface of the node
+    uint32_t m_nextNode;      //!< Id of the node receiving on the hop
+    uint32_t m_nextInterface; //!< Input interface of the next node
+    Ipv4Address m_gateway;    //!< Address of the input interface of the next node
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv4FlowPathRouting ();
+  virtual ~Ipv4FlowPathRouting ();
+
+  // These methods inherited from base class
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+  virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                            LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+
+  /**
+   * \brief Add a path to the table shared by all the nodes
+   *
+   * A node may appear only once in a path.
+   *
+   * \param destination the destination address of the packets sent on the path
+   * \param hops the hops of the path, from the source node to the node
+   * owning the destination address
+   * \returns the index of the path
+   */
+  static uint32_t AddPath (Ipv4Address destination, const std::vector<Hop> &hops);
+
+  /**
+   * \brief Get the number of paths of the table
+   * \returns the number of paths
+   */
+  static uint32_t GetNPaths (void);
+
+  /**
+   * \brief Get the hops of a path
+   * \param pathIndex the index of the path
+   * \returns the hops of the path
+   */
+  static const std::vector<Hop> &GetPath (uint32_t pathIndex);
+
+  /**
+   * \brief Declare a flow from this node
+   *
+   * A flow declared again replaces the previous one.
+   *
+   * \param destination the destination address of the flow
+   * \param paths the indexes of the paths of the flow, in preference order
+   */
+  void AddFlow (Ipv4Address destination, const std::vector<uint32_t> &paths);
+
+  /**
+   * \brief Get the path currently used by a flow from this node
+   * \param destination the destination address of the flow
+   * \returns the index of the path, or -1 if the flow is not declared or
+   * all its paths are down
+   */
+  int32_t GetFlowPath (Ipv4Address destination);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief A path of the shared table
+   */
+  struct Path
+  {
+    Ipv4Address m_destination; //!< Destination address of the path
+    std::vector<Hop> m_hops;   //!< Hops of the path
+  };
+
+  /**
+   * \brief A flow from this node
+   */
+  struct Flow
+  {
+    std::vector<uint32_t> m_paths; //!< Paths in preference order
+    uint32_t m_path;               //!< Path currently used
+    uint32_t m_generation;         //!< Value of g_generation when m_path was selected
+  };
+
+  /**
+   * \brief The route of a path through this node
+   */
+  struct ForwardingEntry
+  {
+    Ptr<Ipv4Route> m_route; //!< Route to the next node, null if the path does not go through this node
+    uint32_t m_interface;   //!< Output interface of the route
+  };
+
+  /**
+   * \brief Build the forwarding entries of the paths added since the last call
+   */
+  void UpdateForwardingEntries (void);
+
+  /**
+   * \brief Select the path of a flow
+   * \param flow the flow
+   */
+  static void SelectFlowPath (Flow &flow);
+
+  /**
+   * \brief Check whether the interfaces of a path are all up
+   * \param path the path
+   * \returns true if the interfaces of the path are all up
+   */
+  static bool IsPathUp (const Path &path);
+
+  static const uint32_t NO_PATH = 0xffffffff; //!< No path usable by a flow
+
+  static std::vector<Path> g_paths; //!< Paths shared by all the nodes
+  static uint32_t g_generation;     //!< Incremented when an interface of any node goes up or down
+
+  Ptr<Ipv4> m_ipv4; //!< IPv4 of this node
+  std::vector<ForwardingEntry> m_forwarding; //!< Forwarding entries, indexed by path
+  std::unordered_map<uint32_t, Flow> m_flows; //!< Flows from this node, by destination address
+};
+
+} // namespace ns3
+
+#endif /* IPV4_FLOW_PATH_ROUTING_H */
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-flow-path-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4FlowPathTag");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4FlowPathTag);
+
+Ipv4FlowPathTag::Ipv4FlowPathTag ()
+  : m_pathIndex (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4FlowPathTag::SetPathIndex (uint32_t pathIndex)
+{
+  NS_LOG_FUNCTION (this << pathIndex);
+  m_pathIndex = pathIndex;
+}
+
+uint32_t
+Ipv4FlowPathTag::GetPathIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_pathIndex;
+}
+
+TypeId
+Ipv4FlowPathTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4FlowPathTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4FlowPathTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+Ipv4FlowPathTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+Ipv4FlowPathTag::GetSerializedSize (void) const
+{
+  return sizeof (uint32_t);
+}
+
+void
+Ipv4FlowPathTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_pathIndex);
+}
+
+void
+Ipv4FlowPathTag::Deserialize (TagBuffer i)
+{
+  m_pathIndex = i.ReadU32 ();
+}
+
+void
+Ipv4FlowPathTag::Print (std::ostream &os) const
+{
+  os << "Flow path [PathIndex: " << m_pathIndex << "] ";
+}
+
+} // namespace ns3
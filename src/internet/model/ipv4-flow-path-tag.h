@@ -0,0 +1,65 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_FLOW_PATH_TAG_H
+#define IPV4_FLOW_PATH_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Index of the precomputed path of a packet
+ *
+ * Stamped by Ipv4FlowPathRouting at the source of a declared flow, and
+ * read by the nodes of the path to find the route of the packet.
+ */
+class Ipv4FlowPathTag : public Tag
+{
+public:
+  Ipv4FlowPathTag ();
+
+  /**
+   * \brief Set the index of the path
+   * \param pathIndex the index of the path in the table of Ipv4FlowPathRouting
+   */
+  void SetPathIndex (uint32_t pathIndex);
+  /**
+   * \brief Get the index of the path
+   * \returns the index of the path in the table of Ipv4FlowPathRouting
+   */
+  uint32_t GetPathIndex (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_pathIndex; //!< Index of the path
+};
+
+} // namespace ns3
+
+#endif /* IPV4_FLOW_PATH_TAG_H */
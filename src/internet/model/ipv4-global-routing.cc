@@ -29,6 +29,7 @@
 #include "ns3/boolean.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
+#include "ipv4-l3-protocol.h"
 
 namespace ns3 {
 
@@ -79,6 +80,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -89,6 +91,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -104,6 +107,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -117,6 +121,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 void 
@@ -132,6 +137,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  FlushRouteCache ();
 }
 
 
@@ -308,6 +314,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  FlushRouteCache ();
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -607,5 +614,15 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   m_ipv4 = ipv4;
 }
 
+void
+Ipv4GlobalRouting::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Ipv4L3Protocol> ipv4 = DynamicCast<Ipv4L3Protocol> (m_ipv4);
+  if (ipv4 != 0)
+    {
+      ipv4->FlushRouteCache ();
+    }
+}
 
 } // namespace ns3
@@ -23,6 +23,7 @@
 #include "ns3/log.h"
 #include "ns3/header.h"
 #include "ipv4-header.h"
+#include "ns3/packet-dissector.h"
 
 namespace ns3 {
 
@@ -30,6 +31,43 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4Header");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4Header);
 
+namespace {
+
+/**
+ * \brief Read the protocol number of an IPv4 header.
+ * \param header the Ipv4Header
+ * \param protocol the protocol number
+ * \returns true if the header following it is identified by \p protocol
+ */
+bool
+GetProtocol (const Header &header, uint32_t &protocol)
+{
+  const Ipv4Header &ip = static_cast<const Ipv4Header &> (header);
+  // Only the first fragment of a datagram holds the next header.
+  if (ip.GetFragmentOffset () != 0)
+    {
+      return false;
+    }
+  protocol = ip.GetProtocol ();
+  return true;
+}
+
+/**
+ * Registers the protocol numbers of Ipv4Header with the PacketDissector.
+ */
+struct Ipv4HeaderDissection
+{
+  Ipv4HeaderDissection ()
+  {
+    PacketDissector::RegisterHeader ("ns3::Ipv4Header", &GetProtocol);
+    PacketDissector::RegisterProtocol ("ns3::Ipv4Header", 17, "ns3::UdpHeader");
+    PacketDissector::RegisterProtocol ("ns3::Ipv4Header", 6, "ns3::TcpHeader");
+    PacketDissector::RegisterProtocol ("ns3::Ipv4Header", 1, "ns3::Icmpv4Header");
+  }
+} g_ipv4HeaderDissection; //!< Registers the protocol numbers at load time.
+
+} // anonymous namespace
+
 Ipv4Header::Ipv4Header ()
   : m_calcChecksum (false),
     m_payloadSize (0),
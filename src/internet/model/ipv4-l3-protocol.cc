@@ -39,6 +39,10 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-l4-protocol.h"
+#include "tcp-gso-tag.h"
+#include "tcp-gro-tag.h"
+#include "ipv4-flow-path-tag.h"
 
 namespace ns3 {
 
@@ -73,6 +77,31 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("IdentificationTableSize",
+                   "The maximum number of slots of the hash table of the "
+                   "identification counters, one for each {source, destination, "
+                   "protocol} tuple the node sends to.  When 3/4 of them are "
+                   "used, the new tuples share the counters.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_identificationTableSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Gro",
+                   "Coalesce the in-sequence TCP segments received "
+                   "at the same time before delivering them to TCP.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4L3Protocol::m_gro),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteCache",
+                   "Cache the route of the forwarded packets by destination, "
+                   "TOS and input interface, instead of asking the routing "
+                   "protocol for each packet.  The packets carrying a "
+                   "nix-vector or an Ipv4FlowPathTag, routed by "
+                   "Ipv4NixVectorRouting or Ipv4FlowPathRouting, bypass "
+                   "the cache.  Not to be used with random ECMP or with "
+                   "dynamic routing protocols (e.g., AODV, OLSR, DSDV).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4L3Protocol::m_routeCache),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx",
                      "Send ipv4 packet to outgoing interface.",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_txTrace),
@@ -112,6 +141,9 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_identificationUsed (0),
+    m_gro (false),
+    m_routeCache (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -206,6 +238,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  FlushRouteCache ();
 }
 
 
@@ -216,6 +249,22 @@ Ipv4L3Protocol::GetRoutingProtocol (void) const
   return m_routingProtocol;
 }
 
+void
+Ipv4L3Protocol::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_routeCacheEntries.empty ())
+    {
+      m_routeCacheEntries.clear ();
+    }
+}
+
+uint64_t
+Ipv4L3Protocol::GetRouteCacheKey (Ipv4Header const &ipHeader, uint32_t iif)
+{
+  return (uint64_t (ipHeader.GetDestination ().Get ()) << 32) | (uint64_t (ipHeader.GetTos ()) << 24) | iif;
+}
+
 void 
 Ipv4L3Protocol::DoDispose (void)
 {
@@ -234,22 +283,23 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  m_routeCacheEntries.clear ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
+      it->second->GetTimeoutEvent ().Cancel ();
       it->second = 0;
     }
 
-  for (MapFragmentsTimers_t::iterator it = m_fragmentsTimers.begin (); it != m_fragmentsTimers.end (); it++)
+  m_fragments.clear ();
+  m_identification.clear ();
+  m_identificationUsed = 0;
+
+  for (MapGro_t::iterator it = m_groEntries.begin (); it != m_groEntries.end (); it++)
     {
-      if (it->second.IsRunning ())
-        {
-          it->second.Cancel ();
-        }
+      it->second.m_flushEvent.Cancel ();
     }
-
-  m_fragments.clear ();
-  m_fragmentsTimers.clear ();
+  m_groEntries.clear ();
 
   Object::DoDispose ();
 }
@@ -531,9 +581,23 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
       socket->ForwardUp (packet, ipHeader, ipv4Interface);
     }
 
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4L3Protocol::IpForward, this);
+  Ipv4FlowPathTag flowPathTag;
+  // The packets carrying their own path (nix-vector, flow path) are never forwarded from the cache
+  if (m_routeCache && !packet->GetNixVector () && !packet->PeekPacketTag (flowPathTag))
+    {
+      RouteCache_t::const_iterator it = m_routeCacheEntries.find (GetRouteCacheKey (ipHeader, interface));
+      if (it != m_routeCacheEntries.end ())
+        {
+          NS_LOG_LOGIC ("Forwarding with the cached route");
+          DoIpForward (it->second, packet, ipHeader);
+          return;
+        }
+      ucb = MakeCallback (&Ipv4L3Protocol::IpForwardCache, this).Bind (interface);
+    }
+
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, ucb,
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
                                       MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
@@ -761,13 +825,11 @@ Ipv4L3Protocol::BuildHeader (
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
 
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (GetNextIdentification (srcDst, protocol));
     }
   else
     {
@@ -776,8 +838,7 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (GetNextIdentification (srcDst, protocol));
     }
   if (Node::ChecksumEnabled ())
     {
@@ -786,6 +847,57 @@ Ipv4L3Protocol::BuildHeader (
   return ipHeader;
 }
 
+uint16_t
+Ipv4L3Protocol::GetNextIdentification (uint64_t srcDst, uint8_t protocol)
+{
+  NS_LOG_FUNCTION (this << srcDst << (uint16_t)protocol);
+  if (m_identificationUsed * 4 >= m_identification.size () * 3
+      && m_identification.size () < m_identificationTableSize)
+    { // Grow the table, up to its maximum size
+      std::vector<IdentificationEntry> old;
+      old.swap (m_identification);
+      IdentificationEntry empty = { 0, 0, false, 0 };
+      m_identification.resize (std::min<uint32_t> (std::max<uint32_t> (8, old.size () * 2), m_identificationTableSize), empty);
+      for (std::vector<IdentificationEntry>::const_iterator it = old.begin (); it != old.end (); it++)
+        {
+          if (it->m_used)
+            {
+              uint32_t i = ((it->m_srcDst ^ it->m_protocol) * 0x9e3779b97f4a7c15ULL >> 32) % m_identification.size ();
+              while (m_identification[i].m_used)
+                {
+                  i = (i + 1) % m_identification.size ();
+                }
+              m_identification[i] = *it;
+            }
+        }
+    }
+
+  uint32_t home = ((srcDst ^ protocol) * 0x9e3779b97f4a7c15ULL >> 32) % m_identification.size ();
+  uint32_t i = home;
+  for (uint32_t probes = 0; probes < m_identification.size (); probes++, i = (i + 1) % m_identification.size ())
+    {
+      IdentificationEntry &entry = m_identification[i];
+      if (entry.m_used && entry.m_srcDst == srcDst && entry.m_protocol == protocol)
+        {
+          return entry.m_next++;
+        }
+      if (!entry.m_used)
+        {
+          if (m_identificationUsed * 4 < m_identification.size () * 3)
+            {
+              entry.m_srcDst = srcDst;
+              entry.m_protocol = protocol;
+              entry.m_used = true;
+              m_identificationUsed++;
+              return entry.m_next++;
+            }
+          break;
+        }
+    }
+  NS_LOG_LOGIC ("Identification table full, sharing the counter of slot " << home);
+  return m_identification[home].m_next++;
+}
+
 void
 Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
                              Ptr<Packet> packet,
@@ -798,6 +910,17 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), 0);
       return;
     }
+  TcpGsoTag gsoTag;
+  if (packet->RemovePacketTag (gsoTag))
+    { // Segment the TCP super-segment at the interface, the segments go down one by one
+      std::list<std::pair<Ptr<Packet>, Ipv4Header> > listSegments;
+      DoSegmentation (packet, ipHeader, gsoTag.GetSegmentSize (), listSegments);
+      for (std::list<std::pair<Ptr<Packet>, Ipv4Header> >::iterator it = listSegments.begin (); it != listSegments.end (); it++)
+        {
+          SendRealOut (route, it->first, it->second);
+        }
+      return;
+    }
   packet->AddHeader (ipHeader);
   Ptr<NetDevice> outDev = route->GetOutputDevice ();
   int32_t interface = GetInterfaceForDevice (outDev);
@@ -906,10 +1029,24 @@ void
 Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
 {
   NS_LOG_FUNCTION (this << rtentry << p << header);
+  DoIpForward (rtentry, p->Copy (), header);
+}
+
+void
+Ipv4L3Protocol::IpForwardCache (uint32_t iif, Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << iif << rtentry << p << header);
+  m_routeCacheEntries[GetRouteCacheKey (header, iif)] = rtentry;
+  DoIpForward (rtentry, p->Copy (), header);
+}
+
+void
+Ipv4L3Protocol::DoIpForward (Ptr<Ipv4Route> rtentry, Ptr<Packet> packet, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << packet << header);
   NS_LOG_LOGIC ("Forwarding logic for node: " << m_node->GetId ());
   // Forwarding
   Ipv4Header ipHeader = header;
-  Ptr<Packet> packet = p->Copy ();
   int32_t interface = GetInterfaceForDevice (rtentry->GetOutputDevice ());
   ipHeader.SetTtl (ipHeader.GetTtl () - 1);
   if (ipHeader.GetTtl () == 0)
@@ -951,6 +1088,17 @@ Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uin
       ipHeader.SetPayloadSize (p->GetSize () + ipHeader.GetSerializedSize ());
     }
 
+  if (m_gro && ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER && GroReceive (p, ipHeader, iif))
+    {
+      return;
+    }
+  LocalDeliverUp (p, ipHeader, iif);
+}
+
+void
+Ipv4L3Protocol::LocalDeliverUp (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << p << &ipHeader << iif);
   m_localDeliverTrace (ipHeader, p, iif);
 
   Ptr<IpL4Protocol> protocol = GetProtocol (ipHeader.GetProtocol ());
@@ -1003,6 +1151,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
     }
+  FlushRouteCache ();
   return retVal;
 }
 
@@ -1034,6 +1183,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
         }
+      FlushRouteCache ();
       return true;
     }
   return false;
@@ -1057,6 +1207,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
         }
+      FlushRouteCache ();
       return true;
     }
   return false;
@@ -1165,6 +1316,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
         {
           m_routingProtocol->NotifyInterfaceUp (i);
         }
+      FlushRouteCache ();
     }
   else
     {
@@ -1183,6 +1335,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
     {
       m_routingProtocol->NotifyInterfaceDown (ifaceIndex);
     }
+  FlushRouteCache ();
 }
 
 bool 
@@ -1200,6 +1353,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushRouteCache ();
 }
 
 Ptr<NetDevice>
@@ -1218,6 +1372,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  FlushRouteCache ();
 }
 
 bool 
@@ -1249,6 +1404,163 @@ Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeade
   m_dropTrace (ipHeader, p, DROP_ROUTE_ERROR, m_node->GetObject<Ipv4> (), 0);
 }
 
+void
+Ipv4L3Protocol::DoSegmentation (Ptr<Packet> packet, Ipv4Header const &ipHeader, uint16_t segmentSize,
+                                std::list<std::pair<Ptr<Packet>, Ipv4Header> >& listSegments)
+{
+  NS_LOG_FUNCTION (this << *packet << &ipHeader << segmentSize);
+  NS_ASSERT (ipHeader.GetProtocol () == TcpL4Protocol::PROT_NUMBER && segmentSize > 0);
+
+  TcpHeader tcpHeader;
+  packet->RemoveHeader (tcpHeader);
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+    }
+  tcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (), TcpL4Protocol::PROT_NUMBER);
+  uint8_t flags = tcpHeader.GetFlags ();
+
+  uint64_t src = ipHeader.GetSource ().Get ();
+  uint64_t dst = ipHeader.GetDestination ().Get ();
+
+  uint32_t size = packet->GetSize ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min<uint32_t> (segmentSize, size - offset);
+      Ptr<Packet> segment = packet->CreateFragment (offset, length);
+
+      TcpHeader segmentTcpHeader = tcpHeader;
+      segmentTcpHeader.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      if (offset + length < size)
+        {
+          segmentTcpHeader.SetFlags (flags & ~(TcpHeader::FIN | TcpHeader::PSH));
+        }
+      else
+        { // The FIN goes with the last segment, and the PSH flag tells the receive offload of the peer
+          segmentTcpHeader.SetFlags (flags | TcpHeader::PSH);
+        }
+      segment->AddHeader (segmentTcpHeader);
+
+      Ipv4Header segmentIpHeader = ipHeader;
+      segmentIpHeader.SetPayloadSize (segment->GetSize ());
+      if (offset > 0)
+        {
+          segmentIpHeader.SetIdentification (GetNextIdentification (dst | (src << 32), ipHeader.GetProtocol ()));
+        }
+      listSegments.push_back (std::make_pair (segment, segmentIpHeader));
+    }
+  NS_LOG_LOGIC ("Split " << size << " bytes into " << listSegments.size () << " segments");
+}
+
+bool
+Ipv4L3Protocol::GroReceive (Ptr<Packet> packet, Ipv4Header const &ipHeader, uint32_t iif)
+{
+  NS_LOG_FUNCTION (this << packet << &ipHeader << iif);
+
+  TcpHeader tcpHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+    }
+  tcpHeader.InitializeChecksum (ipHeader.GetSource (), ipHeader.GetDestination (), TcpL4Protocol::PROT_NUMBER);
+  packet->PeekHeader (tcpHeader);
+  uint32_t headerSize = tcpHeader.GetSerializedSize ();
+  uint32_t payloadSize = packet->GetSize () - headerSize;
+  uint8_t flags = tcpHeader.GetFlags ();
+
+  // Only data segments with nothing but ACK and PSH set are coalesced
+  bool mergeable = payloadSize > 0 && (flags & ~TcpHeader::PSH) == TcpHeader::ACK
+    && (!Node::ChecksumEnabled () || tcpHeader.IsChecksumOk ());
+  std::vector<uint8_t> options;
+  if (mergeable && headerSize > 20)
+    {
+      uint8_t buf[60];
+      packet->CopyData (buf, headerSize);
+      options.assign (buf + 20, buf + headerSize);
+    }
+
+  uint64_t addresses = (uint64_t (ipHeader.GetSource ().Get ()) << 32) | ipHeader.GetDestination ().Get ();
+  uint32_t ports = (uint32_t (tcpHeader.GetSourcePort ()) << 16) | tcpHeader.GetDestinationPort ();
+  std::pair<uint64_t, uint32_t> key = std::make_pair (addresses, ports);
+
+  MapGro_t::iterator it = m_groEntries.find (key);
+  if (it != m_groEntries.end ())
+    {
+      GroEntry &entry = it->second;
+      if (mergeable && entry.m_iif == iif
+          && tcpHeader.GetSequenceNumber () == entry.m_nextSeq
+          && tcpHeader.GetAckNumber () == entry.m_tcpHeader.GetAckNumber ()
+          && tcpHeader.GetWindowSize () == entry.m_tcpHeader.GetWindowSize ()
+          && options == entry.m_options
+          && entry.m_packet->GetSize () + payloadSize + headerSize + ipHeader.GetSerializedSize () <= 0xffff)
+        {
+          packet->RemoveAtStart (headerSize);
+          entry.m_packet->AddAtEnd (packet);
+          entry.m_nextSeq += payloadSize;
+          entry.m_segments++;
+          if (flags & TcpHeader::PSH)
+            {
+              entry.m_tcpHeader.SetFlags (entry.m_tcpHeader.GetFlags () | TcpHeader::PSH);
+              GroFlush (key);
+            }
+          return true;
+        }
+      // Deliver what was coalesced before this segment, to keep the order
+      GroFlush (key);
+    }
+
+  if (!mergeable || (flags & TcpHeader::PSH))
+    {
+      return false;
+    }
+  GroEntry &entry = m_groEntries[key];
+  packet->RemoveAtStart (headerSize);
+  entry.m_packet = packet;
+  entry.m_ipHeader = ipHeader;
+  entry.m_tcpHeader = tcpHeader;
+  entry.m_options = options;
+  entry.m_iif = iif;
+  entry.m_nextSeq = tcpHeader.GetSequenceNumber () + SequenceNumber32 (payloadSize);
+  entry.m_segments = 1;
+  // The segments already scheduled to arrive now are received before
+  // the flush: the burst is coalesced, but not held past its arrival.
+  entry.m_flushEvent = Simulator::ScheduleNow (&Ipv4L3Protocol::GroFlush, this, key);
+  return true;
+}
+
+void
+Ipv4L3Protocol::GroFlush (std::pair<uint64_t, uint32_t> key)
+{
+  NS_LOG_FUNCTION (this);
+  MapGro_t::iterator it = m_groEntries.find (key);
+  if (it == m_groEntries.end ())
+    {
+      return;
+    }
+  GroEntry entry = it->second;
+  m_groEntries.erase (it);
+  entry.m_flushEvent.Cancel ();
+
+  TcpHeader tcpHeader = entry.m_tcpHeader;
+  if (Node::ChecksumEnabled ())
+    {
+      tcpHeader.EnableChecksums ();
+    }
+  tcpHeader.InitializeChecksum (entry.m_ipHeader.GetSource (), entry.m_ipHeader.GetDestination (),
+                                TcpL4Protocol::PROT_NUMBER);
+  entry.m_packet->AddHeader (tcpHeader);
+  if (entry.m_segments > 1)
+    { // Tell TCP how many segments it receives at once
+      TcpGroTag groTag;
+      groTag.SetSegments (entry.m_segments);
+      entry.m_packet->AddPacketTag (groTag);
+    }
+  Ipv4Header ipHeader = entry.m_ipHeader;
+  ipHeader.SetPayloadSize (entry.m_packet->GetSize ());
+  NS_LOG_LOGIC ("Delivering " << entry.m_packet->GetSize () << " bytes coalesced from " << entry.m_segments << " segments");
+  LocalDeliverUp (entry.m_packet, ipHeader, entry.m_iif);
+}
+
 void
 Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, uint32_t outIfaceMtu, std::list<Ptr<Packet> >& listFragments)
 {
@@ -1363,9 +1675,9 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
     {
       fragments = Create<Fragments> ();
       m_fragments.insert (std::make_pair (key, fragments));
-      m_fragmentsTimers[key] = Simulator::Schedule (m_fragmentExpirationTimeout,
-                                                    &Ipv4L3Protocol::HandleFragmentsTimeout, this,
-                                                    key, ipHeader, iif);
+      fragments->SetTimeoutEvent (Simulator::Schedule (m_fragmentExpirationTimeout,
+                                                       &Ipv4L3Protocol::HandleFragmentsTimeout, this,
+                                                       key, ipHeader, iif));
     }
   else
     {
@@ -1379,14 +1691,13 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
-      fragments = 0;
-      m_fragments.erase (key);
-      if (m_fragmentsTimers[key].IsRunning ())
+      if (fragments->GetTimeoutEvent ().IsRunning ())
         {
           NS_LOG_LOGIC ("Stopping WaitFragmentsTimer at " << Simulator::Now ().GetSeconds () << " due to complete packet");
-          m_fragmentsTimers[key].Cancel ();
+          fragments->GetTimeoutEvent ().Cancel ();
         }
-      m_fragmentsTimers.erase (key);
+      fragments = 0;
+      m_fragments.erase (key);
       ret = true;
     }
 
@@ -1404,6 +1715,20 @@ Ipv4L3Protocol::Fragments::~Fragments ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4L3Protocol::Fragments::SetTimeoutEvent (EventId event)
+{
+  NS_LOG_FUNCTION (this);
+  m_timeoutEvent = event;
+}
+
+EventId
+Ipv4L3Protocol::Fragments::GetTimeoutEvent (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_timeoutEvent;
+}
+
 void
 Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
@@ -1550,6 +1875,5 @@ Ipv4L3Protocol::HandleFragmentsTimeout (std::pair<uint64_t, uint32_t> key, Ipv4H
   it->second = 0;
 
   m_fragments.erase (key);
-  m_fragmentsTimers.erase (key);
 }
 } // namespace ns3
@@ -23,6 +23,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
@@ -34,8 +35,10 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
+#include "ns3/tcp-header.h"
 
 class Ipv4L3ProtocolTestCase;
+class Ipv4IdentificationTestCase;
 
 namespace ns3 {
 
@@ -75,6 +78,33 @@ class Icmpv4L4Protocol;
  * Moreover, the actual implementation does not mimic exactly the Linux
  * kernel. Hence it is not possible, for instance, to test a fragmentation
  * attack.
+ *
+ * The segmentation and receive offloads of TCP are handled at this level
+ * too.  A TCP super-segment (see TcpGsoTag) is routed and traced by
+ * SendOutgoing once, and split into segments right before the interface:
+ * the Tx trace and the devices see each segment.  With the "Gro"
+ * attribute set, the in-sequence TCP segments of a flow received in the
+ * same burst, at the same time, are coalesced before being delivered to
+ * TCP: the Rx trace sees each segment, the LocalDeliver trace and TCP see
+ * the coalesced packet, tagged with the number of its segments (see
+ * TcpGroTag).  The coalesced packet is delivered when a segment with the
+ * PSH flag (the last one of a super-segment) or a segment which cannot be
+ * appended arrives, or at the end of the burst, by an event scheduled
+ * without delay: the segments are never held past their arrival time.
+ *
+ * With the "RouteCache" attribute set, the route found by the routing
+ * protocol for a forwarded packet is cached by destination, TOS and input
+ * interface, and the next packets of the flow are forwarded without
+ * asking the routing protocol again.  The cache is flushed when an
+ * interface goes up or down, when an address or the forwarding state of
+ * an interface changes, and when a route is added to or removed from
+ * Ipv4StaticRouting or Ipv4GlobalRouting.  The packets which carry
+ * their own path, a nix-vector (Ipv4NixVectorRouting) or an
+ * Ipv4FlowPathTag (Ipv4FlowPathRouting), bypass the cache: they are
+ * always handed to RouteInput.  Other routing protocols whose forwarding
+ * decisions depend on anything else (e.g., random ECMP), and dynamic
+ * protocols (e.g., AODV, OLSR or DSDV) must not be used with the cache,
+ * or must call FlushRouteCache when their routes change.
  */
 class Ipv4L3Protocol : public Ipv4
 {
@@ -114,6 +144,13 @@ public:
   void SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol);
   Ptr<Ipv4RoutingProtocol> GetRoutingProtocol (void) const;
 
+  /**
+   * \brief Forget the cached forwarding routes.
+   *
+   * To be called when the routes of the routing protocol change.
+   */
+  void FlushRouteCache (void);
+
   Ptr<Socket> CreateRawSocket (void);
   void DeleteRawSocket (Ptr<Socket> socket);
 
@@ -283,6 +320,7 @@ protected:
   virtual void NotifyNewAggregate ();
 private:
   friend class ::Ipv4L3ProtocolTestCase;
+  friend class ::Ipv4IdentificationTestCase;
 
   /**
    * \brief Copy constructor.
@@ -347,6 +385,30 @@ private:
              Ptr<const Packet> p, 
              const Ipv4Header &header);
 
+  /**
+   * \brief Forward a packet, and cache its route.
+   * \param iif input interface packet was received
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void
+  IpForwardCache (uint32_t iif,
+                  Ptr<Ipv4Route> rtentry,
+                  Ptr<const Packet> p,
+                  const Ipv4Header &header);
+
+  /**
+   * \brief Forward a packet the stack owns.
+   * \param rtentry route
+   * \param packet packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void
+  DoIpForward (Ptr<Ipv4Route> rtentry,
+               Ptr<Packet> packet,
+               const Ipv4Header &header);
+
   /**
    * \brief Forward a multicast packet.
    * \param mrtentry route
@@ -366,6 +428,14 @@ private:
    */
   void LocalDeliver (Ptr<const Packet> p, Ipv4Header const&ip, uint32_t iif);
 
+  /**
+   * \brief Deliver a reassembled or coalesced packet to its L4 protocol.
+   * \param p packet delivered
+   * \param ipHeader IPv4 header
+   * \param iif input interface packet was received
+   */
+  void LocalDeliverUp (Ptr<Packet> p, Ipv4Header const &ipHeader, uint32_t iif);
+
   /**
    * \brief Fallback when no route is found.
    * \param p packet
@@ -408,6 +478,31 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, uint32_t outIfaceMtu, std::list<Ptr<Packet> >& listFragments);
 
+  /**
+   * \brief Split a TCP super-segment into segments
+   * \param packet the super-segment, starting with its TCP header
+   * \param ipHeader the IP header of the super-segment
+   * \param segmentSize the payload size of the segments
+   * \param listSegments the list of the segments and of their IP header
+   */
+  void DoSegmentation (Ptr<Packet> packet, Ipv4Header const &ipHeader, uint16_t segmentSize,
+                       std::list<std::pair<Ptr<Packet>, Ipv4Header> >& listSegments);
+
+  /**
+   * \brief Coalesce a received TCP segment with the previous ones of its flow
+   * \param packet the segment, starting with its TCP header
+   * \param ipHeader the IP header
+   * \param iif Input Interface
+   * \return true if the segment is held, false if it must be delivered now
+   */
+  bool GroReceive (Ptr<Packet> packet, Ipv4Header const &ipHeader, uint32_t iif);
+
+  /**
+   * \brief Deliver the coalesced segments of a flow
+   * \param key the flow (src+dst addr, src+dst port)
+   */
+  void GroFlush (std::pair<uint64_t, uint32_t> key);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -444,9 +539,37 @@ private:
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   uint8_t m_defaultTos;  //!< Default TOS
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
   Ptr<Node> m_node; //!< Node attached to stack.
 
+  /**
+   * \brief The identification counter of a {src, dst, proto} tuple
+   */
+  struct IdentificationEntry
+  {
+    uint64_t m_srcDst;     //!< Source and destination addresses
+    uint8_t m_protocol;    //!< Protocol
+    bool m_used;           //!< Whether the slot holds a tuple
+    uint16_t m_next;       //!< Next identification
+  };
+
+  /**
+   * \brief Get the identification of the next packet of a {src, dst, proto} tuple.
+   *
+   * The counters are kept in an open addressing hash table, which grows
+   * up to m_identificationTableSize slots.  When it is full, the new
+   * tuples share the counter of the slot they hash to: the identifications
+   * of each tuple still never repeat before the counter wraps.
+   *
+   * \param srcDst source and destination addresses
+   * \param protocol protocol
+   * \returns the identification
+   */
+  uint16_t GetNextIdentification (uint64_t srcDst, uint8_t protocol);
+
+  std::vector<IdentificationEntry> m_identification; //!< Identification counters (for each {src, dst, proto} tuple)
+  uint32_t m_identificationUsed;      //!< Number of slots holding a tuple
+  uint32_t m_identificationTableSize; //!< Maximum number of slots
+
   /// Trace of sent packets
   TracedCallback<const Ipv4Header &, Ptr<const Packet>, uint32_t> m_sendOutgoingTrace;
   /// Trace of unicast forwarded packets
@@ -510,6 +633,18 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Set the expiration event.
+     * \param event the event clearing the fragments
+     */
+    void SetTimeoutEvent (EventId event);
+
+    /**
+     * \brief Get the expiration event.
+     * \return the event clearing the fragments
+     */
+    EventId GetTimeoutEvent (void) const;
+
 private:
     /**
      * \brief True if other fragments will be sent.
@@ -521,16 +656,68 @@ private:
      */
     std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
 
+    /**
+     * \brief The event clearing the fragments.
+     */
+    EventId m_timeoutEvent;
+
   };
 
-  /// Container of fragments, stored as pairs(src+dst addr, src+dst port) / fragment
-  typedef std::map< std::pair<uint64_t, uint32_t>, Ptr<Fragments> > MapFragments_t;
-  /// Container of fragment timeout event, stored as pairs(src+dst addr, src+dst port) / EventId
-  typedef std::map< std::pair<uint64_t, uint32_t>, EventId > MapFragmentsTimers_t;
+  /**
+   * \brief Hash function of the key of a fragmented packet.
+   */
+  struct FragmentsKeyHash
+  {
+    /**
+     * \param key the src+dst addr and the identification+proto
+     * \returns the hash
+     */
+    size_t operator() (const std::pair<uint64_t, uint32_t> &key) const
+    {
+      return (key.first ^ (key.first >> 32)) * 2654435761U + key.second;
+    }
+  };
 
-  MapFragments_t       m_fragments; //!< Fragmented packets.
+  /// Container of fragments, stored as pairs(src+dst addr, identification+proto) / fragment
+  typedef std::unordered_map< std::pair<uint64_t, uint32_t>, Ptr<Fragments>, FragmentsKeyHash> MapFragments_t;
+
+  MapFragments_t       m_fragments; //!< Fragmented packets, with their expiration event.
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
-  MapFragmentsTimers_t m_fragmentsTimers; //!< Expiration events.
+
+  /**
+   * \brief The TCP segments of a flow being coalesced
+   */
+  struct GroEntry
+  {
+    Ptr<Packet> m_packet;            //!< Coalesced payload
+    Ipv4Header m_ipHeader;           //!< IP header of the first segment
+    TcpHeader m_tcpHeader;           //!< TCP header of the first segment
+    std::vector<uint8_t> m_options;  //!< Serialized TCP options, which all the segments share
+    uint32_t m_iif;                  //!< Input interface
+    SequenceNumber32 m_nextSeq;      //!< Sequence number of the next segment
+    uint16_t m_segments;             //!< Number of segments coalesced
+    EventId m_flushEvent;            //!< Flush at the end of the receive burst
+  };
+
+  /// Container of coalesced segments, stored as pairs(src+dst addr, src+dst port) / entry
+  typedef std::map< std::pair<uint64_t, uint32_t>, GroEntry> MapGro_t;
+
+  bool     m_gro;             //!< Coalesce the received TCP segments
+  MapGro_t m_groEntries;      //!< Flows being coalesced
+
+  /**
+   * \brief Get the route cache key of a packet.
+   * \param ipHeader IPv4 header of the packet
+   * \param iif input interface packet was received
+   * \returns the key (destination address, TOS and input interface)
+   */
+  static uint64_t GetRouteCacheKey (Ipv4Header const &ipHeader, uint32_t iif);
+
+  /// Container of forwarding routes, by destination address, TOS and input interface
+  typedef std::unordered_map<uint64_t, Ptr<Ipv4Route> > RouteCache_t;
+
+  bool         m_routeCache;        //!< Cache the forwarding routes
+  RouteCache_t m_routeCacheEntries; //!< Cached forwarding routes
 
 };
 
@@ -33,6 +33,7 @@
 #include "ns3/output-stream-wrapper.h"
 #include "ipv4-static-routing.h"
 #include "ipv4-routing-table-entry.h"
+#include "ipv4-l3-protocol.h"
 
 using std::make_pair;
 
@@ -73,6 +74,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  FlushRouteCache ();
 }
 
 void 
@@ -87,6 +89,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  FlushRouteCache ();
 }
 
 void 
@@ -436,6 +439,7 @@ void
 Ipv4StaticRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  FlushRouteCache ();
   uint32_t tmp = 0;
   for (NetworkRoutesI j = m_networkRoutes.begin (); 
        j != m_networkRoutes.end (); 
@@ -779,4 +783,15 @@ Ipv4StaticRouting::SourceAddressSelection (uint32_t interfaceIdx, Ipv4Address de
   return candidate;
 }
 
+void
+Ipv4StaticRouting::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Ipv4L3Protocol> ipv4 = DynamicCast<Ipv4L3Protocol> (m_ipv4);
+  if (ipv4 != 0)
+    {
+      ipv4->FlushRouteCache ();
+    }
+}
+
 } // namespace ns3
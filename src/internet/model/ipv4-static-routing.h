@@ -425,6 +425,11 @@ private:
    */
   Ipv4Address SourceAddressSelection (uint32_t interface, Ipv4Address dest);
 
+  /**
+   * \brief Flush the route cache of the IPv4 stack, as the routes changed.
+   */
+  void FlushRouteCache (void);
+
   /**
    * \brief the forwarding table for network.
    */
@@ -26,6 +26,46 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+/**
+ * \param endPoint an end point
+ * \returns true if the end point is connected to a peer address and port
+ */
+static bool IsConnected (Ipv6EndPoint *endPoint)
+{
+  return endPoint->GetPeerAddress () != Ipv6Address::GetAny ()
+         && endPoint->GetPeerPort () != 0;
+}
+
+/**
+ * \brief Find the end point with the fewest wildcard addresses.
+ * \param endPoints the end points to look at
+ * \param genericity the number of wildcard addresses of generic, updated
+ * \param generic the end point found so far, updated
+ */
+static void FindGeneric (const std::list<Ipv6EndPoint *> &endPoints, uint32_t &genericity, Ipv6EndPoint *&generic)
+{
+  for (std::list<Ipv6EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      uint32_t tmp = 0;
+
+      if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
+        {
+          tmp++;
+        }
+
+      if ((*i)->GetPeerAddress () == Ipv6Address::GetAny ())
+        {
+          tmp++;
+        }
+
+      if (tmp < genericity)
+        {
+          generic = (*i);
+          genericity = tmp;
+        }
+    }
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
@@ -37,39 +77,99 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints endPoints = GetEndPoints ();
+  for (EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
       delete endPoint;
     }
-  m_endPoints.clear ();
+  m_ports.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+void Ipv6EndPointDemux::AddToIndex (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  PortEndPoints &port = m_ports[endPoint->GetLocalPort ()];
+  port.n++;
+  port.local[endPoint->GetLocalAddress ()]++;
+  if (IsConnected (endPoint))
     {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
+      Peer peer (endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      port.connected[peer].push_back (endPoint);
+    }
+  else
+    {
+      port.unconnected.push_back (endPoint);
     }
-  return false;
 }
 
-bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+Ipv6EndPointDemux::EndPoints *Ipv6EndPointDemux::GetIndexedEndPoints (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort)
 {
-  NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << localPort << peerAddress << peerPort);
+  static EndPoints empty;
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (localPort);
+  if (port == m_ports.end ())
+    {
+      return &empty;
+    }
+  if (peerAddress == Ipv6Address::GetAny () || peerPort == 0)
+    {
+      return &port->second.unconnected;
+    }
+  std::unordered_map<Peer, EndPoints, PeerHash>::iterator peer =
+    port->second.connected.find (Peer (peerAddress, peerPort));
+  if (peer == port->second.connected.end ())
     {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
+      return &empty;
+    }
+  return &peer->second;
+}
+
+void Ipv6EndPointDemux::RemoveFromIndex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (port != m_ports.end ());
+  if (IsConnected (endPoint))
+    {
+      Peer peer (endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      std::unordered_map<Peer, EndPoints, PeerHash>::iterator i = port->second.connected.find (peer);
+      NS_ASSERT (i != port->second.connected.end ());
+      i->second.remove (endPoint);
+      if (i->second.empty ())
         {
-          return true;
+          port->second.connected.erase (i);
         }
     }
-  return false;
+  else
+    {
+      port->second.unconnected.remove (endPoint);
+    }
+  std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash>::iterator local =
+    port->second.local.find (endPoint->GetLocalAddress ());
+  NS_ASSERT (local != port->second.local.end ());
+  if (--local->second == 0)
+    {
+      port->second.local.erase (local);
+    }
+  if (--port->second.n == 0)
+    {
+      m_ports.erase (port);
+    }
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
+}
+
+bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << addr << port);
+  std::unordered_map<uint16_t, PortEndPoints>::iterator entry = m_ports.find (port);
+  return entry != m_ports.end ()
+         && entry->second.local.find (addr) != entry->second.local.end ();
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -82,8 +182,9 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -97,8 +198,9 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -118,8 +220,9 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << GetEndPoints ().size () << "<< endpoints.");
   return endPoint;
 }
 
@@ -127,10 +230,10 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPoints *endPoints = GetIndexedEndPoints (localPort, peerAddress, peerPort);
+  for (EndPointsI i = endPoints->begin (); i != endPoints->end (); i++)
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
+      if ((*i)->GetLocalAddress () == localAddress
           && (*i)->GetPeerPort () == peerPort
           && (*i)->GetPeerAddress () == peerAddress)
         {
@@ -141,9 +244,10 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  endPoint->m_demux = this;
+  AddToIndex (endPoint);
 
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  NS_LOG_DEBUG ("Now have >>" << GetEndPoints ().size () << "<< endpoints.");
 
   return endPoint;
 }
@@ -151,15 +255,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
-    }
+  RemoveFromIndex (endPoint);
+  delete endPoint;
 }
 
 /*
@@ -179,99 +276,104 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      Ipv6EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
 
-      if (!endP->IsRxEnabled ())
+  /* Only the end points of the port which are not connected, and those
+     connected to the sender of the packet, can match. */
+  EndPoints *candidates[2];
+  candidates[0] = GetIndexedEndPoints (dport, Ipv6Address::GetAny (), 0);
+  candidates[1] = GetIndexedEndPoints (dport, saddr, sport);
+  for (uint32_t list = 0; list < 2; list++)
+    {
+      if (list == 1 && candidates[1] == candidates[0])
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
+          /* The sender has no address or port: no connected end point. */
+          break;
         }
-
-      if (endP->GetLocalPort () != dport)
+      for (EndPointsI i = candidates[list]->begin (); i != candidates[list]->end (); i++)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
+          Ipv6EndPoint* endP = *i;
 
-      if (endP->GetBoundNetDevice ())
-        {
-          if (!incomingInterface)
+          NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                                     << " daddr=" << endP->GetLocalAddress ()
+                                                     << " sport=" << endP->GetPeerPort ()
+                                                     << " saddr=" << endP->GetPeerAddress ());
+
+          if (!endP->IsRxEnabled ())
             {
+              NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                            << " because endpoint can not receive packets");
               continue;
             }
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+
+          if (endP->GetBoundNetDevice ())
             {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
+              if (!incomingInterface)
+                {
+                  continue;
+                }
+              if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+                {
+                  NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                                     << " because endpoint is bound to specific device and"
+                                                     << endP->GetBoundNetDevice ()
+                                                     << " does not match packet device " << incomingInterface->GetDevice ());
+                  continue;
+                }
             }
-        }
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
+          /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
+          NS_LOG_DEBUG ("dest addr " << daddr);
 
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+          bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+          bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+          bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
 
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
+          /* if no match here, keep looking */
+          if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+            {
+              continue;
+            }
+          bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+          bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+          bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+          bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
+
+          /* If remote does not match either with exact or wildcard,i
+             skip this one */
+          if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+            {
+              continue;
+            }
+          if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+            {
+              continue;
+            }
 
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
+          /* Now figure out which return list to add this one to */
+          if (localAddressMatchesWildCard
+              && remotePeerMatchesWildCard
+              && remoteAddressMatchesWildCard)
+            { /* Only local port matches exactly */
+              retval1.push_back (endP);
+            }
+          if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
+              && remotePeerMatchesWildCard
+              && remoteAddressMatchesWildCard)
+            { /* Only local port and local address matches exactly */
+              retval2.push_back (endP);
+            }
+          if (localAddressMatchesWildCard
+              && remotePeerMatchesExact
+              && remoteAddressMatchesExact)
+            { /* All but local address */
+              retval3.push_back (endP);
+            }
+          if (localAddressMatchesExact
+              && remotePeerMatchesExact
+              && remoteAddressMatchesExact)
+            { /* All 4 match */
+              retval4.push_back (endP);
+            }
         }
     }
 
@@ -293,40 +395,30 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
-  uint32_t genericity = 3;
-  Ipv6EndPoint *generic = 0;
-
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<uint16_t, PortEndPoints>::iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
     {
-      uint32_t tmp = 0;
-
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
+      return 0;
+    }
 
+  EndPoints *peerEndPoints = GetIndexedEndPoints (dport, src, sport);
+  for (EndPointsI i = peerEndPoints->begin (); i != peerEndPoints->end (); i++)
+    {
       if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
           && (*i)->GetPeerAddress () == src)
         {
           /* this is an exact match. */
           return *i;
         }
+    }
 
-      if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
-        {
-          tmp++;
-        }
-
-      if ((*i)->GetPeerAddress () == Ipv6Address::GetAny ())
-        {
-          tmp++;
-        }
-
-      if (tmp < genericity)
-        {
-          generic = (*i);
-          genericity = tmp;
-        }
+  uint32_t genericity = 3;
+  Ipv6EndPoint *generic = 0;
+  FindGeneric (port->second.unconnected, genericity, generic);
+  for (std::unordered_map<Peer, EndPoints, PeerHash>::iterator j = port->second.connected.begin ();
+       j != port->second.connected.end (); j++)
+    {
+      FindGeneric (j->second, genericity, generic);
     }
   return generic;
 }
@@ -355,7 +447,18 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints ret;
+  for (std::unordered_map<uint16_t, PortEndPoints>::const_iterator port = m_ports.begin ();
+       port != m_ports.end (); port++)
+    {
+      ret.insert (ret.end (), port->second.unconnected.begin (), port->second.unconnected.end ());
+      for (std::unordered_map<Peer, EndPoints, PeerHash>::const_iterator j = port->second.connected.begin ();
+           j != port->second.connected.end (); j++)
+        {
+          ret.insert (ret.end (), j->second.begin (), j->second.end ());
+        }
+    }
+  return ret;
 }
 
 } /* namespace ns3 */
@@ -23,8 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <utility>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
-#include "ipv6-interface.h"
+#include "ns3/ipv6-interface.h"
 
 namespace ns3 {
 
@@ -33,6 +35,10 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * The endpoints are indexed by local port and, within a port, the
+ * endpoints connected to a peer address and port are hashed by peer,
+ * as in Ipv4EndPointDemux.
  */
 class Ipv6EndPointDemux
 {
@@ -87,6 +93,10 @@ public:
 
   /**
    * \brief Simple lookup for a four-tuple match.
+   *
+   * Only the end points of the port which are not connected, and those
+   * connected to the source address and port, are looked at.
+   *
    * \param dst destination address to test
    * \param dport destination port to test
    * \param src source address to test
@@ -146,6 +156,30 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Add an end point to the index of its local port.
+   * \param endPoint the end point
+   */
+  void AddToIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the index of its local port.
+   * \param endPoint the end point
+   */
+  void RemoveFromIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Get the end points of a local port connected to a peer.
+   * \param localPort the local port
+   * \param peerAddress the peer address, or the wildcard address
+   * \param peerPort the peer port, or 0
+   * \return the end points connected to the peer, or the end points
+   * which are not connected if the peer address or port is a wildcard
+   */
+  EndPoints *GetIndexedEndPoints (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -168,9 +202,40 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief A peer address and port.
+   */
+  typedef std::pair<Ipv6Address, uint16_t> Peer;
+
+  /**
+   * \brief Hash function of a peer address and port.
+   */
+  struct PeerHash
+  {
+    /**
+     * \param peer the peer address and port
+     * \returns the hash
+     */
+    size_t operator() (const Peer &peer) const
+    {
+      return Ipv6AddressHash () (peer.first) * 31 + peer.second;
+    }
+  };
+
+  /**
+   * \brief The end points of a local port.
+   */
+  struct PortEndPoints
+  {
+    EndPoints unconnected;  //!< End points with a wildcard peer address or port
+    std::unordered_map<Peer, EndPoints, PeerHash> connected;  //!< Connected end points, by peer
+    std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash> local;  //!< Number of end points, by local address
+    uint32_t n;             //!< Number of end points
+  };
+
+  /**
+   * \brief The end points, by local port.
    */
-  EndPoints m_endPoints;
+  std::unordered_map<uint16_t, PortEndPoints> m_ports;
 };
 
 } /* namespace ns3 */
@@ -24,6 +24,7 @@
 
 #include "ns3/address-utils.h"
 #include "ipv6-header.h"
+#include "ns3/packet-dissector.h"
 
 namespace ns3 {
 
@@ -31,6 +32,37 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6Header");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv6Header);
 
+namespace {
+
+/**
+ * \brief Read the protocol number of an IPv6 header.
+ * \param header the Ipv6Header
+ * \param protocol the protocol number
+ * \returns true if the header following it is identified by \p protocol
+ */
+bool
+GetNextHeader (const Header &header, uint32_t &protocol)
+{
+  protocol = static_cast<const Ipv6Header &> (header).GetNextHeader ();
+  return true;
+}
+
+/**
+ * Registers the protocol numbers of Ipv6Header with the PacketDissector.
+ */
+struct Ipv6HeaderDissection
+{
+  Ipv6HeaderDissection ()
+  {
+    PacketDissector::RegisterHeader ("ns3::Ipv6Header", &GetNextHeader);
+    PacketDissector::RegisterProtocol ("ns3::Ipv6Header", 17, "ns3::UdpHeader");
+    PacketDissector::RegisterProtocol ("ns3::Ipv6Header", 6, "ns3::TcpHeader");
+    PacketDissector::RegisterProtocol ("ns3::Ipv6Header", 58, "ns3::Icmpv6Header");
+  }
+} g_ipv6HeaderDissection; //!< Registers the protocol numbers at load time.
+
+} // anonymous namespace
+
 Ipv6Header::Ipv6Header ()
   : m_version (6),
     m_trafficClass (0),
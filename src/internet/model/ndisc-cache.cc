@@ -57,13 +57,13 @@ NdiscCache::NdiscCache ()
 NdiscCache::~NdiscCache ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Flush ();
+  RemoveAll ();
 }
 
 void NdiscCache::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Flush ();
+  RemoveAll ();
   m_device = 0;
   m_interface = 0;
   Object::DoDispose ();
@@ -92,10 +92,10 @@ NdiscCache::Entry* NdiscCache::Lookup (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_ndCache.find (dst) != m_ndCache.end ())
+  CacheI it = m_ndCache.find (dst);
+  if (it != m_ndCache.end ())
     {
-      NdiscCache::Entry* entry = m_ndCache[dst];
-      return entry;
+      return it->second;
     }
   return 0;
 }
@@ -131,6 +131,22 @@ void NdiscCache::Flush ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
+  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); )
+    {
+      if ((*i).second->IsPermanent ())
+        {
+          i++;
+          continue;
+        }
+      delete (*i).second; /* delete the pointer NdiscCache::Entry */
+      m_ndCache.erase (i++);
+    }
+}
+
+void NdiscCache::RemoveAll ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
   for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
     {
       delete (*i).second; /* delete the pointer NdiscCache::Entry */
@@ -187,6 +203,10 @@ void NdiscCache::PrintNdiscCache (Ptr<OutputStreamWrapper> stream)
         {
           *os << " PROBE\n";
         }
+      else if (i->second->IsPermanent ())
+        {
+          *os << " PERMANENT\n";
+        }
       else
         {
           *os << " STALE\n";
@@ -495,6 +515,15 @@ void NdiscCache::Entry::MarkDelay ()
   m_state = DELAY;
 }
 
+void NdiscCache::Entry::MarkPermanent (Address mac)
+{
+  NS_LOG_FUNCTION (this << mac);
+  NS_ASSERT (m_waiting.empty ());
+  StopNudTimer ();
+  m_state = PERMANENT;
+  m_macAddress = mac;
+}
+
 bool NdiscCache::Entry::IsStale () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -525,6 +554,12 @@ bool NdiscCache::Entry::IsProbe () const
   return (m_state == PROBE);
 }
 
+bool NdiscCache::Entry::IsPermanent () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return (m_state == PERMANENT);
+}
+
 Address NdiscCache::Entry::GetMacAddress () const
 {
   NS_LOG_FUNCTION_NOARGS ();
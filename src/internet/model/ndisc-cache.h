@@ -101,7 +101,10 @@ public:
   void Remove (NdiscCache::Entry* entry);
 
   /**
-   * \brief Flush the cache.
+   * \brief Flush the cache, except the PERMANENT entries.
+   *
+   * The static neighbors (e.g., those of NeighborCacheHelper) survive
+   * the interface going down, as in the ARP caches.
    */
   void Flush ();
 
@@ -184,6 +187,17 @@ public:
      */
     void MarkDelay ();
 
+    /**
+     * \brief Change the state to this entry to PERMANENT.
+     *
+     * A permanent entry has no NUD timer and is not changed by the
+     * Neighbor Discovery messages received.  Flush keeps it, it is only
+     * removed by Remove or when the cache is disposed.
+     *
+     * \param mac L2 address
+     */
+    void MarkPermanent (Address mac);
+
     /**
      * \brief Add a packet (or replace old value) in the queue.
      * \param p packet to add
@@ -225,6 +239,12 @@ public:
      */
     bool IsProbe () const;
 
+    /**
+     * \brief Is the entry PERMANENT
+     * \return true if the entry is in PERMANENT state, false otherwise
+     */
+    bool IsPermanent () const;
+
     /**
      * \brief Get the MAC address of this entry.
      * \return the L2 address
@@ -328,7 +348,8 @@ private:
       REACHABLE, /**< Mapping exists between IPv6 and L2 addresses */
       STALE, /**< Mapping is stale */
       DELAY, /**< Try to wait contact from remote host */
-      PROBE /**< Try to contact IPv6 address to know again its L2 address */
+      PROBE, /**< Try to contact IPv6 address to know again its L2 address */
+      PERMANENT /**< Static mapping between IPv6 and L2 addresses */
     };
 
     /**
@@ -402,6 +423,11 @@ private:
    */
   void DoDispose ();
 
+  /**
+   * \brief Remove all the entries, the PERMANENT ones included.
+   */
+  void RemoveAll ();
+
   /**
    * \brief The NetDevice.
    */
@@ -0,0 +1,400 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * PIE, the Proportional Integral controller Enhanced queueing
+ * discipline (RFC 8033).
+ */
+
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "pie-queue.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PieQueue");
+
+NS_OBJECT_ENSURE_REGISTERED (PieQueue);
+
+TypeId PieQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PieQueue")
+    .SetParent<Queue> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<PieQueue> ()
+    .AddAttribute ("Mode",
+                   "Whether to use Bytes (see MaxBytes) or Packets (see MaxPackets) as the maximum queue size metric.",
+                   EnumValue (QUEUE_MODE_PACKETS),
+                   MakeEnumAccessor (&PieQueue::SetMode,
+                                     &PieQueue::GetMode),
+                   MakeEnumChecker (QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                                    QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of packets accepted by this PieQueue.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&PieQueue::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxBytes",
+                   "The maximum number of bytes accepted by this PieQueue.",
+                   UintegerValue (1500 * 1000),
+                   MakeUintegerAccessor (&PieQueue::m_maxBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MeanPktSize",
+                   "Average of packet size, used to scale the drop probability in byte mode",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&PieQueue::m_meanPktSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("A",
+                   "Weight of the deviation of the queueing delay from its reference",
+                   DoubleValue (0.125),
+                   MakeDoubleAccessor (&PieQueue::m_a),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("B",
+                   "Weight of the variation of the queueing delay",
+                   DoubleValue (1.25),
+                   MakeDoubleAccessor (&PieQueue::m_b),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Tupdate",
+                   "Period of the drop probability update",
+                   StringValue ("15ms"),
+                   MakeTimeAccessor (&PieQueue::m_tUpdate),
+                   MakeTimeChecker ())
+    .AddAttribute ("QueueDelayReference",
+                   "Target queueing delay",
+                   StringValue ("15ms"),
+                   MakeTimeAccessor (&PieQueue::m_qDelayRef),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxBurstAllowance",
+                   "Length of the bursts let through without random drops",
+                   StringValue ("150ms"),
+                   MakeTimeAccessor (&PieQueue::m_maxBurst),
+                   MakeTimeChecker ())
+    .AddAttribute ("DequeueThreshold",
+                   "Minimum backlog, in bytes, to measure the departure rate",
+                   UintegerValue (16384),
+                   MakeUintegerAccessor (&PieQueue::m_dqThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("DropProbability",
+                     "PIE drop probability",
+                     MakeTraceSourceAccessor (&PieQueue::m_dropProb),
+                     "ns3::TracedValue::DoubleCallback")
+  ;
+
+  return tid;
+}
+
+PieQueue::PieQueue ()
+  : Queue (),
+    m_packets (),
+    m_bytesInQueue (0),
+    m_dropProb (0),
+    m_qDelay (Seconds (0)),
+    m_qDelayOld (Seconds (0)),
+    m_burstAllowance (Seconds (0)),
+    m_avgDqRate (0),
+    m_inMeasurement (false),
+    m_dqCount (0),
+    m_dqStart (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+  m_stats.unforcedDrop = 0;
+  m_stats.forcedDrop = 0;
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+PieQueue::~PieQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PieQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = 0;
+  m_rtrsEvent.Cancel ();
+  Queue::DoDispose ();
+}
+
+void
+PieQueue::SetMode (PieQueue::QueueMode mode)
+{
+  NS_LOG_FUNCTION (this << mode);
+  m_mode = mode;
+}
+
+PieQueue::QueueMode
+PieQueue::GetMode (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_mode;
+}
+
+uint32_t
+PieQueue::GetQueueSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetMode () == QUEUE_MODE_BYTES)
+    {
+      return m_bytesInQueue;
+    }
+  else if (GetMode () == QUEUE_MODE_PACKETS)
+    {
+      return m_packets.size ();
+    }
+  else
+    {
+      NS_ABORT_MSG ("Unknown mode.");
+    }
+}
+
+PieQueue::Stats
+PieQueue::GetStats (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_stats;
+}
+
+double
+PieQueue::GetDropProbability (void) const
+{
+  return m_dropProb;
+}
+
+Time
+PieQueue::GetQueueDelay (void) const
+{
+  return m_qDelay;
+}
+
+int64_t
+PieQueue::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+bool
+PieQueue::DoEnqueue (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  uint32_t packetSize = p->GetSize ();
+  if ((m_mode == QUEUE_MODE_PACKETS && (m_packets.size () >= m_maxPackets))
+      || (m_mode == QUEUE_MODE_BYTES && (m_bytesInQueue + packetSize > m_maxBytes)))
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      m_stats.forcedDrop++;
+      Drop (p);
+      return false;
+    }
+
+  if (!m_rtrsEvent.IsRunning ())
+    {
+      // The queue was idle: restart the periodic update.
+      NS_LOG_LOGIC ("Starting the drop probability updates");
+      m_burstAllowance = m_maxBurst;
+      m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueue::CalculateP, this);
+    }
+
+  if (DropEarly (packetSize))
+    {
+      NS_LOG_LOGIC ("Early drop -- dropping pkt");
+      m_stats.unforcedDrop++;
+      Drop (p);
+      return false;
+    }
+
+  m_bytesInQueue += packetSize;
+  m_packets.push (p);
+
+  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
+
+  return true;
+}
+
+bool
+PieQueue::DropEarly (uint32_t packetSize)
+{
+  NS_LOG_FUNCTION (this << packetSize);
+
+  if (m_burstAllowance.IsStrictlyPositive ())
+    {
+      // Let the bursts through.
+      return false;
+    }
+  if (m_qDelayOld.GetSeconds () < m_qDelayRef.GetSeconds () / 2 && m_dropProb < 0.2)
+    {
+      return false;
+    }
+  if (m_bytesInQueue < 2 * m_meanPktSize)
+    {
+      return false;
+    }
+
+  double p = m_dropProb;
+  if (m_mode == QUEUE_MODE_BYTES)
+    {
+      p = std::min (p * packetSize / m_meanPktSize, 1.0);
+    }
+  return m_uv->GetValue () < p;
+}
+
+void
+PieQueue::CalculateP (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  double qDelay = m_avgDqRate > 0 ? m_bytesInQueue / m_avgDqRate : 0;
+  double qDelayOld = m_qDelayOld.GetSeconds ();
+  double qDelayRef = m_qDelayRef.GetSeconds ();
+  double p = m_a * (qDelay - qDelayRef) + m_b * (qDelay - qDelayOld);
+
+  // Auto-tuning: the smaller the drop probability, the smaller its
+  // adjustments.
+  double dropProb = m_dropProb;
+  if (dropProb < 0.000001)
+    {
+      p /= 2048;
+    }
+  else if (dropProb < 0.00001)
+    {
+      p /= 512;
+    }
+  else if (dropProb < 0.0001)
+    {
+      p /= 128;
+    }
+  else if (dropProb < 0.001)
+    {
+      p /= 32;
+    }
+  else if (dropProb < 0.01)
+    {
+      p /= 8;
+    }
+  else if (dropProb < 0.1)
+    {
+      p /= 2;
+    }
+  else if (p > 0.02)
+    {
+      // Do not jump by more than 2% at once.
+      p = 0.02;
+    }
+
+  dropProb += p;
+  if (qDelay == 0 && qDelayOld == 0)
+    {
+      // Decay the drop probability while the queue is idle.
+      dropProb *= 0.98;
+    }
+  dropProb = std::max (0.0, std::min (dropProb, 1.0));
+  m_dropProb = dropProb;
+
+  m_burstAllowance = std::max (Seconds (0), m_burstAllowance - m_tUpdate);
+  if (dropProb == 0 && qDelay < qDelayRef / 2 && qDelayOld < qDelayRef / 2)
+    {
+      m_burstAllowance = m_maxBurst;
+    }
+
+  m_qDelayOld = m_qDelay = Seconds (qDelay);
+
+  NS_LOG_LOGIC ("Queue delay " << qDelay << " drop probability " << dropProb);
+
+  if (m_packets.empty () && dropProb == 0 && qDelay == 0)
+    {
+      // Nothing left to control: the updates restart with the next packet.
+      NS_LOG_LOGIC ("Stopping the drop probability updates");
+      return;
+    }
+  m_rtrsEvent = Simulator::Schedule (m_tUpdate, &PieQueue::CalculateP, this);
+}
+
+Ptr<Packet>
+PieQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_packets.empty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Time now = Simulator::Now ();
+  Ptr<Packet> p = m_packets.front ();
+  uint32_t packetSize = p->GetSize ();
+
+  // Start a measurement of the departure rate once enough bytes are
+  // waiting for the measurement to be meaningful.
+  if (m_bytesInQueue >= m_dqThreshold && !m_inMeasurement)
+    {
+      m_dqStart = now;
+      m_dqCount = 0;
+      m_inMeasurement = true;
+    }
+
+  m_packets.pop ();
+  m_bytesInQueue -= packetSize;
+
+  if (m_inMeasurement)
+    {
+      m_dqCount += packetSize;
+      if (m_dqCount >= m_dqThreshold)
+        {
+          double elapsed = (now - m_dqStart).GetSeconds ();
+          if (elapsed > 0)
+            {
+              double rate = m_dqCount / elapsed;
+              m_avgDqRate = m_avgDqRate == 0 ? rate : 0.5 * m_avgDqRate + 0.5 * rate;
+              NS_LOG_LOGIC ("Departure rate " << m_avgDqRate);
+            }
+          m_dqStart = now;
+          m_dqCount = 0;
+          m_inMeasurement = m_bytesInQueue >= m_dqThreshold;
+        }
+    }
+
+  NS_LOG_LOGIC ("Popped " << p);
+  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
+
+  return p;
+}
+
+Ptr<const Packet>
+PieQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_packets.empty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_packets.front ();
+}
+
+} // namespace ns3
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * PIE, the Proportional Integral controller Enhanced queueing
+ * discipline (RFC 8033).
+ */
+
+#ifndef PIE_QUEUE_H
+#define PIE_QUEUE_H
+
+#include <queue>
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A PIE packet queue
+ *
+ * Packets are dropped at random on arrival with a probability updated
+ * every Tupdate by a proportional integral controller, so as to keep
+ * the queueing delay, estimated from the backlog and the measured
+ * departure rate, close to QueueDelayReference.  The periodic update
+ * is only scheduled while the queue is in use: it stops once the queue
+ * is empty and the drop probability has decayed to zero.
+ */
+class PieQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief PieQueue Constructor
+   */
+  PieQueue ();
+
+  virtual ~PieQueue ();
+
+  /**
+   * \brief Stats
+   */
+  typedef struct
+  {
+    uint32_t unforcedDrop;  //!< Early probability drops
+    uint32_t forcedDrop;    //!< Drops due to queue limits
+  } Stats;
+
+  /**
+   * \brief Set the operating mode of this queue.
+   *
+   * \param mode The operating mode of this queue.
+   */
+  void SetMode (PieQueue::QueueMode mode);
+
+  /**
+   * \brief Get the operating mode of this queue.
+   *
+   * \returns The operating mode of this queue.
+   */
+  PieQueue::QueueMode GetMode (void) const;
+
+  /**
+   * \brief Get the current value of the queue in bytes or packets.
+   *
+   * \returns The queue size in bytes or packets.
+   */
+  uint32_t GetQueueSize (void) const;
+
+  /**
+   * \brief Get the PIE statistics after running.
+   *
+   * \returns The drop statistics.
+   */
+  Stats GetStats (void) const;
+
+  /**
+   * \brief Get the current drop probability.
+   *
+   * \returns The drop probability
+   */
+  double GetDropProbability (void) const;
+
+  /**
+   * \brief Get the current estimate of the queueing delay.
+   *
+   * \returns The queueing delay
+   */
+  Time GetQueueDelay (void) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<Packet> p);
+  virtual Ptr<Packet> DoDequeue (void);
+  virtual Ptr<const Packet> DoPeek (void) const;
+
+  /**
+   * \brief Check whether an arriving packet must be dropped at random.
+   *
+   * \param packetSize The size of the arriving packet, in bytes
+   * \returns True if the packet must be dropped
+   */
+  bool DropEarly (uint32_t packetSize);
+
+  /**
+   * \brief Update the drop probability, every Tupdate.
+   */
+  void CalculateP (void);
+
+  std::queue<Ptr<Packet> > m_packets;     //!< The packet queue
+  QueueMode m_mode;                       //!< The operating mode (Bytes or packets)
+  uint32_t m_maxPackets;                  //!< Max # of packets accepted by the queue
+  uint32_t m_maxBytes;                    //!< Max # of bytes accepted by the queue
+  uint32_t m_bytesInQueue;                //!< The total number of bytes in queue
+  uint32_t m_meanPktSize;                 //!< Average packet size, in bytes
+  double m_a;                             //!< Weight of the delay error
+  double m_b;                             //!< Weight of the delay trend
+  Time m_tUpdate;                         //!< Period of the drop probability update
+  Time m_qDelayRef;                       //!< Target queueing delay
+  Time m_maxBurst;                        //!< Maximum burst allowance
+  uint32_t m_dqThreshold;                 //!< Minimum backlog, in bytes, to measure the departure rate
+
+  TracedValue<double> m_dropProb;         //!< Drop probability
+  Time m_qDelay;                          //!< Current queueing delay estimate
+  Time m_qDelayOld;                       //!< Previous queueing delay estimate
+  Time m_burstAllowance;                  //!< Remaining burst allowance
+  double m_avgDqRate;                     //!< Average departure rate, in bytes per second
+  bool m_inMeasurement;                   //!< True while measuring the departure rate
+  uint32_t m_dqCount;                     //!< Bytes departed during the current measurement
+  Time m_dqStart;                         //!< Start of the current measurement
+  EventId m_rtrsEvent;                    //!< Next update of the drop probability
+  Stats m_stats;                          //!< PIE statistics
+  Ptr<UniformRandomVariable> m_uv;        //!< Rng stream
+};
+
+} // namespace ns3
+
+#endif /* PIE_QUEUE_H */
@@ -0,0 +1,428 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/abort.h"
+#include "prio-queue.h"
+#include "ip-header-bytes.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PrioQueue");
+
+/** The maximum number of bands, the number of bits of the band bitmap */
+static const uint32_t MAX_BANDS = 32;
+
+/**
+ * \param mask a non-zero bitmap
+ * \returns the index of the least significant bit set in \p mask
+ */
+static inline uint32_t
+FindFirstSet (uint32_t mask)
+{
+#ifdef __GNUC__
+  return __builtin_ctz (mask);
+#else
+  uint32_t i = 0;
+  while (!(mask & 1))
+    {
+      mask >>= 1;
+      i++;
+    }
+  return i;
+#endif
+}
+
+/**
+ * Parses a list of "key:value" pairs.
+ * \param list the space-separated list
+ * \param name the attribute holding the list, for the error messages
+ * \returns the pairs
+ */
+static std::vector<std::pair<uint32_t, uint32_t> >
+ParsePairs (const std::string &list, const char *name)
+{
+  std::vector<std::pair<uint32_t, uint32_t> > pairs;
+  std::istringstream iss (list);
+  std::string item;
+  while (iss >> item)
+    {
+      std::istringstream pair (item);
+      uint32_t key, value;
+      char colon;
+      pair >> key >> colon >> value;
+      NS_ABORT_MSG_IF (pair.fail () || colon != ':', "PrioQueue: invalid " << name << " entry " << item);
+      pairs.push_back (std::make_pair (key, value));
+    }
+  return pairs;
+}
+
+/**
+ * Parses a list of numbers, one per band.
+ * \param list the space-separated list
+ * \param name the attribute holding the list, for the error messages
+ * \returns the numbers
+ */
+static std::vector<uint32_t>
+ParseValues (const std::string &list, const char *name)
+{
+  std::vector<uint32_t> values;
+  std::istringstream iss (list);
+  std::string item;
+  while (iss >> item)
+    {
+      std::istringstream value (item);
+      uint32_t v;
+      value >> v;
+      NS_ABORT_MSG_IF (value.fail (), "PrioQueue: invalid " << name << " entry " << item);
+      values.push_back (v);
+    }
+  return values;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PrioQueue);
+
+TypeId PrioQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PrioQueue")
+    .SetParent<Queue> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<PrioQueue> ()
+    .AddAttribute ("Bands",
+                   "The number of bands, band 0 having the highest priority.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&PrioQueue::m_nBands),
+                   MakeUintegerChecker<uint32_t> (1, MAX_BANDS))
+    .AddAttribute ("Classifier",
+                   "Whether packets are classified by DSCP or by iCenS traffic class.",
+                   EnumValue (CLASSIFY_DSCP),
+                   MakeEnumAccessor (&PrioQueue::m_classifier),
+                   MakeEnumChecker (CLASSIFY_DSCP, "Dscp",
+                                    CLASSIFY_ICENS_PORT, "IcensPort"))
+    .AddAttribute ("Scheduler",
+                   "Whether the bands are served in strict priority order or by weighted fair queueing.",
+                   EnumValue (STRICT_PRIORITY),
+                   MakeEnumAccessor (&PrioQueue::m_scheduler),
+                   MakeEnumChecker (STRICT_PRIORITY, "StrictPriority",
+                                    WEIGHTED_FAIR, "WeightedFair"))
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of packets accepted by each band not listed in BandLimits.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&PrioQueue::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BandLimits",
+                   "The maximum number of packets accepted by each band, such as \"10 100 1000\".",
+                   StringValue (""),
+                   MakeStringAccessor (&PrioQueue::m_bandLimits),
+                   MakeStringChecker ())
+    .AddAttribute ("Quantum",
+                   "The number of bytes a band of weight 1 may send per round of weighted fair queueing.",
+                   UintegerValue (1514),
+                   MakeUintegerAccessor (&PrioQueue::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Weights",
+                   "The weights of the bands in weighted fair queueing, such as \"4 2 1\"; 1 if not listed.",
+                   StringValue (""),
+                   MakeStringAccessor (&PrioQueue::m_weights),
+                   MakeStringChecker ())
+    .AddAttribute ("DscpBands",
+                   "Additional DSCP to band rules, such as \"46:0 10:2\".",
+                   StringValue (""),
+                   MakeStringAccessor (&PrioQueue::m_dscpBands),
+                   MakeStringChecker ())
+    .AddAttribute ("PortBands",
+                   "The destination port to band rules of the IcensPort classifier.",
+                   StringValue ("5000:0 6000:1"),
+                   MakeStringAccessor (&PrioQueue::m_portBands),
+                   MakeStringChecker ())
+  ;
+
+  return tid;
+}
+
+PrioQueue::PrioQueue ()
+  : Queue (),
+    m_current (0),
+    m_active (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PrioQueue::~PrioQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PrioQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_bands.clear ();
+  m_active = 0;
+  Queue::DoDispose ();
+}
+
+void
+PrioQueue::InitializeBands (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t last = m_nBands - 1;
+  Band band;
+  band.limit = m_maxPackets;
+  band.quantum = m_quantum;
+  band.drops = 0;
+  m_bands.resize (m_nBands, band);
+  m_deficit.resize (m_nBands, 0);
+
+  std::vector<uint32_t> limits = ParseValues (m_bandLimits, "BandLimits");
+  NS_ABORT_MSG_IF (limits.size () > m_nBands, "PrioQueue: more BandLimits than bands");
+  for (uint32_t i = 0; i < limits.size (); i++)
+    {
+      NS_ABORT_MSG_IF (limits[i] == 0, "PrioQueue: band " << i << " cannot hold any packet");
+      m_bands[i].limit = limits[i];
+    }
+
+  std::vector<uint32_t> weights = ParseValues (m_weights, "Weights");
+  NS_ABORT_MSG_IF (weights.size () > m_nBands, "PrioQueue: more Weights than bands");
+  for (uint32_t i = 0; i < weights.size (); i++)
+    {
+      NS_ABORT_MSG_IF (weights[i] == 0, "PrioQueue: band " << i << " has a null weight");
+      m_bands[i].quantum = weights[i] * m_quantum;
+    }
+
+  // Network control and expedited forwarding first, then the AF3x and
+  // AF4x classes, then everything else.
+  for (uint32_t dscp = 0; dscp < 64; dscp++)
+    {
+      uint32_t b = last;
+      if (dscp == 46 || dscp == 48 || dscp == 56)
+        {
+          b = 0;
+        }
+      else if (dscp >= 24 && dscp <= 40 && dscp % 2 == 0)
+        {
+          b = 1;
+        }
+      m_dscpBand[dscp] = std::min (b, last);
+    }
+  std::vector<std::pair<uint32_t, uint32_t> > rules = ParsePairs (m_dscpBands, "DscpBands");
+  for (uint32_t i = 0; i < rules.size (); i++)
+    {
+      NS_ABORT_MSG_IF (rules[i].first >= 64 || rules[i].second > last,
+                       "PrioQueue: invalid DscpBands rule " << rules[i].first << ":" << rules[i].second);
+      m_dscpBand[rules[i].first] = rules[i].second;
+    }
+
+  rules = ParsePairs (m_portBands, "PortBands");
+  m_portBand.clear ();
+  for (uint32_t i = 0; i < rules.size (); i++)
+    {
+      NS_ABORT_MSG_IF (rules[i].first > 0xffff || rules[i].second > last,
+                       "PrioQueue: invalid PortBands rule " << rules[i].first << ":" << rules[i].second);
+      m_portBand.push_back (std::make_pair (static_cast<uint16_t> (rules[i].first), rules[i].second));
+    }
+}
+
+uint32_t
+PrioQueue::Classify (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (m_bands.empty ())
+    {
+      InitializeBands ();
+    }
+
+  IpHeaderBytes bytes (p);
+  const uint8_t *ip = bytes.GetIpHeader ();
+  uint32_t left = bytes.GetIpSize ();
+
+  uint32_t band = m_nBands - 1;
+  if (m_classifier == CLASSIFY_DSCP)
+    {
+      if (left >= 2 && (ip[0] >> 4) == 4)
+        {
+          band = m_dscpBand[ip[1] >> 2];
+        }
+      else if (left >= 2 && (ip[0] >> 4) == 6)
+        {
+          uint8_t trafficClass = (ip[0] << 4) | (ip[1] >> 4);
+          band = m_dscpBand[trafficClass >> 2];
+        }
+    }
+  else
+    {
+      // Only the first fragment of a datagram holds its ports.
+      int32_t ports = -1;
+      if (left >= 20 && (ip[0] >> 4) == 4)
+        {
+          uint32_t headerLength = (ip[0] & 0x0f) * 4;
+          bool nonFirstFragment = (IpHeaderBytes::ReadU16 (ip + 6) & 0x1fff) != 0;
+          if ((ip[9] == 6 || ip[9] == 17) && !nonFirstFragment)
+            {
+              ports = headerLength;
+            }
+        }
+      else if (left >= 40 && (ip[0] >> 4) == 6 && (ip[6] == 6 || ip[6] == 17))
+        {
+          ports = 40;
+        }
+      if (ports >= 0 && left >= ports + 4u)
+        {
+          uint16_t port = IpHeaderBytes::ReadU16 (ip + ports + 2);
+          for (uint32_t i = 0; i < m_portBand.size (); i++)
+            {
+              if (m_portBand[i].first == port)
+                {
+                  band = m_portBand[i].second;
+                  break;
+                }
+            }
+        }
+    }
+
+  NS_LOG_LOGIC ("Band " << band);
+  return band;
+}
+
+bool
+PrioQueue::DoEnqueue (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  uint32_t b = Classify (p);
+  Band &band = m_bands[b];
+  if (band.packets.size () >= band.limit)
+    {
+      NS_LOG_LOGIC ("Band " << b << " full -- dropping pkt");
+      band.drops++;
+      Drop (p);
+      return false;
+    }
+
+  band.packets.push_back (p);
+  m_active |= 1u << b;
+
+  NS_LOG_LOGIC ("Number packets in band " << b << ": " << band.packets.size ());
+
+  return true;
+}
+
+uint32_t
+PrioQueue::NextActiveBand (uint32_t band) const
+{
+  // The bands above band, if any are active, else from the first one.
+  uint32_t above = m_active & ~((2u << band) - 1);
+  return FindFirstSet (above ? above : m_active);
+}
+
+uint32_t
+PrioQueue::SelectBand (uint32_t &current, std::vector<uint32_t> &deficit) const
+{
+  if (m_scheduler == STRICT_PRIORITY)
+    {
+      return FindFirstSet (m_active);
+    }
+
+  uint32_t band = current;
+  if (!(m_active & (1u << band)))
+    {
+      band = NextActiveBand (band);
+      deficit[band] += m_bands[band].quantum;
+    }
+  while (m_bands[band].packets.front ()->GetSize () > deficit[band])
+    {
+      band = NextActiveBand (band);
+      deficit[band] += m_bands[band].quantum;
+    }
+  current = band;
+  return band;
+}
+
+Ptr<Packet>
+PrioQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_active == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  uint32_t b = SelectBand (m_current, m_deficit);
+  Band &band = m_bands[b];
+  Ptr<Packet> p = band.packets.front ();
+  band.packets.pop_front ();
+  if (m_scheduler == WEIGHTED_FAIR)
+    {
+      m_deficit[b] -= p->GetSize ();
+    }
+  if (band.packets.empty ())
+    {
+      m_active &= ~(1u << b);
+      m_deficit[b] = 0;
+    }
+
+  NS_LOG_LOGIC ("Popped " << p << " from band " << b);
+
+  return p;
+}
+
+Ptr<const Packet>
+PrioQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_active == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  // Run the round robin on copies of its state.
+  uint32_t current = m_current;
+  std::vector<uint32_t> deficit = m_deficit;
+  return m_bands[SelectBand (current, deficit)].packets.front ();
+}
+
+uint32_t
+PrioQueue::GetNBands (void) const
+{
+  return m_nBands;
+}
+
+uint32_t
+PrioQueue::GetBandPackets (uint32_t band) const
+{
+  NS_ASSERT (band < m_nBands);
+  return m_bands.empty () ? 0 : m_bands[band].packets.size ();
+}
+
+uint32_t
+PrioQueue::GetBandDrops (uint32_t band) const
+{
+  NS_ASSERT (band < m_nBands);
+  return m_bands.empty () ? 0 : m_bands[band].drops;
+}
+
+} // namespace ns3
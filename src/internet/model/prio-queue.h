@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#include <vector>
+#include <deque>
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A multi-band priority packet queue
+ *
+ * Packets are classified into Bands bands, band 0 having the highest
+ * priority, either by the DSCP of their IPv4 or IPv6 header or by the
+ * iCenS traffic class given by their TCP or UDP destination port
+ * (PMU to WAC control traffic on port 5000, PMU to PDC traffic on port
+ * 6000).  Packets which do not match any rule, such as background
+ * traffic, ARP packets or the non-first fragments of a datagram in
+ * ICENS_PORT mode, go to the last band.  The IP header is searched for
+ * after a PPP, Ethernet II or Ethernet LLC/SNAP header by
+ * IpHeaderBytes, as in FqCoDelQueue.
+ *
+ * Each band has its own limit, in packets.  The bands are served
+ * either in strict priority order or by deficit round robin, each band
+ * sending up to its weight times Quantum bytes per round.  A bitmap of
+ * the non-empty bands is kept, so that the band to serve is found with
+ * a single find-first-set instruction whatever the number of bands.
+ *
+ * The BandLimits, Weights, DscpBands and PortBands attributes are
+ * lists of space-separated values, such as "10 100 1000" or
+ * "5000:0 6000:1".  They are read on the first enqueue.
+ */
+class PrioQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief How packets are classified into bands.
+   */
+  enum Classifier
+  {
+    CLASSIFY_DSCP,       //!< By the DSCP of the IP header
+    CLASSIFY_ICENS_PORT  //!< By the destination port of the TCP or UDP header
+  };
+
+  /**
+   * \brief How the bands are served.
+   */
+  enum Scheduler
+  {
+    STRICT_PRIORITY,     //!< The highest priority non-empty band first
+    WEIGHTED_FAIR        //!< Deficit round robin, in proportion to the weights
+  };
+
+  /**
+   * \brief PrioQueue Constructor
+   */
+  PrioQueue ();
+
+  virtual ~PrioQueue ();
+
+  /**
+   * \brief Get the number of bands.
+   *
+   * \returns The number of bands
+   */
+  uint32_t GetNBands (void) const;
+
+  /**
+   * \brief Get the band of a packet.
+   *
+   * \param p The packet, as enqueued
+   * \returns The band of the packet
+   */
+  uint32_t Classify (Ptr<const Packet> p);
+
+  /**
+   * \brief Get the number of packets in a band.
+   *
+   * \param band The band
+   * \returns The number of packets in the band
+   */
+  uint32_t GetBandPackets (uint32_t band) const;
+
+  /**
+   * \brief Get the number of packets dropped because a band was full.
+   *
+   * \param band The band
+   * \returns The number of packets dropped from the band
+   */
+  uint32_t GetBandDrops (uint32_t band) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<Packet> p);
+  virtual Ptr<Packet> DoDequeue (void);
+  virtual Ptr<const Packet> DoPeek (void) const;
+
+  /**
+   * \brief Create the bands and read the band lists, on the first use.
+   */
+  void InitializeBands (void);
+
+  /**
+   * \brief Find the band to serve next.
+   *
+   * \param current The band of the round robin, updated
+   * \param deficit The deficits of the bands, updated
+   * \returns The band to serve
+   */
+  uint32_t SelectBand (uint32_t &current, std::vector<uint32_t> &deficit) const;
+
+  /**
+   * \param band A band
+   * \returns The first non-empty band after \p band, cyclically
+   */
+  uint32_t NextActiveBand (uint32_t band) const;
+
+  /**
+   * \brief A band and its statistics.
+   */
+  struct Band
+  {
+    std::deque<Ptr<Packet> > packets;  //!< The packets of the band
+    uint32_t limit;                    //!< Max # of packets accepted by the band
+    uint32_t quantum;                  //!< Bytes per round of the round robin
+    uint32_t drops;                    //!< Packets dropped because the band was full
+  };
+
+  std::vector<Band> m_bands;           //!< The bands
+  std::vector<uint32_t> m_deficit;     //!< Round robin deficits of the bands, in bytes
+  uint32_t m_current;                  //!< Band served by the round robin
+  uint32_t m_active;                   //!< Bit i is set if band i is not empty
+  uint8_t m_dscpBand[64];              //!< Band of each DSCP
+  std::vector<std::pair<uint16_t, uint32_t> > m_portBand;  //!< Band of each listed port
+
+  uint32_t m_nBands;                   //!< Number of bands
+  Classifier m_classifier;             //!< How packets are classified
+  Scheduler m_scheduler;               //!< How the bands are served
+  uint32_t m_maxPackets;               //!< Default limit of the bands, in packets
+  uint32_t m_quantum;                  //!< Round robin quantum, in bytes
+  std::string m_bandLimits;            //!< Limits of the bands
+  std::string m_weights;               //!< Round robin weights of the bands
+  std::string m_dscpBands;             //!< Additional DSCP to band rules
+  std::string m_portBands;             //!< Port to band rules
+};
+
+} // namespace ns3
+
+#endif /* PRIO_QUEUE_H */
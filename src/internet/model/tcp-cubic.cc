@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define NS_LOG_APPEND_CONTEXT \
+  if (m_node) { std::clog << Simulator::Now ().GetSeconds () << " [node " << m_node->GetId () << "] "; }
+
+#include "tcp-cubic.h"
+#include "rtt-estimator.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpCubic");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpCubic);
+
+TypeId
+TcpCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCubic")
+    .SetParent<TcpNewReno> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpCubic> ()
+    .AddAttribute ("Beta", "Multiplicative decrease factor of the window upon a loss",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&TcpCubic::m_beta),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("C", "Scaling constant of the cubic function",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&TcpCubic::m_c),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("FastConvergence", "Enable fast convergence",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TcpFriendliness", "Grow the window at least as fast as NewReno",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_tcpFriendliness),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TcpCubic::TcpCubic (void)
+  : m_beta (0.7), // mute valgrind, actual value set by the attribute system
+    m_c (0.4),
+    m_fastConvergence (true),
+    m_tcpFriendliness (true),
+    m_wMax (0),
+    m_epochStart (Time (0)),
+    m_k (0),
+    m_originPoint (0),
+    m_wEst (0),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::TcpCubic (const TcpCubic& sock)
+  : TcpNewReno (sock),
+    m_beta (sock.m_beta),
+    m_c (sock.m_c),
+    m_fastConvergence (sock.m_fastConvergence),
+    m_tcpFriendliness (sock.m_tcpFriendliness),
+    m_wMax (0),
+    m_epochStart (Time (0)),
+    m_k (0),
+    m_originPoint (0),
+    m_wEst (0),
+    m_cWndFraction (0)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Invoked the copy constructor");
+}
+
+TcpCubic::~TcpCubic (void)
+{
+}
+
+Ptr<TcpSocketBase>
+TcpCubic::Fork (void)
+{
+  return CopyObject<TcpCubic> (this);
+}
+
+/* Upon a loss, end the epoch and remember the window of the loss (RFC8312 sec.4.6) */
+void
+TcpCubic::LossDetected (void)
+{
+  double cWnd = static_cast<double> (m_cWnd.Get ()) / m_segmentSize;
+  m_epochStart = Time (0);
+  if (m_fastConvergence && cWnd < m_wMax)
+    { // The window did not grow back since the last loss: release some bandwidth
+      m_wMax = cWnd * (1 + m_beta) / 2;
+    }
+  else
+    {
+      m_wMax = cWnd;
+    }
+  NS_LOG_INFO ("Loss at cwnd " << m_cWnd << ", Wmax " << m_wMax << " segments");
+}
+
+/* Reduce the window by beta (RFC8312 sec.4.5) */
+uint32_t
+TcpCubic::GetSsThresh (void)
+{
+  return std::max (2 * m_segmentSize, static_cast<uint32_t> (m_cWnd.Get () * m_beta));
+}
+
+/* Grow the window towards the value of the cubic function one RTT later (RFC8312 sec.4.1 to 4.3) */
+void
+TcpCubic::CongestionAvoidance (void)
+{
+  Time now = Simulator::Now ();
+  double cWnd = static_cast<double> (m_cWnd.Get ()) / m_segmentSize;
+  if (m_epochStart.IsZero ())
+    { // First ACK since the loss, or since the end of the slow start
+      m_epochStart = now;
+      if (cWnd < m_wMax)
+        {
+          m_k = std::cbrt ((m_wMax - cWnd) / m_c);
+          m_originPoint = m_wMax;
+        }
+      else
+        {
+          m_k = 0;
+          m_originPoint = cWnd;
+        }
+      m_wEst = cWnd;
+      NS_LOG_INFO ("New epoch at cwnd " << cWnd << " segments, K " << m_k << "s");
+    }
+
+  double t = (now + m_rtt->GetEstimate () - m_epochStart).GetSeconds ();
+  double target = m_originPoint + m_c * std::pow (t - m_k, 3);
+  // The window NewReno would have, with the same reduction factor (RFC8312 sec.4.2)
+  m_wEst += 3 * (1 - m_beta) / (1 + m_beta) / cWnd;
+  if (m_tcpFriendliness && m_wEst > target)
+    {
+      target = m_wEst;
+    }
+  // Grow by at most half of the window per RTT (RFC8312 sec.4.1)
+  target = std::min (target, 1.5 * cWnd);
+
+  double increment;
+  if (target > cWnd)
+    {
+      increment = (target - cWnd) / cWnd;
+    }
+  else
+    { // Around the plateau, grow very slowly
+      increment = 0.01 / cWnd;
+    }
+  m_cWndFraction += increment * m_segmentSize;
+  uint32_t adder = static_cast<uint32_t> (m_cWndFraction);
+  m_cWndFraction -= adder;
+  m_cWnd += adder;
+  NS_LOG_INFO ("In CongAvoid, target " << target << " segments, updated to cwnd " << m_cWnd <<
+               " ssthresh " << m_ssThresh);
+}
+
+} // namespace ns3
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_CUBIC_H
+#define TCP_CUBIC_H
+
+#include "tcp-newreno.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup socket
+ * \ingroup tcp
+ *
+ * \brief An implementation of a stream socket using TCP.
+ *
+ * This class contains the CUBIC implementation of TCP, as of \RFC{8312}.
+ *
+ * After a loss, the congestion window is reduced by a factor Beta
+ * instead of being halved, and it grows afterwards as a cubic function
+ * of the time elapsed since the loss: quickly while far from the window
+ * at which the loss happened, slowly around it, and quickly again beyond
+ * it.  The growth does not depend on the RTT, which suits the long fat
+ * paths where NewReno needs many round trips to recover its window.  In
+ * the "TCP-friendly" region, where NewReno would grow faster, the window
+ * follows the NewReno estimate.
+ *
+ * The slow start and the fast recovery, with or without SACK, are the
+ * ones of NewReno.
+ */
+class TcpCubic : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * Create an unbound tcp socket.
+   */
+  TcpCubic (void);
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpCubic (const TcpCubic& sock);
+  virtual ~TcpCubic (void);
+
+protected:
+  virtual Ptr<TcpSocketBase> Fork (void); // Call CopyObject<TcpCubic> to clone me
+  virtual void LossDetected (void); // Remember the window of the loss, and end the epoch
+  virtual uint32_t GetSsThresh (void); // Reduce the window by Beta
+  virtual void CongestionAvoidance (void); // Grow the window along the cubic function
+
+private:
+  friend class TcpCubicLossTestCase;
+
+  double   m_beta;            //!< Multiplicative decrease factor
+  double   m_c;               //!< Scaling constant of the cubic function
+  bool     m_fastConvergence; //!< Release bandwidth to new flows faster
+  bool     m_tcpFriendliness; //!< Grow at least as fast as NewReno
+  double   m_wMax;            //!< Window before the last reduction, in segments
+  Time     m_epochStart;      //!< Start of the current congestion avoidance epoch, zero if none
+  double   m_k;               //!< Time to grow back to the origin point, in seconds
+  double   m_originPoint;     //!< Window at the plateau of the cubic function, in segments
+  double   m_wEst;            //!< Window NewReno would have, in segments
+  double   m_cWndFraction;    //!< Window increase not applied yet, in bytes
+};
+
+} // namespace ns3
+
+#endif /* TCP_CUBIC_H */
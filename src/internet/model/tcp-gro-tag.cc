@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-gro-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpGroTag");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpGroTag);
+
+TcpGroTag::TcpGroTag ()
+  : m_segments (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpGroTag::SetSegments (uint16_t segments)
+{
+  NS_LOG_FUNCTION (this << segments);
+  m_segments = segments;
+}
+
+uint16_t
+TcpGroTag::GetSegments (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segments;
+}
+
+TypeId
+TcpGroTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpGroTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpGroTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpGroTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpGroTag::GetSerializedSize (void) const
+{
+  return sizeof (uint16_t);
+}
+
+void
+TcpGroTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_segments);
+}
+
+void
+TcpGroTag::Deserialize (TagBuffer i)
+{
+  m_segments = i.ReadU16 ();
+}
+
+void
+TcpGroTag::Print (std::ostream &os) const
+{
+  os << "TCP GRO [Segments: " << m_segments << "] ";
+}
+
+} // namespace ns3
@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_GRO_TAG_H
+#define TCP_GRO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks a packet coalesced by the receive offload
+ *
+ * With the receive offload enabled, IPv4 delivers several in-sequence
+ * TCP segments as one packet carrying this tag, with the number of
+ * segments it holds (Ipv4L3Protocol::GroFlush).  TCP counts a tagged
+ * packet as that many segments for its delayed and duplicate ACKs; an
+ * untagged packet counts as one segment whatever its size.
+ */
+class TcpGroTag : public Tag
+{
+public:
+  TcpGroTag ();
+
+  /**
+   * \brief Set the number of segments coalesced
+   * \param segments the number of segments received
+   */
+  void SetSegments (uint16_t segments);
+  /**
+   * \brief Get the number of segments coalesced
+   * \returns the number of segments received
+   */
+  uint16_t GetSegments (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segments; //!< Number of segments coalesced
+};
+
+} // namespace ns3
+
+#endif /* TCP_GRO_TAG_H */
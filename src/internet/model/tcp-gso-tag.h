@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_GSO_TAG_H
+#define TCP_GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Marks a TCP super-segment, to be segmented at the interface
+ *
+ * With the segmentation offload enabled, a TCP socket passes several
+ * segments worth of data down as one packet carrying this tag.  IPv4
+ * routes and traces the packet once, and splits it into segments of the
+ * tagged size right before the interface (Ipv4L3Protocol::SendRealOut),
+ * so that the devices and the channels only see ordinary segments.
+ */
+class TcpGsoTag : public Tag
+{
+public:
+  TcpGsoTag ();
+
+  /**
+   * \brief Set the size of the segments
+   * \param segmentSize the payload size of each segment but the last one
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \brief Get the size of the segments
+   * \returns the payload size of each segment but the last one
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< Payload size of the segments
+};
+
+} // namespace ns3
+
+#endif /* TCP_GSO_TAG_H */
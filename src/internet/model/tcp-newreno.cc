@@ -56,7 +56,8 @@ TcpNewReno::GetTypeId (void)
 TcpNewReno::TcpNewReno (void)
   : m_retxThresh (3), // mute valgrind, actual value set by the attribute system
     m_inFastRec (false),
-    m_limitedTx (false) // mute valgrind, actual value set by the attribute system
+    m_limitedTx (false), // mute valgrind, actual value set by the attribute system
+    m_pipe (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -65,7 +66,8 @@ TcpNewReno::TcpNewReno (const TcpNewReno& sock)
   : TcpSocketBase (sock),
     m_retxThresh (sock.m_retxThresh),
     m_inFastRec (false),
-    m_limitedTx (sock.m_limitedTx)
+    m_limitedTx (sock.m_limitedTx),
+    m_pipe (0)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -91,7 +93,16 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
                 " ssthresh " << m_ssThresh);
 
   // Check for exit condition of fast recovery
-  if (m_inFastRec && seq < m_recover)
+  if (m_inFastRec && seq < m_recover && m_sackEnabled)
+    { // Partial ACK in SACK recovery: both the lost segment and its retransmission left the network
+      m_pipe -= std::min (m_pipe, 2 * m_segmentSize);
+      NS_LOG_INFO ("Partial ACK for seq " << seq << " in SACK recovery: pipe set to " << m_pipe);
+      m_txBuffer->DiscardUpTo (seq);
+      TcpSocketBase::NewAck (seq);
+      SackRecovery ();
+      return;
+    }
+  else if (m_inFastRec && seq < m_recover)
     { // Partial ACK, partial window deflation (RFC2582 sec.3 bullet #5 paragraph 3)
       m_cWnd += m_segmentSize - (seq - m_txBuffer->HeadSequence ());
       NS_LOG_INFO ("Partial ACK for seq " << seq << " in fast recovery: cwnd set to " << m_cWnd);
@@ -114,12 +125,8 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
       NS_LOG_INFO ("In SlowStart, ACK of seq " << seq << "; update cwnd to " << m_cWnd << "; ssthresh " << m_ssThresh);
     }
   else
-    { // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
-      // To increase cwnd for one segSize per RTT, it should be (ackBytes*segSize)/cwnd
-      double adder = static_cast<double> (m_segmentSize * m_segmentSize) / m_cWnd.Get ();
-      adder = std::max (1.0, adder);
-      m_cWnd += static_cast<uint32_t> (adder);
-      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
+    {
+      CongestionAvoidance ();
     }
 
   // Complete newAck processing
@@ -131,9 +138,31 @@ void
 TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
 {
   NS_LOG_FUNCTION (this << count);
-  if (count == m_retxThresh && !m_inFastRec)
+  if (count == m_retxThresh && !m_inFastRec && m_sackEnabled)
+    { // triple duplicate ack triggers a SACK-based fast recovery: the
+      // window is not inflated, the number of bytes in the network is estimated instead
+      LossDetected ();
+      m_ssThresh = GetSsThresh ();
+      m_cWnd = m_ssThresh;
+      m_recover = m_highTxMark;
+      m_inFastRec = true;
+      m_pipe = BytesInFlight () - m_txBuffer->GetSackedBytes ();
+      NS_LOG_INFO ("Triple dupack. Enter SACK recovery mode. Reset cwnd to " << m_cWnd <<
+                   ", ssthresh to " << m_ssThresh << " at fast recovery seqnum " << m_recover <<
+                   ", pipe " << m_pipe);
+      // Retransmit the first segment, even if the pipe is full
+      SequenceNumber32 seq = m_txBuffer->HeadSequence ();
+      uint32_t hole = m_txBuffer->NextHole (seq);
+      uint32_t sz = SendDataPacket (m_txBuffer->HeadSequence (),
+                                    hole > 0 ? std::min (hole, m_segmentSize) : m_segmentSize, true);
+      m_highRxt = m_txBuffer->HeadSequence () + SequenceNumber32 (sz);
+      m_pipe += sz;
+      SackRecovery ();
+    }
+  else if (count == m_retxThresh && !m_inFastRec)
     { // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1)
-      m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+      LossDetected ();
+      m_ssThresh = GetSsThresh ();
       m_cWnd = m_ssThresh + 3 * m_segmentSize;
       m_recover = m_highTxMark;
       m_inFastRec = true;
@@ -141,6 +170,12 @@ TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
                    ", ssthresh to " << m_ssThresh << " at fast recovery seqnum " << m_recover);
       DoRetransmit ();
     }
+  else if (m_inFastRec && m_sackEnabled)
+    { // Every additional dupack means that a segment left the network
+      m_pipe -= std::min (m_pipe, m_segmentSize);
+      NS_LOG_INFO ("Dupack in SACK recovery mode. Decrease pipe to " << m_pipe);
+      SackRecovery ();
+    }
   else if (m_inFastRec)
     { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
       m_cWnd += m_segmentSize;
@@ -174,7 +209,8 @@ TcpNewReno::Retransmit (void)
   // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
   // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
   // TCP back to slow start
-  m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+  LossDetected ();
+  m_ssThresh = GetSsThresh ();
   m_cWnd = m_segmentSize;
   m_nextTxSequence = m_txBuffer->HeadSequence (); // Restart from highest Ack
   NS_LOG_INFO ("RTO. Reset cwnd to " << m_cWnd <<
@@ -182,4 +218,55 @@ TcpNewReno::Retransmit (void)
   DoRetransmit ();                          // Retransmit the packet
 }
 
+void
+TcpNewReno::LossDetected (void)
+{
+}
+
+uint32_t
+TcpNewReno::GetSsThresh (void)
+{
+  return std::max (2 * m_segmentSize, BytesInFlight () / 2);
+}
+
+void
+TcpNewReno::CongestionAvoidance (void)
+{
+  // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
+  // To increase cwnd for one segSize per RTT, it should be (ackBytes*segSize)/cwnd
+  double adder = static_cast<double> (m_segmentSize * m_segmentSize) / m_cWnd.Get ();
+  adder = std::max (1.0, adder);
+  m_cWnd += static_cast<uint32_t> (adder);
+  NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
+}
+
+void
+TcpNewReno::SackRecovery (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_pipe < m_cWnd)
+    {
+      SequenceNumber32 seq = std::max (m_highRxt, m_txBuffer->HeadSequence ());
+      uint32_t hole = m_txBuffer->NextHole (seq);
+      uint32_t sz;
+      if (hole > 0 && seq < m_recover)
+        { // Retransmit the next lost segment
+          sz = SendDataPacket (seq, std::min (hole, m_segmentSize), true);
+          m_highRxt = seq + SequenceNumber32 (sz);
+          NS_LOG_INFO ("SACK recovery: retransmit " << sz << " bytes at seqnum " << seq);
+        }
+      else if (m_txBuffer->SizeFromSequence (m_nextTxSequence) > 0 && UnAckDataCount () < m_rWnd.Get ())
+        { // No hole left, send new data
+          sz = SendDataPacket (m_nextTxSequence, std::min (m_segmentSize, m_rWnd.Get () - UnAckDataCount ()), true);
+          m_nextTxSequence += sz;
+          NS_LOG_INFO ("SACK recovery: send " << sz << " new bytes");
+        }
+      else
+        {
+          break;
+        }
+      m_pipe += sz;
+    }
+}
+
 } // namespace ns3
@@ -32,6 +32,11 @@ namespace ns3 {
  * \brief An implementation of a stream socket using TCP.
  *
  * This class contains the NewReno implementation of TCP, as of \RFC{2582}.
+ *
+ * When the SACK option is negotiated, the losses are recovered using the
+ * scoreboard of the peer's selective acknowledgments: every hole is
+ * retransmitted once during the fast recovery, instead of one segment
+ * per round trip.
  */
 class TcpNewReno : public TcpSocketBase
 {
@@ -58,11 +63,49 @@ protected:
   virtual void DupAck (const TcpHeader& t, uint32_t count);  // Halving cwnd and reset nextTxSequence
   virtual void Retransmit (void); // Exit fast recovery upon retransmit timeout
 
+  /**
+   * \brief Called once per loss event, before the window is reduced
+   *
+   * Upon a triple duplicate ACK or a retransmission timeout, right
+   * before GetSsThresh.  The variants which keep a state across the
+   * losses update it here.  NewReno keeps none.
+   */
+  virtual void LossDetected (void);
+
+  /**
+   * \brief Get the slow start threshold after a loss
+   *
+   * NewReno halves the flight size (RFC2581, sec.3.1).  A pure
+   * computation, which may be called more than once per loss.
+   *
+   * \returns the new slow start threshold, in bytes
+   */
+  virtual uint32_t GetSsThresh (void);
+
+  /**
+   * \brief Increase the congestion window upon a new ACK in congestion avoidance
+   *
+   * NewReno increases the window by one segment per RTT (RFC2581, sec.3.1).
+   */
+  virtual void CongestionAvoidance (void);
+
+  /**
+   * \brief Send data during a SACK-based fast recovery
+   *
+   * While the estimated number of bytes in the network (the pipe) is
+   * below the congestion window, retransmit the next hole of the SACK
+   * scoreboard, or send new data when there is no hole left, as in the
+   * "Sack1" algorithm of Fall and Floyd.
+   */
+  void SackRecovery (void);
+
 protected:
   SequenceNumber32       m_recover;      //!< Previous highest Tx seqnum for fast recovery
   uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
   bool                   m_inFastRec;    //!< currently in fast recovery
   bool                   m_limitedTx;    //!< perform limited transmit
+  uint32_t               m_pipe;         //!< Estimated bytes in the network, in SACK recovery
+  SequenceNumber32       m_highRxt;      //!< Seqnum following the last hole retransmitted, in SACK recovery
 };
 
 } // namespace ns3
@@ -52,7 +52,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_readOffset (0)
 {
 }
 
@@ -114,13 +115,26 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size ())
+  else if (m_size)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return HeadSequence () + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
 
+SequenceNumber32
+TcpRxBuffer::HeadSequence (void) const
+{
+  if (m_availBytes == 0)
+    {
+      NS_ASSERT (!m_outOfSequence.empty ());
+      return m_outOfSequence.begin ()->first;
+    }
+  // The in-sequence data ends at the FIN once it has been received
+  SequenceNumber32 end = m_gotFin && m_finSeq < m_nextRxSeq ? m_finSeq : m_nextRxSeq.Get ();
+  return SequenceNumber32 (end.GetValue () - m_availBytes);
+}
+
 void
 TcpRxBuffer::SetFinSequence (const SequenceNumber32& s)
 {
@@ -150,15 +164,21 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 
   // Trim packet to fit Rx window specification
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
-  if (m_data.size ())
+  if (m_size)
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = HeadSequence () + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+  // Remove overlapped bytes from packet.  The in-sequence data ends
+  // before headSeq, and only the range starting before headSeq can
+  // overlap its head.
+  BufIterator i = m_outOfSequence.upper_bound (headSeq);
+  if (i != m_outOfSequence.begin ())
+    {
+      --i;
+    }
+  while (i != m_outOfSequence.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
       if (lastByteSeq > headSeq)
@@ -166,7 +186,7 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
           if (i->first > headSeq && lastByteSeq < tailSeq)
             { // Rare case: Existing packet is embedded fully in the new packet
               m_size -= i->second->GetSize ();
-              m_data.erase (i++);
+              m_outOfSequence.erase (i++);
               continue;
             }
           if (i->first <= headSeq)
@@ -190,27 +210,50 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
     {
       uint32_t start = headSeq - tcph.GetSequenceNumber ();
       uint32_t length = tailSeq - headSeq;
-      p = p->CreateFragment (start, length);
+      // The buffer keeps its own copy, which it may extend when read
+      p = length == pktSize ? p->Copy () : p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
   // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+  NS_ASSERT (m_outOfSequence.find (headSeq) == m_outOfSequence.end ()); // Shouldn't be there yet
+  m_outOfSequence [ headSeq ] = p;
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  // Merge the new data with the blocks it overlaps or touches
+  m_recentSeq = headSeq;
+  SequenceNumber32 first = headSeq;
+  SequenceNumber32 last = tailSeq;
+  std::map<SequenceNumber32, SequenceNumber32>::iterator b = m_sackBlocks.upper_bound (first);
+  if (b != m_sackBlocks.begin ())
     {
-      if (i->first < m_nextRxSeq)
+      --b;
+      if (b->second < first)
         {
-          continue;
+          ++b;
         }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
+    }
+  while (b != m_sackBlocks.end () && b->first <= last)
+    {
+      first = std::min (first, b->first);
+      last = std::max (last, b->second);
+      m_sackBlocks.erase (b++);
+    }
+  m_sackBlocks[first] = last;
+  // Move the ranges which are now in sequence
+  while (!m_outOfSequence.empty () && m_outOfSequence.begin ()->first == m_nextRxSeq)
+    {
+      BufIterator i = m_outOfSequence.begin ();
       m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
       m_availBytes += i->second->GetSize ();
+      m_data.push_back (i->second);
+      m_outOfSequence.erase (i);
+    }
+  // The first block is either entirely in sequence or not at all
+  if (!m_sackBlocks.empty () && m_sackBlocks.begin ()->first < m_nextRxSeq)
+    {
+      NS_ASSERT (m_sackBlocks.begin ()->second == m_nextRxSeq);
+      m_sackBlocks.erase (m_sackBlocks.begin ());
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
@@ -229,31 +272,38 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Ptr<Packet> first = m_data.front ();
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
-      if (pktSize <= extractSize)
+      uint32_t pktSize = first->GetSize () - m_readOffset;
+      uint32_t length = std::min (pktSize, extractSize);
+      Ptr<Packet> fragment = first;
+      if (length < first->GetSize ())
+        {
+          fragment = first->CreateFragment (m_readOffset, length);
+        }
+      if (outPkt == 0)
+        {
+          outPkt = fragment;
+        }
+      else
+        {
+          outPkt->AddAtEnd (fragment);
+        }
+      if (length == pktSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
-          m_size -= pktSize;
-          m_availBytes -= pktSize;
-          extractSize -= pktSize;
+          m_data.pop_front ();
+          m_readOffset = 0;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
-          m_size -= extractSize;
-          m_availBytes -= extractSize;
-          extractSize = 0;
+          m_readOffset += length;
         }
+      m_size -= length;
+      m_availBytes -= length;
+      extractSize -= length;
     }
   if (outPkt->GetSize () == 0)
     {
@@ -265,4 +315,33 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   return outPkt;
 }
 
+TcpOptionSack::SackList
+TcpRxBuffer::GetSackList (uint32_t maxBlocks) const
+{
+  NS_LOG_FUNCTION (this << maxBlocks);
+  TcpOptionSack::SackList list;
+  if (m_sackBlocks.empty () || maxBlocks == 0)
+    {
+      return list;
+    }
+  std::map<SequenceNumber32, SequenceNumber32>::const_iterator recent = m_sackBlocks.upper_bound (m_recentSeq);
+  if (recent != m_sackBlocks.begin ())
+    {
+      --recent;
+      if (m_recentSeq < recent->second)
+        {
+          list.push_back (*recent);
+        }
+    }
+  for (std::map<SequenceNumber32, SequenceNumber32>::const_iterator i = m_sackBlocks.begin ();
+       i != m_sackBlocks.end () && list.size () < maxBlocks; ++i)
+    {
+      if (list.empty () || i->first != list.front ().first)
+        {
+          list.push_back (*i);
+        }
+    }
+  return list;
+}
+
 } //namepsace ns3
@@ -22,11 +22,13 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
 #include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +38,18 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The in-sequence data is kept as a double-ended queue of the received
+ * packets, of which the bytes already read by the application are
+ * skipped rather than fragmented away.  The out-of-sequence data is
+ * kept as a set of non-overlapping ranges, by first sequence number:
+ * the overlap of a new segment is found with a logarithmic lookup, and
+ * the ranges are moved to the in-sequence queue, without being merged,
+ * once the hole before them is filled.  The packets are only merged
+ * when the application reads them.
+ *
+ * The contiguous blocks of out-of-sequence data, which the SACK option
+ * reports, are kept merged alongside the out-of-sequence ranges.
  */
 class TcpRxBuffer : public Object
 {
@@ -124,8 +138,25 @@ public:
    * \returns a packet
    */
   Ptr<Packet> Extract (uint32_t maxSize);
-public:
-  /// container for data stored in the buffer
+
+  /**
+   * \brief Get the blocks of out-of-sequence data to report with the SACK option.
+   *
+   * As \RFC{2018} requires, the first block holds the most recently
+   * received segment; the other blocks follow in sequence order.
+   *
+   * \param maxBlocks the maximum number of blocks
+   * \returns the blocks, empty if all the data is in sequence
+   */
+  TcpOptionSack::SackList GetSackList (uint32_t maxBlocks) const;
+private:
+  /**
+   * \brief Get the sequence number of the first byte in the buffer.
+   * \returns the sequence number of the first byte in the buffer
+   */
+  SequenceNumber32 HeadSequence (void) const;
+
+  /// container for the out-of-sequence data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
@@ -133,7 +164,11 @@ public:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::deque<Ptr<Packet> > m_data;           //!< In-sequence data
+  uint32_t m_readOffset;                     //!< Number of bytes of the first packet already read
+  std::map<SequenceNumber32, Ptr<Packet> > m_outOfSequence; //!< Out-of-sequence data, by first sequence number
+  std::map<SequenceNumber32, SequenceNumber32> m_sackBlocks; //!< Contiguous out-of-sequence blocks: tail by head
+  SequenceNumber32 m_recentSeq;              //!< Seqnum of the last out-of-sequence data buffered
 };
 
 } //namepsace ns3
@@ -49,6 +49,10 @@
 #include "tcp-header.h"
 #include "tcp-option-winscale.h"
 #include "tcp-option-ts.h"
+#include "tcp-option-sack-permitted.h"
+#include "tcp-option-sack.h"
+#include "tcp-gso-tag.h"
+#include "tcp-gro-tag.h"
 #include "rtt-estimator.h"
 
 #include <math.h>
@@ -96,6 +100,15 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_timestampEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("Sack", "Enable or disable the selective acknowledgment (SACK) option",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Gso", "Pass the data of several segments down to IPv4 in one packet, "
+                   "to be segmented at the interface",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_gso),
+                   MakeBooleanChecker ())
     .AddAttribute ("MinRto",
                    "Minimum retransmit timeout value",
                    TimeValue (Seconds (1.0)), // RFC 6298 says min RTO=1 sec, but Linux uses 200ms. See http://www.postel.org/pipermail/end2end-interest/2004-November/004402.html
@@ -190,7 +203,9 @@ TcpSocketBase::TcpSocketBase (void)
     m_sndScaleFactor (0),
     m_rcvScaleFactor (0),
     m_timestampEnabled (true),
-    m_timestampToEcho (0)
+    m_timestampToEcho (0),
+    m_sackEnabled (false),
+    m_gso (false)
 
 {
   NS_LOG_FUNCTION (this);
@@ -237,7 +252,9 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_sndScaleFactor (sock.m_sndScaleFactor),
     m_rcvScaleFactor (sock.m_rcvScaleFactor),
     m_timestampEnabled (sock.m_timestampEnabled),
-    m_timestampToEcho (sock.m_timestampToEcho)
+    m_timestampToEcho (sock.m_timestampToEcho),
+    m_sackEnabled (sock.m_sackEnabled),
+    m_gso (sock.m_gso)
 
 {
   NS_LOG_FUNCTION (this);
@@ -1930,6 +1947,14 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       p->AddPacketTag (ipHopLimitTag);
     }
 
+  if (sz > m_segmentSize)
+    {
+      NS_ASSERT (m_gso && m_endPoint != 0);
+      TcpGsoTag gsoTag;
+      gsoTag.SetSegmentSize (m_segmentSize);
+      p->AddPacketTag (gsoTag);
+    }
+
   if (m_closeOnEmpty && (remainingData == 0))
     {
       flags |= TcpHeader::FIN;
@@ -1987,23 +2012,27 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
                          m_endPoint6->GetPeerAddress (), m_boundnetdevice);
     }
 
-  // update the history of sequence numbers used to calculate the RTT
-  if (isRetransmission == false)
-    { // This is the next expected one, just log at end
-      m_history.push_back (RttHistory (seq, sz, Simulator::Now () ));
-    }
-  else
+  // update the history of sequence numbers used to calculate the RTT,
+  // as if the segments of a super-segment had been sent one by one
+  uint32_t offset = 0;
+  if (isRetransmission == true)
     { // This is a retransmit, find in list and mark as re-tx
+      offset = std::min (sz, m_segmentSize);
       for (RttHistory_t::iterator i = m_history.begin (); i != m_history.end (); ++i)
         {
           if ((seq >= i->seq) && (seq < (i->seq + SequenceNumber32 (i->count))))
             { // Found it
               i->retx = true;
-              i->count = ((seq + SequenceNumber32 (sz)) - i->seq); // And update count in hist
+              i->count = ((seq + SequenceNumber32 (offset)) - i->seq); // And update count in hist
               break;
             }
         }
     }
+  for (; offset < sz; offset += m_segmentSize)
+    { // This is the next expected one, just log at end
+      m_history.push_back (RttHistory (seq + SequenceNumber32 (offset),
+                                       std::min (sz - offset, m_segmentSize), Simulator::Now ()));
+    }
 
   // Notify the application of the data being sent unless this is a retransmit
   if (seq == m_highTxMark)
@@ -2058,6 +2087,17 @@ TcpSocketBase::SendPendingData (bool withAck)
                     " pd->Size " << m_txBuffer->Size () <<
                     " pd->SFS " << m_txBuffer->SizeFromSequence (m_nextTxSequence));
       uint32_t s = std::min (w, m_segmentSize);  // Send no more than window
+      if (m_gso && m_endPoint != 0 && s == m_segmentSize
+          && m_txBuffer->SizeFromSequence (m_nextTxSequence) > m_segmentSize)
+        { // Send all the segments the loop would send in one super-segment
+          uint32_t pending = m_txBuffer->SizeFromSequence (m_nextTxSequence);
+          uint32_t maxSize = (0xffff - 20 - 60) / m_segmentSize * m_segmentSize;
+          s = std::min (std::min (w, pending), maxSize);
+          if (!m_noDelay || s < pending)
+            { // The last partial segment waits, as Nagle's algorithm or SWS avoidance hold it
+              s -= s % m_segmentSize;
+            }
+        }
       uint32_t sz = SendDataPacket (m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_nextTxSequence += sz;                     // Advance next tx sequence
@@ -2122,6 +2162,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
                 " ack " << tcpHeader.GetAckNumber () <<
                 " pkt size " << p->GetSize () );
 
+  // A packet coalesced by the receive offload counts for each of its segments
+  TcpGroTag groTag;
+  uint32_t segments = p->RemovePacketTag (groTag) ? groTag.GetSegments () : 1;
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence ();
   if (!m_rxBuffer->Add (p, tcpHeader))
@@ -2133,10 +2177,18 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   if (m_rxBuffer->Size () > m_rxBuffer->Available () || m_rxBuffer->NextRxSequence () > expectedSeq + p->GetSize ())
     { // A gap exists in the buffer, or we filled a gap: Always ACK
       SendEmptyPacket (TcpHeader::ACK);
+      if (m_rxBuffer->NextRxSequence () == expectedSeq)
+        { // Out of sequence: send the duplicate ACKs the peer expects for the other segments coalesced in this one
+          for (uint32_t i = 1; i < segments; ++i)
+            {
+              SendEmptyPacket (TcpHeader::ACK);
+            }
+        }
     }
   else
-    { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+    { // In-sequence packet: ACK if delayed ack count allows. Coalesced segments count for each of them
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -2298,6 +2350,8 @@ TcpSocketBase::ReTxTimeout ()
       return;
     }
 
+  // The peer may have discarded the SACKed data (RFC 2018, sec. 8)
+  m_txBuffer->ResetScoreboard ();
   Retransmit ();
 }
 
@@ -2573,6 +2627,15 @@ TcpSocketBase::ReadOptions (const TcpHeader& header)
               ScaleSsThresh (m_sndScaleFactor);
             }
         }
+
+      if (m_sackEnabled)
+        {
+          m_sackEnabled = header.HasOption (TcpOption::SACK_PERMITTED);
+        }
+    }
+  else if (m_sackEnabled && header.HasOption (TcpOption::SACK))
+    {
+      ProcessOptionSack (header.GetOption (TcpOption::SACK));
     }
 
   m_timestampEnabled = false;
@@ -2599,6 +2662,16 @@ TcpSocketBase::AddOptions (TcpHeader& header)
     {
       AddOptionTimestamp (header);
     }
+
+  // SACK is permitted on SYN packets, and used afterwards
+  if (m_sackEnabled && (header.GetFlags () & TcpHeader::SYN))
+    {
+      header.AppendOption (CreateObject<TcpOptionSackPermitted> ());
+    }
+  else if (m_sackEnabled)
+    {
+      AddOptionSack (header);
+    }
 }
 
 void
@@ -2693,6 +2766,41 @@ TcpSocketBase::AddOptionTimestamp (TcpHeader& header)
                option->GetTimestamp () << " echo=" << m_timestampToEcho);
 }
 
+void
+TcpSocketBase::ProcessOptionSack (const Ptr<const TcpOption> option)
+{
+  NS_LOG_FUNCTION (this << option);
+
+  Ptr<const TcpOptionSack> sack = DynamicCast<const TcpOptionSack> (option);
+  const TcpOptionSack::SackList &list = sack->GetSackList ();
+  for (TcpOptionSack::SackList::const_iterator i = list.begin (); i != list.end (); ++i)
+    {
+      m_txBuffer->Sack (i->first, i->second);
+    }
+}
+
+void
+TcpSocketBase::AddOptionSack (TcpHeader& header)
+{
+  NS_LOG_FUNCTION (this << header);
+
+  // The header length includes the padding of the options
+  uint32_t maxBlocks = TcpOptionSack::GetMaxSackBlocks (header.GetLength () * 4 - 20);
+  TcpOptionSack::SackList list = m_rxBuffer->GetSackList (maxBlocks);
+  if (list.empty ())
+    {
+      return;
+    }
+
+  Ptr<TcpOptionSack> option = CreateObject<TcpOptionSack> ();
+  for (TcpOptionSack::SackList::const_iterator i = list.begin (); i != list.end (); ++i)
+    {
+      option->AddSackBlock (*i);
+    }
+  header.AppendOption (option);
+  NS_LOG_INFO (m_node->GetId () << " Add option SACK with " << list.size () << " blocks");
+}
+
 void TcpSocketBase::UpdateWindowSize (const TcpHeader &header)
 {
   NS_LOG_FUNCTION (this << header);
@@ -685,6 +685,25 @@ protected:
    */
   void AddOptionTimestamp (TcpHeader& header);
 
+  /**
+   * \brief Process the SACK option from other side
+   *
+   * Record the blocks of the option in the scoreboard of the Tx buffer.
+   *
+   * \param option Option from the packet
+   */
+  void ProcessOptionSack (const Ptr<const TcpOption> option);
+  /**
+   * \brief Add the SACK option to the header
+   *
+   * Report the out-of-sequence blocks of the Rx buffer, as many as the
+   * option space left allows.  Nothing is added if all the received data
+   * is in sequence.
+   *
+   * \param header TcpHeader to which add the option to
+   */
+  void AddOptionSack (TcpHeader& header);
+
   /**
    * \brief Scale the initial SsThresh value to the correct one
    *
@@ -773,6 +792,10 @@ protected:
   bool     m_timestampEnabled;    //!< Timestamp option enabled
   uint32_t m_timestampToEcho;     //!< Timestamp to echo
 
+  bool     m_sackEnabled;         //!< SACK option enabled
+
+  bool     m_gso;                 //!< Segmentation offload enabled
+
   EventId m_sendPendingDataEvent; //!< micro-delay event to send pending data
 };
 
@@ -57,7 +57,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_headOffset (0), m_end (0),
+    m_sackedBytes (0)
 {
 }
 
@@ -111,7 +112,11 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          Chunk chunk;
+          chunk.packet = p;
+          chunk.start = m_end;
+          m_data.push_back (chunk);
+          m_end += p->GetSize ();
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -133,6 +138,28 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return lastSeq - seq;
 }
 
+TcpTxBuffer::BufIterator
+TcpTxBuffer::Find (uint32_t offset)
+{
+  // The stream offsets wrap around, but not their differences
+  uint32_t origin = m_data.front ().start;
+  uint32_t low = 0;
+  uint32_t high = m_data.size ();
+  while (high - low > 1)
+    {
+      uint32_t middle = (low + high) / 2;
+      if (m_data[middle].start - origin <= offset)
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  return m_data.begin () + low;
+}
+
 Ptr<Packet>
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
@@ -148,56 +175,33 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
+  uint32_t offset = m_headOffset + (seq - m_firstByteSeq.Get ());
+  BufIterator i = Find (offset);
+  uint32_t origin = m_data.front ().start;
   Ptr<Packet> outPacket;
   NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  while (s > 0)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
-        { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-          break;
+      NS_ASSERT (i != m_data.end ());
+      uint32_t pktSize = i->packet->GetSize ();
+      uint32_t packetOffset = offset - (i->start - origin);
+      uint32_t fragmentLength = std::min (s, pktSize - packetOffset);
+      NS_LOG_LOGIC ("Copying " << fragmentLength << " bytes at offset " << packetOffset
+                               << " of a packet of len=" << pktSize);
+      Ptr<Packet> fragment = i->packet->CreateFragment (packetOffset, fragmentLength);
+      if (outPacket == 0)
+        {
+          outPacket = fragment;
         }
       else
         {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          outPacket->AddAtEnd (fragment);
         }
-      count += pktSize;
+      offset += fragmentLength;
+      s -= fragmentLength;
+      ++i;
     }
-  NS_ASSERT (outPacket->GetSize () == s);
+  NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
   return outPacket;
 }
 
@@ -217,31 +221,31 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
+  // Skip the acknowledged bytes, and release the packets entirely acknowledged
+  uint32_t offset = std::min (static_cast<uint32_t> (seq - m_firstByteSeq.Get ()), m_size);  // Number of bytes to remove
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  m_size -= offset;
+  m_firstByteSeq += offset;
+  m_headOffset += offset;
+  while (!m_data.empty () && m_headOffset >= m_data.front ().packet->GetSize ())
     {
-      if (offset > (*i)->GetSize ())
-        { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
-          m_size -= pktSize;
-          offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
-        }
-      else if (offset > 0)
-        { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
-          m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
+      m_headOffset -= m_data.front ().packet->GetSize ();
+      NS_LOG_LOGIC ("Removed one packet of size " << m_data.front ().packet->GetSize ());
+      m_data.pop_front ();
+    }
+  // Forget the SACKed blocks which are now acknowledged
+  while (!m_sacked.empty () && m_sacked.begin ()->first < m_firstByteSeq)
+    {
+      SequenceNumber32 head = m_sacked.begin ()->first;
+      SequenceNumber32 tail = m_sacked.begin ()->second;
+      m_sacked.erase (m_sacked.begin ());
+      if (tail > m_firstByteSeq)
+        {
+          m_sackedBytes -= m_firstByteSeq.Get () - head;
+          m_sacked[m_firstByteSeq] = tail;
           break;
         }
+      m_sackedBytes -= tail - head;
     }
   // Catching the case of ACKing a FIN
   if (m_size == 0)
@@ -253,4 +257,89 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+void
+TcpTxBuffer::Sack (const SequenceNumber32& head, const SequenceNumber32& tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+  SequenceNumber32 first = std::max (head, m_firstByteSeq.Get ());
+  SequenceNumber32 last = std::min (tail, TailSequence ());
+  if (first >= last)
+    {
+      NS_LOG_LOGIC ("Block out of the buffer, ignored");
+      return;
+    }
+  // Merge the blocks which overlap or touch the new one
+  std::map<SequenceNumber32, SequenceNumber32>::iterator i = m_sacked.upper_bound (first);
+  if (i != m_sacked.begin ())
+    {
+      --i;
+      if (i->second < first)
+        {
+          ++i;
+        }
+    }
+  while (i != m_sacked.end () && i->first <= last)
+    {
+      first = std::min (first, i->first);
+      last = std::max (last, i->second);
+      m_sackedBytes -= i->second - i->first;
+      m_sacked.erase (i++);
+    }
+  m_sacked[first] = last;
+  m_sackedBytes += last - first;
+  NS_LOG_LOGIC ("SACKed block [" << first << ";" << last << "), " << m_sackedBytes <<
+                " bytes SACKed in " << m_sacked.size () << " blocks");
+}
+
+bool
+TcpTxBuffer::IsSacked (const SequenceNumber32& seq) const
+{
+  std::map<SequenceNumber32, SequenceNumber32>::const_iterator i = m_sacked.upper_bound (seq);
+  if (i == m_sacked.begin ())
+    {
+      return false;
+    }
+  --i;
+  return seq < i->second;
+}
+
+uint32_t
+TcpTxBuffer::GetSackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+uint32_t
+TcpTxBuffer::NextHole (SequenceNumber32& seq) const
+{
+  NS_LOG_FUNCTION (this << seq);
+  if (seq < m_firstByteSeq)
+    {
+      seq = m_firstByteSeq;
+    }
+  std::map<SequenceNumber32, SequenceNumber32>::const_iterator i = m_sacked.upper_bound (seq);
+  if (i != m_sacked.begin ())
+    {
+      std::map<SequenceNumber32, SequenceNumber32>::const_iterator previous = i;
+      --previous;
+      if (seq < previous->second)
+        { // Skip the block holding seq; the next one starts after a hole
+          seq = previous->second;
+        }
+    }
+  if (i == m_sacked.end ())
+    {
+      return 0;
+    }
+  return i->first - seq;
+}
+
+void
+TcpTxBuffer::ResetScoreboard (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sacked.clear ();
+  m_sackedBytes = 0;
+}
+
 } // namepsace ns3
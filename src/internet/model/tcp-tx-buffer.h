@@ -21,7 +21,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
+#include <map>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +37,19 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets given by the application are kept as they are, in a
+ * double-ended queue which also records the stream offset of each of
+ * them.  Appending a packet and discarding acknowledged data are O(1):
+ * the acknowledged bytes of the first packet are skipped rather than
+ * fragmented away.  The packet holding a sequence number is found by a
+ * binary search, and a segment is built from fragments of the packets
+ * it spans.
+ *
+ * The buffer also keeps the SACK scoreboard: the blocks of data which
+ * the peer reported with the SACK option (\RFC{2018}), merged into
+ * disjoint ranges and sorted by sequence number, so that a block is
+ * recorded and a hole is found in logarithmic time.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,14 +141,75 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  /**
+   * \brief Record a block of data which the peer received (SACK).
+   *
+   * The part of the block outside of the buffer is ignored.
+   *
+   * \param head the sequence number of the first byte of the block
+   * \param tail the sequence number following the last byte of the block
+   */
+  void Sack (const SequenceNumber32& head, const SequenceNumber32& tail);
+
+  /**
+   * \brief Check if a byte was SACKed by the peer
+   * \param seq the sequence number of the byte
+   * \returns true if the byte was SACKed
+   */
+  bool IsSacked (const SequenceNumber32& seq) const;
+
+  /**
+   * \brief Get the number of bytes SACKed by the peer
+   * \returns the number of SACKed bytes of the buffer
+   */
+  uint32_t GetSackedBytes (void) const;
+
+  /**
+   * \brief Find the first hole of the scoreboard at or after a sequence number.
+   *
+   * A hole is data which was not SACKed but is followed by SACKed data;
+   * it is deemed lost.
+   *
+   * \param seq the sequence number to start from; set to the sequence
+   *        number of the first byte of the hole
+   * \returns the size of the hole, or 0 if there is none
+   */
+  uint32_t NextHole (SequenceNumber32& seq) const;
+
+  /**
+   * \brief Forget the SACKed blocks, as \RFC{2018} recommends upon a
+   * retransmission timeout since the peer may have discarded them.
+   */
+  void ResetScoreboard (void);
+
 private:
+  /**
+   * \brief A packet of the buffer.
+   */
+  struct Chunk
+  {
+    Ptr<Packet> packet;   //!< The data
+    uint32_t start;       //!< Stream offset of the first byte of the packet
+  };
+
   /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<Chunk>::iterator BufIterator;
+
+  /**
+   * \brief Find the packet holding a byte.
+   * \param offset the offset of the byte from the first byte of the first packet
+   * \returns the packet holding the byte
+   */
+  BufIterator Find (uint32_t offset);
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  std::deque<Chunk> m_data;                     //!< Corresponding data (may be null)
+  uint32_t m_headOffset;                        //!< Number of discarded bytes of the first packet
+  uint32_t m_end;                               //!< Stream offset of the byte following the last packet
+  std::map<SequenceNumber32, SequenceNumber32> m_sacked; //!< SACKed blocks: tail by head, disjoint and not adjacent
+  uint32_t m_sackedBytes;                       //!< Number of SACKed bytes
 };
 
 } // namepsace ns3
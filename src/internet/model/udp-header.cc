@@ -177,7 +177,7 @@ UdpHeader::Print (std::ostream &os) const
 uint32_t 
 UdpHeader::GetSerializedSize (void) const
 {
-  return 8;
+  return SERIALIZED_SIZE;
 }
 
 void
@@ -189,7 +189,7 @@ UdpHeader::Serialize (Buffer::Iterator start) const
   i.WriteHtonU16 (m_destinationPort);
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
+      i.WriteHtonU16 (start.GetRemainingSize ());
     }
   else
     {
@@ -202,9 +202,9 @@ UdpHeader::Serialize (Buffer::Iterator start) const
 
       if (m_calcChecksum)
         {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetRemainingSize ());
           i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+          uint16_t checksum = i.CalculateIpChecksum (start.GetRemainingSize (), headerChecksum);
 
           i = start;
           i.Next (6);
@@ -227,9 +227,9 @@ UdpHeader::Deserialize (Buffer::Iterator start)
 
   if (m_calcChecksum)
     {
-      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetRemainingSize ());
       i = start;
-      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+      uint16_t checksum = i.CalculateIpChecksum (start.GetRemainingSize (), headerChecksum);
 
       m_goodChecksum = (checksum == 0);
     }
@@ -125,6 +125,11 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
 
+  /**
+   * \brief Size of the serialized header, for Packet::AddHeaders.
+   */
+  static const uint32_t SERIALIZED_SIZE = 8;
+
   /**
    * \brief Is the UDP checksum correct ?
    * \returns true if the checksum is correct, false otherwise.
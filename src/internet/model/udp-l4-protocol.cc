@@ -359,7 +359,7 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
       return IpL4Protocol::RX_ENDPOINT_UNREACH;
     }
 
-  packet->RemoveHeader(udpHeader);
+  packet->RemoveHeaders (udpHeader);
   for (Ipv4EndPointDemux::EndPointsI endPoint = endPoints.begin ();
        endPoint != endPoints.end (); endPoint++)
     {
@@ -383,7 +383,7 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
 
   udpHeader.InitializeChecksum (header.GetSourceAddress (), header.GetDestinationAddress (), PROT_NUMBER);
 
-  packet->RemoveHeader (udpHeader);
+  packet->RemoveHeaders (udpHeader);
 
   if(!udpHeader.IsChecksumOk () && !header.GetSourceAddress ().IsIpv4MappedAddress ())
     {
@@ -426,7 +426,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
   udpHeader.SetDestinationPort (dport);
   udpHeader.SetSourcePort (sport);
 
-  packet->AddHeader (udpHeader);
+  packet->AddHeaders (udpHeader);
 
   m_downTarget (packet, saddr, daddr, PROT_NUMBER, 0);
 }
@@ -449,7 +449,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
   udpHeader.SetDestinationPort (dport);
   udpHeader.SetSourcePort (sport);
 
-  packet->AddHeader (udpHeader);
+  packet->AddHeaders (udpHeader);
 
   m_downTarget (packet, saddr, daddr, PROT_NUMBER, route);
 }
@@ -472,7 +472,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
   udpHeader.SetDestinationPort (dport);
   udpHeader.SetSourcePort (sport);
 
-  packet->AddHeader (udpHeader);
+  packet->AddHeaders (udpHeader);
 
   m_downTarget6 (packet, saddr, daddr, PROT_NUMBER, 0);
 }
@@ -495,7 +495,7 @@ UdpL4Protocol::Send (Ptr<Packet> packet,
   udpHeader.SetDestinationPort (dport);
   udpHeader.SetSourcePort (sport);
 
-  packet->AddHeader (udpHeader);
+  packet->AddHeaders (udpHeader);
 
   m_downTarget6 (packet, saddr, daddr, PROT_NUMBER, route);
 }
@@ -993,6 +993,13 @@ UdpSocketImpl::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
       packet->AddPacketTag (ipTtlTag);
     }
 
+  if (IsRecvPktCallbackSet ())
+    { // Direct delivery, without the receive buffer and the address tag
+      NotifyPktRecv (packet, InetSocketAddress (header.GetSource (), port),
+                     InetSocketAddress (header.GetDestination (), m_endPoint->GetLocalPort ()));
+      return;
+    }
+
   if ((m_rxAvailable + packet->GetSize ()) <= m_rcvBufSize)
     {
       Address address = InetSocketAddress (header.GetSource (), port);
@@ -1049,6 +1056,13 @@ UdpSocketImpl::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
       packet->AddPacketTag (ipHopLimitTag);
     }
 
+  if (IsRecvPktCallbackSet ())
+    { // Direct delivery, without the receive buffer and the address tag
+      NotifyPktRecv (packet, Inet6SocketAddress (header.GetSourceAddress (), port),
+                     Inet6SocketAddress (header.GetDestinationAddress (), m_endPoint6->GetLocalPort ()));
+      return;
+    }
+
   if ((m_rxAvailable + packet->GetSize ()) <= m_rcvBufSize)
     {
       Address address = Inet6SocketAddress (header.GetSourceAddress (), port);
@@ -24,6 +24,7 @@
 #include "ns3/integer.h"
 #include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet.h"
 #include "udp-socket.h"
 
 namespace ns3 {
@@ -87,4 +88,24 @@ UdpSocket::~UdpSocket ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+void
+UdpSocket::SetRecvPktCallback (Callback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> receivedPacket)
+{
+  NS_LOG_FUNCTION (this);
+  m_receivedPkt = receivedPacket;
+}
+
+bool
+UdpSocket::IsRecvPktCallbackSet (void) const
+{
+  return !m_receivedPkt.IsNull ();
+}
+
+void
+UdpSocket::NotifyPktRecv (Ptr<Packet> packet, const Address &from, const Address &to)
+{
+  NS_LOG_FUNCTION (this << packet << from << to);
+  m_receivedPkt (this, packet, from, to);
+}
+
 } // namespace ns3
@@ -102,7 +102,41 @@ public:
    */
   virtual int MulticastLeaveGroup (uint32_t interface, const Address &groupAddress) = 0;
 
+  /**
+   * \brief Deliver the received datagrams directly to a callback
+   *
+   * \param receivedPacket Callback invoked with the socket, the datagram,
+   *        the address and port of its sender, and the local address and
+   *        port it was sent to
+   *
+   * Once set, each received datagram is passed to the callback as soon as
+   * it arrives, instead of being queued in the receive buffer for Recv ()
+   * and RecvFrom () with a SocketAddressTag: the callback set by
+   * SetRecvCallback is not invoked anymore, and the receive buffer size
+   * does not limit the reception.  The packet tags asked for by the socket
+   * options (e.g., SetRecvPktInfo) are still added.  Set a null callback
+   * to go back to the queued delivery.
+   */
+  void SetRecvPktCallback (Callback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> receivedPacket);
+
+protected:
+  /**
+   * \brief Whether the received datagrams are delivered directly
+   * \returns true if a callback was set by SetRecvPktCallback
+   */
+  bool IsRecvPktCallbackSet (void) const;
+
+  /**
+   * \brief Notify through the callback set by SetRecvPktCallback that a datagram was received
+   * \param packet the datagram
+   * \param from the address and port of the sender
+   * \param to the local address and port the datagram was sent to
+   */
+  void NotifyPktRecv (Ptr<Packet> packet, const Address &from, const Address &to);
+
 private:
+  Callback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> m_receivedPkt; //!< Direct delivery callback
+
   // Indirect the attribute setting and getting through private virtual methods
   /**
    * \brief Set the receiving buffer size
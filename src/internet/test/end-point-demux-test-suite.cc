@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/private/ipv4-end-point-demux.h"
+#include "ns3/private/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/private/ipv6-end-point-demux.h"
+#include "ns3/private/ipv6-end-point.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+// Test 1: a server with many connections, over IPv4
+class Ipv4EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTest ();
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTest::Ipv4EndPointDemuxTest ()
+  : TestCase ("Ipv4EndPointDemux finds the connected end points by peer")
+{
+}
+
+void
+Ipv4EndPointDemuxTest::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address server ("10.0.0.1");
+
+  Ipv4EndPoint *listener = demux.Allocate (6000);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "The listener should be allocated");
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (6000) == 0), true, "The port is already bound");
+
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv4Address peer (Ipv4Address ("10.1.0.0").Get () + i);
+      connections.push_back (demux.Allocate (server, 6000, peer, 49152));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "The connection should be allocated");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (server, 6000, Ipv4Address ("10.1.0.7"), 49152) == 0), true,
+                         "The four-tuple is already in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6000), true, "The port is in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6001), false, "The port is not in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (server, 6000), true, "The address and port are in use");
+
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (server, 6000, Ipv4Address ("10.1.1.244"), 49152, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "There should be one exact match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connections[500], "The connection to the sender should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (server, 6000, Ipv4Address ("10.1.1.244"), 49152), connections[500],
+                         "The connection to the sender should match");
+
+  found = demux.Lookup (server, 6000, Ipv4Address ("10.2.0.1"), 49152, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "There should be one wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The listener should match an unknown sender");
+  // SimpleLookup prefers the end point with the fewest wildcards, whatever its peer.
+  Ipv4EndPoint *generic = demux.SimpleLookup (server, 6000, Ipv4Address ("10.2.0.1"), 49152);
+  NS_TEST_ASSERT_MSG_NE (generic, 0, "An end point of the port should match an unknown sender");
+  NS_TEST_EXPECT_MSG_EQ ((generic != listener && generic->GetLocalAddress () == server), true,
+                         "A connection to another peer should match an unknown sender");
+
+  // An end point which changes its local address moves in the index.
+  Ipv4EndPoint *client = demux.Allocate (7000);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ipv4Address::GetAny (), 7000), true, "The wildcard address is in use");
+  client->SetLocalAddress (server);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (server, 7000), true, "The new local address is in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (Ipv4Address::GetAny (), 7000), false, "The wildcard address is free");
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (server, 7000), false, "The address and port are free");
+
+  // An end point which changes its peer moves in the index.
+  connections[500]->SetPeer (Ipv4Address ("10.2.0.1"), 49152);
+  found = demux.Lookup (server, 6000, Ipv4Address ("10.2.0.1"), 49152, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connections[500], "The new peer should match");
+  found = demux.Lookup (server, 6000, Ipv4Address ("10.1.1.244"), 49152, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The old peer should not match any more");
+
+  // A disabled end point is skipped.
+  connections[10]->SetRxEnabled (false);
+  found = demux.Lookup (server, 6000, Ipv4Address ("10.1.0.10"), 49152, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "A disabled connection should not match");
+
+  demux.DeAllocate (connections[20]);
+  found = demux.Lookup (server, 6000, Ipv4Address ("10.1.0.20"), 49152, interface);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "A deallocated connection should not match");
+  NS_TEST_EXPECT_MSG_NE (demux.Allocate (server, 6000, Ipv4Address ("10.1.0.20"), 49152), 0,
+                         "The four-tuple is free again");
+
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      if (i != 20)
+        {
+          demux.DeAllocate (connections[i]);
+        }
+    }
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6000), true, "The new connection still uses the port");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 1, "There should be one end point left");
+  demux.DeAllocate (demux.GetAllEndPoints ().front ());
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6000), false, "The port is free");
+}
+
+// Test 2: a server with many connections, over IPv6
+class Ipv6EndPointDemuxTest : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTest ();
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTest::Ipv6EndPointDemuxTest ()
+  : TestCase ("Ipv6EndPointDemux finds the connected end points by peer")
+{
+}
+
+/**
+ * \param i an index
+ * \returns the address of the i-th peer
+ */
+static Ipv6Address
+GetPeer (uint32_t i)
+{
+  std::ostringstream oss;
+  oss << "2001:db8::" << std::hex << i + 1;
+  return Ipv6Address (oss.str ().c_str ());
+}
+
+void
+Ipv6EndPointDemuxTest::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ipv6Address server ("2001:db8:1::1");
+
+  Ipv6EndPoint *listener = demux.Allocate (6000);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "The listener should be allocated");
+
+  std::vector<Ipv6EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      connections.push_back (demux.Allocate (server, 6000, GetPeer (i), 49152));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "The connection should be allocated");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((demux.Allocate (server, 6000, GetPeer (7), 49152) == 0), true,
+                         "The four-tuple is already in use");
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (server, 6000, GetPeer (500), 49152, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "There should be one exact match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connections[500], "The connection to the sender should match");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (server, 6000, GetPeer (500), 49152), connections[500],
+                         "The connection to the sender should match");
+
+  found = demux.Lookup (server, 6000, GetPeer (2000), 49152, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "There should be one wildcard match");
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The listener should match an unknown sender");
+  Ipv6EndPoint *generic = demux.SimpleLookup (server, 6000, GetPeer (2000), 49152);
+  NS_TEST_ASSERT_MSG_NE (generic, 0, "An end point of the port should match an unknown sender");
+  NS_TEST_EXPECT_MSG_EQ ((generic != listener && generic->GetLocalAddress () == server), true,
+                         "A connection to another peer should match an unknown sender");
+
+  connections[500]->SetPeer (GetPeer (2000), 49152);
+  found = demux.Lookup (server, 6000, GetPeer (2000), 49152, 0);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), connections[500], "The new peer should match");
+  found = demux.Lookup (server, 6000, GetPeer (500), 49152, 0);
+  NS_TEST_EXPECT_MSG_EQ (found.front (), listener, "The old peer should not match any more");
+
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6000), true, "The listener still uses the port");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (6000), false, "The port is free");
+}
+
+static class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTest (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTest (), TestCase::QUICK);
+  }
+} g_endPointDemuxTestSuite;
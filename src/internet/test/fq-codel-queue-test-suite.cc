@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/fq-codel-queue.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * Create an IPv4/UDP packet.
+ * \param src the source address
+ * \param dst the destination address
+ * \param srcPort the source port
+ * \param dstPort the destination port
+ * \param size the payload size
+ * \returns the packet
+ */
+static Ptr<Packet>
+CreateUdpPacket (const char *src, const char *dst, uint16_t srcPort, uint16_t dstPort,
+                 uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (srcPort);
+  udp.SetDestinationPort (dstPort);
+  p->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address (src));
+  ip.SetDestination (Ipv4Address (dst));
+  ip.SetProtocol (17);
+  ip.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ip);
+  return p;
+}
+
+// Test 1: flow classification
+class FqCoDelQueueClassify : public TestCase
+{
+public:
+  FqCoDelQueueClassify ();
+  virtual void DoRun (void);
+};
+
+FqCoDelQueueClassify::FqCoDelQueueClassify ()
+  : TestCase ("Classification of packets into flows by their 5-tuple")
+{
+}
+
+void
+FqCoDelQueueClassify::DoRun (void)
+{
+  Ptr<FqCoDelQueue> queue = CreateObject<FqCoDelQueue> ();
+
+  uint32_t a = queue->Classify (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 100));
+  uint32_t b = queue->Classify (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 500));
+  NS_TEST_EXPECT_MSG_EQ (a, b, "The flow does not depend on the payload");
+  NS_TEST_EXPECT_MSG_LT (a, queue->GetNFlows (), "Flow index out of range");
+
+  Ptr<Packet> framed = CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 100);
+  EthernetHeader ethernet;
+  ethernet.SetLengthType (0x0800);
+  framed->AddHeader (ethernet);
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (framed), a, "The Ethernet header should be skipped");
+
+  // Different ports should spread the packets over several flows.
+  uint32_t distinct = 0;
+  for (uint16_t port = 5001; port < 5009; port++)
+    {
+      if (queue->Classify (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, port, 100)) != a)
+        {
+          distinct++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (distinct, 5, "The ports should be hashed");
+
+  // The fragments of a datagram stay in the same flow.
+  Ptr<Packet> first = CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 100);
+  Ipv4Header ip;
+  first->RemoveHeader (ip);
+  ip.SetMoreFragments ();
+  first->AddHeader (ip);
+  Ptr<Packet> second = Create<Packet> (100);
+  ip.SetLastFragment ();
+  ip.SetFragmentOffset (128);
+  second->AddHeader (ip);
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (first), queue->Classify (second),
+                         "The fragments should be in the same flow");
+}
+
+// Test 2: deficit round robin between flows
+class FqCoDelQueueRoundRobin : public TestCase
+{
+public:
+  FqCoDelQueueRoundRobin ();
+  virtual void DoRun (void);
+};
+
+FqCoDelQueueRoundRobin::FqCoDelQueueRoundRobin ()
+  : TestCase ("A flow with a large backlog does not delay a new flow")
+{
+}
+
+void
+FqCoDelQueueRoundRobin::DoRun (void)
+{
+  Ptr<FqCoDelQueue> queue = CreateObject<FqCoDelQueue> ();
+
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      queue->Enqueue (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 472));
+    }
+  Ptr<Packet> b = CreateUdpPacket ("10.0.1.1", "10.0.1.2", 4000, 5000, 472);
+  uint32_t flowB = queue->Classify (b);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (b->Copy ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 23, "There should be 23 packets in queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNewFlowCount (), 2, "There should be two new flows");
+
+  // The first flow sends a quantum of 1514 bytes, that is four packets
+  // of 500 bytes, then the second flow sends its three packets.
+  for (uint32_t i = 0; i < 23; i++)
+    {
+      Ptr<Packet> p = queue->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (p, 0, "There should be a packet");
+      bool fromB = queue->Classify (p) == flowB;
+      NS_TEST_EXPECT_MSG_EQ (fromB, (i >= 4 && i < 7), "Unexpected flow for packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), 0, "There are really no packets in queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes in queue");
+
+  Ptr<CoDelQueue> flowQueue = queue->GetFlowQueue (flowB);
+  NS_TEST_ASSERT_MSG_NE (flowQueue, 0, "The flow queue should exist");
+  NS_TEST_EXPECT_MSG_EQ (flowQueue->GetTotalReceivedPackets (), 3, "Unexpected flow queue statistics");
+}
+
+// Test 3: drops from the largest flow when the queue is full
+class FqCoDelQueueOverflow : public TestCase
+{
+public:
+  FqCoDelQueueOverflow ();
+  virtual void DoRun (void);
+};
+
+FqCoDelQueueOverflow::FqCoDelQueueOverflow ()
+  : TestCase ("Overflow drops packets from the largest flow")
+{
+}
+
+void
+FqCoDelQueueOverflow::DoRun (void)
+{
+  Ptr<FqCoDelQueue> queue = CreateObject<FqCoDelQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (10));
+
+  for (uint32_t i = 0; i < 12; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 972)),
+                             true, "Arriving packets are always accepted");
+    }
+  Ptr<Packet> b = CreateUdpPacket ("10.0.1.1", "10.0.1.2", 4000, 5000, 72);
+  queue->Enqueue (b);
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 10, "The queue should be full");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetDropOverLimit (), 3, "Three packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 3, "Three packets should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 9 * 1000 + 100, "Unexpected number of bytes");
+
+  bool found = false;
+  while (Ptr<Packet> p = queue->Dequeue ())
+    {
+      found = found || p == b;
+    }
+  NS_TEST_EXPECT_MSG_EQ (found, true, "The packet of the small flow should not be dropped");
+
+  Simulator::Destroy ();
+}
+
+// Test 4: the arriving packet is dropped on enqueue when it would be the victim
+class FqCoDelQueueOverflowVictim : public TestCase
+{
+public:
+  FqCoDelQueueOverflowVictim ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record a queue event.
+   * \param event the event name
+   * \param p the packet
+   */
+  void Trace (std::string event, Ptr<const Packet> p);
+
+  std::vector<std::pair<std::string, Ptr<const Packet> > > m_events; //!< The queue events, in order
+};
+
+FqCoDelQueueOverflowVictim::FqCoDelQueueOverflowVictim ()
+  : TestCase ("Overflow drops the arriving packet on enqueue when it is alone in the largest flow")
+{
+}
+
+void
+FqCoDelQueueOverflowVictim::Trace (std::string event, Ptr<const Packet> p)
+{
+  m_events.push_back (std::make_pair (event, p));
+}
+
+void
+FqCoDelQueueOverflowVictim::DoRun (void)
+{
+  Ptr<FqCoDelQueue> queue = CreateObject<FqCoDelQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (3));
+  queue->TraceConnect ("Enqueue", "Enqueue", MakeCallback (&FqCoDelQueueOverflowVictim::Trace, this));
+  queue->TraceConnect ("Dequeue", "Dequeue", MakeCallback (&FqCoDelQueueOverflowVictim::Trace, this));
+  queue->TraceConnect ("Drop", "Drop", MakeCallback (&FqCoDelQueueOverflowVictim::Trace, this));
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 72));
+    }
+  m_events.clear ();
+
+  // The new flow, with its single packet, is larger than the other one.
+  Ptr<Packet> b = CreateUdpPacket ("10.0.1.1", "10.0.1.2", 4000, 5000, 972);
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (b), false, "The arriving packet should be dropped on enqueue");
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), 1, "Only the drop should be traced");
+  NS_TEST_EXPECT_MSG_EQ (m_events[0].first, "Drop", "Unexpected event");
+  NS_TEST_EXPECT_MSG_EQ (m_events[0].second, b, "The arriving packet should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "The queue should be full");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 3 * 100, "Unexpected number of bytes");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetDropOverLimit (), 1, "One packet should have been dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 1, "One packet should have been dropped");
+
+  // A packet of the large flow now drops the head of the large flow first.
+  m_events.clear ();
+  Ptr<Packet> c = CreateUdpPacket ("10.0.0.1", "10.0.0.2", 4000, 5000, 72);
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (c), true, "The arriving packet should be accepted");
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), 3, "Unexpected number of events");
+  NS_TEST_EXPECT_MSG_EQ (m_events[0].first, "Drop", "The head should be dropped first");
+  NS_TEST_EXPECT_MSG_EQ (m_events[1].first, "Dequeue", "The head should then leave the queue");
+  NS_TEST_EXPECT_MSG_EQ (m_events[2].first, "Enqueue", "The arriving packet should be enqueued last");
+  NS_TEST_EXPECT_MSG_EQ (m_events[2].second, c, "Unexpected packet enqueued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 3, "The queue should be full");
+
+  uint32_t n = 0;
+  while (queue->Dequeue ())
+    {
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 3, "Unexpected number of packets dequeued");
+
+  Simulator::Destroy ();
+}
+
+static class FqCoDelQueueTestSuite : public TestSuite
+{
+public:
+  FqCoDelQueueTestSuite ()
+    : TestSuite ("fq-codel-queue", UNIT)
+  {
+    AddTestCase (new FqCoDelQueueClassify (), TestCase::QUICK);
+    AddTestCase (new FqCoDelQueueRoundRobin (), TestCase::QUICK);
+    AddTestCase (new FqCoDelQueueOverflow (), TestCase::QUICK);
+    AddTestCase (new FqCoDelQueueOverflowVictim (), TestCase::QUICK);
+  }
+} g_fqCoDelQueueTestSuite;
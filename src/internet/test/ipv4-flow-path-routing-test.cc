@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-flow-path-routing-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/boolean.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Precomputed flow paths, and their failover
+ *
+ * Topology, the link between 1 and 3 having a higher metric:
+ * \verbatim
+          +-- 2 --+
+    0 -- 1        4
+          +-- 3 --+
+   \endverbatim
+ *
+ * The link between 2 and 4 is declared as failing on the side of node 2.
+ * It is set down, then up, by Ipv4::SetDown and Ipv4::SetUp on either
+ * side.  With the route cache of Ipv4L3Protocol turned on before
+ * PopulateFlowPaths, the cache must be turned off on every node.
+ */
+class Ipv4FlowPathRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * \param downNode the node whose interface on the link between 2 and 4 goes down, 2 or 4
+   * \param routeCache whether the route cache is turned on before the paths are computed
+   */
+  Ipv4FlowPathRoutingTestCase (uint32_t downNode, bool routeCache);
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Count the UDP packets received by a socket
+   * \param socket the socket
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+  /**
+   * \brief Count the packets forwarded by a node
+   * \param node the index of the node
+   * \param header the IPv4 header
+   * \param packet the packet
+   * \param interface the output interface
+   */
+  void Forward (uint32_t node, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+  /**
+   * \brief Send a packet from the source node
+   * \param destination the destination address
+   */
+  void SendPkt (Ipv4Address destination);
+  /**
+   * \brief Record the path used by the flow
+   * \param destination the destination address of the flow
+   */
+  void RecordPath (Ipv4Address destination);
+
+  uint32_t m_downNode;                //!< Node whose interface goes down
+  bool m_routeCache;                  //!< Turn the route cache on
+  NodeContainer m_nodes;              //!< Nodes
+  Ptr<Socket> m_txSocket;             //!< Socket of the source node
+  uint32_t m_received;                //!< Packets received
+  uint32_t m_forwarded[5];            //!< Packets forwarded by each node
+  std::vector<int32_t> m_paths;       //!< Recorded paths of the flow
+};
+
+Ipv4FlowPathRoutingTestCase::Ipv4FlowPathRoutingTestCase (uint32_t downNode, bool routeCache)
+  : TestCase (std::string ("Packets routed on precomputed flow paths, and on their failover paths, link down at node ") +
+              (downNode == 2 ? "2" : "4") + (routeCache ? ", route cache" : "")),
+    m_downNode (downNode),
+    m_routeCache (routeCache),
+    m_received (0)
+{
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      m_forwarded[i] = 0;
+    }
+}
+
+void
+Ipv4FlowPathRoutingTestCase::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received++;
+    }
+}
+
+void
+Ipv4FlowPathRoutingTestCase::Forward (uint32_t node, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  m_forwarded[node]++;
+}
+
+void
+Ipv4FlowPathRoutingTestCase::SendPkt (Ipv4Address destination)
+{
+  m_txSocket->SendTo (Create<Packet> (100), 0, InetSocketAddress (destination, 1234));
+}
+
+void
+Ipv4FlowPathRoutingTestCase::RecordPath (Ipv4Address destination)
+{
+  m_paths.push_back (Ipv4FlowPathRoutingHelper::GetFlowPathRouting (m_nodes.Get (0))->GetFlowPath (destination));
+}
+
+void
+Ipv4FlowPathRoutingTestCase::DoRun (void)
+{
+  m_nodes.Create (5);
+
+  Ipv4FlowPathRoutingHelper flowPaths;
+  Ipv4ListRoutingHelper list;
+  list.Add (Ipv4StaticRoutingHelper (), 0);
+  list.Add (flowPaths, 10);
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (list);
+  internet.Install (m_nodes);
+
+  // links 0-1, 1-2, 2-4, 1-3 and 3-4, each on its own channel
+  uint32_t links[5][2] = { { 0, 1 }, { 1, 2 }, { 2, 4 }, { 1, 3 }, { 3, 4 } };
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper addresses ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces[5];
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NetDeviceContainer devices = simple.Install (NodeContainer (m_nodes.Get (links[i][0]), m_nodes.Get (links[i][1])));
+      interfaces[i] = addresses.Assign (devices);
+      addresses.NewNetwork ();
+    }
+  m_nodes.Get (1)->GetObject<Ipv4> ()->SetMetric (3, 10);
+  Ipv4Address destination = interfaces[2].GetAddress (1);
+  Ipv4Address otherDestination = interfaces[4].GetAddress (1);
+
+  flowPaths.AddFlow (m_nodes.Get (0), destination);
+  flowPaths.AddFlow (m_nodes.Get (0), otherDestination,
+                     NodeContainer (NodeContainer (m_nodes.Get (0), m_nodes.Get (1)), NodeContainer (m_nodes.Get (2), m_nodes.Get (4))));
+  // the interface of node 2 toward node 4
+  flowPaths.AddLinkFailure (m_nodes.Get (2), 2);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->SetAttribute ("RouteCache", BooleanValue (m_routeCache));
+    }
+  flowPaths.PopulateFlowPaths ();
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      BooleanValue routeCache;
+      m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->GetAttribute ("RouteCache", routeCache);
+      NS_TEST_EXPECT_MSG_EQ (routeCache.Get (), false, "the route cache must be off");
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (Ipv4FlowPathRouting::GetNPaths (), 4, "two flows with a failover path each");
+  Ptr<Ipv4FlowPathRouting> routing = Ipv4FlowPathRoutingHelper::GetFlowPathRouting (m_nodes.Get (0));
+  int32_t path = routing->GetFlowPath (destination);
+  NS_TEST_EXPECT_MSG_EQ ((path != -1 && Ipv4FlowPathRouting::GetPath (path).size () == 3
+                          && Ipv4FlowPathRouting::GetPath (path)[1].m_nextNode == m_nodes.Get (2)->GetId ()),
+                         true, "the shortest path goes through node 2");
+  path = routing->GetFlowPath (otherDestination);
+  NS_TEST_EXPECT_MSG_EQ ((path != -1 && Ipv4FlowPathRouting::GetPath (path).size () == 3
+                          && Ipv4FlowPathRouting::GetPath (path)[1].m_nextNode == m_nodes.Get (2)->GetId ()),
+                         true, "the given path goes through node 2");
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+        "UnicastForward", MakeCallback (&Ipv4FlowPathRoutingTestCase::Forward, this).Bind (i));
+    }
+  Ptr<Socket> rxSocket = m_nodes.Get (4)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4FlowPathRoutingTestCase::ReceivePkt, this));
+  m_txSocket = m_nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+
+  // no flow, and no static route, to node 3
+  NS_TEST_EXPECT_MSG_EQ (m_txSocket->SendTo (Create<Packet> (100), 0, InetSocketAddress (interfaces[3].GetAddress (1), 1234)),
+                         -1, "only the declared flows are routed");
+
+  // the interface of node 2 toward node 4 is 2, the one of node 4 toward node 2 is 1
+  Ptr<Ipv4> ipv4 = m_nodes.Get (m_downNode)->GetObject<Ipv4> ();
+  uint32_t downInterface = (m_downNode == 2 ? 2 : 1);
+  Simulator::Schedule (Seconds (1), &Ipv4FlowPathRoutingTestCase::SendPkt, this, destination);
+  Simulator::Schedule (Seconds (1), &Ipv4FlowPathRoutingTestCase::SendPkt, this, otherDestination);
+  Simulator::Schedule (Seconds (1), &Ipv4FlowPathRoutingTestCase::RecordPath, this, destination);
+  Simulator::Schedule (Seconds (2), &Ipv4::SetDown, ipv4, downInterface);
+  Simulator::Schedule (Seconds (3), &Ipv4FlowPathRoutingTestCase::SendPkt, this, destination);
+  Simulator::Schedule (Seconds (3), &Ipv4FlowPathRoutingTestCase::RecordPath, this, destination);
+  Simulator::Schedule (Seconds (4), &Ipv4::SetUp, ipv4, downInterface);
+  Simulator::Schedule (Seconds (5), &Ipv4FlowPathRoutingTestCase::SendPkt, this, destination);
+  Simulator::Schedule (Seconds (5), &Ipv4FlowPathRoutingTestCase::RecordPath, this, destination);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 4, "all the packets should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[1], 4, "node 1 forwards all the packets");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[2], 3, "node 2 forwards the packets while its link is up");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded[3], 1, "node 3 forwards the packet sent during the failure");
+  NS_TEST_EXPECT_MSG_EQ (m_paths.size (), 3, "three recorded paths");
+  NS_TEST_EXPECT_MSG_EQ ((m_paths.size () == 3 && m_paths[0] != m_paths[1] && m_paths[0] == m_paths[2]), true,
+                         "the failover path is used during the failure only");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4FlowPathRouting TestSuite
+ */
+class Ipv4FlowPathRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4FlowPathRoutingTestSuite () : TestSuite ("ipv4-flow-path-routing", UNIT)
+  {
+    AddTestCase (new Ipv4FlowPathRoutingTestCase (2, false), TestCase::QUICK);
+    AddTestCase (new Ipv4FlowPathRoutingTestCase (4, false), TestCase::QUICK);
+    AddTestCase (new Ipv4FlowPathRoutingTestCase (2, true), TestCase::QUICK);
+  }
+};
+
+static Ipv4FlowPathRoutingTestSuite g_ipv4FlowPathRoutingTestSuite;
@@ -68,18 +68,20 @@ AddInternetStack (Ptr<Node> node)
 class Ipv4ForwardingTest : public TestCase
 {
   Ptr<Packet> m_receivedPacket;
+  bool m_routeCache;
   void DoSendData (Ptr<Socket> socket, std::string to);
   void SendData (Ptr<Socket> socket, std::string to);
 
 public:
   virtual void DoRun (void);
-  Ipv4ForwardingTest ();
+  Ipv4ForwardingTest (bool routeCache);
 
   void ReceivePkt (Ptr<Socket> socket);
 };
 
-Ipv4ForwardingTest::Ipv4ForwardingTest ()
-  : TestCase ("UDP socket implementation") 
+Ipv4ForwardingTest::Ipv4ForwardingTest (bool routeCache)
+  : TestCase (routeCache ? "UDP socket implementation, route cache" : "UDP socket implementation"),
+    m_routeCache (routeCache)
 {
 }
 
@@ -141,6 +143,7 @@ Ipv4ForwardingTest::DoRun (void)
     Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask (0xffff0000U));
     ipv4->AddAddress (netdev_idx, ipv4Addr);
     ipv4->SetUp (netdev_idx);
+    ipv4->SetAttribute ("RouteCache", BooleanValue (m_routeCache));
   }
 
   { // second interface
@@ -199,6 +202,19 @@ Ipv4ForwardingTest::DoRun (void)
   m_receivedPacket->RemoveAllByteTags ();
   m_receivedPacket = 0;
 
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding on, second packet");
+
+  // A more specific route to a gateway which does not exist
+  Ptr<Ipv4StaticRouting> fwRouting = fwNode->GetObject<Ipv4StaticRouting> ();
+  fwRouting->AddHostRouteTo (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"), 1);
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 0, "IPv4 Forwarding to the new route");
+
+  fwRouting->RemoveRoute (fwRouting->GetNRoutes () - 1);
+  SendData (txSocket, "10.0.0.2");
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 123, "IPv4 Forwarding to the restored route");
+
   Ptr<Ipv4> ipv4 = fwNode->GetObject<Ipv4> ();
   ipv4->SetAttribute("IpForward", BooleanValue (false));
   SendData (txSocket, "10.0.0.2");
@@ -216,6 +232,7 @@ class Ipv4ForwardingTestSuite : public TestSuite
 public:
   Ipv4ForwardingTestSuite () : TestSuite ("ipv4-forwarding", UNIT)
   {
-    AddTestCase (new Ipv4ForwardingTest, TestCase::QUICK);
+    AddTestCase (new Ipv4ForwardingTest (false), TestCase::QUICK);
+    AddTestCase (new Ipv4ForwardingTest (true), TestCase::QUICK);
   }
 } g_ipv4forwardingTestSuite;
@@ -29,6 +29,7 @@
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/loopback-net-device.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -140,6 +141,65 @@ Ipv4L3ProtocolTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class Ipv4IdentificationTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  Ipv4IdentificationTestCase ();
+  /**
+   * \brief Run unit tests for this class.
+   */
+  virtual void
+  DoRun (void);
+
+};
+
+Ipv4IdentificationTestCase::Ipv4IdentificationTestCase () :
+  TestCase ("Verify the identification of the IPv4 packets")
+{
+}
+
+void
+Ipv4IdentificationTestCase::DoRun (void)
+{
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  ipv4->SetAttribute ("IdentificationTableSize", UintegerValue (16));
+  Ipv4Address source ("10.0.0.1");
+
+  /* Below the size of the table, each tuple counts from 0 */
+  for (uint16_t id = 0; id < 3; id++)
+    {
+      for (uint32_t i = 0; i < 11; i++)
+        {
+          Ipv4Header header = ipv4->BuildHeader (source, Ipv4Address (0x0a010000 + i), 17, 100, 64, 0, true);
+          NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), id, "Wrong identification for tuple " << i);
+        }
+    }
+  Ipv4Header header = ipv4->BuildHeader (source, Ipv4Address (0x0a010000), 6, 100, 64, 0, false);
+  NS_TEST_ASSERT_MSG_EQ (header.GetIdentification (), 0, "The protocol is part of the tuple");
+
+  /* Beyond it, the tuples share counters, which still increase for each tuple */
+  std::vector<uint16_t> last (100, 0);
+  for (uint16_t round = 0; round < 3; round++)
+    {
+      for (uint32_t i = 11; i < 100; i++)
+        {
+          header = ipv4->BuildHeader (source, Ipv4Address (0x0a010000 + i), 17, 100, 64, 0, true);
+          if (round > 0)
+            {
+              NS_TEST_ASSERT_MSG_GT (header.GetIdentification (), last[i], "Identification repeated for tuple " << i);
+            }
+          last[i] = header.GetIdentification ();
+        }
+    }
+  header = ipv4->BuildHeader (source, Ipv4Address (0x0a010000), 17, 100, 64, 0, true);
+  NS_TEST_ASSERT_MSG_GT (header.GetIdentification (), 2, "The counters of the first tuples are kept");
+
+  ipv4->Dispose ();
+}
+
   
 static class IPv4L3ProtocolTestSuite : public TestSuite
 {
@@ -148,5 +208,6 @@ public:
     TestSuite ("ipv4-protocol", UNIT)
   {
     AddTestCase (new Ipv4L3ProtocolTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4IdentificationTestCase (), TestCase::QUICK);
   }
 } g_ipv4protocolTestSuite;
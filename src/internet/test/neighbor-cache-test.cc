@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/icmpv6-l4-protocol.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Permanent neighbor entries filled by the NeighborCacheHelper
+ */
+class NeighborCacheTestCase : public TestCase
+{
+public:
+  NeighborCacheTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Count the ARP frames received by a node
+   */
+  void ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                   const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Count the UDP packets received by a socket
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+
+  uint32_t m_arpFrames;  //!< ARP frames received
+  uint32_t m_udpPackets; //!< UDP packets received
+};
+
+NeighborCacheTestCase::NeighborCacheTestCase ()
+  : TestCase ("Permanent ARP and NDISC entries of static neighbors"),
+    m_arpFrames (0),
+    m_udpPackets (0)
+{
+}
+
+void
+NeighborCacheTestCase::ReceiveArp (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                   const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_arpFrames++;
+}
+
+void
+NeighborCacheTestCase::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_udpPackets++;
+    }
+}
+
+void
+NeighborCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  SimpleNetDeviceHelper helperChannel;
+  NetDeviceContainer devices = helperChannel.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      std::ostringstream v4, v6;
+      v4 << "10.1.1." << i + 1;
+      v6 << "2001:1::" << i + 1;
+
+      Ptr<Ipv4> ipv4 = nodes.Get (i)->GetObject<Ipv4> ();
+      uint32_t interface = ipv4->AddInterface (devices.Get (i));
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (v4.str ().c_str ()), Ipv4Mask ("255.255.255.0")));
+      ipv4->SetUp (interface);
+
+      Ptr<Ipv6> ipv6 = nodes.Get (i)->GetObject<Ipv6> ();
+      interface = ipv6->AddInterface (devices.Get (i));
+      ipv6->AddAddress (interface, Ipv6InterfaceAddress (Ipv6Address (v6.str ().c_str ()), Ipv6Prefix (64)));
+      ipv6->SetUp (interface);
+    }
+  // an address which is not on the link of the other nodes
+  Ptr<Ipv4> ipv4 = nodes.Get (2)->GetObject<Ipv4> ();
+  ipv4->AddAddress (1, Ipv4InterfaceAddress (Ipv4Address ("10.2.2.3"), Ipv4Mask ("255.255.255.0")));
+
+  NeighborCacheHelper neighborCache;
+  neighborCache.PopulateNeighborCache ();
+
+  Ptr<ArpCache> arpCache = nodes.Get (0)->GetObject<Ipv4L3Protocol> ()->GetInterface (1)->GetArpCache ();
+  ArpCache::Entry *arpEntry = arpCache->Lookup (Ipv4Address ("10.1.1.2"));
+  NS_TEST_EXPECT_MSG_EQ ((arpEntry != 0 && arpEntry->IsPermanent ()), true, "the ARP entry of the neighbor should be permanent");
+  NS_TEST_EXPECT_MSG_EQ ((arpEntry != 0 && arpEntry->GetMacAddress () == devices.Get (1)->GetAddress ()), true, "wrong MAC address");
+  NS_TEST_EXPECT_MSG_EQ ((arpCache->Lookup (Ipv4Address ("10.1.1.3")) != 0), true, "no ARP entry for the neighbor");
+  NS_TEST_EXPECT_MSG_EQ ((arpCache->Lookup (Ipv4Address ("10.1.1.1")) == 0), true, "no ARP entry expected for the node itself");
+  NS_TEST_EXPECT_MSG_EQ ((arpCache->Lookup (Ipv4Address ("10.2.2.3")) == 0), true, "no ARP entry expected for an off-link address");
+
+  Ptr<NdiscCache> ndiscCache = nodes.Get (0)->GetObject<Ipv6L3Protocol> ()->GetInterface (1)->GetNdiscCache ();
+  NdiscCache::Entry *ndiscEntry = ndiscCache->Lookup (Ipv6Address ("2001:1::2"));
+  NS_TEST_EXPECT_MSG_EQ ((ndiscEntry != 0 && ndiscEntry->IsPermanent ()), true, "the NDISC entry of the neighbor should be permanent");
+  Ipv6Address linkLocal = nodes.Get (1)->GetObject<Ipv6L3Protocol> ()->GetInterface (1)->GetLinkLocalAddress ().GetAddress ();
+  NS_TEST_EXPECT_MSG_EQ ((ndiscCache->Lookup (linkLocal) != 0), true, "no NDISC entry for the neighbor link-local address");
+
+  Address hardwareDestination;
+  Ptr<Icmpv6L4Protocol> icmpv6 = nodes.Get (0)->GetObject<Icmpv6L4Protocol> ();
+  bool found = icmpv6->Lookup (Ipv6Address ("2001:1::2"), devices.Get (0), ndiscCache, &hardwareDestination);
+  NS_TEST_EXPECT_MSG_EQ (found, true, "a permanent NDISC entry should be resolved at once");
+  NS_TEST_EXPECT_MSG_EQ (hardwareDestination, devices.Get (1)->GetAddress (), "wrong MAC address");
+
+  // The first packets go out without any address resolution exchange
+  nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&NeighborCacheTestCase::ReceiveArp, this),
+                                          ArpL3Protocol::PROT_NUMBER, devices.Get (1));
+  Ptr<Socket> rxSocket = nodes.Get (1)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&NeighborCacheTestCase::ReceivePkt, this));
+  Ptr<Socket> rxSocket6 = nodes.Get (1)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket6->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  rxSocket6->SetRecvCallback (MakeCallback (&NeighborCacheTestCase::ReceivePkt, this));
+  Ptr<Socket> txSocket = nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  txSocket->SendTo (Create<Packet> (123), 0, InetSocketAddress (Ipv4Address ("10.1.1.2"), 1234));
+  Ptr<Socket> txSocket6 = nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  txSocket6->SendTo (Create<Packet> (123), 0, Inet6SocketAddress (Ipv6Address ("2001:1::2"), 1234));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_udpPackets, 2, "the packets should be received");
+  NS_TEST_EXPECT_MSG_EQ (m_arpFrames, 0, "no ARP request should be sent to a static neighbor");
+  NS_TEST_EXPECT_MSG_EQ ((arpEntry != 0 && arpEntry->IsPermanent ()), true, "the ARP entry should stay permanent");
+  NS_TEST_EXPECT_MSG_EQ ((ndiscEntry != 0 && ndiscEntry->IsPermanent ()), true, "the NDISC entry should stay permanent");
+
+  // The permanent entries survive the interfaces going down and up, and the
+  // flushes on link changes, the others do not
+  arpCache->Add (Ipv4Address ("10.1.1.99"));
+  ndiscCache->Add (Ipv6Address ("2001:1::99"));
+  nodes.Get (0)->GetObject<Ipv4> ()->SetDown (1);
+  nodes.Get (0)->GetObject<Ipv4> ()->SetUp (1);
+  nodes.Get (0)->GetObject<Ipv6> ()->SetDown (1);
+  nodes.Get (0)->GetObject<Ipv6> ()->SetUp (1);
+  arpCache->Flush ();
+  arpEntry = arpCache->Lookup (Ipv4Address ("10.1.1.2"));
+  NS_TEST_EXPECT_MSG_EQ ((arpEntry != 0 && arpEntry->IsPermanent ()), true, "the ARP entry should survive a flush");
+  NS_TEST_EXPECT_MSG_EQ ((arpCache->Lookup (Ipv4Address ("10.1.1.99")) == 0), true, "the dynamic ARP entry should be flushed");
+  ndiscEntry = ndiscCache->Lookup (Ipv6Address ("2001:1::2"));
+  NS_TEST_EXPECT_MSG_EQ ((ndiscEntry != 0 && ndiscEntry->IsPermanent ()), true, "the NDISC entry should survive the interface going down");
+  NS_TEST_EXPECT_MSG_EQ ((ndiscCache->Lookup (linkLocal) != 0), true, "the NDISC entry of the link-local address should survive too");
+  NS_TEST_EXPECT_MSG_EQ ((ndiscCache->Lookup (Ipv6Address ("2001:1::99")) == 0), true, "the dynamic NDISC entry should be flushed");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor cache helper TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite () : TestSuite ("neighbor-cache", UNIT)
+  {
+    AddTestCase (new NeighborCacheTestCase, TestCase::QUICK);
+  }
+};
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite;
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pie-queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+// Test 1: the queue limit
+class PieQueueOverflow : public TestCase
+{
+public:
+  PieQueueOverflow ();
+  virtual void DoRun (void);
+};
+
+PieQueueOverflow::PieQueueOverflow ()
+  : TestCase ("Packets beyond the limit are dropped")
+{
+}
+
+void
+PieQueueOverflow::DoRun (void)
+{
+  Ptr<PieQueue> queue = CreateObject<PieQueue> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxPackets", UintegerValue (5)), true,
+                         "Verify that we can actually set the attribute MaxPackets");
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (1000)), true, "The queue is not full yet");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Enqueue (Create<Packet> (1000)), false, "The queue is full");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 5, "There should be 5 packets in queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().forcedDrop, 1, "There should be one forced drop");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetStats ().unforcedDrop, 0, "There should be no early drop");
+
+  Simulator::Destroy ();
+}
+
+// Test 2: the drop probability under overload and at rest
+class PieQueueDropProbability : public TestCase
+{
+public:
+  /**
+   * \param overload Whether packets arrive faster than they depart
+   */
+  PieQueueDropProbability (bool overload);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Enqueue and dequeue packets, every millisecond.
+   * \param queue the queue
+   * \param remaining the number of remaining periods
+   */
+  void Step (Ptr<PieQueue> queue, uint32_t remaining);
+  bool m_overload;        //!< Whether packets arrive faster than they depart
+  double m_maxDropProb;   //!< Largest drop probability seen
+};
+
+PieQueueDropProbability::PieQueueDropProbability (bool overload)
+  : TestCase (overload ? "The drop probability rises under overload"
+              : "The drop probability updates stop when the queue is idle"),
+    m_overload (overload),
+    m_maxDropProb (0)
+{
+}
+
+void
+PieQueueDropProbability::Step (Ptr<PieQueue> queue, uint32_t remaining)
+{
+  queue->Enqueue (Create<Packet> (1000));
+  queue->Enqueue (Create<Packet> (1000));
+  if (m_overload)
+    {
+      queue->Enqueue (Create<Packet> (1000));
+    }
+  queue->Dequeue ();
+  queue->Dequeue ();
+  m_maxDropProb = std::max (m_maxDropProb, queue->GetDropProbability ());
+  if (remaining == 1)
+    {
+      // Drain the queue, so that it becomes idle.
+      while (queue->Dequeue ())
+        {
+        }
+    }
+  else
+    {
+      Simulator::Schedule (MilliSeconds (1), &PieQueueDropProbability::Step, this, queue, remaining - 1);
+    }
+}
+
+void
+PieQueueDropProbability::DoRun (void)
+{
+  Ptr<PieQueue> queue = CreateObject<PieQueue> ();
+  queue->AssignStreams (1);
+
+  Simulator::Schedule (MilliSeconds (1), &PieQueueDropProbability::Step, this, queue, 3000);
+  // No stop time: the simulation ends only if the queue stops scheduling
+  // its updates once it is idle.
+  Simulator::Run ();
+
+  PieQueue::Stats stats = queue->GetStats ();
+  if (m_overload)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_maxDropProb, 0, "The drop probability should have risen");
+      NS_TEST_EXPECT_MSG_GT (stats.unforcedDrop, 0, "There should be early drops");
+      NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 0, "The queue should have been drained");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (stats.unforcedDrop + stats.forcedDrop, 0, "There should be no drops");
+      NS_TEST_EXPECT_MSG_EQ (queue->GetDropProbability (), 0, "The drop probability should be zero");
+    }
+  NS_TEST_EXPECT_MSG_LT (Simulator::Now (), Seconds (10), "The updates should stop once idle");
+
+  Simulator::Destroy ();
+}
+
+static class PieQueueTestSuite : public TestSuite
+{
+public:
+  PieQueueTestSuite ()
+    : TestSuite ("pie-queue", UNIT)
+  {
+    AddTestCase (new PieQueueOverflow (), TestCase::QUICK);
+    AddTestCase (new PieQueueDropProbability (true), TestCase::QUICK);
+    AddTestCase (new PieQueueDropProbability (false), TestCase::QUICK);
+  }
+} g_pieQueueTestSuite;
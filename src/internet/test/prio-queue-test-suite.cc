@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/prio-queue.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+
+using namespace ns3;
+
+/**
+ * Create an Ethernet framed IPv4/UDP packet.
+ * \param tos the type of service byte
+ * \param dstPort the destination port
+ * \param size the payload size
+ * \returns the packet
+ */
+static Ptr<Packet>
+CreatePacket (uint8_t tos, uint16_t dstPort, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udp;
+  udp.SetSourcePort (4000);
+  udp.SetDestinationPort (dstPort);
+  p->AddHeader (udp);
+  Ipv4Header ip;
+  ip.SetSource (Ipv4Address ("10.0.0.1"));
+  ip.SetDestination (Ipv4Address ("10.0.0.2"));
+  ip.SetProtocol (17);
+  ip.SetTos (tos);
+  ip.SetPayloadSize (p->GetSize ());
+  p->AddHeader (ip);
+  EthernetHeader ethernet;
+  ethernet.SetLengthType (0x0800);
+  p->AddHeader (ethernet);
+  return p;
+}
+
+// Test 1: classification by DSCP and by iCenS traffic class
+class PrioQueueClassify : public TestCase
+{
+public:
+  PrioQueueClassify ();
+  virtual void DoRun (void);
+};
+
+PrioQueueClassify::PrioQueueClassify ()
+  : TestCase ("Classification by DSCP and by destination port")
+{
+}
+
+void
+PrioQueueClassify::DoRun (void)
+{
+  Ptr<PrioQueue> queue = CreateObject<PrioQueue> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (46 << 2, 9, 100)), 0, "EF goes to band 0");
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (34 << 2, 9, 100)), 1, "AF41 goes to band 1");
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (0, 5000, 100)), 2, "Best effort goes to band 2");
+
+  queue = CreateObject<PrioQueue> ();
+  queue->SetAttribute ("Classifier", EnumValue (PrioQueue::CLASSIFY_ICENS_PORT));
+  queue->SetAttribute ("Bands", UintegerValue (4));
+  queue->SetAttribute ("PortBands", StringValue ("5000:0 6000:1 7000:2"));
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (0, 5000, 100)), 0, "WAC traffic goes to band 0");
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (0, 6000, 100)), 1, "PDC traffic goes to band 1");
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (0, 7000, 100)), 2, "Port 7000 goes to band 2");
+  NS_TEST_EXPECT_MSG_EQ (queue->Classify (CreatePacket (46 << 2, 1000, 100)), 3, "Background goes to band 3");
+}
+
+// Test 2: strict priority and per-band limits
+class PrioQueueStrictPriority : public TestCase
+{
+public:
+  PrioQueueStrictPriority ();
+  virtual void DoRun (void);
+};
+
+PrioQueueStrictPriority::PrioQueueStrictPriority ()
+  : TestCase ("Strict priority between bands with per-band limits")
+{
+}
+
+void
+PrioQueueStrictPriority::DoRun (void)
+{
+  Ptr<PrioQueue> queue = CreateObject<PrioQueue> ();
+  queue->SetAttribute ("Classifier", EnumValue (PrioQueue::CLASSIFY_ICENS_PORT));
+  queue->SetAttribute ("BandLimits", StringValue ("1 2 3"));
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      queue->Enqueue (CreatePacket (0, 1000, 100));
+    }
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (CreatePacket (0, 6000, 100));
+    }
+  queue->Enqueue (CreatePacket (0, 5000, 100));
+
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 6, "There should be 6 packets in queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandPackets (0), 1, "There should be 1 packet in band 0");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandPackets (1), 2, "There should be 2 packets in band 1");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandPackets (2), 3, "There should be 3 packets in band 2");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandDrops (1), 1, "Band 1 should have dropped a packet");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetBandDrops (2), 1, "Band 2 should have dropped a packet");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 2, "There should be 2 drops");
+
+  uint32_t expected[] = { 0, 1, 1, 2, 2, 2 };
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<const Packet> peeked = queue->Peek ();
+      Ptr<Packet> p = queue->Dequeue ();
+      NS_TEST_ASSERT_MSG_NE (p, 0, "There should be a packet");
+      NS_TEST_EXPECT_MSG_EQ (peeked, p, "Peek should return the next packet");
+      NS_TEST_EXPECT_MSG_EQ (queue->Classify (p), expected[i], "Unexpected band for packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), 0, "There are really no packets in queue");
+}
+
+// Test 3: weighted fair queueing
+class PrioQueueWeightedFair : public TestCase
+{
+public:
+  PrioQueueWeightedFair ();
+  virtual void DoRun (void);
+};
+
+PrioQueueWeightedFair::PrioQueueWeightedFair ()
+  : TestCase ("Weighted fair queueing between bands")
+{
+}
+
+void
+PrioQueueWeightedFair::DoRun (void)
+{
+  Ptr<PrioQueue> queue = CreateObject<PrioQueue> ();
+  queue->SetAttribute ("Classifier", EnumValue (PrioQueue::CLASSIFY_ICENS_PORT));
+  queue->SetAttribute ("Scheduler", EnumValue (PrioQueue::WEIGHTED_FAIR));
+  queue->SetAttribute ("Quantum", UintegerValue (1000));
+  queue->SetAttribute ("Weights", StringValue ("2 1 1"));
+
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      queue->Enqueue (CreatePacket (0, 1000, 972));
+      queue->Enqueue (CreatePacket (0, 5000, 972));
+    }
+
+  // Band 0 sends twice as many bytes as band 2, as long as both are busy.
+  uint32_t band0 = 0;
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      Ptr<const Packet> peeked = queue->Peek ();
+      Ptr<Packet> p = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (peeked, p, "Peek should return the next packet");
+      if (queue->Classify (p) == 0)
+        {
+          band0++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (band0, 20, "Band 0 should have sent 20 packets out of 30");
+
+  uint32_t left = 0;
+  while (queue->Dequeue ())
+    {
+      left++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (left, 30, "All the packets should be dequeued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes in queue");
+}
+
+static class PrioQueueTestSuite : public TestSuite
+{
+public:
+  PrioQueueTestSuite ()
+    : TestSuite ("prio-queue", UNIT)
+  {
+    AddTestCase (new PrioQueueClassify (), TestCase::QUICK);
+    AddTestCase (new PrioQueueStrictPriority (), TestCase::QUICK);
+    AddTestCase (new PrioQueueWeightedFair (), TestCase::QUICK);
+  }
+} g_prioQueueTestSuite;
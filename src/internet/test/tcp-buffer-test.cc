@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \param first the stream offset of the first byte
+ * \param size the size of the packet
+ * \returns a packet whose bytes are their stream offsets, modulo 251
+ */
+static Ptr<Packet>
+CreateStreamPacket (uint32_t first, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = (first + i) % 251;
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+/**
+ * \param p a packet
+ * \param first the stream offset its first byte should have
+ * \returns true if the bytes of the packet are their stream offsets
+ */
+static bool
+CheckStreamPacket (Ptr<Packet> p, uint32_t first)
+{
+  std::vector<uint8_t> data (p->GetSize ());
+  p->CopyData (&data[0], data.size ());
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      if (data[i] != (first + i) % 251)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+// Test 1: the send buffer
+class TcpTxBufferTest : public TestCase
+{
+public:
+  TcpTxBufferTest ();
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTest::TcpTxBufferTest ()
+  : TestCase ("TcpTxBuffer builds segments across packets and discards acknowledged data")
+{
+}
+
+void
+TcpTxBufferTest::DoRun (void)
+{
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> ();
+  buffer->SetMaxBufferSize (1000);
+  // The data may be sent before the connection is established.
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (0, 100)), true, "There is room");
+  buffer->SetHeadSequence (SequenceNumber32 (1000));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (100, 200)), true, "There is room");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (300, 300)), true, "There is room");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (600, 500)), false, "There is no room");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 600, "Three packets are buffered");
+  NS_TEST_EXPECT_MSG_EQ (buffer->TailSequence (), SequenceNumber32 (1600), "The tail follows the data");
+
+  for (uint32_t start = 0; start < 600; start += 70)
+    {
+      Ptr<Packet> p = buffer->CopyFromSequence (150, SequenceNumber32 (1000 + start));
+      NS_TEST_EXPECT_MSG_EQ (p->GetSize (), std::min (150U, 600 - start), "Wrong segment size");
+      NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, start), true, "Wrong segment data at " << start);
+    }
+
+  buffer->DiscardUpTo (SequenceNumber32 (1150));
+  NS_TEST_EXPECT_MSG_EQ (buffer->HeadSequence (), SequenceNumber32 (1150), "The head moved");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 450, "150 bytes were discarded");
+  Ptr<Packet> p = buffer->CopyFromSequence (400, SequenceNumber32 (1150));
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 400, "Wrong segment size");
+  NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, 150), true, "Wrong segment data");
+  p = buffer->CopyFromSequence (1000, SequenceNumber32 (1300));
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 300, "The segment ends with the data");
+  NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, 300), true, "Wrong segment data");
+
+  // Acknowledging the data and the FIN
+  buffer->DiscardUpTo (SequenceNumber32 (1601));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 0, "All the data was discarded");
+  NS_TEST_EXPECT_MSG_EQ (buffer->HeadSequence (), SequenceNumber32 (1601), "The FIN was acknowledged");
+}
+
+// Test 2: the SACK scoreboard of the send buffer
+class TcpTxBufferSackTest : public TestCase
+{
+public:
+  TcpTxBufferSackTest ();
+  virtual void DoRun (void);
+};
+
+TcpTxBufferSackTest::TcpTxBufferSackTest ()
+  : TestCase ("TcpTxBuffer merges the SACKed blocks and finds the holes")
+{
+}
+
+void
+TcpTxBufferSackTest::DoRun (void)
+{
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> ();
+  buffer->SetMaxBufferSize (10000);
+  buffer->SetHeadSequence (SequenceNumber32 (1000));
+  buffer->Add (CreateStreamPacket (0, 5000));
+
+  buffer->Sack (SequenceNumber32 (2000), SequenceNumber32 (2500));
+  buffer->Sack (SequenceNumber32 (3000), SequenceNumber32 (3500));
+  buffer->Sack (SequenceNumber32 (500), SequenceNumber32 (1000));
+  buffer->Sack (SequenceNumber32 (5500), SequenceNumber32 (7000));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 1500, "The blocks out of the buffer are clipped");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (2499)), true, "In a block");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (2500)), false, "After a block");
+
+  SequenceNumber32 seq (1000);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextHole (seq), 1000, "The first hole is before the first block");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (1000), "The first hole starts at the head");
+  seq = SequenceNumber32 (2200);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextHole (seq), 500, "The next hole is after the block");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (2500), "The next hole starts after the block");
+  seq = SequenceNumber32 (3600);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextHole (seq), 1900, "The last hole ends at the last block");
+  seq = SequenceNumber32 (5600);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextHole (seq), 0, "No SACKed data follows");
+
+  // Overlapping and adjacent blocks are merged
+  buffer->Sack (SequenceNumber32 (2400), SequenceNumber32 (3000));
+  buffer->Sack (SequenceNumber32 (3500), SequenceNumber32 (4000));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 2500, "The blocks are merged");
+  seq = SequenceNumber32 (2000);
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextHole (seq), 1500, "The holes are filled");
+  NS_TEST_EXPECT_MSG_EQ (seq, SequenceNumber32 (4000), "The merged block ends after the last one");
+
+  // Acknowledged data leaves the scoreboard
+  buffer->DiscardUpTo (SequenceNumber32 (3000));
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 1500, "The acknowledged part of the block is forgotten");
+  NS_TEST_EXPECT_MSG_EQ (buffer->IsSacked (SequenceNumber32 (3000)), true, "The rest of the block is kept");
+  buffer->ResetScoreboard ();
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackedBytes (), 0, "The scoreboard is empty");
+}
+
+// Test 3: the receive buffer
+class TcpRxBufferTest : public TestCase
+{
+public:
+  TcpRxBufferTest ();
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTest::TcpRxBufferTest ()
+  : TestCase ("TcpRxBuffer reorders and trims segments")
+{
+}
+
+void
+TcpRxBufferTest::DoRun (void)
+{
+  Ptr<TcpRxBuffer> buffer = CreateObject<TcpRxBuffer> ();
+  buffer->SetMaxBufferSize (1000);
+  buffer->SetNextRxSequence (SequenceNumber32 (1000));
+  TcpHeader header;
+
+  // Out of sequence: [1200, 1300) and [1400, 1500)
+  header.SetSequenceNumber (SequenceNumber32 (1200));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (200, 100), header), true, "Buffered");
+  header.SetSequenceNumber (SequenceNumber32 (1400));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (400, 100), header), true, "Buffered");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Available (), 0, "Nothing is in sequence");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 200, "Two segments are buffered");
+  NS_TEST_EXPECT_MSG_EQ (buffer->MaxRxSequence (), SequenceNumber32 (2200), "The window starts at the first byte");
+  TcpOptionSack::SackList sacks = buffer->GetSackList (4);
+  NS_TEST_ASSERT_MSG_EQ (sacks.size (), 2, "Two blocks are reported");
+  NS_TEST_EXPECT_MSG_EQ (sacks.front ().first, SequenceNumber32 (1400), "The most recent block comes first");
+  NS_TEST_EXPECT_MSG_EQ (sacks.back ().first, SequenceNumber32 (1200), "The other blocks follow");
+
+  // A duplicate is dropped, an overlapping segment is trimmed: [1250, 1450) adds [1300, 1400)
+  header.SetSequenceNumber (SequenceNumber32 (1200));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (200, 100), header), false, "Duplicate");
+  header.SetSequenceNumber (SequenceNumber32 (1250));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (250, 200), header), true, "Buffered");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 300, "The overlap was trimmed");
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextRxSequence (), SequenceNumber32 (1000), "The hole is still there");
+  sacks = buffer->GetSackList (4);
+  NS_TEST_ASSERT_MSG_EQ (sacks.size (), 1, "The blocks are merged");
+  NS_TEST_EXPECT_MSG_EQ (sacks.front ().first, SequenceNumber32 (1200), "Wrong left edge");
+  NS_TEST_EXPECT_MSG_EQ (sacks.front ().second, SequenceNumber32 (1500), "Wrong right edge");
+
+  // Filling the hole, with a segment starting before RCV.NXT
+  header.SetSequenceNumber (SequenceNumber32 (900));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (0, 100), header), false, "Old data");
+  header.SetSequenceNumber (SequenceNumber32 (950));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Add (CreateStreamPacket (-50, 300), header), true, "Buffered");
+  NS_TEST_EXPECT_MSG_EQ (buffer->NextRxSequence (), SequenceNumber32 (1500), "The hole was filled");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Available (), 500, "Everything is in sequence");
+  NS_TEST_EXPECT_MSG_EQ (buffer->GetSackList (4).size (), 0, "There is nothing to report");
+
+  Ptr<Packet> p = buffer->Extract (120);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 120, "Wrong extracted size");
+  NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, 0), true, "Wrong extracted data");
+  NS_TEST_EXPECT_MSG_EQ (buffer->MaxRxSequence (), SequenceNumber32 (2120), "The window moved");
+  p = buffer->Extract (130);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 130, "Wrong extracted size");
+  NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, 120), true, "Wrong extracted data");
+
+  buffer->SetFinSequence (SequenceNumber32 (1500));
+  NS_TEST_EXPECT_MSG_EQ (buffer->Finished (), true, "All the data was received");
+  p = buffer->Extract (1000);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 250, "Wrong extracted size");
+  NS_TEST_EXPECT_MSG_EQ (CheckStreamPacket (p, 250), true, "Wrong extracted data");
+  NS_TEST_EXPECT_MSG_EQ (buffer->Size (), 0, "The buffer is empty");
+  NS_TEST_EXPECT_MSG_EQ ((buffer->Extract (1000) == 0), true, "Nothing is left");
+}
+
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTest (), TestCase::QUICK);
+    AddTestCase (new TcpTxBufferSackTest (), TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTest (), TestCase::QUICK);
+  }
+} g_tcpBufferTestSuite;
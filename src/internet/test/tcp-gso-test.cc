@@ -0,0 +1,516 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/node.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/pointer.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/icmpv4-l4-protocol.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpGsoTestSuite");
+
+/**
+ * \brief Drop one data segment, the smaller packets are never dropped
+ */
+class TcpGsoDropModel : public ErrorModel
+{
+public:
+  TcpGsoDropModel (uint32_t drop)
+    : m_drop (drop),
+      m_segments (0)
+  {
+  }
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p)
+  {
+    if (p->GetSize () < 500)
+      {
+        return false;
+      }
+    return m_segments++ == m_drop;
+  }
+  virtual void DoReset (void)
+  {
+    m_segments = 0;
+  }
+
+  uint32_t m_drop;     //!< Rank of the data segment to drop
+  uint32_t m_segments; //!< Data segments seen so far
+};
+
+/**
+ * \brief Transfer a stream with the segmentation offload at the sender
+ * and the receive offload at the receiver
+ *
+ * Without the receive offload, the transfer must take exactly the time
+ * it takes without any offload: the devices see the same segments at the
+ * same times.  With the receive offload, the devices have no data rate,
+ * so that the segments of a super-segment arrive at the same time.
+ */
+class TcpGsoTestCase : public TestCase
+{
+public:
+  TcpGsoTestCase (bool gro, bool checksum, bool loss);
+
+protected:
+  /**
+   * \brief Constructor for the derived test cases
+   * \param name the test case name
+   * \param loss whether one data segment is lost
+   */
+  TcpGsoTestCase (std::string name, bool loss);
+
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Run one transfer
+   * \param gso whether the sender uses the segmentation offload
+   * \param gro whether the receiver uses the receive offload
+   * \return the time from the first data segment to the last byte received
+   */
+  Time RunTransfer (bool gso, bool gro);
+  Ptr<Node> CreateInternetNode (void);
+  Ptr<SimpleNetDevice> AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask);
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  void ServerHandleRecv (Ptr<Socket> sock);
+  void SourceHandleSend (Ptr<Socket> sock, uint32_t available);
+  void SourceSendOutgoing (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+  void SourceTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+  void ServerLocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface);
+  void ServerTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  bool m_gro;
+  bool m_checksum;
+  bool m_loss;
+  uint32_t m_totalBytes;
+  uint32_t m_sourceTxBytes;
+  uint32_t m_serverRxBytes;
+  bool m_corrupted;
+  Time m_firstTx;          //!< Time the first data segment was sent, past the ARP jitter
+  Time m_lastRx;
+  uint32_t m_maxSent;      //!< Largest packet sent by TCP
+  uint32_t m_maxTx;        //!< Largest packet sent to the device
+  uint32_t m_maxDelivered; //!< Largest packet delivered to TCP
+  uint32_t m_serverTx;     //!< Packets sent by the server
+  uint32_t m_sourceSegmentSize; //!< SegmentSize of the source socket
+  uint32_t m_serverSegmentSize; //!< SegmentSize of the server socket
+  DataRate m_dataRate;     //!< DataRate of the devices
+  std::vector<std::pair<Time, uint32_t> > m_delivered; //!< Time and size of the packets delivered to TCP
+  std::vector<Time> m_serverTxTimes; //!< Time of the packets sent by the server
+};
+
+TcpGsoTestCase::TcpGsoTestCase (bool gro, bool checksum, bool loss)
+  : TestCase (std::string ("TCP segmentation offload") + (gro ? " with receive offload" : "") +
+              (checksum ? ", checksums" : "") + (loss ? ", one loss" : "")),
+    m_gro (gro),
+    m_checksum (checksum),
+    m_loss (loss),
+    m_totalBytes (100000),
+    m_sourceSegmentSize (536),
+    m_serverSegmentSize (536),
+    m_dataRate (gro ? "0bps" : "10Mbps")
+{
+}
+
+TcpGsoTestCase::TcpGsoTestCase (std::string name, bool loss)
+  : TestCase (name),
+    m_gro (false),
+    m_checksum (false),
+    m_loss (loss),
+    m_totalBytes (100000),
+    m_sourceSegmentSize (536),
+    m_serverSegmentSize (536),
+    m_dataRate ("10Mbps")
+{
+}
+
+void
+TcpGsoTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (m_checksum));
+
+  Time reference = RunTransfer (false, false);
+  NS_TEST_EXPECT_MSG_EQ (m_maxSent, 536 + 32, "Without offload TCP sends full segments");
+
+  Time offload = RunTransfer (true, m_gro);
+  NS_LOG_INFO ("Transfer time without offload " << reference.GetSeconds () <<
+               "s, with offload " << offload.GetSeconds () << "s");
+  NS_TEST_EXPECT_MSG_GT (m_maxSent, 2 * 536, "TCP did not send super-segments");
+  NS_TEST_EXPECT_MSG_EQ (m_maxTx, 20 + 32 + 536, "The devices must see full segments only");
+  if (m_gro)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_maxDelivered, 2 * 536, "The segments were not coalesced");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_maxDelivered, 536 + 32, "The segments were coalesced");
+      NS_TEST_EXPECT_MSG_EQ (offload, reference, "The segmentation offload changed the timing");
+    }
+}
+
+void
+TcpGsoTestCase::DoTeardown (void)
+{
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (false));
+}
+
+Time
+TcpGsoTestCase::RunTransfer (bool gso, bool gro)
+{
+  m_sourceTxBytes = 0;
+  m_serverRxBytes = 0;
+  m_corrupted = false;
+  m_firstTx = Time (0);
+  m_lastRx = Time (0);
+  m_maxSent = 0;
+  m_maxTx = 0;
+  m_maxDelivered = 0;
+  m_serverTx = 0;
+  m_delivered.clear ();
+  m_serverTxTimes.clear ();
+
+  const char* netmask = "255.255.255.0";
+  const char* ipaddr0 = "192.168.1.1";
+  const char* ipaddr1 = "192.168.1.2";
+  Ptr<Node> node0 = CreateInternetNode ();
+  Ptr<Node> node1 = CreateInternetNode ();
+  Ptr<SimpleNetDevice> dev0 = AddSimpleNetDevice (node0, ipaddr0, netmask);
+  Ptr<SimpleNetDevice> dev1 = AddSimpleNetDevice (node1, ipaddr1, netmask);
+  if (m_loss)
+    {
+      dev0->SetAttribute ("ReceiveErrorModel", PointerValue (Create<TcpGsoDropModel> (40)));
+    }
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (10)));
+  dev0->SetChannel (channel);
+  dev1->SetChannel (channel);
+
+  node0->GetObject<Ipv4L3Protocol> ()->SetAttribute ("Gro", BooleanValue (gro));
+  node0->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("LocalDeliver",
+    MakeCallback (&TcpGsoTestCase::ServerLocalDeliver, this));
+  node0->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx",
+    MakeCallback (&TcpGsoTestCase::ServerTx, this));
+  node1->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("SendOutgoing",
+    MakeCallback (&TcpGsoTestCase::SourceSendOutgoing, this));
+  node1->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Tx",
+    MakeCallback (&TcpGsoTestCase::SourceTx, this));
+
+  Ptr<SocketFactory> sockFactory0 = node0->GetObject<TcpSocketFactory> ();
+  Ptr<SocketFactory> sockFactory1 = node1->GetObject<TcpSocketFactory> ();
+
+  Ptr<Socket> server = sockFactory0->CreateSocket ();
+  Ptr<Socket> source = sockFactory1->CreateSocket ();
+  source->SetAttribute ("Gso", BooleanValue (gso));
+  source->SetAttribute ("SegmentSize", UintegerValue (m_sourceSegmentSize));
+  server->SetAttribute ("SegmentSize", UintegerValue (m_serverSegmentSize));
+
+  uint16_t port = 50000;
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                             MakeCallback (&TcpGsoTestCase::ServerHandleConnectionCreated, this));
+
+  source->SetSendCallback (MakeCallback (&TcpGsoTestCase::SourceHandleSend, this));
+  source->Connect (InetSocketAddress (Ipv4Address (ipaddr0), port));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_serverRxBytes, m_totalBytes, "Server received the wrong amount of data");
+  NS_TEST_EXPECT_MSG_EQ (m_corrupted, false, "Server received corrupted data");
+  return m_lastRx - m_firstTx;
+}
+
+void
+TcpGsoTestCase::SourceSendOutgoing (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  m_maxSent = std::max (m_maxSent, p->GetSize ());
+}
+
+void
+TcpGsoTestCase::SourceTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_maxTx = std::max (m_maxTx, p->GetSize ());
+  if (m_firstTx.IsZero () && p->GetSize () > 100)
+    {
+      m_firstTx = Simulator::Now ();
+    }
+}
+
+void
+TcpGsoTestCase::ServerLocalDeliver (const Ipv4Header &header, Ptr<const Packet> p, uint32_t interface)
+{
+  m_maxDelivered = std::max (m_maxDelivered, p->GetSize ());
+  m_delivered.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+}
+
+void
+TcpGsoTestCase::ServerTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_serverTx++;
+  m_serverTxTimes.push_back (Simulator::Now ());
+}
+
+void
+TcpGsoTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  s->SetRecvCallback (MakeCallback (&TcpGsoTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpGsoTestCase::ServerHandleRecv (Ptr<Socket> sock)
+{
+  while (sock->GetRxAvailable () > 0)
+    {
+      Ptr<Packet> p = sock->Recv (sock->GetRxAvailable (), 0);
+      uint8_t *buf = new uint8_t[p->GetSize ()];
+      p->CopyData (buf, p->GetSize ());
+      for (uint32_t i = 0; i < p->GetSize (); ++i)
+        {
+          m_corrupted |= (buf[i] != static_cast<uint8_t> (m_serverRxBytes + i));
+        }
+      delete [] buf;
+      m_serverRxBytes += p->GetSize ();
+    }
+  if (m_serverRxBytes == m_totalBytes)
+    {
+      m_lastRx = Simulator::Now ();
+      sock->Close ();
+    }
+}
+
+void
+TcpGsoTestCase::SourceHandleSend (Ptr<Socket> sock, uint32_t available)
+{
+  while (sock->GetTxAvailable () > 0 && m_sourceTxBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (sock->GetTxAvailable (), m_totalBytes - m_sourceTxBytes);
+      toSend = std::min<uint32_t> (toSend, 1000);
+      uint8_t buf[1000];
+      for (uint32_t i = 0; i < toSend; ++i)
+        {
+          buf[i] = static_cast<uint8_t> (m_sourceTxBytes + i);
+        }
+      int sent = sock->Send (buf, toSend, 0);
+      NS_TEST_ASSERT_MSG_EQ ((sent > 0), true, "Send failed");
+      m_sourceTxBytes += sent;
+    }
+  if (m_sourceTxBytes == m_totalBytes)
+    {
+      sock->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      sock->Close ();
+    }
+}
+
+Ptr<Node>
+TcpGsoTestCase::CreateInternetNode ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  //ARP
+  Ptr<ArpL3Protocol> arp = CreateObject<ArpL3Protocol> ();
+  node->AggregateObject (arp);
+  //IPV4
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  //Routing for Ipv4
+  Ptr<Ipv4ListRouting> ipv4Routing = CreateObject<Ipv4ListRouting> ();
+  ipv4->SetRoutingProtocol (ipv4Routing);
+  Ptr<Ipv4StaticRouting> ipv4staticRouting = CreateObject<Ipv4StaticRouting> ();
+  ipv4Routing->AddRoutingProtocol (ipv4staticRouting, 0);
+  node->AggregateObject (ipv4);
+  //ICMP
+  Ptr<Icmpv4L4Protocol> icmp = CreateObject<Icmpv4L4Protocol> ();
+  node->AggregateObject (icmp);
+  //UDP
+  Ptr<UdpL4Protocol> udp = CreateObject<UdpL4Protocol> ();
+  node->AggregateObject (udp);
+  //TCP
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+  node->AggregateObject (tcp);
+  return node;
+}
+
+Ptr<SimpleNetDevice>
+TcpGsoTestCase::AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask)
+{
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  dev->SetAttribute ("DataRate", DataRateValue (m_dataRate));
+  node->AddDevice (dev);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t ndid = ipv4->AddInterface (dev);
+  Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (Ipv4Address (ipaddr), Ipv4Mask (netmask));
+  ipv4->AddAddress (ndid, ipv4Addr);
+  ipv4->SetUp (ndid);
+  return dev;
+}
+
+/**
+ * \brief Without the receive offload, a segment larger than the
+ * SegmentSize of the receiver is still one segment for its ACKs
+ *
+ * The receiver sends as many ACKs, delayed and duplicate, when its
+ * SegmentSize is half of the one of the sender as when both are equal.
+ */
+class TcpGroAckCountTestCase : public TcpGsoTestCase
+{
+public:
+  TcpGroAckCountTestCase (bool loss);
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpGroAckCountTestCase::TcpGroAckCountTestCase (bool loss)
+  : TcpGsoTestCase (std::string ("TCP ACKs without receive offload") + (loss ? ", one loss" : ""), loss)
+{
+}
+
+void
+TcpGroAckCountTestCase::DoRun (void)
+{
+  m_sourceSegmentSize = 1072;
+  m_serverSegmentSize = 1072;
+  RunTransfer (false, false);
+  uint32_t reference = m_serverTx;
+
+  m_serverSegmentSize = 536;
+  RunTransfer (false, false);
+  NS_LOG_INFO ("Packets sent by the receiver " << reference << " with the SegmentSize of the sender, " <<
+               m_serverTx << " with half of it");
+  NS_TEST_EXPECT_MSG_EQ (m_serverTx, reference, "The receiver counted a segment as several ones");
+}
+
+/**
+ * \brief The receive offload does not hold the segments which arrive one
+ * at a time
+ *
+ * When the link serializes the segments, the receiver delivers the data
+ * and sends its ACKs at the same times with and without the offload.
+ */
+class TcpGroTimingTestCase : public TcpGsoTestCase
+{
+public:
+  TcpGroTimingTestCase (bool loss);
+
+private:
+  virtual void DoRun (void);
+  /// \returns the time and size of the data packets delivered to TCP, from the first data segment sent
+  std::vector<std::pair<Time, uint32_t> > GetDelivered (void) const;
+  /// \returns the time of the packets sent by the server, from the first data segment sent
+  std::vector<Time> GetServerTxTimes (void) const;
+};
+
+TcpGroTimingTestCase::TcpGroTimingTestCase (bool loss)
+  : TcpGsoTestCase (std::string ("TCP receive offload timing") + (loss ? ", one loss" : ""), loss)
+{
+}
+
+void
+TcpGroTimingTestCase::DoRun (void)
+{
+  // The times are taken from the first data segment, past the ARP jitter.
+  RunTransfer (true, false);
+  std::vector<std::pair<Time, uint32_t> > delivered = GetDelivered ();
+  std::vector<Time> serverTxTimes = GetServerTxTimes ();
+
+  RunTransfer (true, true);
+  NS_TEST_ASSERT_MSG_EQ (GetDelivered ().size (), delivered.size (), "The receive offload coalesced segments");
+  for (uint32_t i = 0; i < delivered.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetDelivered ()[i].first, delivered[i].first, "Segment " << i << " delivered at another time");
+      NS_TEST_ASSERT_MSG_EQ (GetDelivered ()[i].second, delivered[i].second, "Segment " << i << " of another size");
+    }
+  NS_TEST_ASSERT_MSG_EQ (GetServerTxTimes ().size (), serverTxTimes.size (), "The receiver sent another number of ACKs");
+  for (uint32_t i = 0; i < serverTxTimes.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetServerTxTimes ()[i], serverTxTimes[i], "ACK " << i << " sent at another time");
+    }
+}
+
+std::vector<std::pair<Time, uint32_t> >
+TcpGroTimingTestCase::GetDelivered (void) const
+{
+  std::vector<std::pair<Time, uint32_t> > delivered;
+  for (uint32_t i = 0; i < m_delivered.size (); i++)
+    {
+      if (m_delivered[i].first >= m_firstTx)
+        {
+          delivered.push_back (std::make_pair (m_delivered[i].first - m_firstTx, m_delivered[i].second));
+        }
+    }
+  return delivered;
+}
+
+std::vector<Time>
+TcpGroTimingTestCase::GetServerTxTimes (void) const
+{
+  std::vector<Time> times;
+  for (uint32_t i = 0; i < m_serverTxTimes.size (); i++)
+    {
+      if (m_serverTxTimes[i] >= m_firstTx)
+        {
+          times.push_back (m_serverTxTimes[i] - m_firstTx);
+        }
+    }
+  return times;
+}
+
+static class TcpGsoTestSuite : public TestSuite
+{
+public:
+  TcpGsoTestSuite ()
+    : TestSuite ("tcp-gso", UNIT)
+  {
+    AddTestCase (new TcpGsoTestCase (false, false, false), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (false, true, false), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (false, false, true), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (true, false, false), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (true, true, false), TestCase::QUICK);
+    AddTestCase (new TcpGsoTestCase (true, false, true), TestCase::QUICK);
+    AddTestCase (new TcpGroAckCountTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcpGroAckCountTestCase (true), TestCase::QUICK);
+    AddTestCase (new TcpGroTimingTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcpGroTimingTestCase (true), TestCase::QUICK);
+  }
+
+} g_tcpGsoTestSuite;
+
+} // namespace ns3
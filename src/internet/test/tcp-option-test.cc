@@ -22,6 +22,8 @@
 #include "ns3/tcp-option.h"
 #include "ns3/private/tcp-option-winscale.h"
 #include "ns3/private/tcp-option-ts.h"
+#include "ns3/private/tcp-option-sack-permitted.h"
+#include "ns3/tcp-option-sack.h"
 
 #include <string.h>
 
@@ -164,6 +166,61 @@ TcpOptionTSTestCase::DoTeardown ()
 {
 }
 
+class TcpOptionSackTestCase : public TestCase
+{
+public:
+  TcpOptionSackTestCase (std::string name, uint32_t blocks);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_blocks;
+};
+
+TcpOptionSackTestCase::TcpOptionSackTestCase (std::string name, uint32_t blocks)
+  : TestCase (name),
+    m_blocks (blocks)
+{
+}
+
+void
+TcpOptionSackTestCase::DoRun ()
+{
+  TcpOptionSack opt;
+  for (uint32_t i = 0; i < m_blocks; ++i)
+    {
+      opt.AddSackBlock (std::make_pair (SequenceNumber32 (1000 * i + 0xfffff000),
+                                        SequenceNumber32 (1000 * i + 0xfffff200)));
+    }
+  NS_TEST_EXPECT_MSG_EQ (opt.GetSerializedSize (), 2 + 8 * m_blocks, "Wrong option size");
+
+  Buffer buffer;
+  buffer.AddAtStart (opt.GetSerializedSize ());
+  opt.Serialize (buffer.Begin ());
+  NS_TEST_EXPECT_MSG_EQ (buffer.Begin ().PeekU8 (), TcpOption::SACK, "Different kind found");
+
+  TcpOptionSack read;
+  NS_TEST_EXPECT_MSG_EQ (read.Deserialize (buffer.Begin ()), opt.GetSerializedSize (), "Wrong size read");
+  NS_TEST_ASSERT_MSG_EQ (read.GetNumSackBlocks (), m_blocks, "Different number of blocks found");
+  TcpOptionSack::SackList::const_iterator i = opt.GetSackList ().begin ();
+  TcpOptionSack::SackList::const_iterator j = read.GetSackList ().begin ();
+  for (; i != opt.GetSackList ().end (); ++i, ++j)
+    {
+      NS_TEST_EXPECT_MSG_EQ (i->first, j->first, "Different left edge found");
+      NS_TEST_EXPECT_MSG_EQ (i->second, j->second, "Different right edge found");
+    }
+
+  TcpOptionSackPermitted permitted;
+  buffer = Buffer ();
+  buffer.AddAtStart (permitted.GetSerializedSize ());
+  permitted.Serialize (buffer.Begin ());
+  NS_TEST_EXPECT_MSG_EQ (permitted.Deserialize (buffer.Begin ()), 2, "Wrong SACK-permitted size read");
+
+  NS_TEST_EXPECT_MSG_EQ (TcpOptionSack::GetMaxSackBlocks (0), 4, "Four blocks fit in an empty header");
+  NS_TEST_EXPECT_MSG_EQ (TcpOptionSack::GetMaxSackBlocks (12), 3, "Three blocks fit along with a timestamp");
+  NS_TEST_EXPECT_MSG_EQ (TcpOptionSack::GetMaxSackBlocks (32), 0, "No block fits in a full header");
+}
+
 static class TcpOptionTestSuite : public TestSuite
 {
 public:
@@ -176,6 +233,10 @@ public:
                                               "scale value", i), TestCase::QUICK);
       }
     AddTestCase (new TcpOptionTSTestCase ("Testing serialization of random values for timestamp"), TestCase::QUICK);
+    for (uint32_t i = 1; i <= 4; ++i)
+      {
+        AddTestCase (new TcpOptionSackTestCase ("Testing serialization of SACK blocks", i), TestCase::QUICK);
+      }
   }
 
 } g_TcpOptionTestSuite;
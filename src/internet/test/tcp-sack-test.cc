@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/node.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/boolean.h"
+#include "ns3/type-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/icmpv4-l4-protocol.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-newreno.h"
+#include "ns3/tcp-cubic.h"
+
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpSackTestSuite");
+
+/**
+ * \brief Drop the data segments of the given ranks, the smaller
+ * packets (handshake, ACKs) are never dropped
+ */
+class TcpSackDropModel : public ErrorModel
+{
+public:
+  TcpSackDropModel (const std::set<uint32_t> &drops)
+    : m_drops (drops),
+      m_segments (0)
+  {
+  }
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p)
+  {
+    if (p->GetSize () < 500)
+      {
+        return false;
+      }
+    return m_drops.find (m_segments++) != m_drops.end ();
+  }
+  virtual void DoReset (void)
+  {
+    m_segments = 0;
+  }
+
+  std::set<uint32_t> m_drops; //!< Ranks of the data segments to drop
+  uint32_t m_segments;        //!< Data segments seen so far
+};
+
+/**
+ * \brief Transfer a stream with several losses in the same window, with
+ * and without SACK, and check that SACK recovers the losses in less time
+ */
+class TcpSackTestCase : public TestCase
+{
+public:
+  TcpSackTestCase (TypeId socketType);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run one transfer
+   * \param sack whether both ends use SACK
+   * \return the time when the last byte was received
+   */
+  Time RunTransfer (bool sack);
+  Ptr<Node> CreateInternetNode (void);
+  Ptr<SimpleNetDevice> AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask);
+  void ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr);
+  void ServerHandleRecv (Ptr<Socket> sock);
+  void SourceHandleSend (Ptr<Socket> sock, uint32_t available);
+
+  TypeId m_socketType;
+  uint32_t m_totalBytes;
+  uint32_t m_sourceTxBytes;
+  uint32_t m_serverRxBytes;
+  bool m_corrupted;
+  Time m_lastRx;
+};
+
+TcpSackTestCase::TcpSackTestCase (TypeId socketType)
+  : TestCase ("SACK recovery of multiple losses with " + socketType.GetName ()),
+    m_socketType (socketType),
+    m_totalBytes (100000)
+{
+}
+
+void
+TcpSackTestCase::DoRun (void)
+{
+  Time withoutSack = RunTransfer (false);
+  Time withSack = RunTransfer (true);
+  NS_LOG_INFO ("Transfer time without SACK " << withoutSack.GetSeconds () <<
+               "s, with SACK " << withSack.GetSeconds () << "s");
+  NS_TEST_EXPECT_MSG_LT (withSack, withoutSack, "SACK should recover the losses sooner");
+}
+
+Time
+TcpSackTestCase::RunTransfer (bool sack)
+{
+  m_sourceTxBytes = 0;
+  m_serverRxBytes = 0;
+  m_corrupted = false;
+  m_lastRx = Time (0);
+
+  const char* netmask = "255.255.255.0";
+  const char* ipaddr0 = "192.168.1.1";
+  const char* ipaddr1 = "192.168.1.2";
+  Ptr<Node> node0 = CreateInternetNode ();
+  Ptr<Node> node1 = CreateInternetNode ();
+  Ptr<SimpleNetDevice> dev0 = AddSimpleNetDevice (node0, ipaddr0, netmask);
+  Ptr<SimpleNetDevice> dev1 = AddSimpleNetDevice (node1, ipaddr1, netmask);
+
+  // Four losses in the window of the end of the slow start
+  std::set<uint32_t> drops;
+  drops.insert (40);
+  drops.insert (42);
+  drops.insert (44);
+  drops.insert (46);
+  dev0->SetAttribute ("ReceiveErrorModel", PointerValue (Create<TcpSackDropModel> (drops)));
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (20)));
+  dev0->SetChannel (channel);
+  dev1->SetChannel (channel);
+
+  Ptr<SocketFactory> sockFactory0 = node0->GetObject<TcpSocketFactory> ();
+  Ptr<SocketFactory> sockFactory1 = node1->GetObject<TcpSocketFactory> ();
+
+  Ptr<Socket> server = sockFactory0->CreateSocket ();
+  Ptr<Socket> source = sockFactory1->CreateSocket ();
+  server->SetAttribute ("Sack", BooleanValue (sack));
+  source->SetAttribute ("Sack", BooleanValue (sack));
+
+  uint16_t port = 50000;
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
+                             MakeCallback (&TcpSackTestCase::ServerHandleConnectionCreated, this));
+
+  source->SetSendCallback (MakeCallback (&TcpSackTestCase::SourceHandleSend, this));
+  source->Connect (InetSocketAddress (Ipv4Address (ipaddr0), port));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_serverRxBytes, m_totalBytes, "Server received the wrong amount of data");
+  NS_TEST_EXPECT_MSG_EQ (m_corrupted, false, "Server received corrupted data");
+  return m_lastRx;
+}
+
+void
+TcpSackTestCase::ServerHandleConnectionCreated (Ptr<Socket> s, const Address & addr)
+{
+  s->SetRecvCallback (MakeCallback (&TcpSackTestCase::ServerHandleRecv, this));
+}
+
+void
+TcpSackTestCase::ServerHandleRecv (Ptr<Socket> sock)
+{
+  while (sock->GetRxAvailable () > 0)
+    {
+      Ptr<Packet> p = sock->Recv (sock->GetRxAvailable (), 0);
+      uint8_t *buf = new uint8_t[p->GetSize ()];
+      p->CopyData (buf, p->GetSize ());
+      for (uint32_t i = 0; i < p->GetSize (); ++i)
+        {
+          m_corrupted |= (buf[i] != static_cast<uint8_t> (m_serverRxBytes + i));
+        }
+      delete [] buf;
+      m_serverRxBytes += p->GetSize ();
+    }
+  if (m_serverRxBytes == m_totalBytes)
+    {
+      m_lastRx = Simulator::Now ();
+      sock->Close ();
+    }
+}
+
+void
+TcpSackTestCase::SourceHandleSend (Ptr<Socket> sock, uint32_t available)
+{
+  while (sock->GetTxAvailable () > 0 && m_sourceTxBytes < m_totalBytes)
+    {
+      uint32_t toSend = std::min (sock->GetTxAvailable (), m_totalBytes - m_sourceTxBytes);
+      toSend = std::min<uint32_t> (toSend, 1000);
+      uint8_t buf[1000];
+      for (uint32_t i = 0; i < toSend; ++i)
+        {
+          buf[i] = static_cast<uint8_t> (m_sourceTxBytes + i);
+        }
+      int sent = sock->Send (buf, toSend, 0);
+      NS_TEST_ASSERT_MSG_EQ ((sent > 0), true, "Send failed");
+      m_sourceTxBytes += sent;
+    }
+  if (m_sourceTxBytes == m_totalBytes)
+    {
+      sock->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      sock->Close ();
+    }
+}
+
+Ptr<Node>
+TcpSackTestCase::CreateInternetNode ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  //ARP
+  Ptr<ArpL3Protocol> arp = CreateObject<ArpL3Protocol> ();
+  node->AggregateObject (arp);
+  //IPV4
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  //Routing for Ipv4
+  Ptr<Ipv4ListRouting> ipv4Routing = CreateObject<Ipv4ListRouting> ();
+  ipv4->SetRoutingProtocol (ipv4Routing);
+  Ptr<Ipv4StaticRouting> ipv4staticRouting = CreateObject<Ipv4StaticRouting> ();
+  ipv4Routing->AddRoutingProtocol (ipv4staticRouting, 0);
+  node->AggregateObject (ipv4);
+  //ICMP
+  Ptr<Icmpv4L4Protocol> icmp = CreateObject<Icmpv4L4Protocol> ();
+  node->AggregateObject (icmp);
+  //UDP
+  Ptr<UdpL4Protocol> udp = CreateObject<UdpL4Protocol> ();
+  node->AggregateObject (udp);
+  //TCP
+  Ptr<TcpL4Protocol> tcp = CreateObject<TcpL4Protocol> ();
+  tcp->SetAttribute ("SocketType", TypeIdValue (m_socketType));
+  node->AggregateObject (tcp);
+  return node;
+}
+
+Ptr<SimpleNetDevice>
+TcpSackTestCase::AddSimpleNetDevice (Ptr<Node> node, const char* ipaddr, const char* netmask)
+{
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  dev->SetAddress (Mac48Address::ConvertFrom (Mac48Address::Allocate ()));
+  dev->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  node->AddDevice (dev);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  uint32_t ndid = ipv4->AddInterface (dev);
+  Ipv4InterfaceAddress ipv4Addr = Ipv4InterfaceAddress (Ipv4Address (ipaddr), Ipv4Mask (netmask));
+  ipv4->AddAddress (ndid, ipv4Addr);
+  ipv4->SetUp (ndid);
+  return dev;
+}
+
+/**
+ * \brief Check that TcpCubic::GetSsThresh has no side effects: the
+ * window of the loss is only updated once per loss event
+ */
+class TcpCubicLossTestCase : public TestCase
+{
+public:
+  TcpCubicLossTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpCubicLossTestCase::TcpCubicLossTestCase ()
+  : TestCase ("TcpCubic updates Wmax once per loss, not per GetSsThresh call")
+{
+}
+
+void
+TcpCubicLossTestCase::DoRun (void)
+{
+  Ptr<TcpCubic> cubic = CreateObject<TcpCubic> ();
+  cubic->m_segmentSize = 1000;
+  cubic->m_cWnd = 100000;
+  cubic->m_wMax = 200;
+  cubic->m_epochStart = Seconds (1);
+
+  uint32_t ssThresh = cubic->GetSsThresh ();
+  NS_TEST_ASSERT_MSG_EQ (ssThresh, 70000, "ssthresh is cwnd * beta");
+  NS_TEST_ASSERT_MSG_EQ (cubic->GetSsThresh (), ssThresh, "GetSsThresh is not repeatable");
+  NS_TEST_ASSERT_MSG_EQ_TOL (cubic->m_wMax, 200, 1e-9, "GetSsThresh changed Wmax");
+  NS_TEST_ASSERT_MSG_EQ (cubic->m_epochStart, Seconds (1), "GetSsThresh ended the epoch");
+
+  // The window did not grow back to Wmax: fast convergence, once
+  cubic->LossDetected ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (cubic->m_wMax, 85, 1e-9, "Wmax not reduced by fast convergence");
+  NS_TEST_ASSERT_MSG_EQ (cubic->m_epochStart, Time (0), "The loss did not end the epoch");
+  NS_TEST_ASSERT_MSG_EQ (cubic->GetSsThresh (), ssThresh, "GetSsThresh depends on the loss state");
+  NS_TEST_ASSERT_MSG_EQ_TOL (cubic->m_wMax, 85, 1e-9, "GetSsThresh changed Wmax after the loss");
+}
+
+static class TcpSackTestSuite : public TestSuite
+{
+public:
+  TcpSackTestSuite ()
+    : TestSuite ("tcp-sack", UNIT)
+  {
+    AddTestCase (new TcpSackTestCase (TcpNewReno::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new TcpSackTestCase (TcpCubic::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new TcpCubicLossTestCase, TestCase::QUICK);
+  }
+
+} g_tcpSackTestSuite;
+
+} // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/socket.h"
+#include "ns3/udp-socket.h"
 
 #include "ns3/boolean.h"
 #include "ns3/log.h"
@@ -45,6 +46,7 @@
 #include "ns3/icmpv4-l4-protocol.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-header.h"
 #include "ns3/tcp-l4-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-static-routing.h"
@@ -54,6 +56,7 @@
 
 #include <string>
 #include <limits>
+#include <cstring>
 
 using namespace ns3;
 
@@ -100,6 +103,136 @@ UdpSocketLoopbackTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 246, "first socket should not receive it (it is bound specifically to the second interface's address");
 }
 
+class UdpSocketDirectDeliveryTest : public TestCase
+{
+public:
+  UdpSocketDirectDeliveryTest ();
+  virtual void DoRun (void);
+
+  void ReceivePkt (Ptr<Socket> socket, Ptr<Packet> packet, const Address &from, const Address &to);
+  void ReadPkt (Ptr<Socket> socket);
+  Ptr<Packet> m_receivedPacket;
+  Address m_from;
+  Address m_to;
+  uint32_t m_rxAvailable;
+  uint32_t m_read;
+};
+
+UdpSocketDirectDeliveryTest::UdpSocketDirectDeliveryTest ()
+  : TestCase ("UDP direct delivery test"),
+    m_rxAvailable (0),
+    m_read (0)
+{
+}
+
+void UdpSocketDirectDeliveryTest::ReceivePkt (Ptr<Socket> socket, Ptr<Packet> packet,
+                                              const Address &from, const Address &to)
+{
+  m_receivedPacket = packet;
+  m_from = from;
+  m_to = to;
+  m_rxAvailable = socket->GetRxAvailable ();
+}
+
+void UdpSocketDirectDeliveryTest::ReadPkt (Ptr<Socket> socket)
+{
+  m_read++;
+}
+
+void
+UdpSocketDirectDeliveryTest::DoRun ()
+{
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (rxNode);
+
+  Ptr<SocketFactory> rxSocketFactory = rxNode->GetObject<UdpSocketFactory> ();
+  Ptr<Socket> rxSocket = rxSocketFactory->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+  rxSocket->SetRecvCallback (MakeCallback (&UdpSocketDirectDeliveryTest::ReadPkt, this));
+  DynamicCast<UdpSocket> (rxSocket)->SetRecvPktCallback (MakeCallback (&UdpSocketDirectDeliveryTest::ReceivePkt, this));
+
+  Ptr<Socket> txSocket = rxSocketFactory->CreateSocket ();
+  txSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  txSocket->SendTo (Create<Packet> (246), 0, InetSocketAddress ("127.0.0.1", 80));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 246, "the packet should be delivered directly");
+  NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (m_from).GetIpv4 (), Ipv4Address ("127.0.0.1"), "wrong source address");
+  NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (m_from).GetPort (), 1234, "wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (m_to).GetIpv4 (), Ipv4Address ("127.0.0.1"), "wrong destination address");
+  NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (m_to).GetPort (), 80, "wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (m_rxAvailable, 0, "the packet should not be queued in the receive buffer");
+  NS_TEST_EXPECT_MSG_EQ (m_read, 0, "the receive callback should not be notified");
+  SocketAddressTag tag;
+  NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->PeekPacketTag (tag), false, "no address tag should be added");
+
+  // A null callback restores the queued delivery
+  m_receivedPacket = 0;
+  DynamicCast<UdpSocket> (rxSocket)->SetRecvPktCallback (MakeNullCallback<void, Ptr<Socket>, Ptr<Packet>, const Address &, const Address &> ());
+  txSocket->SendTo (Create<Packet> (123), 0, InetSocketAddress ("127.0.0.1", 80));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ ((m_receivedPacket == 0), true, "the packet should not be delivered directly");
+  NS_TEST_EXPECT_MSG_EQ (m_read, 1, "the receive callback should be notified");
+  NS_TEST_EXPECT_MSG_EQ (rxSocket->GetRxAvailable (), 123, "the packet should be queued in the receive buffer");
+}
+
+class UdpHeaderAddHeadersTest : public TestCase
+{
+public:
+  UdpHeaderAddHeadersTest ();
+  virtual void DoRun (void);
+};
+
+UdpHeaderAddHeadersTest::UdpHeaderAddHeadersTest ()
+  : TestCase ("UDP header length and checksum with Packet::AddHeaders")
+{
+}
+
+void
+UdpHeaderAddHeadersTest::DoRun ()
+{
+  Ipv4Address source ("10.1.1.1");
+  Ipv4Address destination ("10.1.1.2");
+  UdpHeader outer;
+  outer.SetSourcePort (1);
+  outer.SetDestinationPort (2);
+  outer.EnableChecksums ();
+  outer.InitializeChecksum (source, destination, UdpL4Protocol::PROT_NUMBER);
+  UdpHeader inner;
+  inner.SetSourcePort (3);
+  inner.SetDestinationPort (4);
+  inner.EnableChecksums ();
+  inner.InitializeChecksum (source, destination, UdpL4Protocol::PROT_NUMBER);
+
+  // The inner header is not the outermost header of the AddHeaders call
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeaders (outer, inner);
+  Ptr<Packet> ref = Create<Packet> (100);
+  ref->AddHeader (inner);
+  ref->AddHeader (outer);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), ref->GetSize (), "AddHeaders size");
+  uint8_t bytes[116];
+  uint8_t refBytes[116];
+  p->CopyData (bytes, 116);
+  ref->CopyData (refBytes, 116);
+  NS_TEST_EXPECT_MSG_EQ (memcmp (bytes, refBytes, 116), 0, "AddHeaders bytes differ from AddHeader");
+
+  UdpHeader removedOuter;
+  removedOuter.EnableChecksums ();
+  removedOuter.InitializeChecksum (source, destination, UdpL4Protocol::PROT_NUMBER);
+  UdpHeader removedInner;
+  removedInner.EnableChecksums ();
+  removedInner.InitializeChecksum (source, destination, UdpL4Protocol::PROT_NUMBER);
+  p->RemoveHeaders (removedOuter, removedInner);
+  NS_TEST_EXPECT_MSG_EQ (removedOuter.IsChecksumOk (), true, "outer checksum");
+  NS_TEST_EXPECT_MSG_EQ (removedInner.IsChecksumOk (), true, "inner checksum");
+  NS_TEST_EXPECT_MSG_EQ (removedInner.GetDestinationPort (), 4, "inner header");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "RemoveHeaders size");
+}
+
 class Udp6SocketLoopbackTest : public TestCase
 {
 public:
@@ -513,6 +646,8 @@ public:
   {
     AddTestCase (new UdpSocketImplTest, TestCase::QUICK);
     AddTestCase (new UdpSocketLoopbackTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketDirectDeliveryTest, TestCase::QUICK);
+    AddTestCase (new UdpHeaderAddHeadersTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketImplTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketLoopbackTest, TestCase::QUICK);
   }
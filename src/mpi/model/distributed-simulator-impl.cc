@@ -28,6 +28,7 @@
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -76,6 +77,48 @@ LbtsMessage::IsFinished ()
   return m_isFinished;
 }
 
+void
+LbtsMessage::Merge (const LbtsMessage &other)
+{
+  if (other.m_smallestTime < m_smallestTime)
+    {
+      m_smallestTime = other.m_smallestTime;
+    }
+  m_txCount += other.m_txCount;
+  m_rxCount += other.m_rxCount;
+  m_isFinished = m_isFinished && other.m_isFinished;
+}
+
+#ifdef NS3_MPI
+namespace {
+
+/** MPI datatype of an LbtsMessage, created by the first simulator. */
+MPI_Datatype g_lbtsType = MPI_DATATYPE_NULL;
+/** MPI reduction operation merging LbtsMessage contributions. */
+MPI_Op g_lbtsOp = MPI_OP_NULL;
+
+/**
+ * MPI user reduction function for the LBTS computation.
+ *
+ * \param in the contributions to merge
+ * \param inout the contributions merged into
+ * \param len the number of LbtsMessage in each buffer
+ * \param datatype unused
+ */
+void
+LbtsReduce (void *in, void *inout, int *len, MPI_Datatype *datatype)
+{
+  LbtsMessage *src = static_cast<LbtsMessage *> (in);
+  LbtsMessage *dst = static_cast<LbtsMessage *> (inout);
+  for (int i = 0; i < *len; ++i)
+    {
+      dst[i].Merge (src[i]);
+    }
+}
+
+} // unnamed namespace
+#endif
+
 Time DistributedSimulatorImpl::m_lookAhead = Seconds (-1);
 
 TypeId
@@ -85,6 +128,13 @@ DistributedSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Mpi")
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("BatchPackets",
+                   "Send the packets for each remote task as a single message "
+                   "at the end of each granted time window, instead of after "
+                   "the event which sent them.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DistributedSimulatorImpl::m_batchPackets),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -97,9 +147,17 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_myId = MpiInterface::GetSystemId ();
   m_systemCount = MpiInterface::GetSize ();
 
-  // Allocate the LBTS message buffer
-  m_pLBTS = new LbtsMessage[m_systemCount];
   m_grantedTime = Seconds (0);
+
+  // The LBTS contributions of all ranks are merged by a single
+  // reduction, so each round exchanges one message per rank instead
+  // of gathering the messages of every rank on every rank.
+  if (g_lbtsOp == MPI_OP_NULL)
+    {
+      MPI_Type_contiguous (sizeof (LbtsMessage), MPI_BYTE, &g_lbtsType);
+      MPI_Type_commit (&g_lbtsType);
+      MPI_Op_create (&LbtsReduce, 1, &g_lbtsOp);
+    }
 #else
   NS_UNUSED (m_systemCount);
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -118,6 +176,8 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
   m_events = 0;
+  m_lbtsRounds = 0;
+  m_batchPackets = true;
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
@@ -136,7 +196,6 @@ DistributedSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
-  delete [] m_pLBTS;
   SimulatorImpl::DoDispose ();
 }
 
@@ -156,6 +215,15 @@ DistributedSimulatorImpl::Destroy ()
         }
     }
 
+  NS_LOG_INFO ("rank " << m_myId << " performed " << m_lbtsRounds << " LBTS rounds");
+#ifdef NS3_MPI
+  if (g_lbtsOp != MPI_OP_NULL)
+    {
+      MPI_Op_free (&g_lbtsOp);
+      MPI_Type_free (&g_lbtsType);
+    }
+#endif
+
   MpiInterface::Destroy ();
 }
 
@@ -385,7 +453,9 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
-          // First receive any pending messages
+          // First send the packets batched during this window
+          GrantedTimeWindowMpiInterface::FlushSendBuffers ();
+          // Then receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
           nextTime = Next ();
@@ -394,27 +464,17 @@ DistributedSimulatorImpl::Run (void)
           // Finally calculate the lbts
           LbtsMessage lMsg (GrantedTimeWindowMpiInterface::GetRxCount (), GrantedTimeWindowMpiInterface::GetTxCount (), 
                             m_myId, IsLocalFinished (), nextTime);
-          m_pLBTS[m_myId] = lMsg;
-          MPI_Allgather (&lMsg, sizeof (LbtsMessage), MPI_BYTE, m_pLBTS,
-                         sizeof (LbtsMessage), MPI_BYTE, MPI_COMM_WORLD);
-          Time smallestTime = m_pLBTS[0].GetSmallestTime ();
+          LbtsMessage global;
+          MPI_Allreduce (&lMsg, &global, 1, g_lbtsType, g_lbtsOp, MPI_COMM_WORLD);
+          m_lbtsRounds++;
+          Time smallestTime = global.GetSmallestTime ();
           // The totRx and totTx counts insure there are no transient
           // messages;  If totRx != totTx, there are transients,
           // so we don't update the granted time.
-          uint32_t totRx = m_pLBTS[0].GetRxCount ();
-          uint32_t totTx = m_pLBTS[0].GetTxCount ();
-          m_globalFinished = m_pLBTS[0].IsFinished ();
+          uint32_t totRx = global.GetRxCount ();
+          uint32_t totTx = global.GetTxCount ();
+          m_globalFinished = global.IsFinished ();
 
-          for (uint32_t i = 1; i < m_systemCount; ++i)
-            {
-              if (m_pLBTS[i].GetSmallestTime () < smallestTime)
-                {
-                  smallestTime = m_pLBTS[i].GetSmallestTime ();
-                }
-              totRx += m_pLBTS[i].GetRxCount ();
-              totTx += m_pLBTS[i].GetTxCount ();
-              m_globalFinished &= m_pLBTS[i].IsFinished ();
-            }
           if (totRx == totTx)
             {
               // If lookahead is infinite then granted time should be as well.
@@ -437,6 +497,10 @@ DistributedSimulatorImpl::Run (void)
       if ( (nextTime <= m_grantedTime) && (!IsLocalFinished ()) )
         { // Safe to process
           ProcessOneEvent ();
+          if (!m_batchPackets)
+            {
+              GrantedTimeWindowMpiInterface::FlushSendBuffers ();
+            }
         }
     }
 
@@ -448,6 +512,12 @@ DistributedSimulatorImpl::Run (void)
 #endif
 }
 
+uint64_t
+DistributedSimulatorImpl::GetLbtsRounds (void) const
+{
+  return m_lbtsRounds;
+}
+
 uint32_t DistributedSimulatorImpl::GetSystemId () const
 {
   return m_myId;
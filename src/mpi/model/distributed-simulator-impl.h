@@ -84,6 +84,15 @@ public:
    */
   bool IsFinished ();
 
+  /**
+   * Combine the LBTS contribution of another rank into this one:
+   * keep the smallest time, add the message counts and require all
+   * ranks to be finished.
+   *
+   * \param other the contribution to merge
+   */
+  void Merge (const LbtsMessage &other);
+
 private:
   uint32_t m_txCount;
   uint32_t m_rxCount;
@@ -127,6 +136,11 @@ public:
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \return the number of LBTS computations performed by Run ()
+   */
+  uint64_t GetLbtsRounds (void) const;
+
 private:
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
@@ -149,11 +163,12 @@ private:
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
 
-  LbtsMessage* m_pLBTS;       // Allocated once we know how many systems
   uint32_t     m_myId;        // MPI Rank
   uint32_t     m_systemCount; // MPI Size
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
+  uint64_t     m_lbtsRounds;  // Number of LBTS computations
+  bool         m_batchPackets; // Send the packets once per granted window
 
 };
 
@@ -22,7 +22,6 @@
 
 #include <iostream>
 #include <iomanip>
-#include <list>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
@@ -46,27 +45,19 @@ NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
 SentBuffer::SentBuffer ()
 {
-  m_buffer = 0;
   m_request = 0;
 }
 
 SentBuffer::~SentBuffer ()
 {
-  delete [] m_buffer;
 }
 
-uint8_t*
+std::vector<uint8_t>&
 SentBuffer::GetBuffer ()
 {
   return m_buffer;
 }
 
-void
-SentBuffer::SetBuffer (uint8_t* buffer)
-{
-  m_buffer = buffer;
-}
-
 #ifdef NS3_MPI
 MPI_Request*
 SentBuffer::GetRequest ()
@@ -81,12 +72,10 @@ bool                  GrantedTimeWindowMpiInterface::m_initialized = false;
 bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
-std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
-
-#ifdef NS3_MPI
-MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
-char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
-#endif
+std::vector<std::vector<uint8_t> > GrantedTimeWindowMpiInterface::m_batches;
+std::vector<uint8_t>  GrantedTimeWindowMpiInterface::m_rxBuffer;
+std::vector<SentBuffer *> GrantedTimeWindowMpiInterface::m_pendingTx;
+std::vector<SentBuffer *> GrantedTimeWindowMpiInterface::m_freeTx;
 
 TypeId 
 GrantedTimeWindowMpiInterface::GetTypeId (void)
@@ -104,14 +93,19 @@ GrantedTimeWindowMpiInterface::Destroy ()
   NS_LOG_FUNCTION (this);
 
 #ifdef NS3_MPI
-  for (uint32_t i = 0; i < GetSize (); ++i)
+  for (std::vector<SentBuffer *>::iterator i = m_pendingTx.begin (); i != m_pendingTx.end (); ++i)
     {
-      delete [] m_pRxBuffers[i];
+      delete *i;
     }
-  delete [] m_pRxBuffers;
-  delete [] m_requests;
-
   m_pendingTx.clear ();
+  for (std::vector<SentBuffer *>::iterator i = m_freeTx.begin (); i != m_freeTx.end (); ++i)
+    {
+      delete *i;
+    }
+  m_freeTx.clear ();
+  // Keep one (empty) batch per task for the next simulation.
+  m_batches.assign (m_size, std::vector<uint8_t> ());
+  m_rxBuffer.clear ();
 #endif
 }
 
@@ -173,15 +167,7 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
   MPI_Comm_size (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_size));
   m_enabled = true;
   m_initialized = true;
-  // Post a non-blocking receive for all peers
-  m_pRxBuffers = new char*[m_size];
-  m_requests = new MPI_Request[m_size];
-  for (uint32_t i = 0; i < GetSize (); ++i)
-    {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[i]);
-    }
+  m_batches.resize (m_size);
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -193,93 +179,124 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
-  uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
-
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
+  std::vector<uint8_t> &batch = m_batches[nodeSysId];
+
+  // Serialize the packet in place at the end of the batch, keeping
+  // the records 8-byte aligned.
+  uint32_t serializedSize = p->GetSerializedSize ();
+  uint32_t offset = batch.size ();
+  uint32_t recordSize = (sizeof (PacketRecord) + serializedSize + 7) & ~7;
+  batch.resize (offset + recordSize);
+
+  PacketRecord *record = reinterpret_cast<PacketRecord *> (&batch[offset]);
+  record->rxTime = rxTime.GetInteger ();
+  record->node = node;
+  record->dev = dev;
+  record->size = serializedSize;
+  record->pad = 0;
+  p->Serialize (&batch[offset + sizeof (PacketRecord)], serializedSize);
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
   m_txCount++;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
 }
 
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+#ifdef NS3_MPI
+  for (uint32_t rank = 0; rank < m_batches.size (); ++rank)
+    {
+      if (m_batches[rank].empty ())
+        {
+          continue;
+        }
+      SentBuffer *sent;
+      if (m_freeTx.empty ())
+        {
+          sent = new SentBuffer ();
+        }
+      else
+        {
+          sent = m_freeTx.back ();
+          m_freeTx.pop_back ();
+        }
+      // The batch becomes the send buffer; the recycled (empty)
+      // storage of the send buffer collects the next batch.
+      sent->GetBuffer ().swap (m_batches[rank]);
+      NS_LOG_LOGIC ("sending " << sent->GetBuffer ().size () << " bytes to rank " << rank);
+      MPI_Isend (&sent->GetBuffer ()[0], sent->GetBuffer ().size (), MPI_BYTE, rank,
+                 0, MPI_COMM_WORLD, sent->GetRequest ());
+      m_pendingTx.push_back (sent);
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
 void
 GrantedTimeWindowMpiInterface::ReceiveMessages ()
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  // Poll the non-block reads to see if data arrived
+  // Poll for arrived batches
   while (true)
     {
       int flag = 0;
-      int index = 0;
       MPI_Status status;
 
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
+      MPI_Iprobe (MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &flag, &status);
       if (!flag)
         {
           break;        // No more messages
         }
       int count;
-      MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
-
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
+      MPI_Get_count (&status, MPI_BYTE, &count);
+      if (static_cast<uint32_t> (count) > m_rxBuffer.size ())
+        {
+          m_rxBuffer.resize (count);
+        }
+      MPI_Recv (&m_rxBuffer[0], count, MPI_BYTE, status.MPI_SOURCE, 0,
+                MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
+      uint32_t offset = 0;
+      while (offset < static_cast<uint32_t> (count))
+        {
+          const PacketRecord *record = reinterpret_cast<const PacketRecord *> (&m_rxBuffer[offset]);
+          m_rxCount++; // Count this receive
 
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
+          Time rxTime (record->rxTime);
+          Ptr<Packet> p = Create<Packet> (&m_rxBuffer[offset + sizeof (PacketRecord)], record->size, true);
 
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
-        {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (record->node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == record->dev)
+                {
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
+                }
             }
-        }
 
-      NS_ASSERT (pNode && pMpiRec);
+          NS_ASSERT (pNode && pMpiRec);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
 
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          offset += (sizeof (PacketRecord) + record->size + 7) & ~7;
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -292,17 +309,22 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
-  while (i != m_pendingTx.end ())
+  uint32_t i = 0;
+  while (i < m_pendingTx.size ())
     {
       MPI_Status status;
       int flag = 0;
-      MPI_Test (i->GetRequest (), &flag, &status);
-      std::list<SentBuffer>::iterator current = i; // Save current for erasing
-      i++;                                    // Advance to next
+      MPI_Test (m_pendingTx[i]->GetRequest (), &flag, &status);
       if (flag)
-        { // This message is complete
-          m_pendingTx.erase (current);
+        { // This message is complete, recycle its buffer
+          m_pendingTx[i]->GetBuffer ().clear ();
+          m_freeTx.push_back (m_pendingTx[i]);
+          m_pendingTx[i] = m_pendingTx.back ();
+          m_pendingTx.pop_back ();
+        }
+      else
+        {
+          i++;
         }
     }
 #else
@@ -24,7 +24,7 @@
 #define NS3_GRANTED_TIME_WINDOW_MPI_INTERFACE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -39,19 +39,14 @@ typedef void* MPI_Request;
 
 namespace ns3 {
 
-/**
- * maximum MPI message size for easy
- * buffer creation
- */
-const uint32_t MAX_MPI_MSG_SIZE = 2000;
-
 /**
  * \ingroup mpi
  *
  * \brief Tracks non-blocking sends
  *
  * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
+ * sends that have been posted.  Once the send completes the object
+ * and the storage of its buffer are recycled for a later send.
  */
 class SentBuffer
 {
@@ -60,20 +55,16 @@ public:
   ~SentBuffer ();
 
   /**
-   * \return pointer to sent buffer
+   * \return the buffer being sent
    */
-  uint8_t* GetBuffer ();
-  /**
-   * \param buffer pointer to sent buffer
-   */
-  void SetBuffer (uint8_t* buffer);
+  std::vector<uint8_t>& GetBuffer ();
   /**
    * \return MPI request
    */
   MPI_Request* GetRequest ();
 
 private:
-  uint8_t* m_buffer;
+  std::vector<uint8_t> m_buffer;
   MPI_Request m_request;
 };
 
@@ -87,6 +78,13 @@ class Packet;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * Packets sent to a remote task during a granted time window are
+ * serialized back to back into a per-destination batch and the
+ * batches are sent, one MPI message per destination task, when the
+ * window ends (see FlushSendBuffers).  Each packet in a batch is
+ * preceded by a PacketRecord giving its receive time, destination
+ * and serialized size.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -131,6 +129,12 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the packets batched for each remote task since the last
+   * call.  Must be called before the LBTS computation at the end of
+   * each granted time window.
+   */
+  static void FlushSendBuffers ();
   /**
    * Check for received messages complete
    */
@@ -149,6 +153,18 @@ public:
   static uint32_t GetTxCount ();
 
 private:
+  /**
+   * Header preceding each packet in a batch.
+   */
+  struct PacketRecord
+  {
+    uint64_t rxTime;  //!< receive time at the destination node, in time steps
+    uint32_t node;    //!< destination node
+    uint32_t dev;     //!< destination device
+    uint32_t size;    //!< serialized packet size, in bytes
+    uint32_t pad;     //!< keeps the serialized packet 8-byte aligned
+  };
+
   static uint32_t m_sid;
   static uint32_t m_size;
 
@@ -160,14 +176,17 @@ private:
   static bool     m_initialized;
   static bool     m_enabled;
 
-  // Pending non-blocking receives
-  static MPI_Request* m_requests;
+  // Packets batched for each remote task in the current window
+  static std::vector<std::vector<uint8_t> > m_batches;
+
+  // Buffer for the batch being received
+  static std::vector<uint8_t> m_rxBuffer;
 
-  // Data buffers for non-blocking reads
-  static char**   m_pRxBuffers;
+  // Pending non-blocking sends
+  static std::vector<SentBuffer *> m_pendingTx;
 
-  // List of pending non-blocking sends
-  static std::list<SentBuffer> m_pendingTx;
+  // Completed sends, kept for reuse
+  static std::vector<SentBuffer *> m_freeTx;
 };
 
 } // namespace ns3
@@ -221,6 +221,7 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
   *pTime++ = guarantee_update.GetTimeStep ();
+  RemoteChannelBundleManager::Find (nodeSysId)->NotifyPacketSent (guarantee_update);
 
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
@@ -262,6 +263,7 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
 
   // Find the system id for the destination MPI rank
   uint32_t nodeSysId = bundle->GetSystemId ();
+  bundle->NotifyNullMessageSent (guarantee_update);
 
   MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
              0, MPI_COMM_WORLD, (iter->GetRequest ()));
@@ -370,6 +372,7 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
           Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (status.MPI_SOURCE);
           NS_ASSERT (bundle);
 
+          bundle->NotifyReceived (rxTime == Time (0));
           bundle->SetGuaranteeTime (Time (guaranteeUpdate));
 
           // Re-queue the next read
@@ -268,6 +268,17 @@ NullMessageSimulatorImpl::ScheduleNullMessageEvent (Ptr<RemoteChannelBundle> bun
 
   Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
 
+  /*
+   * The last guarantee sent was computed from a lower bound on the
+   * time of any future local event.  Until the local time reaches
+   * that bound no better guarantee can be offered, so there is no
+   * point in waking up earlier: idle tasks then send one Null
+   * Message per gap in their event list instead of one per
+   * m_schedulerTune * delay.
+   */
+  Time idle = bundle->GetLastSentGuaranteeTime () - bundle->GetDelay () - Now ();
+  delay = Max (delay, idle);
+
   bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
                                            this, PeekPointer(bundle)));
 }
@@ -278,11 +289,7 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> b
   NS_LOG_FUNCTION (this << bundle);
 
   Simulator::Cancel (bundle->GetEventId ());
-
-  Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
-
-  bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
-                                           this, PeekPointer(bundle)));
+  ScheduleNullMessageEvent (bundle);
 }
 
 void
@@ -588,7 +595,17 @@ void NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bund
   NS_LOG_FUNCTION (this << bundle);
 
   Time time = Min (Next (), GetSafeTime ()) + bundle->GetDelay ();
-  NullMessageMpiInterface::SendNullMessage (time, bundle);
+
+  // A Null Message which does not advance the guarantee time already
+  // known to the remote task, e.g. piggy-backed on a packet, is useless.
+  if (time > bundle->GetLastSentGuaranteeTime ())
+    {
+      NullMessageMpiInterface::SendNullMessage (time, bundle);
+    }
+  else
+    {
+      bundle->NotifyNullMessageSuppressed ();
+    }
 
   ScheduleNullMessageEvent (bundle);
 }
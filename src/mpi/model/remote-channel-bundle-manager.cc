@@ -25,9 +25,12 @@
 #include "null-message-simulator-impl.h"
 
 #include "ns3/simulator.h"
+#include "ns3/log.h"
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("RemoteChannelBundleManager");
+
 bool ns3::RemoteChannelBundleManager::g_initialized = false;
 ns3::RemoteChannelBundleManager::RemoteChannelMap ns3::RemoteChannelBundleManager::g_remoteChannelBundles;
 
@@ -105,6 +108,13 @@ RemoteChannelBundleManager::Destroy (void)
 {
   NS_ASSERT (g_initialized);
 
+  for (RemoteChannelMap::iterator kv = g_remoteChannelBundles.begin ();
+       kv != g_remoteChannelBundles.end ();
+       ++kv)
+    {
+      NS_LOG_INFO (*kv->second);
+    }
+
   g_remoteChannelBundles.clear();
   g_initialized = false;
 }
@@ -42,14 +42,26 @@ TypeId RemoteChannelBundle::GetTypeId (void)
 RemoteChannelBundle::RemoteChannelBundle ()
   : m_remoteSystemId (-1),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_lastSentGuaranteeTime (0),
+    m_packetsSent (0),
+    m_nullMessagesSent (0),
+    m_nullMessagesSuppressed (0),
+    m_packetsReceived (0),
+    m_nullMessagesReceived (0)
 {
 }
 
 RemoteChannelBundle::RemoteChannelBundle (const uint32_t remoteSystemId)
   : m_remoteSystemId (remoteSystemId),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_lastSentGuaranteeTime (0),
+    m_packetsSent (0),
+    m_nullMessagesSent (0),
+    m_nullMessagesSuppressed (0),
+    m_packetsReceived (0),
+    m_nullMessagesReceived (0)
 {
 }
 
@@ -98,6 +110,57 @@ RemoteChannelBundle::GetEventId (void) const
   return m_nullEventId;
 }
 
+Time
+RemoteChannelBundle::GetLastSentGuaranteeTime (void) const
+{
+  return m_lastSentGuaranteeTime;
+}
+
+void
+RemoteChannelBundle::NotifyPacketSent (Time guarantee)
+{
+  m_lastSentGuaranteeTime = Max (m_lastSentGuaranteeTime, guarantee);
+  ++m_packetsSent;
+}
+
+void
+RemoteChannelBundle::NotifyNullMessageSent (Time guarantee)
+{
+  m_lastSentGuaranteeTime = Max (m_lastSentGuaranteeTime, guarantee);
+  ++m_nullMessagesSent;
+}
+
+void
+RemoteChannelBundle::NotifyNullMessageSuppressed (void)
+{
+  ++m_nullMessagesSuppressed;
+}
+
+void
+RemoteChannelBundle::NotifyReceived (bool isNullMessage)
+{
+  if (isNullMessage)
+    {
+      ++m_nullMessagesReceived;
+    }
+  else
+    {
+      ++m_packetsReceived;
+    }
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesSent (void) const
+{
+  return m_nullMessagesSent;
+}
+
+uint64_t
+RemoteChannelBundle::GetNullMessagesSuppressed (void) const
+{
+  return m_nullMessagesSuppressed;
+}
+
 int
 RemoteChannelBundle::GetSize (void) const
 {
@@ -114,7 +177,10 @@ std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle )
 {
   out << "RemoteChannelBundle Rank = " << bundle.m_remoteSystemId
       << ", GuaranteeTime = "  << bundle.m_guaranteeTime
-      << ", Delay = " << bundle.m_delay << std::endl;
+      << ", Delay = " << bundle.m_delay
+      << ", Packets sent/received = " << bundle.m_packetsSent << "/" << bundle.m_packetsReceived
+      << ", Null Messages sent/suppressed/received = " << bundle.m_nullMessagesSent
+      << "/" << bundle.m_nullMessagesSuppressed << "/" << bundle.m_nullMessagesReceived << std::endl;
   
   for (std::map < uint32_t, Ptr < Channel > > ::const_iterator pair = bundle.m_channels.begin ();
        pair != bundle.m_channels.end ();
@@ -100,6 +100,50 @@ public:
    */
   int GetSize (void) const;
 
+  /**
+   * \return the last guarantee time sent to the remote task, either in
+   * a Null Message or piggy-backed on a packet
+   */
+  Time GetLastSentGuaranteeTime (void) const;
+
+  /**
+   * \param guarantee the guarantee time piggy-backed on the packet
+   *
+   * Account for a packet sent to the remote task.
+   */
+  void NotifyPacketSent (Time guarantee);
+
+  /**
+   * \param guarantee the guarantee time of the Null Message
+   *
+   * Account for a Null Message sent to the remote task.
+   */
+  void NotifyNullMessageSent (Time guarantee);
+
+  /**
+   * Account for a Null Message which was not sent because it would
+   * not have advanced the guarantee time of the remote task.
+   */
+  void NotifyNullMessageSuppressed (void);
+
+  /**
+   * \param isNullMessage true if the message did not carry a packet
+   *
+   * Account for a message received from the remote task.
+   */
+  void NotifyReceived (bool isNullMessage);
+
+  /**
+   * \return the number of Null Messages sent to the remote task
+   */
+  uint64_t GetNullMessagesSent (void) const;
+
+  /**
+   * \return the number of Null Messages suppressed because they would
+   * not have advanced the guarantee time of the remote task
+   */
+  uint64_t GetNullMessagesSuppressed (void) const;
+
   /**
    * \param time 
    *
@@ -144,6 +188,20 @@ private:
    */
   EventId m_nullEventId;
 
+  /*
+   * Last guarantee time sent to the remote task.
+   */
+  Time m_lastSentGuaranteeTime;
+
+  /*
+   * Message counters, to measure the synchronization overhead.
+   */
+  uint64_t m_packetsSent;
+  uint64_t m_nullMessagesSent;
+  uint64_t m_nullMessagesSuppressed;
+  uint64_t m_packetsReceived;
+  uint64_t m_nullMessagesReceived;
+
 };
 
 }
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/private/distributed-simulator-impl.h"
+
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Merge the LBTS contributions of several ranks, as the
+ * reduction of DistributedSimulatorImpl does
+ */
+class LbtsMessageMergeTestCase : public TestCase
+{
+public:
+  LbtsMessageMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LbtsMessageMergeTestCase::LbtsMessageMergeTestCase ()
+  : TestCase ("Merge of the LBTS contributions")
+{
+}
+
+void
+LbtsMessageMergeTestCase::DoRun (void)
+{
+  LbtsMessage global (3, 5, 0, true, Seconds (2));
+  global.Merge (LbtsMessage (7, 4, 1, true, Seconds (1)));
+  global.Merge (LbtsMessage (2, 3, 2, true, Seconds (3)));
+  NS_TEST_EXPECT_MSG_EQ (global.GetSmallestTime (), Seconds (1), "The smallest time must be kept");
+  NS_TEST_EXPECT_MSG_EQ (global.GetRxCount (), 12, "The received counts must be added");
+  NS_TEST_EXPECT_MSG_EQ (global.GetTxCount (), 12, "The transmitted counts must be added");
+  NS_TEST_EXPECT_MSG_EQ (global.IsFinished (), true, "All the ranks are finished");
+
+  global.Merge (LbtsMessage (0, 0, 3, false, Seconds (4)));
+  NS_TEST_EXPECT_MSG_EQ (global.GetSmallestTime (), Seconds (1), "The smallest time must be kept");
+  NS_TEST_EXPECT_MSG_EQ (global.IsFinished (), false, "One rank is not finished");
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Run DistributedSimulatorImpl on a single rank
+ *
+ * Every LBTS round goes through the MPI reduction; with a single rank
+ * the events must run in order and the simulation must end when they
+ * are all executed.
+ */
+class DistributedSimulatorTestCase : public TestCase
+{
+public:
+  DistributedSimulatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the time of an event
+   */
+  void Record (void);
+
+  std::vector<Time> m_times; //!< Times the events ran at
+};
+
+DistributedSimulatorTestCase::DistributedSimulatorTestCase ()
+  : TestCase ("Distributed simulator on a single rank")
+{
+}
+
+void
+DistributedSimulatorTestCase::Record (void)
+{
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+DistributedSimulatorTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (MpiInterface::GetSize (), 1, "The test runs on a single rank");
+
+  Simulator::Schedule (Seconds (3), &DistributedSimulatorTestCase::Record, this);
+  Simulator::Schedule (Seconds (1), &DistributedSimulatorTestCase::Record, this);
+  Simulator::Schedule (Seconds (2), &DistributedSimulatorTestCase::Record, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (3), "The simulation ended early");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 3, "Some events were not executed");
+  for (uint32_t i = 0; i < m_times.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], Seconds (i + 1), "The events ran out of order");
+    }
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Send packets through GrantedTimeWindowMpiInterface, with and
+ * without batching
+ *
+ * The single rank sends the packets to itself.  Whether the packets
+ * leave in one message per granted window or after each event, they
+ * must be delivered at the same times and the LBTS rounds must be the
+ * same.
+ */
+class DistributedSimulatorBatchingTestCase : public TestCase
+{
+public:
+  DistributedSimulatorBatchingTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** A delivered packet: its receive time and size. */
+  typedef std::pair<Time, uint32_t> Delivery;
+
+  /**
+   * \brief Send packets to the device of the node through MPI
+   * \param size the size of the packets
+   * \param count the number of packets
+   * \param delay the delay after which they must be received
+   */
+  void Send (uint32_t size, uint32_t count, Time delay);
+  /**
+   * \brief Record a packet delivered by the MpiReceiver
+   * \param p the packet
+   */
+  void Receive (Ptr<Packet> p);
+  /**
+   * \brief Run the simulation
+   * \param batch the value of the BatchPackets attribute
+   * \param [out] rounds the number of LBTS rounds
+   * \return the delivered packets
+   */
+  std::vector<Delivery> RunSimulation (bool batch, uint64_t &rounds);
+
+  Ptr<NetDevice> m_device;           //!< The receiving device
+  std::vector<Delivery> m_delivered; //!< The delivered packets
+};
+
+DistributedSimulatorBatchingTestCase::DistributedSimulatorBatchingTestCase ()
+  : TestCase ("Packets batched per granted window are delivered as when sent one by one")
+{
+}
+
+void
+DistributedSimulatorBatchingTestCase::Send (uint32_t size, uint32_t count, Time delay)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      MpiInterface::SendPacket (Create<Packet> (size + i), Simulator::Now () + delay,
+                                m_device->GetNode ()->GetId (), m_device->GetIfIndex ());
+    }
+}
+
+void
+DistributedSimulatorBatchingTestCase::Receive (Ptr<Packet> p)
+{
+  m_delivered.push_back (Delivery (Simulator::Now (), p->GetSize ()));
+}
+
+std::vector<DistributedSimulatorBatchingTestCase::Delivery>
+DistributedSimulatorBatchingTestCase::RunSimulation (bool batch, uint64_t &rounds)
+{
+  Config::SetDefault ("ns3::DistributedSimulatorImpl::BatchPackets", BooleanValue (batch));
+  m_delivered.clear ();
+
+  Ptr<Node> node = CreateObject<Node> ();
+  m_device = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (m_device);
+  Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver> ();
+  receiver->SetReceiveCallback (MakeCallback (&DistributedSimulatorBatchingTestCase::Receive, this));
+  m_device->AggregateObject (receiver);
+
+  Simulator::Schedule (Seconds (1), &DistributedSimulatorBatchingTestCase::Send, this,
+                       100, 3, MilliSeconds (10));
+  Simulator::Schedule (MilliSeconds (1005), &DistributedSimulatorBatchingTestCase::Send, this,
+                       200, 1, MilliSeconds (10));
+  Simulator::Schedule (Seconds (2), &DistributedSimulatorBatchingTestCase::Send, this,
+                       300, 2, MilliSeconds (1));
+  Simulator::Run ();
+  rounds = DynamicCast<DistributedSimulatorImpl> (Simulator::GetImplementation ())->GetLbtsRounds ();
+  Simulator::Destroy ();
+  m_device = 0;
+
+  return m_delivered;
+}
+
+void
+DistributedSimulatorBatchingTestCase::DoRun (void)
+{
+  uint64_t batchedRounds;
+  std::vector<Delivery> batched = RunSimulation (true, batchedRounds);
+  uint64_t unbatchedRounds;
+  std::vector<Delivery> unbatched = RunSimulation (false, unbatchedRounds);
+  Config::SetDefault ("ns3::DistributedSimulatorImpl::BatchPackets", BooleanValue (true));
+
+  Delivery expected[] = {
+    Delivery (MilliSeconds (1010), 100), Delivery (MilliSeconds (1010), 101),
+    Delivery (MilliSeconds (1010), 102), Delivery (MilliSeconds (1015), 200),
+    Delivery (MilliSeconds (2001), 300), Delivery (MilliSeconds (2001), 301)
+  };
+  uint32_t nExpected = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (batched.size (), nExpected, "Some batched packets were not delivered");
+  NS_TEST_ASSERT_MSG_EQ (unbatched.size (), nExpected, "Some packets were not delivered");
+  for (uint32_t i = 0; i < nExpected; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (batched[i].first, expected[i].first, "Wrong receive time of batched packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (batched[i].second, expected[i].second, "Wrong batched packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (unbatched[i].first, expected[i].first, "Wrong receive time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (unbatched[i].second, expected[i].second, "Wrong packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (batchedRounds, unbatchedRounds, "Batching changed the LBTS rounds");
+  NS_TEST_EXPECT_MSG_GT (batchedRounds, 0, "No LBTS round was performed");
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief MPI test suite
+ *
+ * MPI can only be initialized once per process: the suite enables it
+ * for all its test cases.
+ */
+static class MpiTestSuite : public TestSuite
+{
+public:
+  MpiTestSuite ()
+    : TestSuite ("mpi", UNIT)
+  {
+    AddTestCase (new LbtsMessageMergeTestCase (), TestCase::QUICK);
+    AddTestCase (new DistributedSimulatorTestCase (), TestCase::QUICK);
+    AddTestCase (new DistributedSimulatorBatchingTestCase (), TestCase::QUICK);
+  }
+
+private:
+  virtual void DoSetup (void)
+  {
+    GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable (0, 0);
+  }
+  virtual void DoTeardown (void)
+  {
+    MpiInterface::Disable ();
+    GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  }
+} g_mpiTestSuite;
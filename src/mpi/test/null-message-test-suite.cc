@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/double.h"
+#include "ns3/config.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/private/remote-channel-bundle.h"
+#include "ns3/private/remote-channel-bundle-manager.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Run NullMessageSimulatorImpl with Null Messages suppressed
+ *
+ * The single rank is its own remote task: a bundle towards rank 0
+ * sends the Null Messages back to it, so the safe time of the rank
+ * only advances as far as the guarantees it sends.  With Null Message
+ * events ten times per delay, one of them runs between an event and
+ * the event it schedules at the same time: its guarantee is the one
+ * already sent, and it is suppressed.  The simulation must still run
+ * all the events, without blocking, and the guarantee time must keep
+ * up.
+ */
+class NullMessageSuppressionTestCase : public TestCase
+{
+public:
+  NullMessageSuppressionTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Schedule Record () now
+   */
+  void Forward (void);
+  /**
+   * \brief Record the time of an event
+   */
+  void Record (void);
+
+  std::vector<Time> m_times; //!< Times the events ran at
+};
+
+NullMessageSuppressionTestCase::NullMessageSuppressionTestCase ()
+  : TestCase ("Suppressed Null Messages still advance the guarantee time")
+{
+}
+
+void
+NullMessageSuppressionTestCase::Forward (void)
+{
+  Simulator::ScheduleNow (&NullMessageSuppressionTestCase::Record, this);
+}
+
+void
+NullMessageSuppressionTestCase::Record (void)
+{
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+NullMessageSuppressionTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (MpiInterface::GetSize (), 1, "The test runs on a single rank");
+  Config::SetDefault ("ns3::NullMessageSimulatorImpl::SchedulerTune", DoubleValue (0.1));
+
+  Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Add (0);
+  bundle->AddChannel (CreateObject<SimpleChannel> (), MilliSeconds (100));
+  for (uint32_t i = 1; i <= 10; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (100 * i), &NullMessageSuppressionTestCase::Forward, this);
+    }
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (2), "The simulation did not reach its end");
+  NS_TEST_EXPECT_MSG_GT (bundle->GetNullMessagesSuppressed (), 0, "No Null Message was suppressed");
+  NS_TEST_EXPECT_MSG_GT (bundle->GetNullMessagesSent (), 0, "No Null Message was sent");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (bundle->GetGuaranteeTime (), Seconds (2), "The guarantee time fell behind");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::NullMessageSimulatorImpl::SchedulerTune", DoubleValue (1.0));
+
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 10, "Some events were not executed");
+  for (uint32_t i = 0; i < m_times.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], MilliSeconds (100 * (i + 1)), "The events ran out of order");
+    }
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Null Message simulator test suite
+ *
+ * MPI can only be initialized once per process, and the Null Message
+ * simulator needs its own MPI interface: it gets its own suite.
+ */
+static class NullMessageTestSuite : public TestSuite
+{
+public:
+  NullMessageTestSuite ()
+    : TestSuite ("mpi-null-message", UNIT)
+  {
+    AddTestCase (new NullMessageSuppressionTestCase (), TestCase::QUICK);
+  }
+
+private:
+  virtual void DoSetup (void)
+  {
+    GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::NullMessageSimulatorImpl"));
+    MpiInterface::Enable (0, 0);
+  }
+  virtual void DoTeardown (void)
+  {
+    MpiInterface::Disable ();
+    GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  }
+} g_nullMessageTestSuite;
@@ -376,6 +376,12 @@ public:
      */
     uint32_t GetSize (void) const;
 
+    /**
+     * \returns the size left to read or write from the position of this
+     * iterator to the end of the underlying buffer
+     */
+    uint32_t GetRemainingSize (void) const;
+
 private:
     friend class Buffer;
     /**
@@ -483,6 +489,21 @@ private:
    */
   inline uint32_t GetSize (void) const;
 
+  /**
+   * \return the number of virtual zero bytes of this buffer.
+   *
+   * These bytes, typically the application-level payload created by
+   * Buffer (uint32_t), have never been written and take no memory: they
+   * read as zeroes.
+   */
+  inline uint32_t GetZeroAreaSize (void) const;
+
+  /**
+   * \return the offset of the virtual zero bytes from the start of
+   * this buffer.
+   */
+  inline uint32_t GetZeroAreaOffset (void) const;
+
   /**
    * \return a pointer to the start of the internal 
    * byte buffer.
@@ -785,16 +806,7 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
   static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
@@ -1059,6 +1071,18 @@ Buffer::GetSize (void) const
   return m_end - m_start;
 }
 
+uint32_t
+Buffer::GetZeroAreaSize (void) const
+{
+  return m_zeroAreaEnd - m_zeroAreaStart;
+}
+
+uint32_t
+Buffer::GetZeroAreaOffset (void) const
+{
+  return m_zeroAreaStart - m_start;
+}
+
 Buffer::Iterator 
 Buffer::Begin (void) const
 {
@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-allocator.h"
+#include "ns3/assert.h"
+
+#include <new>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+
+/**
+ * \file
+ * \ingroup packet
+ * Implementation of class ns3::PacketAllocator.
+ */
+
+namespace {
+
+/**
+ * The size classes, in bytes.  They are all multiples of 16 so that
+ * every block keeps the alignment of the system allocator.  The
+ * smaller classes hold the Packet objects, tag list nodes and the
+ * metadata of short packets; the larger ones the byte buffers of
+ * acknowledgements, measurement frames and full-sized Ethernet frames.
+ */
+const uint32_t g_classSizes[] = {
+  32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+/** Number of size classes. */
+const uint32_t N_CLASSES = sizeof (g_classSizes) / sizeof (g_classSizes[0]);
+/** Size of the largest class: larger requests are never cached. */
+const uint32_t MAX_CLASS_SIZE = 2048;
+/** Upper bound on the number of bytes cached per size class and thread. */
+const uint32_t MAX_CACHED_BYTES = 512 * 1024;
+
+/** A block in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next; //!< Next block in the same free list.
+};
+
+/** The free lists and counters of one thread. */
+struct ThreadCache
+{
+  FreeBlock *head[N_CLASSES]; //!< Free list of each size class.
+  /** Counters of each size class, then of the oversized requests. */
+  ns3::PacketAllocator::Statistics stats[N_CLASSES + 1];
+};
+
+/*
+ * As for the free list of the Buffer class before, the state of the
+ * per-thread cache needs to encode "uninitialized" and "destroyed":
+ * the blocks of static packets are released after the cache of the
+ * main thread was destroyed, and must then go straight to the system
+ * allocator rather than re-create the cache.  The zero value is used
+ * for "uninitialized" since it does not need a constructor to run.
+ */
+#define MAGIC_DESTROYED (reinterpret_cast<ThreadCache *> (~(uintptr_t) 0))
+#define IS_INITIALIZED(x) (x != 0 && x != MAGIC_DESTROYED)
+
+/** The cache of the calling thread. */
+thread_local ThreadCache *t_cache = 0;
+
+/** Release the cache of a thread when the thread exits. */
+struct ThreadCacheDestructor
+{
+  ~ThreadCacheDestructor ()
+  {
+    ns3::PacketAllocator::Purge ();
+    delete t_cache;
+    t_cache = MAGIC_DESTROYED;
+  }
+};
+/** Registered the first time a thread creates its cache. */
+thread_local ThreadCacheDestructor t_cacheDestructor;
+
+/**
+ * \param [in] size A number of bytes.
+ * \returns The index of the smallest size class which can hold \p size
+ *          bytes, or N_CLASSES if there is none.
+ */
+inline uint32_t
+GetClass (uint32_t size)
+{
+  uint32_t i = 0;
+  while (i < N_CLASSES && g_classSizes[i] < size)
+    {
+      i++;
+    }
+  return i;
+}
+
+/**
+ * \returns The cache of the calling thread, creating it if needed, or
+ *          zero if the cache of the thread was already destroyed.
+ */
+inline ThreadCache *
+GetCache (void)
+{
+  ThreadCache *cache = t_cache;
+  if (cache == 0)
+    {
+      cache = new ThreadCache ();
+      std::memset (cache, 0, sizeof (*cache));
+      for (uint32_t i = 0; i < N_CLASSES; i++)
+        {
+          cache->stats[i].blockSize = g_classSizes[i];
+        }
+      t_cache = cache;
+      // odr-use the destructor so that it is registered for this thread.
+      (void) &t_cacheDestructor;
+    }
+  else if (cache == MAGIC_DESTROYED)
+    {
+      return 0;
+    }
+  return cache;
+}
+
+} // unnamed namespace
+
+namespace ns3 {
+
+void *
+PacketAllocator::Allocate (uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  ThreadCache *cache = GetCache ();
+  if (cache == 0)
+    {
+      return ::operator new (c < N_CLASSES ? g_classSizes[c] : size);
+    }
+  Statistics &stats = cache->stats[c];
+  stats.allocations++;
+  if (c == N_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeBlock *block = cache->head[c];
+  if (block != 0)
+    {
+      cache->head[c] = block->next;
+      stats.cacheHits++;
+      stats.cached--;
+      return block;
+    }
+  return ::operator new (g_classSizes[c]);
+}
+
+void
+PacketAllocator::Deallocate (void *buffer, uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  ThreadCache *cache = GetCache ();
+  if (cache == 0)
+    {
+      ::operator delete (buffer);
+      return;
+    }
+  Statistics &stats = cache->stats[c];
+  stats.deallocations++;
+  if (c == N_CLASSES || stats.cached >= MAX_CACHED_BYTES / g_classSizes[c])
+    {
+      stats.releases++;
+      ::operator delete (buffer);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (buffer);
+  block->next = cache->head[c];
+  cache->head[c] = block;
+  stats.cached++;
+}
+
+uint32_t
+PacketAllocator::GetBlockSize (uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  return c < N_CLASSES ? g_classSizes[c] : size;
+}
+
+uint32_t
+PacketAllocator::GetMaxBlockSize (void)
+{
+  return MAX_CLASS_SIZE;
+}
+
+uint32_t
+PacketAllocator::GetNStatistics (void)
+{
+  return N_CLASSES + 1;
+}
+
+struct PacketAllocator::Statistics
+PacketAllocator::GetStatistics (uint32_t i)
+{
+  NS_ASSERT (i < GetNStatistics ());
+  ThreadCache *cache = GetCache ();
+  if (cache == 0)
+    {
+      Statistics stats;
+      std::memset (&stats, 0, sizeof (stats));
+      stats.blockSize = i < N_CLASSES ? g_classSizes[i] : 0;
+      return stats;
+    }
+  return cache->stats[i];
+}
+
+void
+PacketAllocator::PrintStatistics (std::ostream &os)
+{
+  os << std::setw (6) << "size"
+     << std::setw (14) << "allocations"
+     << std::setw (14) << "hits"
+     << std::setw (14) << "frees"
+     << std::setw (14) << "releases"
+     << std::setw (10) << "cached" << std::endl;
+  for (uint32_t i = 0; i < GetNStatistics (); i++)
+    {
+      Statistics stats = GetStatistics (i);
+      if (stats.allocations == 0 && stats.deallocations == 0)
+        {
+          continue;
+        }
+      if (stats.blockSize == 0)
+        {
+          std::ostringstream oss;
+          oss << ">" << MAX_CLASS_SIZE;
+          os << std::setw (6) << oss.str ();
+        }
+      else
+        {
+          os << std::setw (6) << stats.blockSize;
+        }
+      os << std::setw (14) << stats.allocations
+         << std::setw (14) << stats.cacheHits
+         << std::setw (14) << stats.deallocations
+         << std::setw (14) << stats.releases
+         << std::setw (10) << stats.cached << std::endl;
+    }
+}
+
+void
+PacketAllocator::Purge (void)
+{
+  ThreadCache *cache = t_cache;
+  if (!IS_INITIALIZED (cache))
+    {
+      return;
+    }
+  for (uint32_t c = 0; c < N_CLASSES; c++)
+    {
+      while (cache->head[c] != 0)
+        {
+          FreeBlock *block = cache->head[c];
+          cache->head[c] = block->next;
+          ::operator delete (block);
+        }
+      cache->stats[c].releases += cache->stats[c].cached;
+      cache->stats[c].cached = 0;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_ALLOCATOR_H
+#define PACKET_ALLOCATOR_H
+
+#include <stdint.h>
+#include <ostream>
+
+/**
+ * \file
+ * \ingroup packet
+ * Declaration of class ns3::PacketAllocator.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Size-class memory allocator shared by the packet data structures.
+ *
+ * Packet objects, Buffer::Data, PacketMetadata::Data, ByteTagListData
+ * and PacketTagList::TagData nodes are allocated and released at a
+ * very high rate, and almost always with one of a handful of sizes.
+ * This allocator rounds every request up to one of a small set of
+ * size classes, chosen to fit the typical sizes of these objects for
+ * short control frames (acknowledgements, measurement reports) up to
+ * Ethernet-sized frames, and keeps the released blocks of each class
+ * in a free list so that they can be handed out again without going
+ * through the system allocator.
+ *
+ * The free lists are private to each thread: blocks are pushed to the
+ * free lists of the thread which releases them, whichever thread
+ * allocated them, so no locking is ever needed.  The number of blocks
+ * cached per size class is bounded; blocks released while the free
+ * list is full, and requests larger than the largest size class, go
+ * straight to the system allocator.  The free lists of a thread are
+ * released when the thread exits.
+ *
+ * Callers must pass the size they requested when they release a
+ * block: the block header is not stored in the block itself.
+ */
+class PacketAllocator
+{
+public:
+  /**
+   * \brief Allocation counters of one size class, for the calling thread.
+   */
+  struct Statistics
+  {
+    /**
+     * Size of the blocks of this class in bytes, or zero for the
+     * requests larger than the largest size class.
+     */
+    uint32_t blockSize;
+    uint64_t allocations;   //!< Number of blocks allocated.
+    uint64_t cacheHits;     //!< Allocations served from the free list.
+    uint64_t deallocations; //!< Number of blocks released.
+    uint64_t releases;      //!< Released blocks returned to the system allocator.
+    uint32_t cached;        //!< Blocks currently in the free list.
+  };
+
+  /**
+   * \brief Allocate a block of memory.
+   *
+   * \param [in] size The number of bytes needed.
+   * \returns A block of at least GetBlockSize (size) bytes, suitably
+   *          aligned for any object type.
+   */
+  static void * Allocate (uint32_t size);
+  /**
+   * \brief Release a block of memory.
+   *
+   * \param [in] buffer The block, as returned by Allocate.
+   * \param [in] size The size passed to Allocate, or any size with the
+   *             same block size.
+   */
+  static void Deallocate (void *buffer, uint32_t size);
+  /**
+   * \param [in] size A number of bytes.
+   * \returns The number of bytes actually usable in a block allocated
+   *          for \p size bytes.
+   */
+  static uint32_t GetBlockSize (uint32_t size);
+  /**
+   * \returns The block size of the largest size class: larger blocks
+   *          are never cached.
+   */
+  static uint32_t GetMaxBlockSize (void);
+
+  /**
+   * \returns The number of entries returned by GetStatistics: one per
+   *          size class, plus one for the oversized requests.
+   */
+  static uint32_t GetNStatistics (void);
+  /**
+   * \param [in] i The index of a size class, smaller than GetNStatistics ().
+   * \returns The counters of this size class for the calling thread.
+   */
+  static struct Statistics GetStatistics (uint32_t i);
+  /**
+   * \brief Print the counters of the calling thread, one line per size class.
+   *
+   * \param [in] os The output stream.
+   */
+  static void PrintStatistics (std::ostream &os);
+  /**
+   * \brief Return all the blocks cached by the calling thread to the
+   * system allocator.
+   */
+  static void Purge (void);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_ALLOCATOR_H */
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-dissector.h"
+#include "header.h"
+#include "ns3/log.h"
+
+#include <vector>
+#include <map>
+
+/**
+ * \file
+ * \ingroup packet
+ * Implementation of class ns3::PacketDissector.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketDissector");
+
+namespace {
+
+/** A registered protocol number, by header names. */
+struct ProtocolRegistration
+{
+  std::string header;   //!< Header holding the protocol number.
+  uint32_t protocol;    //!< Protocol number.
+  std::string next;     //!< Header identified by the protocol number.
+};
+
+/** The decoding rules of a header type, by TypeId uid. */
+struct HeaderEntry
+{
+  PacketDissector::ProtocolGetter getter;   //!< Reads the protocol number, or 0.
+  std::map<uint32_t, uint16_t> next;        //!< Uid of the next header, by protocol number.
+};
+
+/** The registrations, and the rules resolved from them. */
+struct Registry
+{
+  std::vector<std::pair<std::string, PacketDissector::ProtocolGetter> > headers; //!< Registered headers.
+  std::vector<ProtocolRegistration> protocols;  //!< Registered protocol numbers.
+  std::vector<HeaderEntry> entries;             //!< Rules, indexed by TypeId uid.
+  bool resolved;                                //!< Whether entries is up to date.
+};
+
+/**
+ * \returns the registry, created on first use since the modules
+ * register their headers during static initialization.
+ */
+Registry &
+GetRegistry (void)
+{
+  static Registry registry;
+  return registry;
+}
+
+/**
+ * \brief Resolve the header names of the registrations into TypeId uids.
+ *
+ * Registrations whose header types are not known, because the module
+ * defining them is not linked in, are ignored until new types are
+ * registered.
+ */
+void
+Resolve (void)
+{
+  Registry &registry = GetRegistry ();
+  registry.entries.clear ();
+  // The uids start at 1.
+  registry.entries.resize (TypeId::GetRegisteredN () + 1);
+  for (uint32_t i = 0; i < registry.entries.size (); i++)
+    {
+      registry.entries[i].getter = 0;
+    }
+  for (uint32_t i = 0; i < registry.headers.size (); i++)
+    {
+      TypeId tid;
+      if (TypeId::LookupByNameFailSafe (registry.headers[i].first, &tid))
+        {
+          registry.entries[tid.GetUid ()].getter = registry.headers[i].second;
+        }
+    }
+  for (uint32_t i = 0; i < registry.protocols.size (); i++)
+    {
+      TypeId tid;
+      TypeId next;
+      if (TypeId::LookupByNameFailSafe (registry.protocols[i].header, &tid)
+          && TypeId::LookupByNameFailSafe (registry.protocols[i].next, &next))
+        {
+          registry.entries[tid.GetUid ()].next[registry.protocols[i].protocol] = next.GetUid ();
+        }
+    }
+  registry.resolved = true;
+}
+
+} // anonymous namespace
+
+void
+PacketDissector::RegisterHeader (std::string header, ProtocolGetter getter)
+{
+  Registry &registry = GetRegistry ();
+  registry.headers.push_back (std::make_pair (header, getter));
+  registry.resolved = false;
+}
+
+void
+PacketDissector::RegisterProtocol (std::string header, uint32_t protocol, std::string next)
+{
+  ProtocolRegistration registration;
+  registration.header = header;
+  registration.protocol = protocol;
+  registration.next = next;
+  Registry &registry = GetRegistry ();
+  registry.protocols.push_back (registration);
+  registry.resolved = false;
+}
+
+TypeId
+PacketDissector::GetNextHeader (TypeId tid, const Header &header)
+{
+  NS_LOG_FUNCTION (tid << &header);
+  Registry &registry = GetRegistry ();
+  if (!registry.resolved || registry.entries.size () != TypeId::GetRegisteredN () + 1)
+    {
+      Resolve ();
+    }
+  TypeId next;
+  const HeaderEntry &entry = registry.entries[tid.GetUid ()];
+  uint32_t protocol;
+  if (entry.getter != 0 && entry.getter (header, protocol))
+    {
+      std::map<uint32_t, uint16_t>::const_iterator i = entry.next.find (protocol);
+      if (i != entry.next.end ())
+        {
+          next.SetUid (i->second);
+        }
+    }
+  return next;
+}
+
+void
+PacketDissector::Print (std::ostream &os, TypeId outer, Buffer buffer)
+{
+  NS_LOG_FUNCTION (&os << outer << &buffer);
+  TypeId tid = outer;
+  // The headers are decoded from a copy of the buffer followed by
+  // zeroes, so that a truncated header does not read past its end.
+  Buffer padded (0xffff);
+  padded.AddAtStart (buffer.GetSize ());
+  padded.Begin ().Write (buffer.Begin (), buffer.End ());
+  Buffer::Iterator i = padded.Begin ();
+  uint32_t left = buffer.GetSize ();
+  while (tid.GetUid () != 0 && left > 0 && tid.HasConstructor ())
+    {
+      ObjectBase *instance = tid.GetConstructor () ();
+      Header *header = dynamic_cast<Header *> (instance);
+      if (header == 0)
+        {
+          delete instance;
+          break;
+        }
+      // A header built by its default constructor has its minimal size.
+      uint32_t size = header->GetSerializedSize ();
+      if (size <= left)
+        {
+          size = header->Deserialize (i);
+        }
+      if (size > left)
+        {
+          os << tid.GetName () << " (truncated, size=" << left << ")";
+          left = 0;
+          delete header;
+          break;
+        }
+      os << tid.GetName () << " (";
+      header->Print (os);
+      os << ")";
+      i.Next (size);
+      left -= size;
+      tid = GetNextHeader (tid, *header);
+      delete header;
+      if (left > 0)
+        {
+          os << " ";
+        }
+    }
+  if (left > 0)
+    {
+      os << "Payload (size=" << left << ")";
+    }
+}
+
+} // namespace ns3
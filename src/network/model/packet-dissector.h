@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_DISSECTOR_H
+#define PACKET_DISSECTOR_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include "ns3/type-id.h"
+#include "buffer.h"
+
+namespace ns3 {
+
+class Header;
+
+/**
+ * \ingroup packet
+ * \brief Decode the headers of packets which carry no metadata
+ *
+ * When the metadata of a packet is not recorded (see
+ * Packet::EnablePrintingForNode), Packet::Print reconstructs its
+ * header structure from the type of its outermost header: each header
+ * is deserialized from the packet buffer, and the protocol number it
+ * holds gives the type of the next header, down to the first header
+ * whose successor is unknown.  The rest of the packet is printed as
+ * payload.
+ *
+ * Each module registers the headers it defines and the protocol
+ * numbers they use.  Header types are given by name, so that a module
+ * can map its protocol numbers to the headers of modules it does not
+ * depend on; the names are resolved the first time a packet is
+ * decoded.
+ *
+ * Unlike the metadata, the decoding does not know about trailers,
+ * fragments and the payload boundaries: trailers are printed as part
+ * of the payload.  A header truncated by the end of the packet is
+ * printed as such, with the number of bytes left.
+ */
+class PacketDissector
+{
+public:
+  /**
+   * \brief Read the protocol number of the header following a header.
+   *
+   * \param header the header, of the type the function was registered for
+   * \param protocol the protocol number
+   * \returns true if a header follows, false if what follows is unknown
+   */
+  typedef bool (*ProtocolGetter)(const Header &header, uint32_t &protocol);
+
+  /**
+   * \brief Register how to find the protocol number of a header.
+   *
+   * \param header the name of the header type
+   * \param getter the function reading the protocol number of a header
+   */
+  static void RegisterHeader (std::string header, ProtocolGetter getter);
+
+  /**
+   * \brief Register the header identified by a protocol number.
+   *
+   * \param header the name of the header type holding the protocol number
+   * \param protocol the protocol number
+   * \param next the name of the header type following \p header
+   */
+  static void RegisterProtocol (std::string header, uint32_t protocol, std::string next);
+
+  /**
+   * \brief Get the type of the header following a header.
+   *
+   * \param tid the type of the header
+   * \param header the header
+   * \returns the type of the next header, or a TypeId of uid 0 if unknown
+   */
+  static TypeId GetNextHeader (TypeId tid, const Header &header);
+
+  /**
+   * \brief Print the headers and the payload of a packet.
+   *
+   * \param os the output stream
+   * \param outer the type of the outermost header, or a TypeId of uid 0 if unknown
+   * \param buffer the packet buffer
+   */
+  static void Print (std::ostream &os, TypeId outer, Buffer buffer);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_DISSECTOR_H */
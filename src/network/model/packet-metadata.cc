@@ -18,11 +18,15 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <utility>
+#include <algorithm>
 #include <list>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 #include "packet-metadata.h"
+#include "packet-allocator.h"
+#include "packet-dissector.h"
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -34,19 +38,11 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
+bool PacketMetadata::m_enableContexts = false;
+std::vector<bool> PacketMetadata::m_recordedContexts;
+bool PacketMetadata::m_enableDissection = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
 
 void 
 PacketMetadata::Enable (void)
@@ -70,6 +66,39 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableContext (uint32_t context)
+{
+  NS_LOG_FUNCTION (context);
+  if (context >= m_recordedContexts.size ())
+    {
+      m_recordedContexts.resize (context + 1, false);
+    }
+  m_recordedContexts[context] = true;
+  m_enableContexts = true;
+  EnableDissection ();
+}
+
+void
+PacketMetadata::EnableDissection (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableDissection = true;
+}
+
+bool
+PacketMetadata::IsDissectionEnabled (void)
+{
+  return m_enableDissection;
+}
+
+bool
+PacketMetadata::IsRecordedContext (void)
+{
+  uint32_t context = Simulator::GetContext ();
+  return context < m_recordedContexts.size () && m_recordedContexts[context];
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +162,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff && m_used == 0;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -505,7 +538,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
    */
 
   // create a copy of the packet without its tail.
-  PacketMetadata h (m_packetUid, 0);
+  PacketMetadata h (m_packetUid, 0, true);
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -576,20 +609,6 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
-    {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
-    }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
   return PacketMetadata::Allocate (m_maxSize);
 }
 
@@ -597,35 +616,22 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
-  NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  NS_LOG_LOGIC ("recycle size="<<data->m_size);
+  PacketMetadata::Deallocate (data);
 }
 
 struct PacketMetadata::Data *
 PacketMetadata::Allocate (uint32_t n)
 {
   NS_LOG_FUNCTION (n);
-  uint32_t size = sizeof (struct Data);
   if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
     {
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
-  size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
+  uint32_t size = PacketAllocator::GetBlockSize (sizeof (struct Data) + n - PACKET_METADATA_DATA_M_DATA_SIZE);
+  // use all the bytes of the block, within the range of m_size.
+  n = std::min<uint32_t> (size - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE, 0xffff);
+  uint8_t *buf = static_cast<uint8_t *> (PacketAllocator::Allocate (size));
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
   data->m_size = n;
   data->m_count = 1;
@@ -636,8 +642,7 @@ void
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  PacketAllocator::Deallocate (data, sizeof (struct Data) + data->m_size - PACKET_METADATA_DATA_M_DATA_SIZE);
 }
 
 
@@ -656,6 +661,17 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
+  if (m_data == 0)
+    {
+      // skip the virtual GetInstanceTypeId call, unless the packet
+      // may have to be printed.
+      m_metadataSkipped = true;
+      if (m_enableDissection)
+        {
+          m_outerUid = header.GetInstanceTypeId ().GetUid ();
+        }
+      return;
+    }
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
@@ -664,7 +680,7 @@ void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
@@ -683,14 +699,18 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 void 
 PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
 {
-  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
+      if (m_enableDissection)
+        {
+          m_outerUid = PacketDissector::GetNextHeader (header.GetInstanceTypeId (), header).GetUid ();
+        }
       return;
     }
+  uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -734,7 +754,7 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
@@ -756,7 +776,7 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
@@ -803,7 +823,8 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  NS_ASSERT ((m_data == 0) == (o.m_data == 0));
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
@@ -880,20 +901,47 @@ void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  NS_ASSERT (IsStateOk ());
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
     }
+  if (end == 0)
+    {
+      return;
+    }
+  // the fragments of the packet must cover the padding bytes too.
+  struct PacketMetadata::SmallItem item;
+  item.next = 0xffff;
+  item.prev = m_tail;
+  item.typeUid = 0;
+  item.size = end;
+  item.chunkUid = m_chunkUid;
+  m_chunkUid++;
+  uint16_t written = AddSmall (&item);
+  UpdateTail (written);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::Record (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (m_data == 0);
+  *this = PacketMetadata (m_packetUid, size, true);
 }
 void 
 PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
+      if (start > 0)
+        {
+          m_outerUid = 0;
+        }
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -922,7 +970,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, true);
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -954,7 +1002,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_data == 0)
     {
       m_metadataSkipped = true;
       return;
@@ -986,7 +1034,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, true);
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1043,6 +1091,14 @@ PacketMetadata::GetUid (void) const
   NS_LOG_FUNCTION (this);
   return m_packetUid;
 }
+TypeId
+PacketMetadata::GetOuterHeader (void) const
+{
+  NS_LOG_FUNCTION (this);
+  TypeId tid;
+  tid.SetUid (m_outerUid);
+  return tid;
+}
 PacketMetadata::ItemIterator 
 PacketMetadata::BeginItem (Buffer buffer) const
 {
@@ -1146,7 +1202,7 @@ PacketMetadata::GetSerializedSize (void) const
   // if packet-metadata not enabled, total size
   // is simply 4-bytes for itself plus 8-bytes 
   // for packet uid
-  if (!m_enable)
+  if (m_data == 0)
     {
       return totalSize;
     }
@@ -1290,6 +1346,12 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
 
+  if (desSize > 0 && m_data == 0)
+    {
+      // the sender recorded the metadata of this packet.
+      *this = PacketMetadata (m_packetUid, 0, true);
+    }
+
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
   while (desSize > 0)
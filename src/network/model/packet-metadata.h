@@ -159,6 +159,25 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata of the packets created in a
+   * simulation context, and the tracking of the outermost header of
+   * the other packets.
+   *
+   * \param context the context, usually a node id
+   */
+  static void EnableContext (uint32_t context);
+  /**
+   * \brief Enable the tracking of the outermost header of the packets
+   * whose metadata is not recorded, from which PacketDissector
+   * reconstructs their headers.
+   */
+  static void EnableDissection (void);
+  /**
+   * \returns true if the outermost header of the packets whose
+   * metadata is not recorded is tracked
+   */
+  static bool IsDissectionEnabled (void);
 
   /**
    * \brief Constructor
@@ -219,14 +238,28 @@ private:
 
   /**
    * \brief Add a metadata at the metadata start
+   *
+   * Both metadata must be recorded, or both not recorded: see Record.
+   *
    * \param o the metadata to add
    */
   void AddAtEnd (PacketMetadata const&o);
   /**
    * \brief Add some padding at the end
+   *
+   * The padding of a recorded metadata is recorded as payload.
+   *
    * \param end size of padding
    */
   void AddPaddingAtEnd (uint32_t end);
+  /**
+   * \brief Start recording the metadata of a packet not recorded so far
+   *
+   * Its current bytes are covered by padding.
+   *
+   * \param size the size of the packet
+   */
+  void Record (uint32_t size);
   /**
    * \brief Remove a chunk of metadata at the metadata start
    * \param start the size of metadata to remove
@@ -244,6 +277,20 @@ private:
    */
   uint64_t GetUid (void) const;
 
+  /**
+   * \returns true if the metadata of this packet is recorded
+   */
+  inline bool IsRecorded (void) const;
+
+  /**
+   * \brief Get the outermost header of a packet whose metadata is not
+   * recorded.
+   *
+   * \returns the type of the outermost header, or a TypeId of uid 0 if
+   * it is not known
+   */
+  TypeId GetOuterHeader (void) const;
+
   /**
    * \brief Get the metadata serialized size
    * \return the seralized size
@@ -491,16 +538,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -615,6 +652,18 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Constructor of a metadata recorded or not, whatever the context.
+   * \param uid packet uid
+   * \param size size of the payload
+   * \param record whether the metadata is recorded
+   */
+  inline PacketMetadata (uint64_t uid, uint32_t size, bool record);
+  /**
+   * \returns true if the metadata of the packets created in the current
+   * simulation context is recorded
+   */
+  static bool IsRecordedContext (void);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -656,7 +705,6 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -667,10 +715,14 @@ public:
    */
   static bool m_metadataSkipped;
 
+  static bool m_enableContexts; //!< Enable the packet metadata in some contexts only
+  static std::vector<bool> m_recordedContexts; //!< The contexts where the metadata is recorded
+  static bool m_enableDissection; //!< Track the outermost header of the packets not recorded
+
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
-  struct Data *m_data; //!< Metadata storage
+  struct Data *m_data; //!< Metadata storage, or 0 if the metadata is not recorded
   /*
      head -(next)-> tail
        ^             |
@@ -679,6 +731,7 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  uint16_t m_outerUid; //!< Uid of the outermost header if not recorded and known, else 0
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -687,16 +740,24 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : PacketMetadata (uid, size, m_enable || (m_enableContexts && IsRecordedContext ()))
+{
+}
+PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size, bool record)
+  : m_data (record ? PacketMetadata::Create (10) : 0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_outerUid (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
-  if (size > 0)
+  if (m_data != 0)
     {
-      DoAddHeader (0, size);
+      memset (m_data->m_data, 0xff, 4);
+      if (size > 0)
+        {
+          DoAddHeader (0, size);
+        }
     }
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
@@ -704,11 +765,14 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_outerUid (o.m_outerUid),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -716,31 +780,44 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_outerUid = o.m_outerUid;
   m_packetUid = o.m_packetUid;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
 }
+bool
+PacketMetadata::IsRecorded (void) const
+{
+  return m_data != 0;
+}
 
 } // namespace ns3
 
@@ -29,6 +29,7 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -157,6 +158,16 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  int32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i >= 0)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      tag.Deserialize (TagBuffer (m_inline[i].data,
+                                  m_inline[i].data + TagData::MAX_SIZE));
+      std::copy (m_inline + i + 1, m_inline + m_nInline, m_inline + i);
+      m_nInline--;
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -196,6 +207,14 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  int32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i >= 0)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      tag.Serialize (TagBuffer (m_inline[i].data,
+                                m_inline[i].data + tag.GetSerializedSize ()));
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -240,24 +259,40 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
   return found;
 }
 
+void
+PacketTagList::Spill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_nInline > 0);
+  struct TagData * head = new struct TagData ();
+  head->count = 1;
+  head->tid = m_inline[0].tid;
+  std::memcpy (head->data, m_inline[0].data, TagData::MAX_SIZE);
+  head->next = m_next;
+  m_next = head;
+  std::copy (m_inline + 1, m_inline + m_nInline, m_inline);
+  m_nInline--;
+}
+
 void 
 PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT (FindInline (tag.GetInstanceTypeId ()) < 0);
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
     }
-  struct TagData * head = new struct TagData ();
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
   NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  if (m_nInline == INLINE_TAGS)
+    {
+      self->Spill ();
+    }
+  struct InlineTag &item = self->m_inline[self->m_nInline++];
+  item.tid = tag.GetInstanceTypeId ();
+  tag.Serialize (TagBuffer (item.data, item.data + tag.GetSerializedSize ()));
 }
 
 bool
@@ -265,6 +300,13 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  int32_t i = FindInline (tid);
+  if (i >= 0)
+    {
+      tag.Deserialize (TagBuffer (const_cast<uint8_t *> (m_inline[i].data),
+                                  const_cast<uint8_t *> (m_inline[i].data) + TagData::MAX_SIZE));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -278,11 +320,5 @@ PacketTagList::Peek (Tag &tag) const
   return false;
 }
 
-const struct PacketTagList::TagData *
-PacketTagList::Head (void) const
-{
-  return m_next;
-}
-
 } /* namespace ns3 */
 
@@ -27,7 +27,9 @@
 
 #include <stdint.h>
 #include <ostream>
+#include <algorithm>
 #include "ns3/type-id.h"
+#include "packet-allocator.h"
 
 namespace ns3 {
 
@@ -120,6 +122,20 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline storage: </b>
+ *
+ *   - The most recent #INLINE_TAGS tags are not stored in the tree,
+ *     but inline in the PacketTagList itself, in the order they
+ *     were added.  Most packets never carry more tags than that, so
+ *     that #Add, #Peek, #Remove and #Replace do not allocate memory
+ *     and copies of the list copy a few bytes instead of sharing
+ *     nodes.
+ *
+ *   - When #Add finds the inline storage full, the oldest inline tag
+ *     spills to the head of the tree, so that the tree always holds
+ *     tags older than the inline ones.  The copy-on-write rules above
+ *     apply unchanged to the tree.
+ *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
@@ -165,8 +181,35 @@ public:
     struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
     uint32_t count;           /**< Number of incoming links */
+
+    /**
+     * Allocate the nodes from the PacketAllocator.
+     * \param [in] size The size of the node.
+     * \returns The memory of the node.
+     */
+    static void * operator new (size_t size)
+    {
+      return PacketAllocator::Allocate (size);
+    }
+    /**
+     * Return the nodes to the PacketAllocator.
+     * \param [in] p The memory of the node.
+     * \param [in] size The size of the node.
+     */
+    static void operator delete (void *p, size_t size)
+    {
+      PacketAllocator::Deallocate (p, size);
+    }
   };  /* struct TagData */
 
+  /**
+   * Number of tags stored inline, without memory allocation.
+   */
+  enum InlineTags_e
+  {
+    INLINE_TAGS = 4
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -176,8 +219,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy by copying the inline tags
+   * of \pname{o}, then pointing to the same \ref TagData as \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -186,8 +229,8 @@ public:
    * \param [in] o The PacketTagList to copy.
    * \returns the copied object
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy by #RemoveAll, copying the inline
+   * tags of \pname{o}, then pointing to the same \ref TagData as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
@@ -233,12 +276,30 @@ public:
    * Remove all tags from this list (up to the first merge).
    */
   inline void RemoveAll (void);
+
+private:
+  friend class PacketTagIterator;
+
   /**
-   * \returns pointer to head of tag list
+   * A tag stored inline.
    */
-  const struct PacketTagList::TagData *Head (void) const;
+  struct InlineTag
+  {
+    TypeId tid;                          /**< Type of the tag serialized into #data */
+    uint8_t data[TagData::MAX_SIZE];     /**< Serialization buffer */
+  };
 
-private:
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The tag type to find.
+   * \returns The index of the tag in #m_inline, or -1 if there is none.
+   */
+  inline int32_t FindInline (TypeId tid) const;
+  /**
+   * Move the oldest inline tag to the head of the tree.
+   */
+  void Spill (void);
   /**
    * Typedef of method function pointer for copy-on-write operations
    *
@@ -291,6 +352,14 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * Number of tags in #m_inline
+   */
+  uint8_t m_nInline;
+  /**
+   * The inline tags, oldest first
+   */
+  struct InlineTag m_inline[INLINE_TAGS];
 };
 
 } // namespace ns3
@@ -302,33 +371,41 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_nInline (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_nInline (o.m_nInline)
 {
   if (m_next != 0)
     {
       m_next->count++;
     }
+  std::copy (o.m_inline, o.m_inline + m_nInline, m_inline);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next)
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
     }
+  m_nInline = o.m_nInline;
+  std::copy (o.m_inline, o.m_inline + m_nInline, m_inline);
   return *this;
 }
 
@@ -359,6 +436,20 @@ PacketTagList::RemoveAll (void)
       delete prev;
     }
   m_next = 0;
+  m_nInline = 0;
+}
+
+int32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  for (int32_t i = m_nInline - 1; i >= 0; i--)
+    {
+      if (m_inline[i].tid == tid)
+        {
+          return i;
+        }
+    }
+  return -1;
 }
 
 } // namespace ns3
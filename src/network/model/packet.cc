@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-dissector.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -81,39 +82,49 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagList &list)
+  : m_list (&list),
+    m_inline (list.m_nInline),
+    m_current (list.m_next)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_inline != 0 || m_current != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  // the inline tags are the most recent ones, and are stored oldest first.
+  if (m_inline != 0)
+    {
+      m_inline--;
+      const struct PacketTagList::InlineTag &item = m_list->m_inline[m_inline];
+      return PacketTagIterator::Item (item.tid, item.data);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  return PacketTagIterator::Item (prev->tid, prev->data);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data)
+  : m_tid (tid),
+    m_data (data)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data
                               + PacketTagList::TagData::MAX_SIZE));
 }
 
@@ -292,6 +303,22 @@ Packet::RemoveHeader (Header &header)
   m_metadata.RemoveHeader (header, deserialized);
   return deserialized;
 }
+Buffer::Iterator
+Packet::ReserveHeaders (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_buffer.AddAtStart (size);
+  m_byteTagList.Adjust (size);
+  m_byteTagList.AddAtStart (size);
+  return m_buffer.Begin ();
+}
+void
+Packet::ReleaseHeaders (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_buffer.RemoveAtStart (size);
+  m_byteTagList.Adjust (-size);
+}
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
@@ -336,8 +363,23 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   copy.AddAtStart (0);
   copy.Adjust (GetSize ());
   m_byteTagList.Add (copy);
+  uint32_t size = GetSize ();
   m_buffer.AddAtEnd (packet->m_buffer);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  // the bytes of a packet whose metadata is not recorded are covered
+  // by padding in the metadata of the other.
+  if (m_metadata.IsRecorded () == packet->m_metadata.IsRecorded ())
+    {
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
+  else if (m_metadata.IsRecorded ())
+    {
+      m_metadata.AddPaddingAtEnd (packet->GetSize ());
+    }
+  else
+    {
+      m_metadata.Record (size);
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -429,6 +471,11 @@ Packet::ToString() const
 void 
 Packet::Print (std::ostream &os) const
 {
+  if (!m_metadata.IsRecorded () && PacketMetadata::IsDissectionEnabled ())
+    {
+      PacketDissector::Print (os, m_metadata.GetOuterHeader (), m_buffer);
+      return;
+    }
   PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
   while (i.HasNext ())
     {
@@ -556,6 +603,13 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnablePrintingForNode (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (nodeId);
+  PacketMetadata::EnableContext (nodeId);
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -899,7 +953,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -29,10 +29,12 @@
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
 #include "nix-vector.h"
+#include "packet-allocator.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include "ns3/unused.h"
 
 namespace ns3 {
 
@@ -151,10 +153,12 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the type of the tag.
+     * \param data the serialized tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data);
+    TypeId m_tid;          //!< the type of the tag
+    const uint8_t *m_data; //!< the serialized tag
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -168,10 +172,12 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the tags to iterate over
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const PacketTagList &list);
+  const PacketTagList *m_list; //!< the tags to iterate over
+  uint32_t m_inline;  //!< number of inline tags not visited yet
+  const struct PacketTagList::TagData *m_current;  //!< actual position over the tags which are not inline
 };
 
 /**
@@ -310,6 +316,25 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Returns the size in bytes of the zero-filled payload of the packet.
+   *
+   * The payload created by Packet (uint32_t) carries only its size: its
+   * bytes take no memory, and the IP checksums, the Ethernet FCS, the
+   * serialization used by MPI, fragmentation and reassembly skip them.
+   * A device model may use this to skip the work which only depends on
+   * the content of the payload.  The payload still reads as zeroes, so
+   * the models which do read it are not affected.
+   *
+   * \returns the number of zero-filled payload bytes, or 0 if the packet
+   *          carries no zero-filled payload
+   */
+  inline uint32_t GetZeroPayloadSize (void) const;
+  /**
+   * \returns the offset from the start of the packet of the zero-filled
+   *          payload, when GetZeroPayloadSize is not 0
+   */
+  inline uint32_t GetZeroPayloadOffset (void) const;
   /**
    * \brief Add header to this packet.
    *
@@ -339,6 +364,76 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header) const;
+  /**
+   * \brief Add headers of a fixed size to this packet.
+   *
+   * The headers are given in the order in which they appear on the
+   * wire: AddHeaders (h1, h2) is equivalent to AddHeader (h2) followed
+   * by AddHeader (h1).  Each header type H must declare its size as
+   * a compile-time constant, <tt>static const uint32_t H::SERIALIZED_SIZE</tt>,
+   * which must be the value returned by H::GetSerializedSize.  The
+   * space for all headers is then reserved at once in the buffer and
+   * the headers are serialized with non-virtual calls, from the innermost
+   * one, so that each header may read the bytes which follow it.
+   *
+   * The iterator given to the Serialize method of a header points into a
+   * buffer which already holds the space of the outer headers of the same
+   * call: Buffer::Iterator::GetSize counts them as well.  A header which
+   * derives a length or a checksum from the buffer, such as UdpHeader,
+   * must use Buffer::Iterator::GetRemainingSize instead, or be the
+   * outermost header \p h1.
+   *
+   * \param h1 the outermost header to add to this packet.
+   */
+  template <typename H1>
+  void AddHeaders (const H1 &h1);
+  /**
+   * \brief Add headers of a fixed size to this packet.
+   * \see AddHeaders (const H1 &h1)
+   * \param h1 the outermost header to add to this packet.
+   * \param h2 the header which follows \p h1.
+   */
+  template <typename H1, typename H2>
+  void AddHeaders (const H1 &h1, const H2 &h2);
+  /**
+   * \brief Add headers of a fixed size to this packet.
+   * \see AddHeaders (const H1 &h1)
+   * \param h1 the outermost header to add to this packet.
+   * \param h2 the header which follows \p h1.
+   * \param h3 the header which follows \p h2.
+   */
+  template <typename H1, typename H2, typename H3>
+  void AddHeaders (const H1 &h1, const H2 &h2, const H3 &h3);
+  /**
+   * \brief Remove headers of a fixed size from this packet.
+   *
+   * The headers are given in the order in which they appear on the
+   * wire: RemoveHeaders (h1, h2) is equivalent to RemoveHeader (h1)
+   * followed by RemoveHeader (h2).  The header types must declare
+   * their size as for AddHeaders, and the same constraint applies to the
+   * Deserialize method of a header which is not the outermost one.
+   *
+   * \param h1 the outermost header to remove from this packet.
+   */
+  template <typename H1>
+  void RemoveHeaders (H1 &h1);
+  /**
+   * \brief Remove headers of a fixed size from this packet.
+   * \see RemoveHeaders (H1 &h1)
+   * \param h1 the outermost header to remove from this packet.
+   * \param h2 the header which follows \p h1.
+   */
+  template <typename H1, typename H2>
+  void RemoveHeaders (H1 &h1, H2 &h2);
+  /**
+   * \brief Remove headers of a fixed size from this packet.
+   * \see RemoveHeaders (H1 &h1)
+   * \param h1 the outermost header to remove from this packet.
+   * \param h2 the header which follows \p h1.
+   * \param h3 the header which follows \p h2.
+   */
+  template <typename H1, typename H2, typename H3>
+  void RemoveHeaders (H1 &h1, H2 &h2, H3 &h3);
   /**
    * \brief Add trailer to this packet.
    *
@@ -502,6 +597,22 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing the packets of a node.
+   *
+   * Only the metadata of the packets created by the node, that is from
+   * events scheduled in its context, is recorded: the other packets
+   * pay no metadata cost.  They can still be printed, but their headers
+   * are then decoded by PacketDissector from their outermost header and
+   * the protocol numbers of the registered headers, without the
+   * trailers and the fragmentation information.
+   *
+   * Unlike EnablePrinting, this method may be called at any time; the
+   * packets created before are never recorded.
+   *
+   * \param nodeId the id of the node
+   */
+  static void EnablePrintingForNode (uint32_t nodeId);
   /**
    * \brief Enable packets metadata checking.
    *
@@ -693,6 +804,19 @@ public:
   typedef void (* PacketSizeTracedCallback)
     (const uint32_t oldSize, const uint32_t newSize);
 
+  /**
+   * \brief Allocate the memory of a packet from the PacketAllocator.
+   * \param [in] size The size of the object.
+   * \returns The memory of the object.
+   */
+  inline static void * operator new (size_t size);
+  /**
+   * \brief Return the memory of a packet to the PacketAllocator.
+   * \param [in] p The memory of the object.
+   * \param [in] size The size of the object.
+   */
+  inline static void operator delete (void *p, size_t size);
+
 private:
   /**
    * \brief Constructor
@@ -706,6 +830,32 @@ private:
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Reserve space for headers at the start of the packet.
+   * \param size the total size of the headers.
+   * \returns an iterator to the start of the reserved space.
+   */
+  Buffer::Iterator ReserveHeaders (uint32_t size);
+  /**
+   * \brief Drop the bytes of removed headers from the start of the packet.
+   * \param size the total size of the headers.
+   */
+  void ReleaseHeaders (uint32_t size);
+  /**
+   * \brief Serialize a fixed-size header.
+   * \param i the position of the header in the buffer.
+   * \param header the header to serialize.
+   */
+  template <typename H>
+  static void SerializeFixedHeader (Buffer::Iterator i, const H &header);
+  /**
+   * \brief Deserialize a fixed-size header and move past it.
+   * \param i the position of the header in the buffer.
+   * \param header the header to deserialize.
+   */
+  template <typename H>
+  static void DeserializeFixedHeader (Buffer::Iterator &i, H &header);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -781,6 +931,125 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+uint32_t
+Packet::GetZeroPayloadSize (void) const
+{
+  return m_buffer.GetZeroAreaSize ();
+}
+
+uint32_t
+Packet::GetZeroPayloadOffset (void) const
+{
+  return m_buffer.GetZeroAreaOffset ();
+}
+
+void *
+Packet::operator new (size_t size)
+{
+  return PacketAllocator::Allocate (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  PacketAllocator::Deallocate (p, size);
+}
+
+template <typename H>
+void
+Packet::SerializeFixedHeader (Buffer::Iterator i, const H &header)
+{
+  NS_ASSERT (header.GetSerializedSize () == H::SERIALIZED_SIZE);
+  header.H::Serialize (i);
+}
+
+template <typename H>
+void
+Packet::DeserializeFixedHeader (Buffer::Iterator &i, H &header)
+{
+  uint32_t deserialized = header.H::Deserialize (i);
+  NS_ASSERT (deserialized == H::SERIALIZED_SIZE);
+  NS_UNUSED (deserialized);
+  i.Next (H::SERIALIZED_SIZE);
+}
+
+template <typename H1>
+void
+Packet::AddHeaders (const H1 &h1)
+{
+  SerializeFixedHeader (ReserveHeaders (H1::SERIALIZED_SIZE), h1);
+  m_metadata.AddHeader (h1, H1::SERIALIZED_SIZE);
+}
+
+template <typename H1, typename H2>
+void
+Packet::AddHeaders (const H1 &h1, const H2 &h2)
+{
+  Buffer::Iterator i1 = ReserveHeaders (H1::SERIALIZED_SIZE + H2::SERIALIZED_SIZE);
+  Buffer::Iterator i2 = i1;
+  i2.Next (H1::SERIALIZED_SIZE);
+  // serialize from the innermost header, as AddHeader would.
+  SerializeFixedHeader (i2, h2);
+  SerializeFixedHeader (i1, h1);
+  // the metadata records the headers from the innermost one.
+  m_metadata.AddHeader (h2, H2::SERIALIZED_SIZE);
+  m_metadata.AddHeader (h1, H1::SERIALIZED_SIZE);
+}
+
+template <typename H1, typename H2, typename H3>
+void
+Packet::AddHeaders (const H1 &h1, const H2 &h2, const H3 &h3)
+{
+  Buffer::Iterator i1 = ReserveHeaders (H1::SERIALIZED_SIZE + H2::SERIALIZED_SIZE
+                                        + H3::SERIALIZED_SIZE);
+  Buffer::Iterator i2 = i1;
+  i2.Next (H1::SERIALIZED_SIZE);
+  Buffer::Iterator i3 = i2;
+  i3.Next (H2::SERIALIZED_SIZE);
+  SerializeFixedHeader (i3, h3);
+  SerializeFixedHeader (i2, h2);
+  SerializeFixedHeader (i1, h1);
+  m_metadata.AddHeader (h3, H3::SERIALIZED_SIZE);
+  m_metadata.AddHeader (h2, H2::SERIALIZED_SIZE);
+  m_metadata.AddHeader (h1, H1::SERIALIZED_SIZE);
+}
+
+template <typename H1>
+void
+Packet::RemoveHeaders (H1 &h1)
+{
+  Buffer::Iterator i = m_buffer.Begin ();
+  DeserializeFixedHeader (i, h1);
+  ReleaseHeaders (H1::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h1, H1::SERIALIZED_SIZE);
+}
+
+template <typename H1, typename H2>
+void
+Packet::RemoveHeaders (H1 &h1, H2 &h2)
+{
+  Buffer::Iterator i = m_buffer.Begin ();
+  DeserializeFixedHeader (i, h1);
+  DeserializeFixedHeader (i, h2);
+  ReleaseHeaders (H1::SERIALIZED_SIZE + H2::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h1, H1::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h2, H2::SERIALIZED_SIZE);
+}
+
+template <typename H1, typename H2, typename H3>
+void
+Packet::RemoveHeaders (H1 &h1, H2 &h2, H3 &h3)
+{
+  Buffer::Iterator i = m_buffer.Begin ();
+  DeserializeFixedHeader (i, h1);
+  DeserializeFixedHeader (i, h2);
+  DeserializeFixedHeader (i, h3);
+  ReleaseHeaders (H1::SERIALIZED_SIZE + H2::SERIALIZED_SIZE + H3::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h1, H1::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h2, H2::SERIALIZED_SIZE);
+  m_metadata.RemoveHeader (h3, H3::SERIALIZED_SIZE);
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
@@ -22,6 +22,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <cstring>
 
 using namespace ns3;
 
@@ -359,6 +360,57 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // the virtual zero bytes are skipped by the checksums and the reads.
+  buffer = Buffer (101);
+  buffer.AddAtStart (3);
+  i = buffer.Begin ();
+  i.WriteU8 (0x12);
+  i.WriteU8 (0x34);
+  i.WriteU8 (0x56);
+  buffer.AddAtEnd (3);
+  i = buffer.End ();
+  i.Prev (3);
+  i.WriteU8 (0x78);
+  i.WriteU8 (0x9a);
+  i.WriteU8 (0xbc);
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetZeroAreaSize (), 101, "Bad zero area size");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetZeroAreaOffset (), 3, "Bad zero area offset");
+  Buffer real;
+  real.AddAtStart (buffer.GetSize ());
+  real.Begin ().Write (buffer.Begin (), buffer.End ());
+  NS_TEST_EXPECT_MSG_EQ (real.GetZeroAreaSize (), 0, "Zero area not written");
+  for (uint32_t start = 0; start < 4; start++)
+    {
+      uint16_t size = buffer.GetSize () - start;
+      i = buffer.Begin ();
+      i.Next (start);
+      Buffer::Iterator j = real.Begin ();
+      j.Next (start);
+      NS_TEST_EXPECT_MSG_EQ (i.CalculateIpChecksum (size, 0x1234), j.CalculateIpChecksum (size, 0x1234),
+                             "Bad checksum of the zero area from offset " << start);
+      NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "Checksum did not read the whole buffer");
+    }
+  uint8_t bytes[106];
+  i = buffer.Begin ();
+  i.Next (1);
+  i.Read (bytes, 106);
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "Read did not read the whole buffer");
+  uint8_t copy[107];
+  real.CopyData (copy, 107);
+  NS_TEST_EXPECT_MSG_EQ (memcmp (bytes, copy + 1, 106), 0, "Bad read of the zero area");
+
+  // concatenating fragments which share their data keeps the zero area
+  // virtual.
+  Buffer first = buffer.CreateFragment (0, 54);
+  Buffer second = buffer.CreateFragment (54, 53);
+  first.AddAtEnd (second);
+  NS_TEST_EXPECT_MSG_EQ (first.GetSize (), 107, "Bad reassembled size");
+  NS_TEST_EXPECT_MSG_EQ (first.GetZeroAreaSize (), 101, "Zero area of fragments written");
+  first.CopyData (bytes, 106);
+  NS_TEST_EXPECT_MSG_EQ (memcmp (bytes, copy, 106), 0, "Bad reassembled data");
+  buffer.CopyData (bytes, 106);
+  NS_TEST_EXPECT_MSG_EQ (memcmp (bytes, copy, 106), 0, "Fragmented buffer modified");
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
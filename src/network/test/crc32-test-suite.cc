@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/crc32.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * CRC-32 of data and of runs of zero bytes.
+ */
+class Crc32Test : public TestCase
+{
+public:
+  Crc32Test ();
+private:
+  virtual void DoRun (void);
+};
+
+Crc32Test::Crc32Test ()
+  : TestCase ("CRC-32 of data and of runs of zero bytes")
+{
+}
+
+void
+Crc32Test::DoRun (void)
+{
+  const char *check = "123456789";
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (reinterpret_cast<const uint8_t *> (check), 9), 0xcbf43926,
+                         "Bad CRC-32 check value");
+
+  uint32_t lengths[] = { 0, 1, 2, 63, 64, 65, 127, 1500, 9000, 65539 };
+  uint32_t crcs[] = { 0xffffffff, 0x00000000, 0x12345678 };
+  std::vector<uint8_t> zeroes (65539, 0);
+  for (uint32_t i = 0; i < sizeof (lengths) / sizeof (lengths[0]); i++)
+    {
+      for (uint32_t j = 0; j < sizeof (crcs) / sizeof (crcs[0]); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (CRC32UpdateZeroes (crcs[j], lengths[i]),
+                                 CRC32Update (crcs[j], &zeroes[0], lengths[i]),
+                                 "Bad CRC-32 of " << lengths[i] << " zero bytes from " << crcs[j]);
+        }
+    }
+
+  // the zero bytes may be anywhere in the data.
+  uint8_t data[300];
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      data[i] = i < 100 || i >= 200 ? i * 7 : 0;
+    }
+  uint32_t crc = CRC32Update (0xffffffff, data, 100);
+  crc = CRC32UpdateZeroes (crc, 100);
+  crc = CRC32Update (crc, data + 200, 100);
+  NS_TEST_EXPECT_MSG_EQ (~crc, CRC32Calculate (data, 300), "Bad CRC-32 of data split by zero bytes");
+}
+
+class Crc32TestSuite : public TestSuite
+{
+public:
+  Crc32TestSuite ();
+};
+
+Crc32TestSuite::Crc32TestSuite ()
+  : TestSuite ("crc32", UNIT)
+{
+  AddTestCase (new Crc32Test, TestCase::QUICK);
+}
+
+static Crc32TestSuite g_crc32TestSuite;
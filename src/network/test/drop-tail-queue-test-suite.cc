@@ -20,6 +20,8 @@
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
 
+#include <vector>
+
 using namespace ns3;
 
 class DropTailQueueTestCase : public TestCase
@@ -77,6 +79,66 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((p == 0), true, "There are really no packets in there");
 }
 
+class DropTailQueueBurstTestCase : public TestCase
+{
+public:
+  DropTailQueueBurstTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueBurstTestCase::DropTailQueueBurstTestCase ()
+  : TestCase ("Check the ring buffer and the burst dequeue of the drop tail queue")
+{
+}
+void
+DropTailQueueBurstTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (40));
+
+  // Wrap around the initial ring buffer several times, then make it grow
+  // while wrapped.
+  std::vector<Ptr<Packet> > sent;
+  uint32_t next = 0;
+  for (uint32_t round = 0; round < 5; round++)
+    {
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          sent.push_back (Create<Packet> (i + 1));
+          queue->Enqueue (sent.back ());
+        }
+      for (uint32_t i = 0; i < 7; i++)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_EXPECT_MSG_EQ (p->GetUid (), sent[next++]->GetUid (), "Packets out of order");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 15, "Unexpected number of packets");
+
+  // Fill the queue up to the limit.
+  for (uint32_t i = 0; i < 30; i++)
+    {
+      sent.push_back (Create<Packet> (100));
+      bool ok = queue->Enqueue (sent.back ());
+      NS_TEST_EXPECT_MSG_EQ (ok, (i < 25), "Unexpected drop behavior");
+    }
+  sent.resize (sent.size () - 5);
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 40, "The queue should be full");
+
+  std::vector<Ptr<Packet> > burst;
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBurst (16, burst), 16, "The burst should be complete");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 24, "Unexpected number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBurst (100, burst), 24, "The burst should empty the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBurst (10, burst), 0, "There are really no packets in there");
+  NS_TEST_EXPECT_MSG_EQ (burst.size (), 40, "Unexpected burst size");
+  for (uint32_t i = 0; i < burst.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (burst[i]->GetUid (), sent[next++]->GetUid (), "Burst out of order");
+    }
+}
+
 static class DropTailQueueTestSuite : public TestSuite
 {
 public:
@@ -84,5 +146,6 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueBurstTestCase (), TestCase::QUICK);
   }
 } g_dropTailQueueTestSuite;
@@ -19,10 +19,15 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/packet-dissector.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
 #include <string>
+#include <vector>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
@@ -182,6 +187,8 @@ public:
   ATestHeader ()
     : ATestHeaderBase () {}
 
+  static const uint32_t SERIALIZED_SIZE = N;
+
 };
 
 class ATestTrailerBase : public Trailer
@@ -582,6 +589,59 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  {
+    // AddHeaders and RemoveHeaders behave like a sequence of
+    // AddHeader and RemoveHeader calls
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<25> ());
+    Ptr<Packet> ref = tmp->Copy ();
+    tmp->AddHeaders (ATestHeader<2> (), ATestHeader<3> (), ATestHeader<4> ());
+    ref->AddHeader (ATestHeader<4> ());
+    ref->AddHeader (ATestHeader<3> ());
+    ref->AddHeader (ATestHeader<2> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), ref->GetSize (), "AddHeaders size");
+    std::vector<uint8_t> a (tmp->GetSize ());
+    std::vector<uint8_t> b (ref->GetSize ());
+    tmp->CopyData (&a[0], a.size ());
+    ref->CopyData (&b[0], b.size ());
+    NS_TEST_EXPECT_MSG_EQ ((a == b), true, "AddHeaders bytes");
+    CHECK (tmp, 1, E (25, 9, 109));
+
+    ATestHeader<2> h2;
+    ATestHeader<3> h3;
+    tmp->RemoveHeaders (h2, h3);
+    NS_TEST_EXPECT_MSG_EQ (h2.m_error || h3.m_error, false, "RemoveHeaders content");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 104, "RemoveHeaders size");
+    CHECK (tmp, 1, E (25, 4, 104));
+    ATestHeader<4> h4;
+    tmp->RemoveHeaders (h4);
+    NS_TEST_EXPECT_MSG_EQ (h4.m_error, false, "RemoveHeaders content");
+    CHECK (tmp, 1, E (25, 0, 100));
+  }
+
+  {
+    // the zero-filled payload stays virtual through headers, trailers
+    // and fragmentation, and gives the same FCS as real zero bytes.
+    Ptr<Packet> tmp = Create<Packet> (1000);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddTrailer (ATestTrailer<3> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetZeroPayloadSize (), 1000, "zero payload size");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetZeroPayloadOffset (), 10, "zero payload offset");
+    Ptr<Packet> frag = tmp->CreateFragment (0, 500);
+    frag->AddAtEnd (tmp->CreateFragment (500, 513));
+    NS_TEST_EXPECT_MSG_EQ (frag->GetZeroPayloadSize (), 1000, "zero payload of fragments");
+
+    std::vector<uint8_t> bytes (tmp->GetSize ());
+    tmp->CopyData (&bytes[0], bytes.size ());
+    Ptr<Packet> real = Create<Packet> (&bytes[0], bytes.size ());
+    NS_TEST_EXPECT_MSG_EQ (real->GetZeroPayloadSize (), 0, "zero payload of real bytes");
+    EthernetTrailer fcs;
+    fcs.EnableFcs (true);
+    fcs.CalcFcs (real);
+    NS_TEST_EXPECT_MSG_EQ (fcs.CheckFcs (tmp), true, "bad FCS of the zero payload");
+    NS_TEST_EXPECT_MSG_EQ (fcs.CheckFcs (frag), true, "bad FCS of the reassembled zero payload");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -727,6 +787,59 @@ PacketTagListTest::DoRun (void)
     NS_TEST_EXPECT_MSG_EQ (ref.Peek (t10), false, "missing tag");
   }
 
+  { // Inline storage
+    std::cout << GetName () << "check inline tags do not allocate"
+              << std::endl;
+    NS_TEST_ASSERT_MSG_GT_OR_EQ (PacketTagList::INLINE_TAGS, 4, "too few inline tags for this test");
+    uint64_t allocations = 0;
+    for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+      {
+        allocations -= PacketAllocator::GetStatistics (i).allocations;
+      }
+    PacketTagList ptl;
+    ptl.Add (t1);
+    ptl.Add (t2);
+    ptl.Add (t3);
+    ptl.Add (t4);
+    PacketTagList copy = ptl;
+    copy.Remove (t2);
+    ATestTag<3> r3 (10);
+    copy.Replace (r3);
+    for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+      {
+        allocations += PacketAllocator::GetStatistics (i).allocations;
+      }
+    NS_TEST_EXPECT_MSG_EQ (allocations, 0, "inline tags allocated memory");
+    CheckRef (ptl, t2, "inline orig", false);
+    CheckRef (ptl, t3, "inline orig", false);
+    CheckRef (copy, t2, "inline copy", true);
+    CheckRef (copy, r3, "inline copy", false);
+    CheckRef (copy, t4, "inline copy", false);
+
+    std::cout << GetName () << "check iteration order across the spill"
+              << std::endl;
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddPacketTag (t1);
+    p->AddPacketTag (t2);
+    p->AddPacketTag (t3);
+    p->AddPacketTag (t4);
+    p->AddPacketTag (t5);
+    p->AddPacketTag (t6);
+    p->AddPacketTag (t7);
+    ATestTagBase * expected[] = { &t7, &t6, &t5, &t4, &t3, &t2, &t1 };
+    uint32_t n = 0;
+    PacketTagIterator it = p->GetPacketTagIterator ();
+    while (it.HasNext ())
+      {
+        PacketTagIterator::Item item = it.Next ();
+        NS_TEST_ASSERT_MSG_LT (n, 7, "too many tags");
+        NS_TEST_EXPECT_MSG_EQ (item.GetTypeId (), expected[n]->GetInstanceTypeId (),
+                               "tag " << n << " out of order");
+        n++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 7, "missing tags");
+  }
+
   { // Copy ctor, assignment
     std::cout << GetName () << "check copy and assignment" << std::endl;
     { PacketTagList ptl (ref);
@@ -847,6 +960,325 @@ PacketTagListTest::DoRun (void)
     
 }
 
+//-----------------------------------------------------------------------------
+class PacketAllocatorTest : public TestCase
+{
+public:
+  PacketAllocatorTest ();
+private:
+  void DoRun (void);
+  PacketAllocator::Statistics GetClassStatistics (uint32_t blockSize);
+};
+
+PacketAllocatorTest::PacketAllocatorTest ()
+  : TestCase ("PacketAllocator")
+{
+}
+
+PacketAllocator::Statistics
+PacketAllocatorTest::GetClassStatistics (uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      PacketAllocator::Statistics stats = PacketAllocator::GetStatistics (i);
+      if (stats.blockSize == blockSize)
+        {
+          return stats;
+        }
+    }
+  NS_ASSERT_MSG (false, "no size class of " << blockSize << " bytes");
+  return PacketAllocator::GetStatistics (0);
+}
+
+void
+PacketAllocatorTest::DoRun (void)
+{
+  uint32_t blockSize = PacketAllocator::GetBlockSize (70);
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (blockSize, 70, "block too small");
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetBlockSize (blockSize), blockSize, "size classes not stable");
+
+  // a released block is handed out again by the next allocation of the same class.
+  void *a = PacketAllocator::Allocate (70);
+  PacketAllocator::Deallocate (a, 70);
+  PacketAllocator::Statistics before = GetClassStatistics (blockSize);
+  void *b = PacketAllocator::Allocate (blockSize);
+  PacketAllocator::Statistics after = GetClassStatistics (blockSize);
+  NS_TEST_EXPECT_MSG_EQ (b, a, "released block not reused");
+  NS_TEST_EXPECT_MSG_EQ (after.allocations, before.allocations + 1, "allocation not counted");
+  NS_TEST_EXPECT_MSG_EQ (after.cacheHits, before.cacheHits + 1, "cache hit not counted");
+  NS_TEST_EXPECT_MSG_EQ (after.cached + 1, before.cached, "cached block not removed");
+  PacketAllocator::Deallocate (b, blockSize);
+
+  // oversized requests are never cached.
+  uint32_t large = PacketAllocator::GetMaxBlockSize () + 1;
+  NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetBlockSize (large), large, "oversized request rounded");
+  PacketAllocator::Statistics oversized = PacketAllocator::GetStatistics (PacketAllocator::GetNStatistics () - 1);
+  PacketAllocator::Deallocate (PacketAllocator::Allocate (large), large);
+  PacketAllocator::Statistics oversizedAfter = PacketAllocator::GetStatistics (PacketAllocator::GetNStatistics () - 1);
+  NS_TEST_EXPECT_MSG_EQ (oversizedAfter.blockSize, 0, "bad oversized class");
+  NS_TEST_EXPECT_MSG_EQ (oversizedAfter.releases, oversized.releases + 1, "oversized block cached");
+  NS_TEST_EXPECT_MSG_EQ (oversizedAfter.cached, 0, "oversized block cached");
+
+  // packets, their buffers and their tags come from the allocator and are
+  // recycled: a steady flow of packets is served from the free lists.
+  uint64_t allocations = 0;
+  uint64_t hits = 0;
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      allocations -= PacketAllocator::GetStatistics (i).allocations;
+      hits -= PacketAllocator::GetStatistics (i).cacheHits;
+    }
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      p->AddHeader (ATestHeader<10> ());
+      p->AddPacketTag (ATestTag<4> ());
+      p->AddByteTag (ATestTag<8> ());
+      Ptr<Packet> copy = p->Copy ();
+      copy->AddAtEnd (p);
+    }
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      allocations += PacketAllocator::GetStatistics (i).allocations;
+      hits += PacketAllocator::GetStatistics (i).cacheHits;
+    }
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (allocations, 100 * 5, "packet objects not allocated by the PacketAllocator");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (hits, allocations * 9 / 10, "packet objects not recycled");
+
+  PacketAllocator::Purge ();
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (PacketAllocator::GetStatistics (i).cached, 0, "blocks left after Purge");
+    }
+}
+//-----------------------------------------------------------------------------
+/**
+ * A header holding the protocol number of the next header.
+ */
+class ADissectedHeader : public Header
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::ADissectedHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ADissectedHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 2;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    iter.WriteU8 (0xaa);
+    iter.WriteU8 (m_protocol);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    iter.ReadU8 ();
+    m_protocol = iter.ReadU8 ();
+    return 2;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << "protocol=" << static_cast<uint32_t> (m_protocol);
+  }
+  ADissectedHeader ()
+    : m_protocol (0) {}
+  ADissectedHeader (uint8_t protocol)
+    : m_protocol (protocol) {}
+  /**
+   * Read the protocol number of a header.
+   * \param header the ADissectedHeader
+   * \param protocol the protocol number
+   * \returns true
+   */
+  static bool GetProtocol (const Header &header, uint32_t &protocol) {
+    protocol = static_cast<const ADissectedHeader &> (header).m_protocol;
+    return true;
+  }
+  uint8_t m_protocol;
+};
+
+class PacketDissectorTest : public TestCase
+{
+public:
+  PacketDissectorTest ();
+private:
+  void DoRun (void);
+  /**
+   * Create a packet in the current context.
+   * \param packet the packet created
+   */
+  void CreatePacket (Ptr<Packet> *packet);
+  /**
+   * \param p a packet
+   * \returns the output of Packet::Print
+   */
+  std::string Print (Ptr<const Packet> p);
+};
+
+PacketDissectorTest::PacketDissectorTest ()
+  : TestCase ("PacketDissector")
+{
+}
+
+void
+PacketDissectorTest::CreatePacket (Ptr<Packet> *packet)
+{
+  *packet = Create<Packet> (10);
+}
+
+std::string
+PacketDissectorTest::Print (Ptr<const Packet> p)
+{
+  std::ostringstream oss;
+  p->Print (oss);
+  return oss.str ();
+}
+
+void
+PacketDissectorTest::DoRun (void)
+{
+  PacketDissector::RegisterHeader ("anon::ADissectedHeader", &ADissectedHeader::GetProtocol);
+  PacketDissector::RegisterProtocol ("anon::ADissectedHeader", 1, "anon::ADissectedHeader");
+  PacketDissector::RegisterProtocol ("anon::ADissectedHeader", 2, "anon::ATestHeader<10>");
+  Packet::EnablePrintingForNode (3);
+
+  // only the packets created by node 3 are recorded.
+  Ptr<Packet> recorded;
+  Ptr<Packet> other;
+  Simulator::ScheduleWithContext (3, Seconds (1), &PacketDissectorTest::CreatePacket, this, &recorded);
+  Simulator::ScheduleWithContext (4, Seconds (1), &PacketDissectorTest::CreatePacket, this, &other);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_NE (recorded, 0, "packet not created");
+  NS_TEST_ASSERT_MSG_NE (other, 0, "packet not created");
+  NS_TEST_EXPECT_MSG_EQ (recorded->BeginItem ().HasNext (), true, "metadata of node 3 not recorded");
+  NS_TEST_EXPECT_MSG_EQ (other->BeginItem ().HasNext (), false, "metadata of node 4 recorded");
+
+  // the headers of the other packets are decoded from the outermost one.
+  other->AddHeader (ATestHeader<10> ());
+  other->AddHeader (ADissectedHeader (2));
+  other->AddHeader (ADissectedHeader (1));
+  NS_TEST_EXPECT_MSG_EQ (Print (other),
+                         "anon::ADissectedHeader (protocol=1) anon::ADissectedHeader (protocol=2) "
+                         "anon::ATestHeader<10> () Payload (size=10)", "bad dissection");
+  NS_TEST_EXPECT_MSG_EQ (Print (other->CreateFragment (0, 5)),
+                         "anon::ADissectedHeader (protocol=1) anon::ADissectedHeader (protocol=2) "
+                         "anon::ATestHeader<10> (truncated, size=1)", "bad dissection of a truncated header");
+  Ptr<Packet> copy = other->Copy ();
+  ADissectedHeader header;
+  copy->RemoveHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (Print (copy),
+                         "anon::ADissectedHeader (protocol=2) anon::ATestHeader<10> () Payload (size=10)",
+                         "bad dissection after RemoveHeader");
+  copy->RemoveHeader (header);
+  ATestHeader<10> last;
+  copy->RemoveHeader (last);
+  NS_TEST_EXPECT_MSG_EQ (Print (copy), "Payload (size=10)", "unknown header decoded");
+  other->AddHeader (ADissectedHeader (7));
+  NS_TEST_EXPECT_MSG_EQ (Print (other), "anon::ADissectedHeader (protocol=7) Payload (size=24)",
+                         "unknown protocol decoded");
+
+  // the recorded packets are printed from their metadata.
+  recorded->AddHeader (ADissectedHeader (7));
+  NS_TEST_EXPECT_MSG_EQ (Print (recorded), "anon::ADissectedHeader (protocol=7) Payload (size=10)",
+                         "bad metadata");
+}
+//-----------------------------------------------------------------------------
+/**
+ * Append packets whose metadata is recorded to packets whose metadata
+ * is not, and the converse.
+ */
+class PacketMixedAppendTest : public TestCase
+{
+public:
+  PacketMixedAppendTest ();
+private:
+  void DoRun (void);
+  /**
+   * Create a packet in the current context.
+   * \param packet the packet created
+   */
+  void CreatePacket (Ptr<Packet> *packet);
+  /**
+   * \param p a packet
+   * \returns the output of Packet::Print
+   */
+  std::string Print (Ptr<const Packet> p);
+};
+
+PacketMixedAppendTest::PacketMixedAppendTest ()
+  : TestCase ("Append packets recorded and not recorded")
+{
+}
+
+void
+PacketMixedAppendTest::CreatePacket (Ptr<Packet> *packet)
+{
+  *packet = Create<Packet> (10);
+  (*packet)->AddHeader (ADissectedHeader (7));
+}
+
+std::string
+PacketMixedAppendTest::Print (Ptr<const Packet> p)
+{
+  std::ostringstream oss;
+  p->Print (oss);
+  return oss.str ();
+}
+
+void
+PacketMixedAppendTest::DoRun (void)
+{
+  Packet::EnablePrintingForNode (3);
+  Ptr<Packet> recorded;
+  Ptr<Packet> other;
+  Simulator::ScheduleWithContext (3, Seconds (1), &PacketMixedAppendTest::CreatePacket, this, &recorded);
+  Simulator::ScheduleWithContext (4, Seconds (1), &PacketMixedAppendTest::CreatePacket, this, &other);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_NE (recorded, 0, "packet not created");
+  NS_TEST_ASSERT_MSG_NE (other, 0, "packet not created");
+  NS_TEST_ASSERT_MSG_EQ (other->BeginItem ().HasNext (), false, "metadata of node 4 recorded");
+
+  // the bytes of the packet not recorded are padding.
+  Ptr<Packet> p = recorded->Copy ();
+  p->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 24, "bad size");
+  NS_TEST_EXPECT_MSG_EQ (Print (p), "anon::ADissectedHeader (protocol=7) Payload (size=10) Payload (size=12)",
+                         "bad metadata of a packet with a packet not recorded appended");
+  NS_TEST_EXPECT_MSG_EQ (Print (p->CreateFragment (0, 20)),
+                         "anon::ADissectedHeader (protocol=7) Payload (size=10) Payload Fragment [0:8]",
+                         "bad metadata of the first fragment");
+  NS_TEST_EXPECT_MSG_EQ (Print (p->CreateFragment (20, 4)), "Payload Fragment [8:12]",
+                         "bad metadata of the last fragment");
+
+  // the packet not recorded becomes recorded, its bytes are padding.
+  p = other->Copy ();
+  p->AddAtEnd (recorded);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 24, "bad size");
+  NS_TEST_EXPECT_MSG_EQ (p->BeginItem ().HasNext (), true, "metadata not recorded");
+  NS_TEST_EXPECT_MSG_EQ (Print (p), "Payload (size=12) anon::ADissectedHeader (protocol=7) Payload (size=10)",
+                         "bad metadata of a packet not recorded with a packet appended");
+  NS_TEST_EXPECT_MSG_EQ (Print (p->CreateFragment (0, 20)),
+                         "Payload (size=12) anon::ADissectedHeader (protocol=7) Payload Fragment [0:6]",
+                         "bad metadata of the first fragment");
+
+  // appending a packet not recorded to an unrecorded one is not recorded either.
+  p = other->Copy ();
+  p->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (p->BeginItem ().HasNext (), false, "metadata recorded");
+  NS_TEST_EXPECT_MSG_EQ (Print (p), "anon::ADissectedHeader (protocol=7) Payload (size=22)", "bad dissection");
+}
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -859,6 +1291,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketAllocatorTest, TestCase::QUICK);
+  AddTestCase (new PacketDissectorTest, TestCase::QUICK);
+  AddTestCase (new PacketMixedAppendTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
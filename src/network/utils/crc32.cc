@@ -26,6 +26,7 @@
  * code or tables extracted from it, as desired without restriction.
  */
 #include <stdint.h>
+#include "crc32.h"
 
 namespace ns3 {
 
@@ -70,13 +71,89 @@ static uint32_t crc32table[256] = {
 uint32_t
 CRC32Calculate (const uint8_t *data, int length)
 {
-  uint32_t crc = 0xffffffff;
+  return ~CRC32Update (0xffffffff, data, length);
+}
 
+uint32_t
+CRC32Update (uint32_t crc, const uint8_t *data, int length)
+{
   while (length--)
     {
       crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
     }
-  return ~crc;
+  return crc;
+}
+
+/**
+ * Multiply a vector by a matrix over GF(2).
+ *
+ * \param matrix the 32x32 matrix, as the images of the 32 unit vectors
+ * \param vector the vector
+ * \returns the product
+ */
+static uint32_t
+Gf2MatrixTimes (const uint32_t *matrix, uint32_t vector)
+{
+  uint32_t sum = 0;
+  for (; vector != 0; vector >>= 1, matrix++)
+    {
+      if (vector & 1)
+        {
+          sum ^= *matrix;
+        }
+    }
+  return sum;
+}
+
+/**
+ * The operators applying a run of zero bytes to a running CRC-32.
+ *
+ * Updating a CRC-32 with zero bytes is linear over GF(2): the operator
+ * of 2^(k+1) zero bytes is the square of the operator of 2^k zero bytes.
+ */
+struct Crc32ZeroOperators
+{
+  Crc32ZeroOperators ();
+  uint32_t op[32][32]; //!< The operators of 2^k zero bytes, k = 0..31
+};
+
+Crc32ZeroOperators::Crc32ZeroOperators ()
+{
+  for (uint32_t i = 0; i < 32; i++)
+    {
+      uint32_t crc = 1U << i;
+      op[0][i] = (crc >> 8) ^ crc32table[crc & 0xFF];
+    }
+  for (uint32_t k = 1; k < 32; k++)
+    {
+      for (uint32_t i = 0; i < 32; i++)
+        {
+          op[k][i] = Gf2MatrixTimes (op[k - 1], op[k - 1][i]);
+        }
+    }
+}
+
+uint32_t
+CRC32UpdateZeroes (uint32_t crc, uint32_t length)
+{
+  // A few bytes are faster through the table.
+  if (length < 64)
+    {
+      while (length--)
+        {
+          crc = (crc >> 8) ^ crc32table[crc & 0xFF];
+        }
+      return crc;
+    }
+  static const Crc32ZeroOperators operators;
+  for (uint32_t k = 0; length != 0; k++, length >>= 1)
+    {
+      if (length & 1)
+        {
+          crc = Gf2MatrixTimes (operators.op[k], crc);
+        }
+    }
+  return crc;
 }
 
 } // namespace ns3
@@ -33,6 +33,30 @@ namespace ns3 {
  */
 uint32_t CRC32Calculate (const uint8_t *data, int length);
 
+/**
+ * Updates a running CRC-32 with the bytes of a buffer
+ *
+ * The CRC-32 of a message split in several parts is the complement of
+ * the running CRC-32 started at 0xffffffff and updated with each part.
+ *
+ * \param crc the running crc-32
+ * \param data buffer to calculate the checksum for
+ * \param length the length of the buffer (bytes)
+ * \returns the updated running crc-32.
+ */
+uint32_t CRC32Update (uint32_t crc, const uint8_t *data, int length);
+
+/**
+ * Updates a running CRC-32 with zero bytes
+ *
+ * The time is logarithmic in the number of zero bytes.
+ *
+ * \param crc the running crc-32
+ * \param length the number of zero bytes
+ * \returns the updated running crc-32.
+ */
+uint32_t CRC32UpdateZeroes (uint32_t crc, uint32_t length);
+
 } // namespace ns3
 
 #endif
@@ -21,6 +21,8 @@
 #include "ns3/uinteger.h"
 #include "drop-tail-queue.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DropTailQueue");
@@ -58,6 +60,8 @@ TypeId DropTailQueue::GetTypeId (void)
 DropTailQueue::DropTailQueue () :
   Queue (),
   m_packets (),
+  m_head (0),
+  m_count (0),
   m_bytesInQueue (0)
 {
   NS_LOG_FUNCTION (this);
@@ -82,12 +86,32 @@ DropTailQueue::GetMode (void) const
   return m_mode;
 }
 
+void
+DropTailQueue::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // The initial capacity is small: queues of devices which are never
+  // congested hold very few packets.
+  uint32_t capacity = m_packets.empty () ? 16 : 2 * m_packets.size ();
+  std::vector<Ptr<Packet> > packets (capacity);
+  uint32_t mask = m_packets.size () - 1;
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      packets[i] = m_packets[(m_head + i) & mask];
+    }
+  m_packets.swap (packets);
+  m_head = 0;
+
+  NS_LOG_LOGIC ("Capacity " << capacity);
+}
+
 bool 
 DropTailQueue::DoEnqueue (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
 
-  if (m_mode == QUEUE_MODE_PACKETS && (m_packets.size () >= m_maxPackets))
+  if (m_mode == QUEUE_MODE_PACKETS && (m_count >= m_maxPackets))
     {
       NS_LOG_LOGIC ("Queue full (at max packets) -- droppping pkt");
       Drop (p);
@@ -101,10 +125,16 @@ DropTailQueue::DoEnqueue (Ptr<Packet> p)
       return false;
     }
 
+  if (m_count == m_packets.size ())
+    {
+      Grow ();
+    }
+
   m_bytesInQueue += p->GetSize ();
-  m_packets.push (p);
+  m_packets[(m_head + m_count) & (m_packets.size () - 1)] = p;
+  m_count++;
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return true;
@@ -115,38 +145,66 @@ DropTailQueue::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_packets.empty ())
+  if (m_count == 0)
     {
       NS_LOG_LOGIC ("Queue empty");
       return 0;
     }
 
-  Ptr<Packet> p = m_packets.front ();
-  m_packets.pop ();
+  Ptr<Packet> p = m_packets[m_head];
+  m_packets[m_head] = 0;
+  m_head = (m_head + 1) & (m_packets.size () - 1);
+  m_count--;
   m_bytesInQueue -= p->GetSize ();
 
   NS_LOG_LOGIC ("Popped " << p);
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return p;
 }
 
+uint32_t
+DropTailQueue::DoDequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  uint32_t count = std::min (n, m_count);
+  uint32_t mask = m_packets.size () - 1;
+  packets.reserve (packets.size () + count);
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<Packet> p = m_packets[m_head];
+      m_packets[m_head] = 0;
+      m_head = (m_head + 1) & mask;
+      m_bytesInQueue -= p->GetSize ();
+      packets.push_back (p);
+    }
+  m_count -= count;
+
+  NS_LOG_LOGIC ("Popped " << count << " packets");
+
+  NS_LOG_LOGIC ("Number packets " << m_count);
+  NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
+
+  return count;
+}
+
 Ptr<const Packet>
 DropTailQueue::DoPeek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_packets.empty ())
+  if (m_count == 0)
     {
       NS_LOG_LOGIC ("Queue empty");
       return 0;
     }
 
-  Ptr<Packet> p = m_packets.front ();
+  Ptr<Packet> p = m_packets[m_head];
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return p;
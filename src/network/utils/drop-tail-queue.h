@@ -19,7 +19,7 @@
 #ifndef DROPTAIL_H
 #define DROPTAIL_H
 
-#include <queue>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/queue.h"
 
@@ -31,6 +31,11 @@ class TraceContainer;
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The packets are stored in a ring buffer whose capacity is a power of
+ * two.  The capacity is doubled whenever the buffer is full; it is
+ * bounded by MaxPackets in packet mode, so that once the queue has been
+ * filled no more memory is ever allocated.
  */
 class DropTailQueue : public Queue {
 public:
@@ -66,9 +71,17 @@ public:
 private:
   virtual bool DoEnqueue (Ptr<Packet> p);
   virtual Ptr<Packet> DoDequeue (void);
+  virtual uint32_t DoDequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets);
   virtual Ptr<const Packet> DoPeek (void) const;
 
-  std::queue<Ptr<Packet> > m_packets; //!< the packets in the queue
+  /**
+   * Double the capacity of the ring buffer, keeping the packets in order.
+   */
+  void Grow (void);
+
+  std::vector<Ptr<Packet> > m_packets; //!< the ring buffer of the packets in the queue
+  uint32_t m_head;                    //!< index of the front packet in the ring buffer
+  uint32_t m_count;                   //!< number of packets in the queue
   uint32_t m_maxPackets;              //!< max packets in the queue
   uint32_t m_maxBytes;                //!< max bytes in the queue
   uint32_t m_bytesInQueue;            //!< actual bytes in the queue
@@ -25,6 +25,7 @@
 #include "ns3/header.h"
 #include "ethernet-header.h"
 #include "address-utils.h"
+#include "ns3/packet-dissector.h"
 
 namespace ns3 {
 
@@ -32,6 +33,40 @@ NS_LOG_COMPONENT_DEFINE ("EthernetHeader");
 
 NS_OBJECT_ENSURE_REGISTERED (EthernetHeader);
 
+namespace {
+
+/**
+ * \brief Read the protocol number of an Ethernet header.
+ * \param header the EthernetHeader
+ * \param protocol the protocol number
+ * \returns true if the header following it is identified by \p protocol
+ */
+bool
+GetLengthType (const Header &header, uint32_t &protocol)
+{
+  uint16_t lengthType = static_cast<const EthernetHeader &> (header).GetLengthType ();
+  // A length rather than a type: an LLC/SNAP header follows.
+  protocol = lengthType <= 1500 ? 0 : lengthType;
+  return true;
+}
+
+/**
+ * Registers the protocol numbers of EthernetHeader with the PacketDissector.
+ */
+struct EthernetHeaderDissection
+{
+  EthernetHeaderDissection ()
+  {
+    PacketDissector::RegisterHeader ("ns3::EthernetHeader", &GetLengthType);
+    PacketDissector::RegisterProtocol ("ns3::EthernetHeader", 0, "ns3::LlcSnapHeader");
+    PacketDissector::RegisterProtocol ("ns3::EthernetHeader", 0x0800, "ns3::Ipv4Header");
+    PacketDissector::RegisterProtocol ("ns3::EthernetHeader", 0x86dd, "ns3::Ipv6Header");
+    PacketDissector::RegisterProtocol ("ns3::EthernetHeader", 0x0806, "ns3::ArpHeader");
+  }
+} g_ethernetHeaderDissection; //!< Registers the protocol numbers at load time.
+
+} // anonymous namespace
+
 EthernetHeader::EthernetHeader (bool hasPreamble)
   : m_enPreambleSfd (hasPreamble),
     m_lengthType (0)
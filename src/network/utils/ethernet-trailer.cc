@@ -23,6 +23,7 @@
 #include "ns3/trailer.h"
 #include "ethernet-trailer.h"
 #include "crc32.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -30,6 +31,38 @@ NS_LOG_COMPONENT_DEFINE ("EthernetTrailer");
 
 NS_OBJECT_ENSURE_REGISTERED (EthernetTrailer);
 
+/**
+ * \brief Calculate the CRC-32 of the content of a packet.
+ *
+ * The zero-filled payload of the packet is not copied.
+ *
+ * \param p the packet
+ * \returns the CRC-32 of the packet
+ */
+static uint32_t
+CalculatePacketCrc (Ptr<const Packet> p)
+{
+  uint32_t size = p->GetSize ();
+  uint32_t zeroes = p->GetZeroPayloadSize ();
+  uint32_t head = zeroes > 0 ? p->GetZeroPayloadOffset () : size;
+  uint32_t tail = size - head - zeroes;
+  std::vector<uint8_t> buffer (head + tail);
+  if (head > 0)
+    {
+      p->CopyData (&buffer[0], head);
+    }
+  if (tail > 0)
+    {
+      p->CreateFragment (head + zeroes, tail)->CopyData (&buffer[head], tail);
+    }
+  const uint8_t *data = buffer.empty () ? 0 : &buffer[0];
+  uint32_t crc = 0xffffffff;
+  crc = CRC32Update (crc, data, head);
+  crc = CRC32UpdateZeroes (crc, zeroes);
+  crc = CRC32Update (crc, data + head, tail);
+  return ~crc;
+}
+
 EthernetTrailer::EthernetTrailer ()
   : m_calcFcs (false),
     m_fcs (0)
@@ -48,38 +81,26 @@ bool
 EthernetTrailer::CheckFcs (Ptr<const Packet> p) const
 {
   NS_LOG_FUNCTION (this << p);
-  int len = p->GetSize ();
-  uint8_t *buffer;
-  uint32_t crc;
 
   if (!m_calcFcs)
     {
       return true;
     }
 
-  buffer = new uint8_t[len];
-  p->CopyData (buffer, len);
-  crc = CRC32Calculate (buffer, len);
-  delete[] buffer;
-  return (m_fcs == crc);
+  return (m_fcs == CalculatePacketCrc (p));
 }
 
 void
 EthernetTrailer::CalcFcs (Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
-  int len = p->GetSize ();
-  uint8_t *buffer;
 
   if (!m_calcFcs)
     {
       return;
     }
 
-  buffer = new uint8_t[len];
-  p->CopyData (buffer, len);
-  m_fcs = CRC32Calculate (buffer, len);
-  delete[] buffer;
+  m_fcs = CalculatePacketCrc (p);
 }
 
 void
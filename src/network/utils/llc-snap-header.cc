@@ -19,6 +19,7 @@
  */
 
 #include "llc-snap-header.h"
+#include "ns3/packet-dissector.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include <string>
@@ -29,6 +30,38 @@ NS_LOG_COMPONENT_DEFINE ("LlcSnalHeader");
 
 NS_OBJECT_ENSURE_REGISTERED (LlcSnapHeader);
 
+namespace {
+
+/**
+ * \brief Read the protocol number of an LLC/SNAP header.
+ * \param header the LlcSnapHeader
+ * \param protocol the protocol number
+ * \returns true if the header following it is identified by \p protocol
+ */
+bool
+GetType (const Header &header, uint32_t &protocol)
+{
+  LlcSnapHeader llc = static_cast<const LlcSnapHeader &> (header);
+  protocol = llc.GetType ();
+  return true;
+}
+
+/**
+ * Registers the protocol numbers of LlcSnapHeader with the PacketDissector.
+ */
+struct LlcSnapHeaderDissection
+{
+  LlcSnapHeaderDissection ()
+  {
+    PacketDissector::RegisterHeader ("ns3::LlcSnapHeader", &GetType);
+    PacketDissector::RegisterProtocol ("ns3::LlcSnapHeader", 0x0800, "ns3::Ipv4Header");
+    PacketDissector::RegisterProtocol ("ns3::LlcSnapHeader", 0x86dd, "ns3::Ipv6Header");
+    PacketDissector::RegisterProtocol ("ns3::LlcSnapHeader", 0x0806, "ns3::ArpHeader");
+  }
+} g_llcSnapHeaderDissection; //!< Registers the protocol numbers at load time.
+
+} // anonymous namespace
+
 LlcSnapHeader::LlcSnapHeader ()
 {
   NS_LOG_FUNCTION (this);
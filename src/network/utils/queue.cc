@@ -73,8 +73,11 @@ Queue::Enqueue (Ptr<Packet> p)
   bool retval = DoEnqueue (p);
   if (retval)
     {
-      NS_LOG_LOGIC ("m_traceEnqueue (p)");
-      m_traceEnqueue (p);
+      if (!m_traceEnqueue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceEnqueue (p)");
+          m_traceEnqueue (p);
+        }
 
       uint32_t size = p->GetSize ();
       m_nBytes += size;
@@ -101,12 +104,60 @@ Queue::Dequeue (void)
       m_nBytes -= packet->GetSize ();
       m_nPackets--;
 
-      NS_LOG_LOGIC ("m_traceDequeue (packet)");
-      m_traceDequeue (packet);
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceDequeue (packet)");
+          m_traceDequeue (packet);
+        }
     }
   return packet;
 }
 
+uint32_t
+Queue::DequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  std::size_t first = packets.size ();
+  uint32_t count = DoDequeueBurst (n, packets);
+  NS_ASSERT (count <= n && packets.size () == first + count);
+
+  for (std::size_t i = first; i < packets.size (); i++)
+    {
+      Ptr<Packet> packet = packets[i];
+      NS_ASSERT (m_nBytes >= packet->GetSize ());
+      NS_ASSERT (m_nPackets > 0);
+
+      m_nBytes -= packet->GetSize ();
+      m_nPackets--;
+
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceDequeue (packet)");
+          m_traceDequeue (packet);
+        }
+    }
+  return count;
+}
+
+uint32_t
+Queue::DoDequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets)
+{
+  NS_LOG_FUNCTION (this << n);
+  uint32_t count = 0;
+  while (count < n)
+    {
+      Ptr<Packet> packet = DoDequeue ();
+      if (packet == 0)
+        {
+          break;
+        }
+      packets.push_back (packet);
+      count++;
+    }
+  return count;
+}
+
 void
 Queue::DequeueAll (void)
 {
@@ -199,8 +250,11 @@ Queue::Drop (Ptr<Packet> p)
   m_nTotalDroppedPackets++;
   m_nTotalDroppedBytes += p->GetSize ();
 
-  NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (p);
+  if (!m_traceDrop.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("m_traceDrop (p)");
+      m_traceDrop (p);
+    }
 }
 
 } // namespace ns3
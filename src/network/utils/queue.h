@@ -26,6 +26,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
@@ -69,6 +70,16 @@ public:
    * \return 0 if the operation was not successful; the packet otherwise.
    */
   Ptr<Packet> Dequeue (void);
+  /**
+   * Remove up to \p n packets from the front of the Queue, as if by
+   * as many calls to Dequeue, for devices which send several packets
+   * back-to-back
+   * \param n the maximum number of packets to remove
+   * \param packets the vector to which the packets removed are appended,
+   *        in queue order
+   * \return the number of packets removed
+   */
+  uint32_t DequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets);
   /**
    * Get a copy of the item at the front of the queue without removing it
    * \return 0 if the operation was not successful; the packet otherwise.
@@ -166,6 +177,17 @@ private:
    * \return the packet.
    */
   virtual Ptr<Packet> DoDequeue (void) = 0;
+  /**
+   * Pull up to \p n packets from the queue
+   *
+   * The default implementation calls DoDequeue until it fails or \p n
+   * packets have been pulled.
+   *
+   * \param n the maximum number of packets to pull
+   * \param packets the vector to which the packets are appended
+   * \return the number of packets pulled.
+   */
+  virtual uint32_t DoDequeueBurst (uint32_t n, std::vector<Ptr<Packet> > &packets);
   /**
    * Peek the front packet in the queue
    * \return the packet.
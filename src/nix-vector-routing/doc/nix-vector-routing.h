@@ -30,7 +30,7 @@
  * when dealing with a large number of nodes.
  *
  * Currently, the ns-3 model of nix-vector routing supports IPv4 p2p links 
- * as well as CSMA links.  It does not (yet) provide support for 
+ * as well as CSMA links.  By default, it does not provide support for 
  * efficient adaptation to link failures.  It simply flushes all nix-vector 
  * routing caches. Finally, IPv6 is not supported.
  *
@@ -52,6 +52,18 @@
  *    stack.SetRoutingHelper (list);
  *    stack.Install (allNodes);
  *
+ * When many sources send to many destinations, e.g. all-to-all traffic,
+ * the BFS run by each source node for each destination dominates the
+ * simulation setup.  The "SharedTrees" attribute makes all the nodes use
+ * instead one shortest path tree per destination node, computed once by
+ * a reverse BFS from the destination, and a single table of nix-vectors
+ * indexed by source and destination:
+ *
+ *    nixRouting.Set ("SharedTrees", BooleanValue (true));
+ *
+ * In this mode, an interface going down only erases the trees which route
+ * over it, the other trees are kept.
+ *
  * \section impl Implementation
  *
  * ns-3 nix-vector-routing performs on-demand route computation using 
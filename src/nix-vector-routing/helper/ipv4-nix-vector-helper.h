@@ -64,6 +64,14 @@ public:
   */
   virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set.
+   *
+   * This method controls the attributes of ns3::Ipv4NixVectorRouting
+   */
+  void Set (std::string name, const AttributeValue &value);
+
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
@@ -24,6 +24,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
+#include "ns3/boolean.h"
 #include "ns3/ipv4-list-routing.h"
 
 #include "ipv4-nix-vector-routing.h"
@@ -35,6 +36,14 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+bool Ipv4NixVectorRouting::g_isSharedTreeDirty = false;
+const uint32_t Ipv4NixVectorRouting::NO_NIX_INDEX;
+std::vector<std::vector<Ipv4NixVectorRouting::NixLink> > Ipv4NixVectorRouting::g_nixLinks;
+std::vector<std::vector<std::pair<uint32_t, uint32_t> > > Ipv4NixVectorRouting::g_nixInLinks;
+std::unordered_map<uint32_t, uint32_t> Ipv4NixVectorRouting::g_nixNodeByIp;
+std::unordered_map<uint32_t, std::vector<uint32_t> > Ipv4NixVectorRouting::g_nixTrees;
+std::unordered_map<uint32_t, std::unordered_map<uint32_t, Ptr<NixVector> > > Ipv4NixVectorRouting::g_nixVectors;
+std::vector<std::pair<uint32_t, uint32_t> > Ipv4NixVectorRouting::g_nixDownDevices;
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -43,12 +52,19 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("NixVectorRouting")
     .AddConstructor<Ipv4NixVectorRouting> ()
+    .AddAttribute ("SharedTrees",
+                   "Derive the nix-vectors from per-destination shortest path trees "
+                   "shared by all the source nodes, instead of a BFS per source node.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4NixVectorRouting::m_sharedTrees),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_totalNeighbors (0),
+    m_sharedTrees (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -75,6 +91,7 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  FlushSharedNixTrees ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -90,6 +107,14 @@ Ipv4NixVectorRouting::SetNode (Ptr<Node> node)
 
 void
 Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FlushAllNodeCaches ();
+  FlushSharedNixTrees ();
+}
+
+void
+Ipv4NixVectorRouting::FlushAllNodeCaches (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   NodeList::Iterator listEnd = NodeList::End ();
@@ -498,11 +523,18 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
   CheckCacheStateAndFlush ();
 
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
-  // check if cache
-  nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
+  if (m_sharedTrees && !oif)
+    {
+      nixVectorInCache = GetSharedNixVector (header.GetDestination ());
+    }
+  else
+    {
+      // check if cache
+      nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
+    }
 
   // not in cache
-  if (!nixVectorInCache)
+  if (!nixVectorInCache && !(m_sharedTrees && !oif))
     {
       NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
       // Build the nix-vector, given this node and the
@@ -721,21 +753,33 @@ void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
   g_isCacheDirty = true;
+  g_isSharedTreeDirty = true;
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
   g_isCacheDirty = true;
+  // only the shared trees routing over this device are affected
+  if (m_node && m_ipv4)
+    {
+      g_nixDownDevices.push_back (std::make_pair (m_node->GetId (), m_ipv4->GetNetDevice (i)->GetIfIndex ()));
+    }
+  else
+    {
+      g_isSharedTreeDirty = true;
+    }
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   g_isCacheDirty = true;
+  g_isSharedTreeDirty = true;
 }
 void
 Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   g_isCacheDirty = true;
+  g_isSharedTreeDirty = true;
 }
 
 bool
@@ -750,8 +794,7 @@ Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source,
 
   // reset the parent vector
   parentVector.clear ();
-  parentVector.reserve (sizeof (Ptr<Node>)*numberOfNodes);
-  parentVector.insert (parentVector.begin (), sizeof (Ptr<Node>)*numberOfNodes, 0); // initialize to 0
+  parentVector.assign (numberOfNodes, 0); // initialize to 0
 
   // Add the source node to the queue, set its parent to itself 
   greyNodeList.push (source);
@@ -891,9 +934,274 @@ Ipv4NixVectorRouting::CheckCacheStateAndFlush (void) const
 {
   if (g_isCacheDirty)
     {
-      FlushGlobalNixRoutingCache ();
+      FlushAllNodeCaches ();
+      if (g_isSharedTreeDirty)
+        {
+          FlushSharedNixTrees ();
+        }
+      else
+        {
+          UpdateSharedNixTrees ();
+        }
       g_isCacheDirty = false;
     }
 }
 
+Ptr<NixVector>
+Ipv4NixVectorRouting::GetSharedNixVector (Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  if (g_nixLinks.empty ())
+    {
+      BuildSharedNixGraph ();
+    }
+
+  std::unordered_map<uint32_t, uint32_t>::const_iterator destIt = g_nixNodeByIp.find (dest.Get ());
+  if (destIt == g_nixNodeByIp.end ())
+    {
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+  uint32_t destNode = destIt->second;
+  uint32_t sourceNode = m_node->GetId ();
+
+  /// \internal
+  /// Do not process packets to self (see \bugid{1308})
+  if (sourceNode == destNode)
+    {
+      NS_LOG_DEBUG ("Do not processs packets to self");
+      return 0;
+    }
+
+  std::unordered_map<uint32_t, Ptr<NixVector> > &nixVectors = g_nixVectors[destNode];
+  std::unordered_map<uint32_t, Ptr<NixVector> >::const_iterator it = nixVectors.find (sourceNode);
+  if (it != nixVectors.end ())
+    {
+      NS_LOG_LOGIC ("Found shared Nix-vector.");
+      return it->second;
+    }
+
+  // walk the tree from this node to the dest node, the nix-vector
+  // is then built from the last hop, as it is read from the first one
+  const std::vector<uint32_t> &tree = GetSharedNixTree (destNode);
+  std::vector<uint32_t> path;
+  Ptr<NixVector> nixVector;
+  for (uint32_t node = sourceNode; node != destNode; node = g_nixLinks[node][tree[node]].m_node)
+    {
+      if (tree[node] == NO_NIX_INDEX)
+        {
+          NS_LOG_ERROR ("No routing path exists");
+          path.clear ();
+          break;
+        }
+      path.push_back (node);
+    }
+  if (!path.empty ())
+    {
+      nixVector = Create<NixVector> ();
+      for (std::vector<uint32_t>::const_reverse_iterator node = path.rbegin (); node != path.rend (); ++node)
+        {
+          uint32_t numberOfBits = nixVector->BitCount (g_nixLinks[*node].size ());
+          NS_LOG_LOGIC ("Adding Nix: " << tree[*node] << " with " << numberOfBits << " bits, for node " << *node);
+          nixVector->AddNeighborIndex (tree[*node], numberOfBits);
+        }
+    }
+  nixVectors[sourceNode] = nixVector;
+  return nixVector;
+}
+
+void
+Ipv4NixVectorRouting::BuildSharedNixGraph (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // the links of a node are enumerated in the neighbor index
+  // order of FindNetDeviceForNixIndex
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  g_nixLinks.assign (numberOfNodes, std::vector<NixLink> ());
+  g_nixNodeByIp.clear ();
+  for (uint32_t n = 0; n < numberOfNodes; n++)
+    {
+      Ptr<Node> node = NodeList::GetNode (n);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (ipv4)
+        {
+          for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+                {
+                  // the first node owning an address wins, as in GetNodeByIp
+                  g_nixNodeByIp.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal ().Get (), n));
+                }
+            }
+        }
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          bool usable = IsNetDeviceUsable (node, localNetDevice);
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              NixLink link;
+              link.m_node = (*iter)->GetNode ()->GetId ();
+              link.m_device = i;
+              link.m_usable = usable;
+              g_nixLinks[n].push_back (link);
+            }
+        }
+    }
+  BuildSharedNixInLinks ();
+}
+
+void
+Ipv4NixVectorRouting::BuildSharedNixInLinks (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_nixInLinks.assign (g_nixLinks.size (), std::vector<std::pair<uint32_t, uint32_t> > ());
+  for (uint32_t n = 0; n < g_nixLinks.size (); n++)
+    {
+      for (uint32_t index = 0; index < g_nixLinks[n].size (); index++)
+        {
+          const NixLink &link = g_nixLinks[n][index];
+          if (link.m_usable)
+            {
+              g_nixInLinks[link.m_node].push_back (std::make_pair (n, index));
+            }
+        }
+    }
+}
+
+const std::vector<uint32_t> &
+Ipv4NixVectorRouting::GetSharedNixTree (uint32_t destNode)
+{
+  NS_LOG_FUNCTION (this << destNode);
+
+  std::unordered_map<uint32_t, std::vector<uint32_t> >::const_iterator it = g_nixTrees.find (destNode);
+  if (it != g_nixTrees.end ())
+    {
+      return it->second;
+    }
+
+  // reverse BFS: a node is reached through one of its own links
+  // toward a node which is already in the tree
+  NS_LOG_LOGIC ("Building the shared tree of Node " << destNode);
+  std::vector<uint32_t> &tree = g_nixTrees[destNode];
+  tree.assign (g_nixLinks.size (), NO_NIX_INDEX);
+  std::vector<bool> visited (g_nixLinks.size (), false);
+  std::queue<uint32_t> greyNodeList;
+  greyNodeList.push (destNode);
+  visited[destNode] = true;
+  while (!greyNodeList.empty ())
+    {
+      uint32_t currNode = greyNodeList.front ();
+      greyNodeList.pop ();
+      const std::vector<std::pair<uint32_t, uint32_t> > &inLinks = g_nixInLinks[currNode];
+      for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator link = inLinks.begin (); link != inLinks.end (); ++link)
+        {
+          if (!visited[link->first])
+            {
+              visited[link->first] = true;
+              tree[link->first] = link->second;
+              greyNodeList.push (link->first);
+            }
+        }
+    }
+  return tree;
+}
+
+bool
+Ipv4NixVectorRouting::IsNetDeviceUsable (Ptr<Node> node, Ptr<NetDevice> netDevice)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4)
+    {
+      int32_t interfaceIndex = ipv4->GetInterfaceForDevice (netDevice);
+      if (interfaceIndex != -1 && !ipv4->IsUp (interfaceIndex))
+        {
+          return false;
+        }
+    }
+  return netDevice->IsLinkUp ();
+}
+
+void
+Ipv4NixVectorRouting::UpdateSharedNixTrees (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (g_nixLinks.empty ())
+    {
+      g_nixDownDevices.clear ();
+      return;
+    }
+
+  // links which are not usable anymore, as (node, neighbor index)
+  std::vector<std::pair<uint32_t, uint32_t> > downLinks;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = g_nixDownDevices.begin (); it != g_nixDownDevices.end (); ++it)
+    {
+      Ptr<Node> node = NodeList::GetNode (it->first);
+      bool usable = IsNetDeviceUsable (node, node->GetDevice (it->second));
+      std::vector<NixLink> &links = g_nixLinks[it->first];
+      for (uint32_t index = 0; index < links.size (); index++)
+        {
+          if (links[index].m_device == it->second && links[index].m_usable && !usable)
+            {
+              links[index].m_usable = false;
+              downLinks.push_back (std::make_pair (it->first, index));
+            }
+        }
+    }
+  g_nixDownDevices.clear ();
+  if (downLinks.empty ())
+    {
+      return;
+    }
+  BuildSharedNixInLinks ();
+
+  // the other trees are still shortest path trees
+  std::unordered_map<uint32_t, std::vector<uint32_t> >::iterator tree = g_nixTrees.begin ();
+  while (tree != g_nixTrees.end ())
+    {
+      bool routesOverDownLink = false;
+      for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator link = downLinks.begin (); link != downLinks.end (); ++link)
+        {
+          if (tree->second[link->first] == link->second)
+            {
+              routesOverDownLink = true;
+              break;
+            }
+        }
+      if (routesOverDownLink)
+        {
+          NS_LOG_LOGIC ("Erasing the shared tree of Node " << tree->first);
+          g_nixVectors.erase (tree->first);
+          tree = g_nixTrees.erase (tree);
+        }
+      else
+        {
+          ++tree;
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::FlushSharedNixTrees (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_nixLinks.clear ();
+  g_nixInLinks.clear ();
+  g_nixNodeByIp.clear ();
+  g_nixTrees.clear ();
+  g_nixVectors.clear ();
+  g_nixDownDevices.clear ();
+  g_isSharedTreeDirty = false;
+}
+
 } // namespace ns3
@@ -22,6 +22,8 @@
 #define IPV4_NIX_VECTOR_ROUTING_H
 
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -48,6 +50,15 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * By default, each node runs a BFS from itself to each destination it
+ * sends to, and caches the nix-vectors it built.  With the "SharedTrees"
+ * attribute set, the nix-vectors are instead derived from one shortest
+ * path tree per destination node, computed by a reverse BFS from the
+ * destination and shared by all the source nodes, and stored in a single
+ * table indexed by source and destination.  When an interface goes down,
+ * only the trees routing over it are recomputed.  Packets sent through a
+ * specific output device still use the per-source BFS.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
@@ -82,6 +93,9 @@ public:
 
 private:
 
+  /* flushes the nix-vector and Ipv4Route caches of all the nodes */
+  void FlushAllNodeCaches (void) const;
+
   /* flushes the cache which stores nix-vector based on
    * destination IP */
   void FlushNixCache (void) const;
@@ -103,6 +117,31 @@ private:
   /* checks the cache based on dest IP for the nix-vector */
   Ptr<NixVector> GetNixVectorInCache (Ipv4Address);
 
+  /* returns the nix-vector from this node to the dest IP, taken from
+   * the shared table or built from the shared tree of the dest node */
+  Ptr<NixVector> GetSharedNixVector (Ipv4Address);
+
+  /* builds the links between all the nodes and the map of the node
+   * IP addresses, shared by all the trees */
+  void BuildSharedNixGraph (void);
+
+  /* reverse BFS from the dest node, returns for each node the neighbor
+   * index of its next hop toward the dest node, NO_NIX_INDEX if none */
+  const std::vector<uint32_t> & GetSharedNixTree (uint32_t destNode);
+
+  /* determines if a node can send through one of its net-devices */
+  static bool IsNetDeviceUsable (Ptr<Node> node, Ptr<NetDevice> netDevice);
+
+  /* rebuilds the links toward each node from the links of each node */
+  static void BuildSharedNixInLinks (void);
+
+  /* updates the links of the net-devices which went down and erases
+   * the shared trees and nix-vectors routing over them */
+  static void UpdateSharedNixTrees (void);
+
+  /* flushes the shared links, trees and nix-vectors */
+  static void FlushSharedNixTrees (void);
+
   /* checks the cache based on dest IP for the Ipv4Route */
   Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address);
 
@@ -171,6 +210,41 @@ private:
    */
   static bool g_isCacheDirty;
 
+  /* 
+   * Flag to mark when the shared trees must all be recomputed, as opposed
+   * to the trees routing over the net-devices which went down.
+   */
+  static bool g_isSharedTreeDirty;
+
+  /* Neighbor index for "no next hop" in a shared tree */
+  static const uint32_t NO_NIX_INDEX = 0xffffffff;
+
+  /* A link from a node to a neighbor, for the shared trees */
+  struct NixLink
+  {
+    uint32_t m_node;   //!< Neighbor node
+    uint32_t m_device; //!< Net-device of the node toward the neighbor
+    bool m_usable;     //!< The node can send through the net-device
+  };
+
+  /* Links of each node, in neighbor index order */
+  static std::vector<std::vector<NixLink> > g_nixLinks;
+
+  /* Usable links toward each node, as (node, neighbor index) */
+  static std::vector<std::vector<std::pair<uint32_t, uint32_t> > > g_nixInLinks;
+
+  /* Node of each IP address */
+  static std::unordered_map<uint32_t, uint32_t> g_nixNodeByIp;
+
+  /* Shared trees, by dest node: neighbor index of the next hop of each node */
+  static std::unordered_map<uint32_t, std::vector<uint32_t> > g_nixTrees;
+
+  /* Shared nix-vectors, by dest node then source node */
+  static std::unordered_map<uint32_t, std::unordered_map<uint32_t, Ptr<NixVector> > > g_nixVectors;
+
+  /* Net-devices which went down since the shared trees were updated, as (node, device) */
+  static std::vector<std::pair<uint32_t, uint32_t> > g_nixDownDevices;
+
   /* Cache stores nix-vectors based on destination ip */
   mutable NixMap_t m_nixCache;
 
@@ -183,6 +257,9 @@ private:
   /* Total neighbors used for nix-vector to determine
    * number of bits */
   uint32_t m_totalNeighbors;
+
+  /* Use the shared per-destination trees */
+  bool m_sharedTrees;
 };
 } // namespace ns3
 
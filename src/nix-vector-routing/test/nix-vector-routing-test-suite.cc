@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/boolean.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing around a link going down, and back up
+ *
+ * Topology:
+ * \verbatim
+          +-- 2 --+
+    0 -- 1        4
+          +-- 3 --+
+   \endverbatim
+ *
+ * Node 0 sends to node 4, first over node 2.  The packets go over node 3
+ * while the link between 2 and 4 is down, and over node 2 again once it
+ * is back up and the link between 3 and 4 is down.  With shared trees,
+ * this checks that the trees routing over a device which went down are
+ * invalidated, and that all of them are rebuilt when it goes up.  With
+ * the route cache of Ipv4L3Protocol, this checks that the packets are
+ * still forwarded by their nix-vector: node 1 does not see the links go
+ * down, so a cached route would keep sending them over the same node.
+ */
+class NixVectorRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * \param sharedTrees whether the nix-vectors come from the shared trees
+   * \param routeCache whether the nodes cache their forwarding routes
+   */
+  NixVectorRoutingTestCase (bool sharedTrees, bool routeCache);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Count the UDP packets received by a socket
+   * \param socket the socket
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+  /**
+   * \brief Record the node in the middle of the path of a packet
+   * \param node the index of the node
+   * \param header the IPv4 header
+   * \param packet the packet
+   * \param interface the output interface
+   */
+  void Forward (uint32_t node, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+  /**
+   * \brief Send a packet from the source node
+   * \param destination the destination address
+   */
+  void SendPkt (Ipv4Address destination);
+
+  bool m_sharedTrees;             //!< Use the shared trees
+  bool m_routeCache;              //!< Cache the forwarding routes
+  Ptr<Socket> m_txSocket;         //!< Socket of the source node
+  uint32_t m_received;            //!< Packets received
+  std::vector<uint32_t> m_middle; //!< Node 2 or 3, for each packet forwarded by one of them
+};
+
+NixVectorRoutingTestCase::NixVectorRoutingTestCase (bool sharedTrees, bool routeCache)
+  : TestCase (std::string ("Nix-vector routing around a link failure") + (sharedTrees ? ", shared trees" : "") +
+              (routeCache ? ", route cache" : "")),
+    m_sharedTrees (sharedTrees),
+    m_routeCache (routeCache),
+    m_received (0)
+{
+}
+
+void
+NixVectorRoutingTestCase::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received++;
+    }
+}
+
+void
+NixVectorRoutingTestCase::Forward (uint32_t node, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  if (node == 2 || node == 3)
+    {
+      m_middle.push_back (node);
+    }
+}
+
+void
+NixVectorRoutingTestCase::SendPkt (Ipv4Address destination)
+{
+  m_txSocket->SendTo (Create<Packet> (100), 0, InetSocketAddress (destination, 1234));
+}
+
+void
+NixVectorRoutingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+
+  Ipv4NixVectorHelper nix;
+  nix.Set ("SharedTrees", BooleanValue (m_sharedTrees));
+  Ipv4ListRoutingHelper list;
+  list.Add (Ipv4StaticRoutingHelper (), 0);
+  list.Add (nix, 10);
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (list);
+  internet.Install (nodes);
+
+  // links 0-1, 1-2, 2-4, 1-3 and 3-4, each on its own channel
+  uint32_t links[5][2] = { { 0, 1 }, { 1, 2 }, { 2, 4 }, { 1, 3 }, { 3, 4 } };
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper addresses ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces[5];
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NetDeviceContainer devices = simple.Install (NodeContainer (nodes.Get (links[i][0]), nodes.Get (links[i][1])));
+      interfaces[i] = addresses.Assign (devices);
+      addresses.NewNetwork ();
+    }
+  // the address of node 4 on the link to node 3
+  Ipv4Address destination = interfaces[4].GetAddress (1);
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->SetAttribute ("RouteCache", BooleanValue (m_routeCache));
+      nodes.Get (i)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+        "UnicastForward", MakeCallback (&NixVectorRoutingTestCase::Forward, this).Bind (i));
+    }
+  Ptr<Socket> rxSocket = nodes.Get (4)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&NixVectorRoutingTestCase::ReceivePkt, this));
+  m_txSocket = nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+
+  // the interfaces of nodes 2 and 3 toward node 4
+  Ptr<Ipv4> ipv4Node2 = nodes.Get (2)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Node3 = nodes.Get (3)->GetObject<Ipv4> ();
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingTestCase::SendPkt, this, destination);
+  Simulator::Schedule (Seconds (2), &Ipv4::SetDown, ipv4Node2, 2);
+  Simulator::Schedule (Seconds (3), &NixVectorRoutingTestCase::SendPkt, this, destination);
+  Simulator::Schedule (Seconds (4), &Ipv4::SetUp, ipv4Node2, 2);
+  Simulator::Schedule (Seconds (4), &Ipv4::SetDown, ipv4Node3, 2);
+  Simulator::Schedule (Seconds (5), &NixVectorRoutingTestCase::SendPkt, this, destination);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "all the packets should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_middle.size (), 3, "each packet is forwarded by node 2 or node 3");
+  NS_TEST_EXPECT_MSG_EQ (m_middle[0], 2, "the first packet goes over node 2");
+  NS_TEST_EXPECT_MSG_EQ (m_middle[1], 3, "the packet sent while the link 2-4 is down goes over node 3");
+  NS_TEST_EXPECT_MSG_EQ (m_middle[2], 2, "the packet sent while the link 3-4 is down goes over node 2");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing
+ * \ingroup tests
+ *
+ * \brief Ipv4NixVectorRouting TestSuite
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite () : TestSuite ("nix-vector-routing", UNIT)
+  {
+    AddTestCase (new NixVectorRoutingTestCase (false, false), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingTestCase (true, false), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingTestCase (false, true), TestCase::QUICK);
+    AddTestCase (new NixVectorRoutingTestCase (true, true), TestCase::QUICK);
+  }
+};
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite;
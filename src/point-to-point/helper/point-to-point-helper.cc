@@ -39,6 +39,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("PointToPointHelper");
 
 PointToPointHelper::PointToPointHelper ()
+  : m_asciiPrintingPerNode (false)
 {
   m_queueFactory.SetTypeId ("ns3::DropTailQueue");
   m_deviceFactory.SetTypeId ("ns3::PointToPointNetDevice");
@@ -79,6 +80,12 @@ PointToPointHelper::SetChannelAttribute (std::string n1, const AttributeValue &v
   m_remoteChannelFactory.Set (n1, v1);
 }
 
+void
+PointToPointHelper::SetAsciiPrintingPerNode (bool perNode)
+{
+  m_asciiPrintingPerNode = perNode;
+}
+
 void 
 PointToPointHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -133,9 +140,18 @@ PointToPointHelper::EnableAsciiInternal (
 
   //
   // Our default trace sinks are going to use packet printing, so we have to 
-  // make sure that is turned on.
+  // make sure that is turned on.  With per-node printing, it is turned on
+  // for the packets created on this node only, and the packets coming from
+  // other nodes are decoded when printed.
   //
-  Packet::EnablePrinting ();
+  if (m_asciiPrintingPerNode)
+    {
+      Packet::EnablePrintingForNode (device->GetNode ()->GetId ());
+    }
+  else
+    {
+      Packet::EnablePrinting ();
+    }
 
   //
   // If we are not provided an OutputStreamWrapper, we are expected to create 
@@ -112,6 +112,22 @@ public:
    */
   void SetChannelAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \brief Print in the ascii traces only the packets of the traced nodes
+   * with their recorded metadata.
+   *
+   * By default, enabling an ascii trace enables the printing of all the
+   * packets with Packet::EnablePrinting.  With per-node printing, it is
+   * only enabled for the packets created on the node of the traced
+   * device, with Packet::EnablePrintingForNode: the other packets, such
+   * as the forwarded ones, record no metadata and are decoded from their
+   * bytes when printed, without their trailers and fragmentation
+   * information.
+   *
+   * \param perNode true to enable the printing per node
+   */
+  void SetAsciiPrintingPerNode (bool perNode);
+
   /**
    * \param c a set of nodes
    * \return a NetDeviceContainer for nodes
@@ -198,6 +214,7 @@ private:
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_remoteChannelFactory; //!< Remote Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
+  bool m_asciiPrintingPerNode;          //!< Enable the packet printing per node for the ascii traces
 };
 
 } // namespace ns3
@@ -106,6 +106,38 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitTrain (
+  const PointToPointNetDevice::PacketTrain &train,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << train.size () << src);
+  NS_ASSERT (!train.empty ());
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+
+  Time now = Simulator::Now ();
+  PointToPointNetDevice::PacketTrain arrivals;
+  arrivals.reserve (train.size ());
+  for (PointToPointNetDevice::PacketTrain::const_iterator i = train.begin (); i != train.end (); ++i)
+    {
+      NS_LOG_LOGIC ("UID is " << i->first->GetUid () << ")");
+      arrivals.push_back (std::make_pair (i->first, i->second + m_delay));
+      // Call the tx anim callback on the net device
+      m_txrxPointToPoint (i->first, src, m_link[wire].m_dst,
+                          i->second - now, i->second - now + m_delay);
+    }
+
+  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                  arrivals.front ().second - now,
+                                  &PointToPointNetDevice::ReceiveTrain,
+                                  m_link[wire].m_dst, arrivals);
+  return true;
+}
+
 uint32_t 
 PointToPointChannel::GetNDevices (void) const
 {
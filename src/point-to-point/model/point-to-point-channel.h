@@ -25,6 +25,7 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "point-to-point-net-device.h"
 
 namespace ns3 {
 
@@ -80,6 +81,20 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a train of back-to-back packets over this channel
+   *
+   * The whole train is handed to the destination device in a single
+   * event, at the arrival time of its first packet.
+   *
+   * \param train Packets to transmit, each with the time at which its
+   *        transmission by the source device completes
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrain (const PointToPointNetDevice::PacketTrain &train,
+                              Ptr<PointToPointNetDevice> src);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -67,6 +67,16 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxTrainLength",
+                   "The maximum number of packets waiting in the transmit "
+                   "queue which are sent back-to-back as a single train.  "
+                   "The packets of a train leave the queue when the train "
+                   "starts, so the queue may accept up to MaxTrainLength - 1 "
+                   "more packets than without trains.  "
+                   "A value of one disables packet trains.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxTrainLength),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -177,7 +187,8 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_maxTrainLength (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -193,7 +204,7 @@ PointToPointNetDevice::AddHeader (Ptr<Packet> p, uint16_t protocolNumber)
   NS_LOG_FUNCTION (this << p << protocolNumber);
   PppHeader ppp;
   ppp.SetProtocol (EtherToPpp (protocolNumber));
-  p->AddHeader (ppp);
+  p->AddHeaders (ppp);
 }
 
 bool
@@ -201,7 +212,7 @@ PointToPointNetDevice::ProcessHeader (Ptr<Packet> p, uint16_t& param)
 {
   NS_LOG_FUNCTION (this << p << param);
   PppHeader ppp;
-  p->RemoveHeader (ppp);
+  p->RemoveHeaders (ppp);
   param = PppToEther (ppp.GetProtocol ());
   return true;
 }
@@ -214,6 +225,9 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_currentTrain.clear ();
+  m_rxTrain.clear ();
+  m_rxTrainEvent.Cancel ();
   NetDevice::DoDispose ();
 }
 
@@ -243,6 +257,10 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   // schedule an event that will be executed when the transmission is complete.
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  if (m_maxTrainLength > 1 && !m_queue->IsEmpty ())
+    {
+      return TransmitTrainStart (p);
+    }
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
@@ -261,6 +279,57 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitTrainStart (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  //
+  // Take the packets waiting in the queue, up to the maximum length of a
+  // train, and compute the time at which each of them will have been
+  // completely transmitted if sent back-to-back.  The channel is told
+  // about the whole train at once, and a single event is scheduled for
+  // the end of the train.
+  //
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  NS_ASSERT_MSG (m_currentTrain.empty (), "Previous train not completed");
+  m_txMachineState = BUSY;
+
+  std::vector<Ptr<Packet> > packets;
+  packets.push_back (p);
+  m_queue->DequeueBurst (m_maxTrainLength - 1, packets);
+
+  Time now = Simulator::Now ();
+  Time offset = Seconds (0);
+  for (std::vector<Ptr<Packet> >::const_iterator i = packets.begin (); i != packets.end (); ++i)
+    {
+      NS_LOG_LOGIC ("UID is " << (*i)->GetUid () << ")");
+      if (i != packets.begin ())
+        {
+          m_snifferTrace (*i);
+          m_promiscSnifferTrace (*i);
+        }
+      m_phyTxBeginTrace (*i);
+      offset += m_bps.CalculateBytesTxTime ((*i)->GetSize ());
+      m_currentTrain.push_back (std::make_pair (*i, now + offset));
+      offset += m_tInterframeGap;
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent for a train of " <<
+                m_currentTrain.size () << " packets in " << offset.GetSeconds () << "sec");
+  Simulator::Schedule (offset, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitTrain (m_currentTrain, this);
+  if (result == false)
+    {
+      for (PacketTrain::const_iterator i = m_currentTrain.begin (); i != m_currentTrain.end (); ++i)
+        {
+          m_phyTxDropTrace (i->first);
+        }
+    }
+  return result;
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -275,10 +344,21 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
   m_txMachineState = READY;
 
-  NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
+  if (!m_currentTrain.empty ())
+    {
+      for (PacketTrain::const_iterator i = m_currentTrain.begin (); i != m_currentTrain.end (); ++i)
+        {
+          m_phyTxEndTrace (i->first);
+        }
+      m_currentTrain.clear ();
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
-  m_currentPkt = 0;
+      m_phyTxEndTrace (m_currentPkt);
+      m_currentPkt = 0;
+    }
 
   Ptr<Packet> p = m_queue->Dequeue ();
   if (p == 0)
@@ -379,6 +459,41 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
     }
 }
 
+void
+PointToPointNetDevice::ReceiveTrain (PacketTrain train)
+{
+  NS_LOG_FUNCTION (this << train.size ());
+  m_rxTrain.insert (m_rxTrain.end (), train.begin (), train.end ());
+  if (!m_rxTrainEvent.IsRunning ())
+    {
+      DeliverTrain ();
+    }
+}
+
+void
+PointToPointNetDevice::DeliverTrain (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  //
+  // Forward up the stack, in order, all the packets whose last bit has
+  // arrived by now; the first packet still in flight, if any, will be
+  // forwarded by another call at its arrival time.
+  //
+  Time now = Simulator::Now ();
+  while (!m_rxTrain.empty () && m_rxTrain.front ().second <= now)
+    {
+      Ptr<Packet> packet = m_rxTrain.front ().first;
+      m_rxTrain.pop_front ();
+      Receive (packet);
+    }
+  if (!m_rxTrain.empty ())
+    {
+      m_rxTrainEvent = Simulator::Schedule (m_rxTrain.front ().second - now,
+                                            &PointToPointNetDevice::DeliverTrain, this);
+    }
+}
+
 Ptr<Queue>
 PointToPointNetDevice::GetQueue (void) const
 { 
@@ -20,6 +20,8 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
+#include <deque>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -30,6 +32,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
 
 namespace ns3 {
 
@@ -58,10 +61,39 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * When the MaxTrainLength attribute is larger than one, packets found
+ * waiting in the transmit queue when the transmitter becomes ready are
+ * sent back-to-back as a single train: the device schedules one event
+ * for the end of the whole train instead of one per packet, and the
+ * channel hands the train to the peer device in one event.  Packets
+ * are still received at their exact arrival times: the receiving device
+ * forwards them up the stack with one event per arrival time, so only
+ * the events of the transmitting side are saved.  All the trace sources
+ * still fire once per packet; however the transmit side trace sources
+ * (Sniffer, PromiscSniffer, the queue Dequeue and PhyTxBegin when the
+ * train starts, PhyTxEnd when it ends) fire at the start and at the end
+ * of the train rather than of each packet.
+ *
+ * The packets of a train are all dequeued when the train starts, so
+ * until their own transmission would have started they no longer take
+ * room in the transmit queue.  The queue may thus accept up to
+ * MaxTrainLength - 1 more packets than without trains: fewer packets
+ * are dropped by a full queue, and the packets accepted instead wait
+ * longer.  Keep MaxTrainLength small compared to the queue limit where
+ * the queue losses matter.
  */
 class PointToPointNetDevice : public NetDevice
 {
 public:
+  /**
+   * A train of packets sent back-to-back over the channel.  Each packet
+   * is paired with the absolute time at which its last bit leaves the
+   * sending device or, once handed to the receiving device, at which
+   * its last bit arrives there.
+   */
+  typedef std::vector<std::pair<Ptr<Packet>, Time> > PacketTrain;
+
   /**
    * \brief Get the TypeId
    *
@@ -149,6 +181,18 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a train of packets from a connected PointToPointChannel.
+   *
+   * The channel calls this method once per train, when the last bit of
+   * the first packet of the train has arrived.  Each packet of the train
+   * is then forwarded up the protocol stack, as by Receive, at its own
+   * arrival time.
+   *
+   * \param train The packets of the train, with their arrival times.
+   */
+  void ReceiveTrain (PacketTrain train);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -272,14 +316,35 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start Sending a Train of Packets Down the Wire.
+   *
+   * Used by TransmitStart when packet trains are enabled and more
+   * packets are waiting in the transmit queue: up to MaxTrainLength
+   * packets, starting with \p p, are taken from the queue and handed
+   * to the channel at once, and a single event is scheduled for the
+   * time at which the last of them has been completely transmitted.
+   *
+   * \see PointToPointChannel::TransmitTrain ()
+   * \param p the first packet of the train
+   * \returns true if success, false on failure
+   */
+  bool TransmitTrainStart (Ptr<Packet> p);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
    * The TransmitComplete method is used internally to finish the process
-   * of sending a packet out on the channel.
+   * of sending a packet, or a train of packets, out on the channel.
    */
   void TransmitComplete (void);
 
+  /**
+   * Forward up the stack the packets of the received trains whose last
+   * bit has arrived, and schedule the next delivery if packets remain.
+   */
+  void DeliverTrain (void);
+
   /**
    * \brief Make the link up and running
    *
@@ -462,6 +527,23 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  /**
+   * \brief The maximum number of packets sent as a single train
+   *
+   * A value of one disables packet trains: each packet is then
+   * transmitted and received with its own events.
+   */
+  uint32_t m_maxTrainLength;
+
+  PacketTrain m_currentTrain; //!< Current train of packets processed
+
+  /**
+   * Packets of the received trains not yet forwarded up the stack, in
+   * order of arrival.
+   */
+  std::deque<std::pair<Ptr<Packet>, Time> > m_rxTrain;
+  EventId m_rxTrainEvent; //!< Next delivery of a packet of m_rxTrain
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
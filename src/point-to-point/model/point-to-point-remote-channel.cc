@@ -76,4 +76,30 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitTrain (
+  const PointToPointNetDevice::PacketTrain &train,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << train.size () << src);
+
+  IsInitialized ();
+
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+#ifdef NS3_MPI
+  for (PointToPointNetDevice::PacketTrain::const_iterator i = train.begin (); i != train.end (); ++i)
+    {
+      NS_LOG_LOGIC ("UID is " << i->first->GetUid () << ")");
+      // The rxTime of each packet (absolute)
+      Time rxTime = i->second + GetDelay ();
+      MpiInterface::SendPacket (i->first, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+  return true;
+}
+
 } // namespace ns3
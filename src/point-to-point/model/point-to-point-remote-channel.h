@@ -68,6 +68,20 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a train of packets
+   *
+   * Each packet of the train is sent with its own arrival time, so that
+   * the remote device receives it exactly as if sent by TransmitStart.
+   *
+   * \param train Packets to transmit, each with the time at which its
+   *        transmission by the source device completes
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrain (const PointToPointNetDevice::PacketTrain &train,
+                              Ptr<PointToPointNetDevice> src);
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/header.h"
 #include "ppp-header.h"
+#include "ns3/packet-dissector.h"
 
 namespace ns3 {
 
@@ -29,6 +30,37 @@ NS_LOG_COMPONENT_DEFINE ("PppHeader");
 
 NS_OBJECT_ENSURE_REGISTERED (PppHeader);
 
+namespace {
+
+/**
+ * \brief Read the protocol number of a PPP header.
+ * \param header the PppHeader
+ * \param protocol the protocol number
+ * \returns true if the header following it is identified by \p protocol
+ */
+bool
+GetProtocol (const Header &header, uint32_t &protocol)
+{
+  PppHeader ppp = static_cast<const PppHeader &> (header);
+  protocol = ppp.GetProtocol ();
+  return true;
+}
+
+/**
+ * Registers the protocol numbers of PppHeader with the PacketDissector.
+ */
+struct PppHeaderDissection
+{
+  PppHeaderDissection ()
+  {
+    PacketDissector::RegisterHeader ("ns3::PppHeader", &GetProtocol);
+    PacketDissector::RegisterProtocol ("ns3::PppHeader", 0x0021, "ns3::Ipv4Header");
+    PacketDissector::RegisterProtocol ("ns3::PppHeader", 0x0057, "ns3::Ipv6Header");
+  }
+} g_pppHeaderDissection; //!< Registers the protocol numbers at load time.
+
+} // anonymous namespace
+
 PppHeader::PppHeader ()
 {
 }
@@ -79,7 +111,7 @@ PppHeader::Print (std::ostream &os) const
 uint32_t
 PppHeader::GetSerializedSize (void) const
 {
-  return 2;
+  return SERIALIZED_SIZE;
 }
 
 void
@@ -79,6 +79,11 @@ public:
   virtual uint32_t Deserialize (Buffer::Iterator start);
   virtual uint32_t GetSerializedSize (void) const;
 
+  /**
+   * \brief Size of the serialized header, for Packet::AddHeaders.
+   */
+  static const uint32_t SERIALIZED_SIZE = 2;
+
   /**
    * \brief Set the protocol type carried by this PPP packet
    *
@@ -23,6 +23,10 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -93,6 +97,317 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for the packet trains of the PointToPoint model
+ *
+ * It sends a burst of packets from one NetDevice to another, with and
+ * without packet trains, and checks that the packets are received at
+ * the same, exact, times and that the trace sources fire per packet.
+ */
+class PointToPointTrainTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointTrainTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets with one device to its peer
+   *
+   * \param maxTrainLength the MaxTrainLength attribute of the devices
+   * \returns the times at which the packets are received
+   */
+  std::vector<Time> RunBurst (uint32_t maxTrainLength);
+
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from);
+
+  /**
+   * \brief Count the packets completely transmitted
+   *
+   * \param p the packet
+   */
+  void PhyTxEnd (Ptr<const Packet> p);
+
+  std::vector<Time> m_rxTimes; //!< Reception times of the current run
+  uint32_t m_txEnd;            //!< PhyTxEnd trace count of the current run
+};
+
+/// Number of packets of a burst
+static const uint32_t BURST_SIZE = 6;
+/// Size of the packets of a burst
+static const uint32_t PACKET_SIZE = 998;
+
+PointToPointTrainTest::PointToPointTrainTest ()
+  : TestCase ("PointToPoint packet trains"),
+    m_txEnd (0)
+{
+}
+
+void
+PointToPointTrainTest::SendBurst (Ptr<PointToPointNetDevice> device)
+{
+  for (uint32_t i = 0; i < BURST_SIZE; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (PACKET_SIZE);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointTrainTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointTrainTest::PhyTxEnd (Ptr<const Packet> p)
+{
+  m_txEnd++;
+}
+
+std::vector<Time>
+PointToPointTrainTest::RunBurst (uint32_t maxTrainLength)
+{
+  m_rxTimes.clear ();
+  m_txEnd = 0;
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetInterframeGap (MicroSeconds (10));
+  devA->SetAttribute ("MaxTrainLength", UintegerValue (maxTrainLength));
+  devA->TraceConnectWithoutContext ("PhyTxEnd", MakeCallback (&PointToPointTrainTest::PhyTxEnd, this));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+  devB->SetAttribute ("MaxTrainLength", UintegerValue (maxTrainLength));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointTrainTest::Receive, this));
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointTrainTest::SendBurst, this, devA);
+
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+  return m_rxTimes;
+}
+
+void
+PointToPointTrainTest::DoRun (void)
+{
+  std::vector<Time> single = RunBurst (1);
+  NS_TEST_ASSERT_MSG_EQ (single.size (), BURST_SIZE, "Packets lost without trains");
+  NS_TEST_ASSERT_MSG_EQ (m_txEnd, BURST_SIZE, "PhyTxEnd not fired per packet without trains");
+
+  // 1000 bytes with the PPP header at 8Mbps, then the interframe gap.
+  for (uint32_t i = 0; i < BURST_SIZE; i++)
+    {
+      Time expected = Seconds (1.0) + MicroSeconds (1000 * (i + 1) + 10 * i) + MilliSeconds (2);
+      NS_TEST_ASSERT_MSG_EQ (single[i], expected, "Unexpected arrival time without trains");
+    }
+
+  // The first packet is sent alone, the other ones as trains.
+  uint32_t lengths[] = { 2, 3, 8 };
+  for (uint32_t j = 0; j < sizeof (lengths) / sizeof (lengths[0]); j++)
+    {
+      std::vector<Time> train = RunBurst (lengths[j]);
+      NS_TEST_ASSERT_MSG_EQ (train.size (), BURST_SIZE, "Packets lost with trains of " << lengths[j]);
+      NS_TEST_ASSERT_MSG_EQ (m_txEnd, BURST_SIZE, "PhyTxEnd not fired per packet with trains of " << lengths[j]);
+      for (uint32_t i = 0; i < BURST_SIZE; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (train[i], single[i], "Arrival time changed by trains of " << lengths[j]);
+        }
+    }
+}
+
+/**
+ * \brief Test class for the packet trains of the PointToPoint model
+ * with an overflowing transmit queue
+ *
+ * It sends packets at twice the rate of the link into a small drop-tail
+ * queue, with and without packet trains, and checks that trains of
+ * length n make the queue drop at most n - 1 fewer packets.
+ */
+class PointToPointTrainOverflowTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointTrainOverflowTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets faster than the link rate
+   *
+   * \param maxTrainLength the MaxTrainLength attribute of the devices
+   */
+  void RunOverflow (uint32_t maxTrainLength);
+
+  /**
+   * \brief Send a packet to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendPacket (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param device the receiving device
+   * \param p the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from);
+
+  /**
+   * \brief Count the packets dropped by the transmit queue
+   *
+   * \param p the packet
+   */
+  void Drop (Ptr<const Packet> p);
+
+  uint32_t m_received; //!< Packets received in the current run
+  uint32_t m_dropped;  //!< Packets dropped in the current run
+};
+
+/// Number of packets sent by an overflow run
+static const uint32_t OVERFLOW_PACKETS = 200;
+/// Transmit queue limit of an overflow run
+static const uint32_t OVERFLOW_QUEUE = 5;
+
+PointToPointTrainOverflowTest::PointToPointTrainOverflowTest ()
+  : TestCase ("PointToPoint packet trains with an overflowing queue"),
+    m_received (0),
+    m_dropped (0)
+{
+}
+
+void
+PointToPointTrainOverflowTest::SendPacket (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (PACKET_SIZE);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointTrainOverflowTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                        uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+PointToPointTrainOverflowTest::Drop (Ptr<const Packet> p)
+{
+  m_dropped++;
+}
+
+void
+PointToPointTrainOverflowTest::RunOverflow (uint32_t maxTrainLength)
+{
+  m_received = 0;
+  m_dropped = 0;
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (OVERFLOW_QUEUE));
+  queue->TraceConnectWithoutContext ("Drop", MakeCallback (&PointToPointTrainOverflowTest::Drop, this));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (queue);
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetAttribute ("MaxTrainLength", UintegerValue (maxTrainLength));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointTrainOverflowTest::Receive, this));
+
+  // A packet takes 1 ms on the link: send one every 450 us.
+  for (uint32_t i = 0; i < OVERFLOW_PACKETS; i++)
+    {
+      Simulator::Schedule (Seconds (1.0) + MicroSeconds (450 * i),
+                           &PointToPointTrainOverflowTest::SendPacket, this, devA);
+    }
+
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+}
+
+void
+PointToPointTrainOverflowTest::DoRun (void)
+{
+  RunOverflow (1);
+  uint32_t dropped = m_dropped;
+  NS_TEST_ASSERT_MSG_GT (dropped, 0, "The queue should overflow without trains");
+  NS_TEST_ASSERT_MSG_EQ (m_received + m_dropped, OVERFLOW_PACKETS, "Packets lost without trains");
+
+  uint32_t lengths[] = { 2, 4, 8 };
+  for (uint32_t j = 0; j < sizeof (lengths) / sizeof (lengths[0]); j++)
+    {
+      RunOverflow (lengths[j]);
+      NS_TEST_EXPECT_MSG_EQ (m_received + m_dropped, OVERFLOW_PACKETS, "Packets lost with trains of " << lengths[j]);
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (m_dropped, dropped, "More drops with trains of " << lengths[j]);
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (m_dropped + lengths[j] - 1, dropped,
+                                   "Too few drops with trains of " << lengths[j]);
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -109,6 +424,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointTrainTest, TestCase::QUICK);
+  AddTestCase (new PointToPointTrainOverflowTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
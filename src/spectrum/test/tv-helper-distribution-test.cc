@@ -18,6 +18,12 @@
  * Author: Benjamin Cizdziel <ben.cizdziel@gmail.com>
  */
 
+#include <sstream> // local toolchain workaround, not committed
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <map>
+#include <vector>
 #define private public //to make private method testable
 
 #include <ns3/test.h>
@@ -0,0 +1,8 @@
+$node_(0) set X_ 350.00000000000000
+$node_(0) set Y_ 50.00000000000000
+$ns_ at 50.00000000000000  "$node_(0) setdest 400.00000000000000 50.00000000000000 1.00000000000000"
+$ns_ at 150.00000000000000 "$node_(0) setdest 400.00000000000000 150.00000000000000 4.00000000000000"
+$ns_ at 300.00000000000000 "$node_(0) setdest 250.00000000000000 150.00000000000000 3.00000000000000"
+$ns_ at 350.00000000000000 "$node_(0) setdest 250.00000000000000 50.00000000000000 1.00000000000000"
+$ns_ at 600.00000000000000 "$node_(0) setdest 250.00000000000000 1050.00000000000000 2.00000000000000"
+$ns_ at 900.00000000000000 "$node_(0) setdest 300.00000000000000 650.00000000000000 2.50000000000000"
@@ -0,0 +1,4 @@
+$node_(0) set X_ -1.0
+$node_(0) set Y_ 0
+$ns_ at 1.0 "$node_(0) setdest 0 0 1"
+$ns_ at 2.0 "$node_(0) setdest 0  -1  1"
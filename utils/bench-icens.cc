@@ -0,0 +1,557 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the iCenS PMU to PDC path: iCenSSubscriber, UDP, IPv4,
+ * PPP, the device queue and the point-to-point channel, and the
+ * acknowledgements of the iCenSProducer on the way back.
+ *
+ * The PMUs are attached to the routers of a star, grid or case39-like
+ * (the 46 branches of the IEEE 39-bus system) topology and send their
+ * measurements to a PDC and, optionally, to a WAC.  The simulation runs
+ * for a fixed simulated duration and the results are written as JSON,
+ * so that the runs of two commits can be compared:
+ *
+ *   ./waf --run "bench-icens --topology=grid --size=5 --json=grid.json"
+ *
+ * The time per layer comes from the event profiler of the default
+ * simulator implementation: an event is charged to the layer of its
+ * type until the packet it carries crosses into another layer, as seen
+ * by the traces of the device, IPv4 and the applications, and from
+ * there on to that layer.  The profile itself is only written to files
+ * when --profile gives their prefix.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/packet-allocator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-profiler.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <sys/resource.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/*
+ * Count the heap allocations of the whole program, the ns-3 libraries
+ * included.
+ */
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size != 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/** The branches of the IEEE 39-bus system, buses numbered from 1. */
+static const uint32_t g_case39Branches[][2] = {
+  { 1, 2 }, { 1, 39 }, { 2, 3 }, { 2, 25 }, { 2, 30 }, { 3, 4 }, { 3, 18 },
+  { 4, 5 }, { 4, 14 }, { 5, 6 }, { 5, 8 }, { 6, 7 }, { 6, 11 }, { 6, 31 },
+  { 7, 8 }, { 8, 9 }, { 9, 39 }, { 10, 11 }, { 10, 13 }, { 10, 32 },
+  { 12, 11 }, { 12, 13 }, { 13, 14 }, { 14, 15 }, { 15, 16 }, { 16, 17 },
+  { 16, 19 }, { 16, 21 }, { 16, 24 }, { 17, 18 }, { 17, 27 }, { 19, 20 },
+  { 19, 33 }, { 20, 34 }, { 21, 22 }, { 22, 23 }, { 22, 35 }, { 23, 24 },
+  { 23, 36 }, { 25, 26 }, { 25, 37 }, { 26, 27 }, { 26, 28 }, { 26, 29 },
+  { 28, 29 }, { 29, 38 }
+};
+
+/** The counters of the traces. */
+struct Counters
+{
+  uint64_t sent;        //!< Packets sent by the PMUs
+  uint64_t received;    //!< Packets received by the PDC and the WAC
+  uint64_t acks;        //!< Acknowledgements received by the PMUs
+  uint64_t hops;        //!< Packets transmitted on a link
+};
+
+static Counters g_counters;
+
+/** The layers the time of the events is split between. */
+enum Layer
+{
+  APPLICATION,
+  INTERNET,
+  DEVICE,
+  N_LAYERS
+};
+
+static const char *g_layerNames[N_LAYERS] = { "application", "internet", "device" };
+
+/** The profiler of the simulation, 0 if profiling is disabled. */
+static EventProfiler *g_profiler = 0;
+/** The profiler scopes of the layers. */
+static uint32_t g_layerScopes[N_LAYERS];
+
+/**
+ * Charge the rest of the running event to a layer.
+ *
+ * \param layer the layer the packet of the event enters
+ */
+static void
+EnterLayer (Layer layer)
+{
+  if (g_profiler != 0)
+    {
+      g_profiler->EnterScope (g_layerScopes[layer]);
+    }
+}
+
+static void
+PmuSent (uint32_t, Ptr<Packet>, const Address &, uint32_t)
+{
+  g_counters.sent++;
+}
+
+static void
+CollectorReceived (uint32_t, Ptr<Packet>, const Address &, uint32_t, uint32_t, uint32_t, Ipv4Address)
+{
+  g_counters.received++;
+  EnterLayer (APPLICATION);
+}
+
+static void
+PmuReceived (uint32_t, Ptr<Packet>, const Address &)
+{
+  g_counters.acks++;
+  EnterLayer (APPLICATION);
+}
+
+static void
+DeviceReceived (Ptr<const Packet>)
+{
+  EnterLayer (INTERNET);
+}
+
+static void
+InternetSent (const Ipv4Header &, Ptr<const Packet>, uint32_t)
+{
+  EnterLayer (INTERNET);
+}
+
+static void
+DeviceSent (Ptr<const Packet>)
+{
+  EnterLayer (DEVICE);
+}
+
+static void
+LinkTransmitted (Ptr<const Packet>)
+{
+  g_counters.hops++;
+}
+
+/** The parameters of a run. */
+struct Scenario
+{
+  std::string topology;   //!< star, grid or case39
+  uint32_t size;          //!< Leaves of the star, side of the grid
+  double duration;        //!< Simulated duration, in seconds
+  double interval;        //!< Interval between the measurements of a PMU, in seconds
+  uint32_t packetSize;    //!< Size of the measurements, in bytes
+  bool wac;               //!< Whether the PMUs also report to a WAC
+  std::string dataRate;   //!< Data rate of the links
+  std::string delay;      //!< Delay of the links
+  std::string queue;      //!< Queue of the devices
+  std::string routing;    //!< global, or flowpath for the PMU flows
+};
+
+/**
+ * Build the topology, install the applications and connect the traces.
+ *
+ * \param scenario the parameters
+ * \returns the number of nodes
+ */
+static uint32_t
+Build (const Scenario &scenario)
+{
+  // The routers, and the links between them.
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  uint32_t nRouters = 0;
+  uint32_t pdcRouter = 0;
+  uint32_t wacRouter = 0;
+  if (scenario.topology == "star")
+    {
+      nRouters = 1;
+    }
+  else if (scenario.topology == "grid")
+    {
+      nRouters = scenario.size * scenario.size;
+      for (uint32_t i = 0; i < nRouters; i++)
+        {
+          if ((i + 1) % scenario.size != 0)
+            {
+              links.push_back (std::make_pair (i, i + 1));
+            }
+          if (i + scenario.size < nRouters)
+            {
+              links.push_back (std::make_pair (i, i + scenario.size));
+            }
+        }
+      wacRouter = nRouters - 1;
+    }
+  else if (scenario.topology == "case39")
+    {
+      nRouters = 39;
+      for (uint32_t i = 0; i < sizeof (g_case39Branches) / sizeof (g_case39Branches[0]); i++)
+        {
+          links.push_back (std::make_pair (g_case39Branches[i][0] - 1, g_case39Branches[i][1] - 1));
+        }
+      pdcRouter = 15;
+      wacRouter = 1;
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown topology " << scenario.topology);
+    }
+  // One PMU per router, or the leaves of the star.
+  uint32_t nPmus = scenario.topology == "star" ? scenario.size : nRouters;
+
+  NodeContainer routers;
+  routers.Create (nRouters);
+  NodeContainer pmus;
+  pmus.Create (nPmus);
+  NodeContainer collectors;
+  collectors.Create (2);
+  // The PMU flows are known in advance, they can be routed on
+  // precomputed paths, and the acknowledgements by global routing.
+  Ipv4FlowPathRoutingHelper flowPaths;
+  InternetStackHelper stack;
+  if (scenario.routing == "flowpath")
+    {
+      Ipv4ListRoutingHelper list;
+      list.Add (Ipv4StaticRoutingHelper (), 0);
+      list.Add (flowPaths, 10);
+      list.Add (Ipv4GlobalRoutingHelper (), -10);
+      stack.SetRoutingHelper (list);
+    }
+  else if (scenario.routing != "global")
+    {
+      NS_FATAL_ERROR ("Unknown routing " << scenario.routing);
+    }
+  stack.Install (routers);
+  stack.Install (pmus);
+  stack.Install (collectors);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue (scenario.dataRate));
+  p2p.SetChannelAttribute ("Delay", StringValue (scenario.delay));
+  p2p.SetQueue (scenario.queue);
+  Ipv4AddressHelper addresses ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      addresses.Assign (p2p.Install (routers.Get (links[i].first), routers.Get (links[i].second)));
+      addresses.NewNetwork ();
+    }
+  for (uint32_t i = 0; i < nPmus; i++)
+    {
+      addresses.Assign (p2p.Install (pmus.Get (i), routers.Get (i % nRouters)));
+      addresses.NewNetwork ();
+    }
+  Ipv4Address collectorAddresses[2];
+  uint32_t collectorRouters[2] = { pdcRouter, wacRouter };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ipv4InterfaceContainer interfaces =
+        addresses.Assign (p2p.Install (collectors.Get (i), routers.Get (collectorRouters[i])));
+      collectorAddresses[i] = interfaces.GetAddress (0);
+      addresses.NewNetwork ();
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The PDC listens on port 6000 and the WAC on port 5000, as in the
+  // case39 scenarios.
+  uint16_t ports[2] = { 6000, 5000 };
+  uint32_t nCollectors = scenario.wac ? 2 : 1;
+  for (uint32_t i = 0; i < nCollectors; i++)
+    {
+      ProducerHelper producer;
+      producer.SetAttribute ("LocalPort", UintegerValue (ports[i]));
+      producer.Install (collectors.Get (i));
+
+      SubscriberHelper subscriber;
+      subscriber.SetAttribute ("RemoteAddress", AddressValue (InetSocketAddress (collectorAddresses[i], ports[i])));
+      subscriber.SetAttribute ("Frequency", TimeValue (Seconds (scenario.interval)));
+      subscriber.SetAttribute ("Subscription", UintegerValue (0));
+      subscriber.SetAttribute ("PacketSize", UintegerValue (scenario.packetSize));
+      subscriber.SetAttribute ("Offset", UintegerValue (0));
+      subscriber.Install (pmus);
+      for (uint32_t j = 0; j < nPmus; j++)
+        {
+          flowPaths.AddFlow (pmus.Get (j), collectorAddresses[i]);
+        }
+    }
+  if (scenario.routing == "flowpath")
+    {
+      BooleanValue routeCache;
+      routers.Get (0)->GetObject<Ipv4L3Protocol> ()->GetAttribute ("RouteCache", routeCache);
+      if (routeCache.Get ())
+        {
+          std::cerr << "warning: the route cache is turned off with --routing=flowpath" << std::endl;
+        }
+      flowPaths.PopulateFlowPaths ();
+    }
+
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::iCenSSubscriber/SentPacket",
+                                 MakeCallback (&PmuSent));
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::iCenSSubscriber/ReceivedPacket",
+                                 MakeCallback (&PmuReceived));
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::iCenSProducer/ReceivedPacket",
+                                 MakeCallback (&CollectorReceived));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyTxEnd",
+                                 MakeCallback (&LinkTransmitted));
+  // The crossings between the layers, for the profile.
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacRx",
+                                 MakeCallback (&DeviceReceived));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                 MakeCallback (&InternetSent));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/MacTx",
+                                 MakeCallback (&DeviceSent));
+
+  return routers.GetN () + pmus.GetN () + collectors.GetN ();
+}
+
+/**
+ * \param eventType the name of an event type of the profile
+ * \returns the layer the time of the events is charged to until
+ * they enter another layer
+ */
+static std::string
+GetLayer (const std::string &eventType)
+{
+  if (eventType.find ("iCenS") != std::string::npos)
+    {
+      return "application";
+    }
+  if (eventType.find ("PointToPoint") != std::string::npos
+      || eventType.find ("Queue") != std::string::npos)
+    {
+      return "device";
+    }
+  if (eventType.find ("Ipv4") != std::string::npos
+      || eventType.find ("Arp") != std::string::npos
+      || eventType.find ("Udp") != std::string::npos
+      || eventType.find ("Icmp") != std::string::npos)
+    {
+      return "internet";
+    }
+  return "other";
+}
+
+/** The profile of the events, read back from the profiler output. */
+struct Profile
+{
+  uint64_t events;                        //!< Number of events
+  std::map<std::string, double> layerMs;  //!< Time per layer, in ms
+  std::map<std::string, uint64_t> layerEvents;  //!< Events per layer, by event type
+  std::map<std::string, uint64_t> layerEntries; //!< Packets entering each layer
+};
+
+/**
+ * Read the flat profile of the event profiler.
+ *
+ * \param is the flat profile
+ * \returns the profile
+ */
+static Profile
+ReadProfile (std::istream &is)
+{
+  Profile profile;
+  profile.events = 0;
+  std::string line;
+  std::string section;
+  while (std::getline (is, line))
+    {
+      if (line.compare (0, 10, "# events: ") == 0)
+        {
+          profile.events = std::strtoull (line.c_str () + 10, 0, 10);
+        }
+      else if (line.find ("%time") != std::string::npos)
+        {
+          section = line.substr (line.rfind ("  ") + 2);
+        }
+      else if (line.empty ())
+        {
+          section = "";
+        }
+      else if (section == "event type" || section == "scope")
+        {
+          // %time total(ms) calls ns/call name
+          std::istringstream fields (line);
+          double percent;
+          double ms;
+          uint64_t calls;
+          double ns;
+          fields >> percent >> ms >> calls >> ns;
+          std::string name;
+          std::getline (fields >> std::ws, name);
+          if (section == "scope")
+            {
+              profile.layerMs[name] += ms;
+              profile.layerEntries[name] += calls;
+            }
+          else
+            {
+              std::string layer = GetLayer (name);
+              profile.layerMs[layer] += ms;
+              profile.layerEvents[layer] += calls;
+            }
+        }
+    }
+  return profile;
+}
+
+int
+main (int argc, char *argv[])
+{
+  Scenario scenario;
+  scenario.topology = "star";
+  scenario.size = 20;
+  scenario.duration = 10;
+  scenario.interval = 0.02;
+  scenario.packetSize = 200;
+  scenario.wac = true;
+  scenario.dataRate = "100Mbps";
+  scenario.delay = "1ms";
+  scenario.queue = "ns3::DropTailQueue";
+  scenario.routing = "global";
+  std::string json = "";
+  std::string profileFile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("topology", "star, grid or case39", scenario.topology);
+  cmd.AddValue ("size", "Number of PMUs of the star, side of the grid", scenario.size);
+  cmd.AddValue ("duration", "Simulated duration, in seconds", scenario.duration);
+  cmd.AddValue ("interval", "Interval between the measurements of a PMU, in seconds", scenario.interval);
+  cmd.AddValue ("packetSize", "Size of the measurements, in bytes", scenario.packetSize);
+  cmd.AddValue ("wac", "Whether the PMUs also report to a WAC", scenario.wac);
+  cmd.AddValue ("dataRate", "Data rate of the links", scenario.dataRate);
+  cmd.AddValue ("delay", "Delay of the links", scenario.delay);
+  cmd.AddValue ("queue", "Queue of the devices", scenario.queue);
+  cmd.AddValue ("routing", "global, or flowpath for the PMU flows", scenario.routing);
+  cmd.AddValue ("json", "File the results are written to, standard output if empty", json);
+  cmd.AddValue ("profile", "Prefix of the event profile files, none if empty", profileFile);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EnableProfiling", BooleanValue (true));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (profileFile));
+
+  g_counters.sent = 0;
+  g_counters.received = 0;
+  g_counters.acks = 0;
+  g_counters.hops = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint32_t nNodes = Build (scenario);
+  int64_t setupMs = clock.End ();
+
+  g_profiler = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ())->GetProfiler ();
+  for (uint32_t i = 0; i < N_LAYERS; i++)
+    {
+      g_layerScopes[i] = g_profiler->GetScope (g_layerNames[i]);
+    }
+
+  uint64_t allocations = g_allocations;
+  uint64_t packetAllocations = 0;
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      packetAllocations -= PacketAllocator::GetStatistics (i).allocations;
+    }
+  clock.Start ();
+  Simulator::Stop (Seconds (scenario.duration));
+  Simulator::Run ();
+  int64_t runMs = clock.End ();
+  allocations = g_allocations - allocations;
+  for (uint32_t i = 0; i < PacketAllocator::GetNStatistics (); i++)
+    {
+      packetAllocations += PacketAllocator::GetStatistics (i).allocations;
+    }
+  std::stringstream flat;
+  g_profiler->PrintFlat (flat);
+  Profile profile = ReadProfile (flat);
+  g_profiler = 0;
+  Simulator::Destroy ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  double seconds = runMs > 0 ? runMs / 1000.0 : 0.001;
+
+  std::ofstream file;
+  if (!json.empty ())
+    {
+      file.open (json.c_str ());
+    }
+  std::ostream &os = json.empty () ? std::cout : file;
+  os << "{" << std::endl
+     << "  \"topology\": \"" << scenario.topology << "\"," << std::endl
+     << "  \"size\": " << scenario.size << "," << std::endl
+     << "  \"nodes\": " << nNodes << "," << std::endl
+     << "  \"simulatedSeconds\": " << scenario.duration << "," << std::endl
+     << "  \"interval\": " << scenario.interval << "," << std::endl
+     << "  \"packetSize\": " << scenario.packetSize << "," << std::endl
+     << "  \"queue\": \"" << scenario.queue << "\"," << std::endl
+     << "  \"routing\": \"" << scenario.routing << "\"," << std::endl
+     << "  \"setupMs\": " << setupMs << "," << std::endl
+     << "  \"runMs\": " << runMs << "," << std::endl
+     << "  \"events\": " << profile.events << "," << std::endl
+     << "  \"eventsPerSecond\": " << profile.events / seconds << "," << std::endl
+     << "  \"packetsSent\": " << g_counters.sent << "," << std::endl
+     << "  \"packetsReceived\": " << g_counters.received << "," << std::endl
+     << "  \"acksReceived\": " << g_counters.acks << "," << std::endl
+     << "  \"linkTransmissions\": " << g_counters.hops << "," << std::endl
+     << "  \"packetsPerSecond\": " << g_counters.hops / seconds << "," << std::endl
+     << "  \"peakRssKb\": " << usage.ru_maxrss << "," << std::endl
+     << "  \"peakRssKbPerNode\": " << double (usage.ru_maxrss) / nNodes << "," << std::endl
+     << "  \"allocations\": " << allocations << "," << std::endl
+     << "  \"packetAllocations\": " << packetAllocations << "," << std::endl
+     << "  \"layers\": {";
+  for (std::map<std::string, double>::const_iterator i = profile.layerMs.begin ();
+       i != profile.layerMs.end (); ++i)
+    {
+      os << (i == profile.layerMs.begin () ? "" : ",") << std::endl
+         << "    \"" << i->first << "\": { \"ms\": " << i->second
+         << ", \"events\": " << profile.layerEvents[i->first]
+         << ", \"entries\": " << profile.layerEntries[i->first] << " }";
+    }
+  os << std::endl << "  }" << std::endl
+     << "}" << std::endl;
+  return 0;
+}
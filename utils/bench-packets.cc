@@ -21,6 +21,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-allocator.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -336,12 +337,14 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool printAllocator = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("print-allocator", "print the packet allocator statistics", printAllocator);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -360,5 +363,11 @@ int main (int argc, char *argv[])
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
 
+  if (printAllocator)
+    {
+      std::cout << std::endl << "Packet allocator statistics:" << std::endl;
+      PacketAllocator::PrintStatistics (std::cout);
+    }
+
   return 0;
 }